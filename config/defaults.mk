@@ -107,6 +107,7 @@ MFEM_THREAD_SAFE       = NO
 MFEM_USE_OPENMP        = NO
 MFEM_USE_LEGACY_OPENMP = NO
 MFEM_USE_MEMALLOC      = YES
+MFEM_USE_JIT           = NO
 MFEM_TIMER_TYPE        = $(if $(NOTMAC),2,4)
 MFEM_USE_SUNDIALS      = NO
 MFEM_USE_MESQUITE      = NO
@@ -135,6 +136,10 @@ ZLIB_RPATH = -Wl,-rpath,$(ZLIB_DIR)/lib
 LIBUNWIND_OPT = -g
 LIBUNWIND_LIB = $(if $(NOTMAC),-lunwind -ldl,)
 
+# Runtime compilation of kernels: the dynamic loader library.
+JIT_OPT =
+JIT_LIB = $(if $(NOTMAC),-ldl,)
+
 # HYPRE library configuration (needed to build the parallel version)
 HYPRE_DIR = @MFEM_DIR@/../hypre-2.10.0b/src/hypre
 HYPRE_OPT = -I$(HYPRE_DIR)/include
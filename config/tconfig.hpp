@@ -47,7 +47,8 @@ namespace mfem
 {
 namespace internal
 {
-long long flop_count;
+// Defined in general/globals.cpp.
+extern long long flop_count;
 }
 }
 
@@ -125,20 +125,19 @@ void BilinearForm::SetAssemblyLevel(AssemblyLevel assembly_level)
          if (Device::IsEnabled())
          {
             mfem_error("Full assembly not supported yet in device mode!");
-            // ext = new FABilinearFormExtension(this);
          }
-         // Use the original BilinearForm implementation for now
+         // The domain integrators are assembled by the extension, the rest
+         // uses the original BilinearForm implementation
+         ext = new FABilinearFormExtension(this);
          break;
       case AssemblyLevel::ELEMENT:
-         mfem_error("Element assembly not supported yet... stay tuned!");
-         // ext = new EABilinearFormExtension(this);
+         ext = new EABilinearFormExtension(this);
          break;
       case AssemblyLevel::PARTIAL:
          ext = new PABilinearFormExtension(this);
          break;
       case AssemblyLevel::NONE:
-         mfem_error("Matrix-free action not supported yet... stay tuned!");
-         // ext = new MFBilinearFormExtension(this);
+         ext = new MFBilinearFormExtension(this);
          break;
       default:
          mfem_error("Unknown assembly level");
@@ -344,15 +343,28 @@ void BilinearForm::AssembleBdrElementMatrix(
 
 void BilinearForm::Assemble(int skip_zeros)
 {
-   if (Device::IsEnabled() && (assembly != AssemblyLevel::PARTIAL))
+   if (Device::IsEnabled() && (assembly == AssemblyLevel::FULL))
    {
       mfem_error("Chosen assembly level not supported yet in device mode!");
    }
 
+   // With AssemblyLevel::FULL, the domain integrators are assembled by ext,
+   // unless the form uses features that ext does not support.
+   bool ext_assembled = false;
    if (ext)
    {
-      ext->Assemble();
-      return;
+      if (assembly != AssemblyLevel::FULL)
+      {
+         ext->Assemble();
+         return;
+      }
+      FABilinearFormExtension *fa_ext =
+         static_cast<FABilinearFormExtension*>(ext);
+      if (fa_ext->IsSupported())
+      {
+         fa_ext->Assemble();
+         ext_assembled = true;
+      }
    }
 
    ElementTransformation *eltrans;
@@ -366,14 +378,14 @@ void BilinearForm::Assemble(int skip_zeros)
 
 #ifdef MFEM_USE_LEGACY_OPENMP
    int free_element_matrices = 0;
-   if (!element_matrices)
+   if (!element_matrices && !ext_assembled)
    {
       ComputeElementMatrices();
       free_element_matrices = 1;
    }
 #endif
 
-   if (dbfi.Size())
+   if (dbfi.Size() && !ext_assembled)
    {
       for (int i = 0; i < fes -> GetNE(); i++)
       {
@@ -549,6 +561,19 @@ void BilinearForm::Assemble(int skip_zeros)
 #endif
 }
 
+void BilinearForm::AssembleDiagonal(Vector &diag) const
+{
+   diag.SetSize(fes->GetVSize());
+   if (ext && assembly != AssemblyLevel::FULL)
+   {
+      ext->AssembleDiagonal(diag);
+      return;
+   }
+   MFEM_VERIFY(mat != NULL && mat->Finalized(),
+               "the form must be assembled and finalized");
+   mat->GetDiag(diag);
+}
+
 void BilinearForm::ConformingAssemble()
 {
    // Do not remove zero entries to preserve the symmetric structure of the
@@ -588,7 +613,7 @@ void BilinearForm::FormLinearSystem(const Array<int> &ess_tdof_list, Vector &x,
                                     Vector &b, OperatorHandle &A, Vector &X,
                                     Vector &B, int copy_interior)
 {
-   if (ext)
+   if (ext && assembly != AssemblyLevel::FULL)
    {
       ext->FormLinearSystem(ess_tdof_list, x, b, A, X, B, copy_interior);
       return;
@@ -658,7 +683,7 @@ void BilinearForm::FormLinearSystem(const Array<int> &ess_tdof_list, Vector &x,
 void BilinearForm::FormSystemMatrix(const Array<int> &ess_tdof_list,
                                     OperatorHandle &A)
 {
-   if (ext)
+   if (ext && assembly != AssemblyLevel::FULL)
    {
       ext->FormSystemMatrix(ess_tdof_list, A);
       return;
@@ -701,7 +726,7 @@ void BilinearForm::FormSystemMatrix(const Array<int> &ess_tdof_list,
 void BilinearForm::RecoverFEMSolution(const Vector &X,
                                       const Vector &b, Vector &x)
 {
-   if (ext)
+   if (ext && assembly != AssemblyLevel::FULL)
    {
       ext->RecoverFEMSolution(X, b, x);
       return;
@@ -1008,6 +1033,8 @@ MixedBilinearForm::MixedBilinearForm (FiniteElementSpace *tr_fes,
    test_fes = te_fes;
    mat = NULL;
    extern_bfs = 0;
+   assembly = AssemblyLevel::FULL;
+   ext = NULL;
 }
 
 MixedBilinearForm::MixedBilinearForm (FiniteElementSpace *tr_fes,
@@ -1019,6 +1046,8 @@ MixedBilinearForm::MixedBilinearForm (FiniteElementSpace *tr_fes,
    test_fes = te_fes;
    mat = NULL;
    extern_bfs = 1;
+   assembly = AssemblyLevel::FULL;
+   ext = NULL;
 
    // Copy the pointers to the integrators
    dom = mbf->dom;
@@ -1036,23 +1065,73 @@ const double & MixedBilinearForm::Elem (int i, int j) const
    return (*mat)(i, j);
 }
 
+void MixedBilinearForm::SetAssemblyLevel(AssemblyLevel assembly_level)
+{
+   if (ext)
+   {
+      MFEM_ABORT("the assembly level has already been set!");
+   }
+   assembly = assembly_level;
+   switch (assembly)
+   {
+      case AssemblyLevel::FULL:
+         // Use the original MixedBilinearForm implementation
+         break;
+      case AssemblyLevel::PARTIAL:
+         ext = new PAMixedBilinearFormExtension(this);
+         break;
+      case AssemblyLevel::ELEMENT:
+      case AssemblyLevel::NONE:
+         mfem_error("Assembly level not supported yet for MixedBilinearForm");
+         break;
+      default:
+         mfem_error("Unknown assembly level");
+   }
+}
+
 void MixedBilinearForm::Mult (const Vector & x, Vector & y) const
 {
+   if (ext)
+   {
+      ext->Mult(x, y);
+      return;
+   }
    mat -> Mult (x, y);
 }
 
 void MixedBilinearForm::AddMult (const Vector & x, Vector & y,
                                  const double a) const
 {
+   if (ext)
+   {
+      ext->AddMult(x, y, a);
+      return;
+   }
    mat -> AddMult (x, y, a);
 }
 
 void MixedBilinearForm::AddMultTranspose (const Vector & x, Vector & y,
                                           const double a) const
 {
+   if (ext)
+   {
+      ext->AddMultTranspose(x, y, a);
+      return;
+   }
    mat -> AddMultTranspose (x, y, a);
 }
 
+void MixedBilinearForm::MultTranspose (const Vector & x, Vector & y) const
+{
+   if (ext)
+   {
+      ext->MultTranspose(x, y);
+      return;
+   }
+   y = 0.0;
+   AddMultTranspose (x, y);
+}
+
 MatrixInverse * MixedBilinearForm::Inverse() const
 {
    return mat -> Inverse ();
@@ -1060,6 +1139,7 @@ MatrixInverse * MixedBilinearForm::Inverse() const
 
 void MixedBilinearForm::Finalize (int skip_zeros)
 {
+   if (ext) { return; }
    mat -> Finalize (skip_zeros);
 }
 
@@ -1099,6 +1179,15 @@ void MixedBilinearForm::Assemble (int skip_zeros)
 
    Mesh *mesh = test_fes -> GetMesh();
 
+   if (ext)
+   {
+      MFEM_VERIFY(bdr.Size() == 0 && skt.Size() == 0,
+                  "only domain integrators are supported with partial "
+                  "assembly");
+      ext->Assemble();
+      return;
+   }
+
    if (mat == NULL)
    {
       mat = new SparseMatrix(height, width);
@@ -1256,11 +1345,14 @@ void MixedBilinearForm::Update()
    mat = NULL;
    height = test_fes->GetVSize();
    width = trial_fes->GetVSize();
+
+   if (ext) { ext->Update(); }
 }
 
 MixedBilinearForm::~MixedBilinearForm()
 {
    if (mat) { delete mat; }
+   delete ext;
    if (!extern_bfs)
    {
       int i;
@@ -48,6 +48,8 @@ enum class AssemblyLevel
     BLFIntegrators. */
 class BilinearForm : public Matrix
 {
+   friend class FABilinearFormExtension;
+
 protected:
    /// Sparse matrix to be associated with the form. Owned.
    SparseMatrix *mat;
@@ -319,6 +321,15 @@ public:
    /// Assembles the form i.e. sums over all domain/bdr integrators.
    void Assemble(int skip_zeros = 1);
 
+   /** @brief Assemble the diagonal of the bilinear form into @a diag, a vector
+       of size fes->GetVSize().
+
+       With partial assembly, the diagonal is computed from the quadrature data
+       by BilinearFormIntegrator::AssembleDiagonalPA(), otherwise it is taken
+       from the assembled and finalized matrix. Essential dofs are not
+       eliminated. */
+   void AssembleDiagonal(Vector &diag) const;
+
    /// Get the finite element space prolongation matrix
    virtual const Operator *GetProlongation() const
    { return fes->GetConformingProlongation(); }
@@ -524,6 +535,12 @@ protected:
    /// Trace face (skeleton) integrators.
    Array<BilinearFormIntegrator*> skt;
 
+   /// The form assembly level (full, partial, etc.)
+   AssemblyLevel assembly;
+   /** Extension for supporting Partial Assembly (PA). Only domain integrators
+       are supported with PA. */
+   MixedBilinearFormExtension *ext;
+
 private:
    /// Copy construction is not supported; body is undefined.
    MixedBilinearForm(const MixedBilinearForm &);
@@ -564,13 +581,28 @@ public:
    virtual void AddMultTranspose(const Vector & x, Vector & y,
                                  const double a = 1.0) const;
 
-   virtual void MultTranspose(const Vector & x, Vector & y) const
-   { y = 0.0; AddMultTranspose (x, y); }
+   virtual void MultTranspose(const Vector & x, Vector & y) const;
 
    virtual MatrixInverse *Inverse() const;
 
    virtual void Finalize(int skip_zeros = 1);
 
+   /// Set the desired assembly level. The default is AssemblyLevel::FULL.
+   /** This method must be called before assembly. With AssemblyLevel::PARTIAL
+       the form can be applied with Mult(), AddMult(), MultTranspose() and
+       AddMultTranspose(), but the SparseMatrix is not available. */
+   void SetAssemblyLevel(AssemblyLevel assembly_level);
+
+   /// Return the trial FE space associated with the MixedBilinearForm.
+   FiniteElementSpace *TrialFESpace() { return trial_fes; }
+   /// Read-only access to the associated trial FiniteElementSpace.
+   const FiniteElementSpace *TrialFESpace() const { return trial_fes; }
+
+   /// Return the test FE space associated with the MixedBilinearForm.
+   FiniteElementSpace *TestFESpace() { return test_fes; }
+   /// Read-only access to the associated test FiniteElementSpace.
+   const FiniteElementSpace *TestFESpace() const { return test_fes; }
+
    /** Extract the associated matrix as SparseMatrix blocks. The number of
        block rows and columns is given by the vector dimensions (vdim) of the
        test and trial spaces, respectively. */
@@ -10,10 +10,15 @@
 // Software Foundation) version 2.1 dated February 1999.
 
 // Implementations of classes FABilinearFormExtension, EABilinearFormExtension,
-// PABilinearFormExtension and MFBilinearFormExtension.
+// PABilinearFormExtension, MFBilinearFormExtension,
+// PAMixedBilinearFormExtension, ElemRestriction and FaceRestriction.
 
 #include "../general/forall.hpp"
 #include "bilinearform.hpp"
+#include "tbilinearform_registry.hpp"
+
+#include <algorithm>
+#include <cmath>
 
 namespace mfem
 {
@@ -34,27 +39,370 @@ const Operator *BilinearFormExtension::GetRestriction() const
    return a->GetRestriction();
 }
 
+void BilinearFormExtension::AssembleDiagonal(Vector &) const
+{
+   MFEM_ABORT("AssembleDiagonal is not supported by this assembly level");
+}
+
+
+// Data and methods for fully-assembled bilinear forms
+FABilinearFormExtension::FABilinearFormExtension(BilinearForm *form)
+   : BilinearFormExtension(form), sequence(-1) { }
+
+void FABilinearFormExtension::Setup()
+{
+   const FiniteElementSpace &fes = *a->FESpace();
+   const int ne = fes.GetNE();
+   const int n = fes.GetVSize();
+
+   // Element-to-vdof table; the signs of the vdofs are dropped.
+   Table elem_vdof;
+   Array<int> vdofs;
+   elem_vdof.MakeI(ne);
+   for (int e = 0; e < ne; e++)
+   {
+      elem_vdof.AddColumnsInRow(e, fes.GetFE(e)->GetDof()*fes.GetVDim());
+   }
+   elem_vdof.MakeJ();
+   for (int e = 0; e < ne; e++)
+   {
+      fes.GetElementVDofs(e, vdofs);
+      for (int i = 0; i < vdofs.Size(); i++)
+      {
+         const int vd = vdofs[i];
+         vdofs[i] = (vd >= 0) ? vd : -1-vd;
+      }
+      elem_vdof.AddConnections(e, vdofs.GetData(), vdofs.Size());
+   }
+   elem_vdof.ShiftUpI();
+
+   Table vdof_elem;
+   Transpose(elem_vdof, vdof_elem, n);
+   mfem::Mult(vdof_elem, elem_vdof, dof_dof);
+   dof_dof.SortRows();
+
+   // CSR positions of the element matrix entries; entries whose sign is
+   // flipped by the orientation of the vdofs are stored as -1-pos.
+   const int *I = dof_dof.GetI(), *J = dof_dof.GetJ();
+   slot_offsets.SetSize(ne+1);
+   slot_offsets[0] = 0;
+   for (int e = 0; e < ne; e++)
+   {
+      const int nd = elem_vdof.RowSize(e);
+      slot_offsets[e+1] = slot_offsets[e] + nd*nd;
+   }
+   slots.SetSize(slot_offsets[ne]);
+   for (int e = 0; e < ne; e++)
+   {
+      fes.GetElementVDofs(e, vdofs);
+      const int nd = vdofs.Size();
+      int *eslots = slots.GetData() + slot_offsets[e];
+      for (int j = 0; j < nd; j++)
+      {
+         const int col = (vdofs[j] >= 0) ? vdofs[j] : -1-vdofs[j];
+         for (int i = 0; i < nd; i++)
+         {
+            const int row = (vdofs[i] >= 0) ? vdofs[i] : -1-vdofs[i];
+            const int pos = std::lower_bound(J + I[row], J + I[row+1], col) - J;
+            const bool plus = (vdofs[i] >= 0) == (vdofs[j] >= 0);
+            eslots[i + nd*j] = plus ? pos : -1-pos;
+         }
+      }
+   }
+
+   // Greedy coloring of the elements: elements sharing a vdof get different
+   // colors. The elements are visited in order, so the coloring is
+   // deterministic.
+   Array<int> elem_color(ne), color_mark;
+   int ncolors = 0;
+   for (int e = 0; e < ne; e++)
+   {
+      const int *ev = elem_vdof.GetRow(e);
+      for (int i = 0; i < elem_vdof.RowSize(e); i++)
+      {
+         const int *ve = vdof_elem.GetRow(ev[i]);
+         for (int k = 0; k < vdof_elem.RowSize(ev[i]); k++)
+         {
+            if (ve[k] < e) { color_mark[elem_color[ve[k]]] = e; }
+         }
+      }
+      int c = 0;
+      while (c < ncolors && color_mark[c] == e) { c++; }
+      if (c == ncolors)
+      {
+         color_mark.Append(-1);
+         ncolors++;
+      }
+      elem_color[e] = c;
+   }
+   Transpose(elem_color, color_elem, ncolors);
+
+   sequence = fes.GetSequence();
+}
+
+bool FABilinearFormExtension::IsSupported() const
+{
+   return a->GetFBFI()->Size() == 0 && !a->static_cond &&
+          !a->hybridization && !a->element_matrices;
+}
+
+void FABilinearFormExtension::Assemble()
+{
+   MFEM_VERIFY(IsSupported(), "interior face integrators, static "
+               "condensation, hybridization and element matrices are not "
+               "supported with FABilinearFormExtension");
+   FiniteElementSpace &fes = *a->FESpace();
+   if (sequence != fes.GetSequence()) { Setup(); }
+
+   if (a->mat && !a->mat->Finalized() && a->mat->NumNonZeroElems() == 0)
+   {
+      // Replace the empty matrix allocated by the BilinearForm.
+      delete a->mat;
+      a->mat = NULL;
+   }
+   if (a->mat == NULL)
+   {
+      const int n = fes.GetVSize();
+      const int nnz = dof_dof.Size_of_connections();
+      int *I = mfem::New<int>(n+1);
+      int *J = mfem::New<int>(nnz);
+      double *data = mfem::New<double>(nnz);
+      std::copy(dof_dof.GetI(), dof_dof.GetI() + n + 1, I);
+      std::copy(dof_dof.GetJ(), dof_dof.GetJ() + nnz, J);
+      a->mat = new SparseMatrix(I, J, data, n, n, true, true, true);
+      *a->mat = 0.0;
+   }
+   MFEM_VERIFY(a->mat->Finalized() &&
+               a->mat->NumNonZeroElems() == dof_dof.Size_of_connections(),
+               "the matrix does not match the sparsity pattern");
+
+   Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
+   if (integrators.Size() == 0) { return; }
+   double *data = a->mat->GetData();
+   const int ncolors = color_elem.Size();
+
+#if defined(MFEM_USE_OPENMP) && defined(MFEM_THREAD_SAFE)
+   #pragma omp parallel
+#endif
+   {
+      // Thread-local scratch data
+      DenseMatrix elmat, elmat_k;
+      IsoparametricTransformation T;
+      for (int c = 0; c < ncolors; c++)
+      {
+         const int nce = color_elem.RowSize(c);
+         const int *elems = color_elem.GetRow(c);
+#if defined(MFEM_USE_OPENMP) && defined(MFEM_THREAD_SAFE)
+         #pragma omp for schedule(static)
+#endif
+         for (int k = 0; k < nce; k++)
+         {
+            const int e = elems[k];
+            const FiniteElement &fe = *fes.GetFE(e);
+            fes.GetElementTransformation(e, &T);
+            integrators[0]->AssembleElementMatrix(fe, T, elmat);
+            for (int i = 1; i < integrators.Size(); i++)
+            {
+               integrators[i]->AssembleElementMatrix(fe, T, elmat_k);
+               elmat += elmat_k;
+            }
+            // No other element of this color writes to these slots.
+            const int nd2 = slot_offsets[e+1] - slot_offsets[e];
+            const int *eslots = slots.GetData() + slot_offsets[e];
+            const double *ed = elmat.Data();
+            for (int i = 0; i < nd2; i++)
+            {
+               const int s = eslots[i];
+               if (s >= 0) { data[s] += ed[i]; }
+               else { data[-1-s] -= ed[i]; }
+            }
+         }
+      }
+   }
+}
+
+void FABilinearFormExtension::FormSystemMatrix(const Array<int> &,
+                                               OperatorHandle &)
+{
+   MFEM_ABORT("the system matrix is formed by the BilinearForm");
+}
+
+void FABilinearFormExtension::FormLinearSystem(const Array<int> &,
+                                               Vector &, Vector &,
+                                               OperatorHandle &,
+                                               Vector &, Vector &, int)
+{
+   MFEM_ABORT("the linear system is formed by the BilinearForm");
+}
+
+void FABilinearFormExtension::Mult(const Vector &x, Vector &y) const
+{
+   a->SpMat().Mult(x, y);
+}
+
+void FABilinearFormExtension::MultTranspose(const Vector &x, Vector &y) const
+{
+   a->SpMat().MultTranspose(x, y);
+}
+
+void FABilinearFormExtension::Update()
+{
+   sequence = -1;
+   dof_dof.Clear();
+   slot_offsets.DeleteAll();
+   slots.DeleteAll();
+   color_elem.Clear();
+}
 
 // Data and methods for partially-assembled bilinear forms
 PABilinearFormExtension::PABilinearFormExtension(BilinearForm *form) :
    BilinearFormExtension(form),
    trialFes(a->FESpace()), testFes(a->FESpace()),
-   localX(trialFes->GetNE() * trialFes->GetFE(0)->GetDof() * trialFes->GetVDim()),
-   localY( testFes->GetNE() * testFes->GetFE(0)->GetDof() * testFes->GetVDim()),
-   elem_restrict(new ElemRestriction(*a->FESpace())) { }
+   elem_restrict(new ElemRestriction(*a->FESpace())),
+   int_face_restrict(NULL), bdr_face_restrict(NULL),
+   integs_assembled(false)
+{
+   localX.SetSize(elem_restrict->nedofs * trialFes->GetVDim());
+   localY.SetSize(elem_restrict->nedofs * testFes->GetVDim());
+}
 
 PABilinearFormExtension::~PABilinearFormExtension()
 {
+   DeleteTemplatedForms();
    delete elem_restrict;
+   delete int_face_restrict;
+   delete bdr_face_restrict;
+}
+
+void PABilinearFormExtension::SetupFaceRestrictions()
+{
+   const FiniteElementSpace &fes = *a->FESpace();
+   if (a->GetFBFI()->Size() > 0 && int_face_restrict == NULL)
+   {
+      int_face_restrict = new FaceRestriction(fes, true);
+      intFaceX.SetSize(int_face_restrict->Height());
+      intFaceY.SetSize(int_face_restrict->Height());
+   }
+   if (a->GetBFBFI()->Size() > 0 && bdr_face_restrict == NULL)
+   {
+      bdr_face_restrict = new FaceRestriction(fes, false);
+      bdrFaceX.SetSize(bdr_face_restrict->Height());
+      bdrFaceY.SetSize(bdr_face_restrict->Height());
+   }
+}
+
+void PABilinearFormExtension::DeleteTemplatedForms()
+{
+   for (int i = 0; i < tforms.Size(); ++i) { delete tforms[i]; }
+   tforms.SetSize(0);
+}
+
+void PABilinearFormExtension::SetupTemplatedForms()
+{
+   DeleteTemplatedForms();
+   Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
+   for (int i = 0; i < integrators.Size(); ++i)
+   {
+      Operator *op = TBilinearFormRegistry::Create(*integrators[i],
+                                                   *a->FESpace());
+      if (!op)
+      {
+         DeleteTemplatedForms();
+         return;
+      }
+      tforms.Append(op);
+   }
 }
 
 void PABilinearFormExtension::Assemble()
 {
+   // The PA data of the integrators is assembled on demand, e.g. for the
+   // diagonal, when the templated operators are used.
+   SetupTemplatedForms();
+   integs_assembled = false;
+   if (tforms.Size() == 0)
+   {
+      Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
+      const int integratorCount = integrators.Size();
+      for (int i = 0; i < integratorCount; ++i)
+      {
+         integrators[i]->Assemble(*a->FESpace());
+      }
+      integs_assembled = true;
+   }
+
+   Array<BilinearFormIntegrator*> &fintegs = *a->GetFBFI();
+   Array<BilinearFormIntegrator*> &bfintegs = *a->GetBFBFI();
+   Array<Array<int>*> &bf_marker = *a->GetBFBFI_Marker();
+   for (int i = 0; i < bf_marker.Size(); ++i)
+   {
+      MFEM_VERIFY(bf_marker[i] == NULL,
+                  "boundary face markers are not supported with PA");
+   }
+   SetupFaceRestrictions();
+   for (int i = 0; i < fintegs.Size(); ++i)
+   {
+      fintegs[i]->AssembleInteriorFaces(*a->FESpace());
+   }
+   for (int i = 0; i < bfintegs.Size(); ++i)
+   {
+      bfintegs[i]->AssembleBoundaryFaces(*a->FESpace());
+   }
+}
+
+void PABilinearFormExtension::AssembleDiagonal(Vector &diag) const
+{
+   MFEM_VERIFY(a->GetFBFI()->Size() == 0 && a->GetBFBFI()->Size() == 0,
+               "face integrators are not supported by AssembleDiagonal");
    Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
-   const int integratorCount = integrators.Size();
-   for (int i = 0; i < integratorCount; ++i)
+   if (!integs_assembled)
+   {
+      for (int i = 0; i < integrators.Size(); ++i)
+      {
+         integrators[i]->Assemble(*a->FESpace());
+      }
+      integs_assembled = true;
+   }
+   localY = 0.0;
+   for (int i = 0; i < integrators.Size(); ++i)
+   {
+      integrators[i]->AssembleDiagonalPA(localY);
+   }
+   elem_restrict->MultTranspose(localY, diag);
+}
+
+void PABilinearFormExtension::AddMultFaces(const Vector &x, Vector &y,
+                                           const bool transpose) const
+{
+   Array<BilinearFormIntegrator*> &fintegs = *a->GetFBFI();
+   Array<BilinearFormIntegrator*> &bfintegs = *a->GetBFBFI();
+   if (fintegs.Size() > 0)
    {
-      integrators[i]->Assemble(*a->FESpace());
+      int_face_restrict->Mult(x, intFaceX);
+      intFaceY = 0.0;
+      for (int i = 0; i < fintegs.Size(); ++i)
+      {
+         if (transpose)
+         {
+            fintegs[i]->MultAssembledTranspose(intFaceX, intFaceY);
+         }
+         else { fintegs[i]->MultAssembled(intFaceX, intFaceY); }
+      }
+      int_face_restrict->AddMultTranspose(intFaceY, y);
+   }
+   if (bfintegs.Size() > 0)
+   {
+      bdr_face_restrict->Mult(x, bdrFaceX);
+      bdrFaceY = 0.0;
+      for (int i = 0; i < bfintegs.Size(); ++i)
+      {
+         if (transpose)
+         {
+            bfintegs[i]->MultAssembledTranspose(bdrFaceX, bdrFaceY);
+         }
+         else { bfintegs[i]->MultAssembled(bdrFaceX, bdrFaceY); }
+      }
+      bdr_face_restrict->AddMultTranspose(bdrFaceY, y);
    }
 }
 
@@ -64,12 +412,15 @@ void PABilinearFormExtension::Update()
    height = width = fes->GetVSize();
    trialFes = fes;
    testFes = fes;
-   localX.SetSize(trialFes->GetNE() * trialFes->GetFE(0)->GetDof() *
-                  trialFes->GetVDim());
-   localY.SetSize(testFes->GetNE() * testFes->GetFE(0)->GetDof() *
-                  testFes->GetVDim());
    delete elem_restrict;
    elem_restrict = new ElemRestriction(*fes);
+   localX.SetSize(elem_restrict->nedofs * trialFes->GetVDim());
+   localY.SetSize(elem_restrict->nedofs * testFes->GetVDim());
+   delete int_face_restrict;
+   delete bdr_face_restrict;
+   int_face_restrict = bdr_face_restrict = NULL;
+   DeleteTemplatedForms();
+   integs_assembled = false;
 }
 
 void PABilinearFormExtension::FormSystemMatrix(const Array<int> &ess_tdof_list,
@@ -94,8 +445,29 @@ void PABilinearFormExtension::FormLinearSystem(const Array<int> &ess_tdof_list,
    A.Reset(oper); // A will own oper
 }
 
+void PABilinearFormExtension::MultTemplated(const Vector &x, Vector &y) const
+{
+   tforms[0]->Mult(x, y);
+   if (tforms.Size() > 1)
+   {
+      // localY is used as a temporary L-vector
+      Vector ty(localY.GetData(), y.Size());
+      for (int i = 1; i < tforms.Size(); ++i)
+      {
+         tforms[i]->Mult(x, ty);
+         y += ty;
+      }
+   }
+}
+
 void PABilinearFormExtension::Mult(const Vector &x, Vector &y) const
 {
+   if (tforms.Size() > 0)
+   {
+      MultTemplated(x, y);
+      AddMultFaces(x, y, false);
+      return;
+   }
    Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
    elem_restrict->Mult(x, localX);
    localY = 0.0;
@@ -105,10 +477,36 @@ void PABilinearFormExtension::Mult(const Vector &x, Vector &y) const
       integrators[i]->MultAssembled(localX, localY);
    }
    elem_restrict->MultTranspose(localY, y);
+   AddMultFaces(x, y, false);
+}
+
+double PABilinearFormExtension::MultAndDot(const Vector &x, Vector &y) const
+{
+   if (int_face_restrict || bdr_face_restrict || tforms.Size() > 0 ||
+       Device::Allows(Backend::DEVICE_MASK))
+   {
+      return Operator::MultAndDot(x, y);
+   }
+   Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
+   elem_restrict->Mult(x, localX);
+   localY = 0.0;
+   const int iSz = integrators.Size();
+   for (int i = 0; i < iSz; ++i)
+   {
+      integrators[i]->MultAssembled(localX, localY);
+   }
+   return elem_restrict->MultTransposeAndDot(localY, x, y);
 }
 
 void PABilinearFormExtension::MultTranspose(const Vector &x, Vector &y) const
 {
+   if (tforms.Size() > 0)
+   {
+      // The mass and diffusion operators are symmetric.
+      MultTemplated(x, y);
+      AddMultFaces(x, y, true);
+      return;
+   }
    Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
    elem_restrict->Mult(x, localX);
    localY = 0.0;
@@ -118,8 +516,434 @@ void PABilinearFormExtension::MultTranspose(const Vector &x, Vector &y) const
       integrators[i]->MultAssembledTranspose(localX, localY);
    }
    elem_restrict->MultTranspose(localY, y);
+   AddMultFaces(x, y, true);
+}
+
+
+// Data and methods for element-assembled bilinear forms
+EABilinearFormExtension::EABilinearFormExtension(BilinearForm *form)
+   : PABilinearFormExtension(form) { }
+
+void EABilinearFormExtension::Assemble()
+{
+   MFEM_VERIFY(a->GetBBFI()->Size() == 0 && a->GetFBFI()->Size() == 0 &&
+               a->GetBFBFI()->Size() == 0,
+               "only domain integrators are supported with element assembly");
+   FiniteElementSpace &fes = *a->FESpace();
+   Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
+   const bool tensor = ElementBatches::UsesTensorLayout(fes);
+   const ElementBatches batches(fes);
+   const int nb = batches.Size();
+   const int vdim = fes.GetVDim();
+
+   batch_ne.SetSize(nb);
+   batch_dofs.SetSize(nb);
+   batch_dof_offsets = batches.dof_offsets;
+   ea_offsets.SetSize(nb+1);
+   ea_offsets[0] = 0;
+   for (int b = 0; b < nb; b++)
+   {
+      batch_ne[b] = batches.offsets[b+1] - batches.offsets[b];
+      batch_dofs[b] = fes.GetFE(batches.elements[batches.offsets[b]])->GetDof();
+      const int N = vdim*batch_dofs[b];
+      ea_offsets[b+1] = ea_offsets[b] + N*N*batch_ne[b];
+   }
+   ea_data.SetSize(ea_offsets[nb]);
+
+   DenseMatrix elmat, elmat_i;
+   Array<int> emap;
+   for (int b = 0; b < nb; b++)
+   {
+      const FiniteElement *fe = fes.GetFE(batches.elements[batches.offsets[b]]);
+      Array<int> dof_map;
+      if (tensor)
+      {
+         const TensorBasisElement *tel =
+            dynamic_cast<const TensorBasisElement*>(fe);
+         dof_map = tel ? tel->GetDofMap() :
+                   dynamic_cast<const VectorTensorFiniteElement*>
+                   (fe)->GetDofMap();
+      }
+      const int dof = batch_dofs[b];
+      const int N = vdim*dof;
+
+      // Map from the local ordering of the ElemRestriction to the ordering of
+      // the element matrices, with the sign of the dof_map entries.
+      emap.SetSize(N);
+      for (int c = 0; c < vdim; c++)
+      {
+         for (int i = 0; i < dof; i++)
+         {
+            const int si = (dof_map.Size() == 0) ? i : dof_map[i];
+            emap[i + dof*c] = (si >= 0) ? si + dof*c : -1-(-1-si + dof*c);
+         }
+      }
+
+      for (int k = 0; k < batch_ne[b]; k++)
+      {
+         const int e = batches.elements[batches.offsets[b] + k];
+         const FiniteElement &el = *fes.GetFE(e);
+         MFEM_VERIFY(el.GetDof() == dof, "the elements of a batch must have "
+                     "the same number of dofs");
+         ElementTransformation &T = *fes.GetElementTransformation(e);
+         elmat.SetSize(N);
+         elmat = 0.0;
+         for (int l = 0; l < integrators.Size(); l++)
+         {
+            integrators[l]->AssembleElementMatrix(el, T, elmat_i);
+            elmat += elmat_i;
+         }
+         double *A = ea_data.GetData() + ea_offsets[b] + N*N*k;
+         for (int j = 0; j < N; j++)
+         {
+            const int sj = emap[j];
+            const int jj = (sj >= 0) ? sj : -1-sj;
+            for (int i = 0; i < N; i++)
+            {
+               const int si = emap[i];
+               const int ii = (si >= 0) ? si : -1-si;
+               const bool plus = (si >= 0) == (sj >= 0);
+               A[i + N*j] = plus ? elmat(ii,jj) : -elmat(ii,jj);
+            }
+         }
+      }
+   }
+   ea_data.Push();
+}
+
+void EABilinearFormExtension::Update()
+{
+   PABilinearFormExtension::Update();
+   batch_ne.SetSize(0);
+   batch_dofs.SetSize(0);
+   batch_dof_offsets.SetSize(0);
+   ea_offsets.SetSize(0);
+   ea_data.SetSize(0);
+}
+
+// EA Apply kernel: y += A x or y += A^T x on each of the NE elements of a
+// batch, with N = VD*D dofs per element and the element matrices starting at
+// the offset AO of a. The local vectors are in the layout of the
+// ElemRestriction: the entry i of the component c of the element e of the
+// batch is at EO + e*e_stride + c*c_stride + i*i_stride. The element vectors
+// are gathered in local arrays, so that the dense products have unit stride.
+template<int T_N = 0, int MAX_N = 0>
+static void EABatchMult(const int NE,
+                        const int D,
+                        const int VD,
+                        const int NED,
+                        const bool byvdim,
+                        const bool transpose,
+                        const int AO,
+                        const int EO,
+                        const double *a,
+                        const double *_x,
+                        double *_y)
+{
+   const int N = T_N ? T_N : VD*D;
+   MFEM_VERIFY(N <= (T_N ? T_N : MAX_N), "");
+   const int e_stride = byvdim ? VD*D : D;
+   const int c_stride = byvdim ? 1 : NED;
+   const int i_stride = byvdim ? VD : 1;
+   const DeviceVector A(a, AO + N*N*NE);
+   const DeviceVector x(_x, VD*NED);
+   DeviceVector y(_y, VD*NED);
+   MFEM_FORALL(e, NE,
+   {
+      constexpr int max_N = T_N ? T_N : MAX_N;
+      double xe[max_N], ye[max_N];
+      const int eo = EO + e*e_stride;
+      const int ao = AO + N*N*e;
+      for (int c = 0; c < VD; ++c)
+      {
+         for (int i = 0; i < D; ++i)
+         {
+            xe[i + D*c] = x(eo + c*c_stride + i*i_stride);
+         }
+      }
+      if (!transpose)
+      {
+         // Column-oriented product: contiguous access to the columns.
+         for (int i = 0; i < N; ++i) { ye[i] = 0.0; }
+         for (int j = 0; j < N; ++j)
+         {
+            const double xj = xe[j];
+            for (int i = 0; i < N; ++i) { ye[i] += A(ao + i + N*j) * xj; }
+         }
+      }
+      else
+      {
+         // Dot products of the columns with the element vector.
+         for (int j = 0; j < N; ++j)
+         {
+            double yj = 0.0;
+            for (int i = 0; i < N; ++i) { yj += A(ao + i + N*j) * xe[i]; }
+            ye[j] = yj;
+         }
+      }
+      for (int c = 0; c < VD; ++c)
+      {
+         for (int i = 0; i < D; ++i)
+         {
+            y(eo + c*c_stride + i*i_stride) += ye[i + D*c];
+         }
+      }
+   });
+}
+
+static void EABatchMult(const int NE, const int D, const int VD,
+                        const int NED, const bool byvdim, const bool transpose,
+                        const int AO, const int EO, const double *a,
+                        const double *x, double *y)
+{
+   switch (VD*D)
+   {
+      // Scalar elements of orders 1-3 on quads/hexes, and of orders 1-3 on
+      // triangles/tets.
+      case 3: return EABatchMult<3>(NE,D,VD,NED,byvdim,transpose,AO,EO,a,x,y);
+      case 4: return EABatchMult<4>(NE,D,VD,NED,byvdim,transpose,AO,EO,a,x,y);
+      case 6: return EABatchMult<6>(NE,D,VD,NED,byvdim,transpose,AO,EO,a,x,y);
+      case 8: return EABatchMult<8>(NE,D,VD,NED,byvdim,transpose,AO,EO,a,x,y);
+      case 9: return EABatchMult<9>(NE,D,VD,NED,byvdim,transpose,AO,EO,a,x,y);
+      case 10:
+         return EABatchMult<10>(NE,D,VD,NED,byvdim,transpose,AO,EO,a,x,y);
+      case 16:
+         return EABatchMult<16>(NE,D,VD,NED,byvdim,transpose,AO,EO,a,x,y);
+      case 20:
+         return EABatchMult<20>(NE,D,VD,NED,byvdim,transpose,AO,EO,a,x,y);
+      case 27:
+         return EABatchMult<27>(NE,D,VD,NED,byvdim,transpose,AO,EO,a,x,y);
+      case 64:
+         return EABatchMult<64>(NE,D,VD,NED,byvdim,transpose,AO,EO,a,x,y);
+   }
+   MFEM_VERIFY(VD*D <= 1024, "element matrices of size " << VD*D
+               << " are not supported with element assembly");
+   if (VD*D <= 128)
+   {
+      return EABatchMult<0,128>(NE,D,VD,NED,byvdim,transpose,AO,EO,a,x,y);
+   }
+   EABatchMult<0,1024>(NE,D,VD,NED,byvdim,transpose,AO,EO,a,x,y);
+}
+
+// EA diagonal kernel: copy the diagonals of the element matrices of a batch
+// to the local vector y, in the layout of EABatchMult().
+static void EABatchDiagonal(const int NE,
+                            const int D,
+                            const int VD,
+                            const int NED,
+                            const bool byvdim,
+                            const int AO,
+                            const int EO,
+                            const double *a,
+                            double *_y)
+{
+   const int N = VD*D;
+   const int e_stride = byvdim ? VD*D : D;
+   const int c_stride = byvdim ? 1 : NED;
+   const int i_stride = byvdim ? VD : 1;
+   const DeviceVector A(a, AO + N*N*NE);
+   DeviceVector y(_y, VD*NED);
+   MFEM_FORALL(e, NE,
+   {
+      const int eo = EO + e*e_stride;
+      const int ao = AO + N*N*e;
+      for (int c = 0; c < VD; ++c)
+      {
+         for (int i = 0; i < D; ++i)
+         {
+            const int k = i + D*c;
+            y(eo + c*c_stride + i*i_stride) = A(ao + k + N*k);
+         }
+      }
+   });
+}
+
+void EABilinearFormExtension::AddMultElements(const Vector &x, Vector &y,
+                                              const bool transpose) const
+{
+   const int vdim = trialFes->GetVDim();
+   const bool byvdim = elem_restrict->byvdim;
+   for (int b = 0; b < batch_ne.Size(); b++)
+   {
+      const int EO = byvdim ? vdim*batch_dof_offsets[b] : batch_dof_offsets[b];
+      EABatchMult(batch_ne[b], batch_dofs[b], vdim, elem_restrict->nedofs,
+                  byvdim, transpose, ea_offsets[b], EO, ea_data.GetData(),
+                  x.GetData(), y.GetData());
+   }
+}
+
+void EABilinearFormExtension::AssembleDiagonal(Vector &diag) const
+{
+   MFEM_VERIFY(ea_offsets.Size() > 0, "the form must be assembled");
+   const int vdim = trialFes->GetVDim();
+   const bool byvdim = elem_restrict->byvdim;
+   for (int b = 0; b < batch_ne.Size(); b++)
+   {
+      const int EO = byvdim ? vdim*batch_dof_offsets[b] : batch_dof_offsets[b];
+      EABatchDiagonal(batch_ne[b], batch_dofs[b], vdim, elem_restrict->nedofs,
+                      byvdim, ea_offsets[b], EO, ea_data.GetData(),
+                      localY.GetData());
+   }
+   // The diagonal entries are not affected by the signs of the local dofs.
+   elem_restrict->MultTransposeUnsigned(localY, diag);
+}
+
+void EABilinearFormExtension::Mult(const Vector &x, Vector &y) const
+{
+   elem_restrict->Mult(x, localX);
+   localY = 0.0;
+   AddMultElements(localX, localY, false);
+   elem_restrict->MultTranspose(localY, y);
+}
+
+void EABilinearFormExtension::MultTranspose(const Vector &x, Vector &y) const
+{
+   elem_restrict->Mult(x, localX);
+   localY = 0.0;
+   AddMultElements(localX, localY, true);
+   elem_restrict->MultTranspose(localY, y);
+}
+
+// Data and methods for matrix-free bilinear forms
+MFBilinearFormExtension::MFBilinearFormExtension(BilinearForm *form)
+   : PABilinearFormExtension(form) { }
+
+void MFBilinearFormExtension::Assemble()
+{
+   MFEM_VERIFY(a->GetFBFI()->Size() == 0 && a->GetBFBFI()->Size() == 0,
+               "face integrators are not supported with MF");
+   Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
+   for (int i = 0; i < integrators.Size(); ++i)
+   {
+      integrators[i]->AssembleMF(*a->FESpace());
+   }
+}
+
+void MFBilinearFormExtension::AssembleDiagonal(Vector &) const
+{
+   MFEM_ABORT("AssembleDiagonal is not supported with matrix-free assembly");
+}
+
+void MFBilinearFormExtension::Mult(const Vector &x, Vector &y) const
+{
+   Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
+   elem_restrict->Mult(x, localX);
+   localY = 0.0;
+   for (int i = 0; i < integrators.Size(); ++i)
+   {
+      integrators[i]->MultMF(localX, localY);
+   }
+   elem_restrict->MultTranspose(localY, y);
+}
+
+void MFBilinearFormExtension::MultTranspose(const Vector &x, Vector &y) const
+{
+   // The only integrator with a matrix-free action, DiffusionIntegrator with
+   // a constant coefficient, is symmetric.
+   Mult(x, y);
+}
+
+MixedBilinearFormExtension::MixedBilinearFormExtension(MixedBilinearForm *form)
+   : Operator(form->Height(), form->Width()), a(form)
+{
+   // empty
+}
+
+const Operator *MixedBilinearFormExtension::GetProlongation() const
+{
+   return a->TrialFESpace()->GetProlongationMatrix();
 }
 
+const Operator *MixedBilinearFormExtension::GetRestriction() const
+{
+   return a->TestFESpace()->GetRestrictionMatrix();
+}
+
+// Data and methods for partially-assembled mixed bilinear forms
+PAMixedBilinearFormExtension::PAMixedBilinearFormExtension(
+   MixedBilinearForm *form)
+   : MixedBilinearFormExtension(form),
+     trialFes(NULL), testFes(NULL),
+     trial_restrict(NULL), test_restrict(NULL)
+{
+   Update();
+}
+
+PAMixedBilinearFormExtension::~PAMixedBilinearFormExtension()
+{
+   delete trial_restrict;
+   delete test_restrict;
+}
+
+void PAMixedBilinearFormExtension::Assemble()
+{
+   Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
+   const int integratorCount = integrators.Size();
+   for (int i = 0; i < integratorCount; ++i)
+   {
+      integrators[i]->Assemble(*trialFes, *testFes);
+   }
+}
+
+void PAMixedBilinearFormExtension::Update()
+{
+   trialFes = a->TrialFESpace();
+   testFes = a->TestFESpace();
+   height = testFes->GetVSize();
+   width = trialFes->GetVSize();
+   delete trial_restrict;
+   delete test_restrict;
+   trial_restrict = new ElemRestriction(*trialFes);
+   test_restrict = new ElemRestriction(*testFes);
+   localTrial.SetSize(trial_restrict->nedofs * trialFes->GetVDim());
+   localTest.SetSize(test_restrict->nedofs * testFes->GetVDim());
+}
+
+void PAMixedBilinearFormExtension::Mult(const Vector &x, Vector &y) const
+{
+   y = 0.0;
+   AddMult(x, y);
+}
+
+void PAMixedBilinearFormExtension::AddMult(const Vector &x, Vector &y,
+                                           const double c) const
+{
+   Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
+   trial_restrict->Mult(x, localTrial);
+   localTest = 0.0;
+   const int iSz = integrators.Size();
+   for (int i = 0; i < iSz; ++i)
+   {
+      integrators[i]->MultAssembled(localTrial, localTest);
+   }
+   tmp.SetSize(y.Size());
+   test_restrict->MultTranspose(localTest, tmp);
+   y.Add(c, tmp);
+}
+
+void PAMixedBilinearFormExtension::MultTranspose(const Vector &x,
+                                                 Vector &y) const
+{
+   y = 0.0;
+   AddMultTranspose(x, y);
+}
+
+void PAMixedBilinearFormExtension::AddMultTranspose(const Vector &x,
+                                                    Vector &y,
+                                                    const double c) const
+{
+   Array<BilinearFormIntegrator*> &integrators = *a->GetDBFI();
+   test_restrict->Mult(x, localTest);
+   localTrial = 0.0;
+   const int iSz = integrators.Size();
+   for (int i = 0; i < iSz; ++i)
+   {
+      integrators[i]->MultAssembledTranspose(localTest, localTrial);
+   }
+   tmp.SetSize(y.Size());
+   trial_restrict->MultTranspose(localTrial, tmp);
+   y.Add(c, tmp);
+}
 
 ElemRestriction::ElemRestriction(const FiniteElementSpace &f)
    : fes(f),
@@ -127,52 +951,80 @@ ElemRestriction::ElemRestriction(const FiniteElementSpace &f)
      vdim(fes.GetVDim()),
      byvdim(fes.GetOrdering() == Ordering::byVDIM),
      ndofs(fes.GetNDofs()),
-     dof(fes.GetFE(0)->GetDof()),
-     nedofs(ne*dof),
-     offsets(ndofs+1),
-     indices(ne*dof)
+     dof(0),
+     nedofs(0),
+     offsets(ndofs+1)
 {
-   for (int e = 0; e < ne; ++e)
+   const bool tensor = ElementBatches::UsesTensorLayout(fes);
+   const Table& e2dTable = fes.GetElementToDofTable();
+   const int* elementMap = e2dTable.GetJ();
+   const int* elementOffsets = e2dTable.GetI();
+   // Elements in the order of the E-vector, the offsets of their dofs in the
+   // E-vector and the map from the local to the element dofs.
+   Array<int> elements, eoffsets(ne+1);
+   Array<int> dof_map;
+   if (tensor)
    {
-      const FiniteElement *fe = fes.GetFE(e);
-      const TensorBasisElement* el =
-         dynamic_cast<const TensorBasisElement*>(fe);
-      if (el) { continue; }
-      mfem_error("Finite element not supported with partial assembly");
+      elements.SetSize(ne);
+      for (int e = 0; e < ne; ++e) { elements[e] = e; }
+      if (ne > 0)
+      {
+         const FiniteElement *fe = fes.GetFE(0);
+         const TensorBasisElement* el =
+            dynamic_cast<const TensorBasisElement*>(fe);
+         dof_map = el ? el->GetDofMap() :
+                   dynamic_cast<const VectorTensorFiniteElement*>
+                   (fe)->GetDofMap();
+         dof = fe->GetDof();
+      }
    }
-   const FiniteElement *fe = fes.GetFE(0);
-   const TensorBasisElement* el = dynamic_cast<const TensorBasisElement*>(fe);
-   const Array<int> &dof_map = el->GetDofMap();
+   else
+   {
+      ElementBatches batches(fes);
+      elements = batches.elements;
+   }
+   eoffsets[0] = 0;
+   for (int i = 0; i < ne; ++i)
+   {
+      const int e = elements[i];
+      eoffsets[i+1] = eoffsets[i] + elementOffsets[e+1] - elementOffsets[e];
+   }
+   nedofs = eoffsets[ne];
+   indices.SetSize(nedofs);
    const bool dof_map_is_identity = (dof_map.Size()==0);
-   const Table& e2dTable = fes.GetElementToDofTable();
-   const int* elementMap = e2dTable.GetJ();
    // We'll be keeping a count of how many local nodes point to its global dof
    for (int i = 0; i <= ndofs; ++i)
    {
       offsets[i] = 0;
    }
-   for (int e = 0; e < ne; ++e)
+   for (int l = 0; l < e2dTable.Size_of_connections(); ++l)
    {
-      for (int d = 0; d < dof; ++d)
-      {
-         const int gid = elementMap[dof*e + d];
-         ++offsets[gid + 1];
-      }
+      const int sgid = elementMap[l];
+      const int gid = (sgid >= 0) ? sgid : -1-sgid;
+      ++offsets[gid + 1];
    }
    // Aggregate to find offsets for each global dof
    for (int i = 1; i <= ndofs; ++i)
    {
       offsets[i] += offsets[i - 1];
    }
-   // For each global dof, fill in all local nodes that point   to it
-   for (int e = 0; e < ne; ++e)
+   // For each global dof, fill in all local nodes that point   to it. Negative
+   // entries in the dof map (vector tensor elements) or in the element-to-dof
+   // table (oriented ND/RT dofs) flip the sign: these local nodes are stored
+   // as -1-lid.
+   for (int i = 0; i < ne; ++i)
    {
-      for (int d = 0; d < dof; ++d)
+      const int e = elements[i];
+      const int edof = eoffsets[i+1] - eoffsets[i];
+      for (int d = 0; d < edof; ++d)
       {
-         const int did = dof_map_is_identity?d:dof_map[d];
-         const int gid = elementMap[dof*e + did];
-         const int lid = dof*e + d;
-         indices[offsets[gid]++] = lid;
+         const int sdid = dof_map_is_identity?d:dof_map[d];
+         const int did = (sdid >= 0) ? sdid : -1-sdid;
+         const int sgid = elementMap[elementOffsets[e] + did];
+         const int gid = (sgid >= 0) ? sgid : -1-sgid;
+         const int lid = eoffsets[i] + d;
+         const bool plus = (sdid >= 0) == (sgid >= 0);
+         indices[offsets[gid]++] = plus ? lid : -1-lid;
       }
    }
    // We shifted the offsets vector by 1 by using it as a counter
@@ -202,7 +1054,9 @@ void ElemRestriction::Mult(const Vector& x, Vector& y) const
          for (int j = offset; j < nextOffset; ++j)
          {
             const int idx_j = d_indices[j];
-            d_y(t?c:idx_j,t?idx_j:c) = dofValue;
+            const bool plus = idx_j >= 0;
+            const int lid = plus ? idx_j : -1-idx_j;
+            d_y(t?c:lid,t?lid:c) = plus ? dofValue : -dofValue;
          }
       }
    });
@@ -226,11 +1080,211 @@ void ElemRestriction::MultTranspose(const Vector& x, Vector& y) const
          for (int j = offset; j < nextOffset; ++j)
          {
             const int idx_j = d_indices[j];
-            dofValue +=  d_x(t?c:idx_j,t?idx_j:c);
+            const bool plus = idx_j >= 0;
+            const int lid = plus ? idx_j : -1-idx_j;
+            dofValue += plus ? d_x(t?c:lid,t?lid:c) : -d_x(t?c:lid,t?lid:c);
          }
          d_y(t?c:i,t?i:c) = dofValue;
       }
    });
 }
 
+void ElemRestriction::MultTransposeUnsigned(const Vector& x, Vector& y) const
+{
+   const int vd = vdim;
+   const bool t = byvdim;
+   const DeviceArray d_offsets(offsets, ndofs+1);
+   const DeviceArray d_indices(indices, nedofs);
+   const DeviceMatrix d_x(x, t?vd:nedofs, t?nedofs:vd);
+   DeviceMatrix d_y(y, t?vd:ndofs, t?ndofs:vd);
+   MFEM_FORALL(i, ndofs,
+   {
+      const int offset = d_offsets[i];
+      const int nextOffset = d_offsets[i + 1];
+      for (int c = 0; c < vd; ++c)
+      {
+         double dofValue = 0;
+         for (int j = offset; j < nextOffset; ++j)
+         {
+            const int idx_j = d_indices[j];
+            const int lid = (idx_j >= 0) ? idx_j : -1-idx_j;
+            dofValue += d_x(t?c:lid,t?lid:c);
+         }
+         d_y(t?c:i,t?i:c) = dofValue;
+      }
+   });
+}
+
+double ElemRestriction::MultTransposeAndDot(const Vector& x, const Vector& z,
+                                            Vector& y) const
+{
+   const int vd = vdim;
+   const bool t = byvdim;
+   const double *d_x = x.GetData(), *d_z = z.GetData();
+   double *d_y = y.GetData();
+   double dot = 0.0;
+#ifdef MFEM_USE_OPENMP
+   // Threaded with the OpenMP backends, which do not use device memory.
+#ifdef MFEM_USE_LEGACY_OPENMP
+   const bool use_omp = true;
+#else
+   const bool use_omp = Device::Allows(Backend::OMP_MASK);
+#endif
+   #pragma omp parallel for reduction(+:dot) if (use_omp)
+#endif
+   for (int i = 0; i < ndofs; ++i)
+   {
+      const int offset = offsets[i];
+      const int nextOffset = offsets[i + 1];
+      for (int c = 0; c < vd; ++c)
+      {
+         double dofValue = 0;
+         for (int j = offset; j < nextOffset; ++j)
+         {
+            const int idx_j = indices[j];
+            const bool plus = idx_j >= 0;
+            const int lid = plus ? idx_j : -1-idx_j;
+            const double value = d_x[t ? c+vd*lid : lid+nedofs*c];
+            dofValue += plus ? value : -value;
+         }
+         const int k = t ? c+vd*i : i+ndofs*c;
+         d_y[k] = dofValue;
+         dot += dofValue * d_z[k];
+      }
+   }
+   return dot;
+}
+
+static int FaceRestrictionNumFaces(const FiniteElementSpace &fes,
+                                   const bool interior)
+{
+   Array<int> faces;
+   GetPAFaces(*fes.GetMesh(), interior, faces);
+   return faces.Size();
+}
+
+static int FaceRestrictionFaceDofs(const FiniteElementSpace &fes)
+{
+   const FiniteElement *fe = fes.GetFE(0);
+   const int d1d = fe->GetOrder() + 1;
+   return (fe->GetDim() == 3) ? d1d*d1d : d1d;
+}
+
+FaceRestriction::FaceRestriction(const FiniteElementSpace &f,
+                                 const bool interior)
+   : Operator((interior ? 2 : 1)*FaceRestrictionNumFaces(f, interior)*
+              FaceRestrictionFaceDofs(f), f.GetVSize()),
+     fes(f),
+     interior(interior),
+     nf(FaceRestrictionNumFaces(f, interior)),
+     nsides(interior ? 2 : 1),
+     ndofs(fes.GetNDofs()),
+     fdofs(FaceRestrictionFaceDofs(f)),
+     nfdofs(nf*nsides*fdofs),
+     offsets(ndofs+1),
+     indices(nfdofs)
+{
+   Mesh &mesh = *fes.GetMesh();
+   const FiniteElement *fe = fes.GetFE(0);
+   const TensorBasisElement *el = dynamic_cast<const TensorBasisElement*>(fe);
+   MFEM_VERIFY(el && dynamic_cast<const NodalFiniteElement*>(fe) &&
+               fes.GetVDim() == 1 && fe->GetDim() > 1 &&
+               mesh.SpaceDimension() == fe->GetDim(),
+               "FaceRestriction requires scalar nodal tensor product elements "
+               "on quads or hexes");
+   const int dim = fe->GetDim();
+   const int d1d = fe->GetOrder() + 1;
+   const Array<int> &dof_map = el->GetDofMap();
+   const IntegrationRule &nodes = fe->GetNodes();
+   Array<double> x1d(d1d);
+   for (int i = 0; i < d1d; ++i)
+   {
+      x1d[i] = nodes.IntPoint(dof_map.Size() ? dof_map[i] : i).x;
+   }
+
+   // Local face dof lid = k + fdofs*(s + nsides*f) is at the point
+   // (x1d[k % d1d], x1d[k / d1d]) of the reference face: find the element dof
+   // at the image of this point on the side s.
+   Array<int> faces, dofs, lid_gid(nfdofs);
+   GetPAFaces(mesh, interior, faces);
+   for (int f = 0; f < nf; ++f)
+   {
+      FaceElementTransformations &T =
+         *mesh.GetFaceElementTransformations(faces[f], interior ? 4|8 : 4);
+      for (int s = 0; s < nsides; ++s)
+      {
+         fes.GetElementDofs(s == 0 ? T.Elem1No : T.Elem2No, dofs);
+         IntegrationPointTransformation &Loc = (s == 0) ? T.Loc1 : T.Loc2;
+         for (int k = 0; k < fdofs; ++k)
+         {
+            IntegrationPoint ip, eip;
+            ip.Init();
+            ip.x = x1d[k % d1d];
+            ip.y = (dim == 3) ? x1d[k / d1d] : 0.0;
+            Loc.Transform(ip, eip);
+            const double ex[3] = { eip.x, eip.y, eip.z };
+            int lex = 0;
+            for (int c = dim-1; c >= 0; --c)
+            {
+               int j = 0;
+               while (j < d1d && std::abs(ex[c] - x1d[j]) > 1e-12) { ++j; }
+               MFEM_VERIFY(j < d1d, "face dof not found: the basis must have "
+                           "nodes on the element boundary");
+               lex = j + d1d*lex;
+            }
+            const int did = dof_map.Size() ? dof_map[lex] : lex;
+            const int gid = dofs[did];
+            lid_gid[k + fdofs*(s + nsides*f)] = (gid >= 0) ? gid : -1-gid;
+         }
+      }
+   }
+
+   // Same gather structure as in ElemRestriction.
+   for (int i = 0; i <= ndofs; ++i) { offsets[i] = 0; }
+   for (int l = 0; l < nfdofs; ++l) { ++offsets[lid_gid[l] + 1]; }
+   for (int i = 1; i <= ndofs; ++i) { offsets[i] += offsets[i - 1]; }
+   for (int l = 0; l < nfdofs; ++l) { indices[offsets[lid_gid[l]]++] = l; }
+   for (int i = ndofs; i > 0; --i) { offsets[i] = offsets[i - 1]; }
+   offsets[0] = 0;
+}
+
+void FaceRestriction::Mult(const Vector& x, Vector& y) const
+{
+   const DeviceArray d_offsets(offsets, ndofs+1);
+   const DeviceArray d_indices(indices, nfdofs);
+   const DeviceVector d_x(x, ndofs);
+   DeviceVector d_y(y, nfdofs);
+   MFEM_FORALL(i, ndofs,
+   {
+      const double dofValue = d_x[i];
+      for (int j = d_offsets[i]; j < d_offsets[i+1]; ++j)
+      {
+         d_y[d_indices[j]] = dofValue;
+      }
+   });
+}
+
+void FaceRestriction::MultTranspose(const Vector& x, Vector& y) const
+{
+   y = 0.0;
+   AddMultTranspose(x, y);
+}
+
+void FaceRestriction::AddMultTranspose(const Vector& x, Vector& y) const
+{
+   const DeviceArray d_offsets(offsets, ndofs+1);
+   const DeviceArray d_indices(indices, nfdofs);
+   const DeviceVector d_x(x, nfdofs);
+   DeviceVector d_y(y, ndofs);
+   MFEM_FORALL(i, ndofs,
+   {
+      double dofValue = 0.0;
+      for (int j = d_offsets[i]; j < d_offsets[i+1]; ++j)
+      {
+         dofValue += d_x[d_indices[j]];
+      }
+      d_y[i] += dofValue;
+   });
+}
+
 } // namespace mfem
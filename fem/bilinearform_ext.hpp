@@ -19,8 +19,16 @@ namespace mfem
 {
 
 class BilinearForm;
+class MixedBilinearForm;
 
-/// Element restriction operator
+/** @brief Element restriction operator
+
+    Maps the L-vector of a space to its E-vector, the concatenation of the
+    element dofs. For tensor product elements on a mesh of a single geometry,
+    the element dofs are in lexicographic order and dof is the number of dofs
+    per element. Otherwise, e.g. on simplex and mixed meshes, they are in the
+    native order of the elements, grouped as in ElementBatches, and dof is 0.
+    The size of the scalar E-vector is nedofs. */
 class ElemRestriction: public Operator
 {
 public:
@@ -29,14 +37,51 @@ public:
    const int vdim;
    const bool byvdim;
    const int ndofs;
-   const int dof;
-   const int nedofs;
+   int dof;
+   int nedofs;
    Array<int> offsets;
    Array<int> indices;
 public:
    ElemRestriction(const FiniteElementSpace&);
    void Mult(const Vector &x, Vector &y) const;
    void MultTranspose(const Vector &x, Vector &y) const;
+   /** @brief Compute y = R^T x without the sign changes of the local dofs,
+       e.g. to sum the diagonal entries of the element matrices. */
+   void MultTransposeUnsigned(const Vector &x, Vector &y) const;
+   /** @brief Compute y = R^T x and return the dot product of @a z and @a y,
+       in one pass over the L-vectors on the host, threaded with the OpenMP
+       backends. */
+   double MultTransposeAndDot(const Vector &x, const Vector &z,
+                              Vector &y) const;
+};
+
+/** @brief Face restriction operator
+
+    Maps the L-vector of a scalar space of tensor product elements to the
+    values of the element dofs on the interior (or boundary) faces of the mesh,
+    with nsides = 2 (or 1) sides per face. The face dofs of each side are in
+    the lexicographic order of the reference coordinates of the face, so that
+    the two sides of an interior face match. The face dofs are located by their
+    coordinates, which requires a basis with nodes on the element boundary,
+    e.g. BasisType::GaussLobatto. */
+class FaceRestriction: public Operator
+{
+public:
+   const FiniteElementSpace &fes;
+   const bool interior;
+   const int nf;
+   const int nsides;
+   const int ndofs;
+   const int fdofs;
+   const int nfdofs;
+   Array<int> offsets;
+   Array<int> indices;
+public:
+   FaceRestriction(const FiniteElementSpace&, const bool interior);
+   void Mult(const Vector &x, Vector &y) const;
+   void MultTranspose(const Vector &x, Vector &y) const;
+   /// y += R^T x
+   void AddMultTranspose(const Vector &x, Vector &y) const;
 };
 
 
@@ -55,6 +100,10 @@ public:
    virtual const Operator *GetRestriction() const;
 
    virtual void Assemble() = 0;
+
+   /// Assemble the diagonal of the operator into the L-vector @a diag.
+   virtual void AssembleDiagonal(Vector &diag) const;
+
    virtual void FormSystemMatrix(const Array<int> &ess_tdof_list,
                                  OperatorHandle &A) = 0;
    virtual void FormLinearSystem(const Array<int> &ess_tdof_list,
@@ -64,56 +113,99 @@ public:
    virtual void Update() = 0;
 };
 
-/// Data and methods for fully-assembled bilinear forms
+/** @brief Data and methods for fully-assembled bilinear forms.
+
+    The sparsity pattern of the form matrix is built once from the
+    element-to-dof connectivity, together with the positions (slots) in the
+    CSR data array of all element matrix entries. The elements are split into
+    colors such that the elements of one color do not share dofs; the element
+    matrices of one color are computed and added to their slots in parallel,
+    and the colors are processed in order. The result does not depend on the
+    number of threads.
+
+    The extension assembles the domain integrators into the SparseMatrix of the
+    BilinearForm, while the boundary integrators, the elimination of essential
+    dofs and the formation of the linear system are handled by BilinearForm.
+    Parallel execution requires MFEM_USE_OPENMP and MFEM_THREAD_SAFE, otherwise
+    the elements are processed sequentially. Interior face integrators, static
+    condensation, hybridization and precomputed element matrices are not
+    supported: with them, BilinearForm::Assemble() falls back to the original
+    assembly, see IsSupported(). */
 class FABilinearFormExtension : public BilinearFormExtension
 {
-public:
-   FABilinearFormExtension(BilinearForm *form)
-      : BilinearFormExtension(form) { }
+protected:
+   long sequence;       ///< FE space sequence of the current sparsity pattern
+   Table dof_dof;       ///< Sparsity pattern of the matrix (sorted rows)
+   Array<int> slot_offsets; ///< Offsets of the element slots in #slots
+   Array<int> slots;    ///< CSR positions of the element matrix entries
+   Table color_elem;    ///< Color-to-element table
 
-   /// TODO
-   void Assemble() {}
-   void FormSystemMatrix(const Array<int> &ess_tdof_list, OperatorHandle &A) {}
-   void FormLinearSystem(const Array<int> &ess_tdof_list,
-                         Vector &x, Vector &b,
-                         OperatorHandle &A, Vector &X, Vector &B,
-                         int copy_interior = 0) {}
-   void Mult(const Vector &x, Vector &y) const {}
-   void MultTranspose(const Vector &x, Vector &y) const {}
-   ~FABilinearFormExtension() {}
-};
+   /// Build the sparsity pattern, the element slots and the element colors.
+   void Setup();
 
-/// Data and methods for element-assembled bilinear forms
-class EABilinearFormExtension : public BilinearFormExtension
-{
 public:
-   EABilinearFormExtension(BilinearForm *form)
-      : BilinearFormExtension(form) { }
+   FABilinearFormExtension(BilinearForm *form);
 
-   /// TODO
-   void Assemble() {}
-   void FormSystemMatrix(const Array<int> &ess_tdof_list, OperatorHandle &A) {}
+   /** @brief Return true if the current setup of the BilinearForm can be
+       assembled by the extension. */
+   bool IsSupported() const;
+
+   /// Assemble the domain integrators into the matrix of the BilinearForm.
+   void Assemble();
+   void FormSystemMatrix(const Array<int> &ess_tdof_list, OperatorHandle &A);
    void FormLinearSystem(const Array<int> &ess_tdof_list,
                          Vector &x, Vector &b,
                          OperatorHandle &A, Vector &X, Vector &B,
-                         int copy_interior = 0) {}
-   void Mult(const Vector &x, Vector &y) const {}
-   void MultTranspose(const Vector &x, Vector &y) const {}
-   ~EABilinearFormExtension() {}
+                         int copy_interior = 0);
+   void Mult(const Vector &x, Vector &y) const;
+   void MultTranspose(const Vector &x, Vector &y) const;
+   void Update();
+
+   /// Return the number of element colors used in the assembly.
+   int GetNColors() const { return color_elem.Size(); }
 };
 
-/// Data and methods for partially-assembled bilinear forms
+/** @brief Data and methods for partially-assembled bilinear forms
+
+    The interior and boundary face integrators, see
+    BilinearFormIntegrator::AssembleInteriorFaces(), act on the face vectors of
+    the FaceRestriction%s, created when such integrators are present. Boundary
+    markers are not supported. */
 class PABilinearFormExtension : public BilinearFormExtension
 {
 protected:
    const FiniteElementSpace *trialFes, *testFes;
    mutable Vector localX, localY;
    ElemRestriction *elem_restrict;
+   FaceRestriction *int_face_restrict, *bdr_face_restrict;
+   mutable Vector intFaceX, intFaceY, bdrFaceX, bdrFaceY;
+   /** Templated operators of the domain integrators, acting on L-vectors, from
+       TBilinearFormRegistry; empty when the generic PA kernels are used. */
+   Array<Operator*> tforms;
+   /// Whether the PA data of the domain integrators is assembled.
+   mutable bool integs_assembled;
+
+   /// Create the face restrictions needed by the face integrators of the form.
+   void SetupFaceRestrictions();
+   /** Create the templated operators of all domain integrators, if they all
+       match a TBilinearFormRegistry entry. */
+   void SetupTemplatedForms();
+   void DeleteTemplatedForms();
+   /// Apply the sum of the templated operators to the L-vector x.
+   void MultTemplated(const Vector &x, Vector &y) const;
+   /// Add the action (or transposed action) of the face integrators to y.
+   void AddMultFaces(const Vector &x, Vector &y, const bool transpose) const;
 
 public:
    PABilinearFormExtension(BilinearForm*);
 
+   /** The domain integrators are applied with precompiled TBilinearForm
+       specializations when they all match an entry of TBilinearFormRegistry,
+       and with the generic PA kernels otherwise. */
    void Assemble();
+   /** The element diagonals of the domain integrators are summed by the
+       transpose of the ElemRestriction; face integrators are not supported. */
+   void AssembleDiagonal(Vector &diag) const;
    void FormSystemMatrix(const Array<int> &ess_tdof_list, OperatorHandle &A);
    void FormLinearSystem(const Array<int> &ess_tdof_list,
                          Vector &x, Vector &b,
@@ -121,29 +213,124 @@ public:
                          int copy_interior = 0);
 
    void Mult(const Vector &x, Vector &y) const;
+   /** The dot product is computed in the transpose of the ElemRestriction,
+       when the form has no face integrators and the device is not used. */
+   double MultAndDot(const Vector &x, Vector &y) const;
    void MultTranspose(const Vector &x, Vector &y) const;
    void Update();
 
+   /// Check if the action uses templated operators from TBilinearFormRegistry.
+   bool UsesTemplatedForms() const { return tforms.Size() > 0; }
+
    ~PABilinearFormExtension();
 };
 
-/// Data and methods for matrix-free bilinear forms
-class MFBilinearFormExtension : public BilinearFormExtension
+/** @brief Data and methods for element-assembled bilinear forms.
+
+    The element matrices of all domain integrators are computed with
+    BilinearFormIntegrator::AssembleElementMatrix() and stored contiguously,
+    batch by batch of the ElementBatches of the space, as dense matrices of size
+    (vdim*dof) x (vdim*dof) in the local ordering of the ElemRestriction:
+    lexicographic for tensor product elements, native otherwise, e.g. on
+    simplex and mixed meshes. The action is computed by applying the element
+    matrices between the element restriction and its transpose, with a batched
+    dense kernel on the gathered element vectors. */
+class EABilinearFormExtension : public PABilinearFormExtension
 {
+protected:
+   /// Number of elements and of scalar dofs per element of each batch
+   Array<int> batch_ne, batch_dofs;
+   /// Offsets of each batch in the scalar E-vector and in #ea_data
+   Array<int> batch_dof_offsets, ea_offsets;
+   Vector ea_data;
+
+   /// Add the action (or transposed action) of the element matrices to @a y.
+   void AddMultElements(const Vector &x, Vector &y,
+                        const bool transpose) const;
+
 public:
-   MFBilinearFormExtension(BilinearForm *form)
-      : BilinearFormExtension(form) { }
+   EABilinearFormExtension(BilinearForm *form);
 
-   /// TODO
-   void Assemble() {}
-   void FormSystemMatrix(const Array<int> &ess_tdof_list, OperatorHandle &A) {}
-   void FormLinearSystem(const Array<int> &ess_tdof_list,
-                         Vector &x, Vector &b,
-                         OperatorHandle &A, Vector &X, Vector &B,
-                         int copy_interior = 0) {}
-   void Mult(const Vector &x, Vector &y) const {}
-   void MultTranspose(const Vector &x, Vector &y) const {}
-   ~MFBilinearFormExtension() {}
+   void Assemble();
+   void AssembleDiagonal(Vector &diag) const;
+   void Mult(const Vector &x, Vector &y) const;
+   double MultAndDot(const Vector &x, Vector &y) const
+   { return Operator::MultAndDot(x, y); }
+   void MultTranspose(const Vector &x, Vector &y) const;
+   void Update();
+
+   /** @brief Return the element matrices, stored as column-major dense
+       matrices, batch by batch. */
+   const Vector &GetElementMatrices() const { return ea_data; }
+};
+
+/** @brief Data and methods for matrix-free bilinear forms.
+
+    Unlike the partial assembly, no data is stored at the quadrature points:
+    the integrators store only the data defined by
+    BilinearFormIntegrator::AssembleMF(), e.g. the element nodes of the mesh,
+    and recompute the geometric factors in BilinearFormIntegrator::MultMF(). */
+class MFBilinearFormExtension : public PABilinearFormExtension
+{
+public:
+   MFBilinearFormExtension(BilinearForm *form);
+
+   void Assemble();
+   void AssembleDiagonal(Vector &diag) const;
+   void Mult(const Vector &x, Vector &y) const;
+   double MultAndDot(const Vector &x, Vector &y) const
+   { return Operator::MultAndDot(x, y); }
+   void MultTranspose(const Vector &x, Vector &y) const;
+};
+
+/// Class extending the MixedBilinearForm class to support the different
+/// AssemblyLevel%s.
+class MixedBilinearFormExtension : public Operator
+{
+protected:
+   MixedBilinearForm *a; ///< Not owned
+
+public:
+   MixedBilinearFormExtension(MixedBilinearForm *form);
+
+   /// Get the trial finite element space prolongation matrix
+   virtual const Operator *GetProlongation() const;
+
+   /// Get the test finite element space restriction matrix
+   virtual const Operator *GetRestriction() const;
+
+   virtual void Assemble() = 0;
+   virtual void Update() = 0;
+
+   /// y += a A x
+   virtual void AddMult(const Vector &x, Vector &y,
+                        const double a = 1.0) const = 0;
+   /// y += a A^T x
+   virtual void AddMultTranspose(const Vector &x, Vector &y,
+                                 const double a = 1.0) const = 0;
+};
+
+/// Data and methods for partially-assembled mixed bilinear forms
+class PAMixedBilinearFormExtension : public MixedBilinearFormExtension
+{
+protected:
+   const FiniteElementSpace *trialFes, *testFes;
+   mutable Vector localTrial, localTest, tmp;
+   ElemRestriction *trial_restrict, *test_restrict;
+
+public:
+   PAMixedBilinearFormExtension(MixedBilinearForm *form);
+
+   void Assemble();
+   void Update();
+
+   void Mult(const Vector &x, Vector &y) const;
+   void AddMult(const Vector &x, Vector &y, const double a = 1.0) const;
+   void MultTranspose(const Vector &x, Vector &y) const;
+   void AddMultTranspose(const Vector &x, Vector &y,
+                         const double a = 1.0) const;
+
+   ~PAMixedBilinearFormExtension();
 };
 
 }
@@ -25,6 +25,13 @@ void BilinearFormIntegrator::Assemble(const FiniteElementSpace&)
                "   is not implemented for this class.");
 }
 
+void BilinearFormIntegrator::Assemble(const FiniteElementSpace&,
+                                      const FiniteElementSpace&)
+{
+   mfem_error ("BilinearFormIntegrator::Assemble (mixed form)\n"
+               "   is not implemented for this class.");
+}
+
 void BilinearFormIntegrator::MultAssembled(Vector&, Vector&)
 {
    mfem_error ("BilinearFormIntegrator::MultAssembled (...)\n"
@@ -37,6 +44,36 @@ void BilinearFormIntegrator::MultAssembledTranspose(Vector&, Vector&)
                "   is not implemented for this class.");
 }
 
+void BilinearFormIntegrator::AssembleDiagonalPA(Vector&)
+{
+   mfem_error ("BilinearFormIntegrator::AssembleDiagonalPA (...)\n"
+               "   is not implemented for this class.");
+}
+
+void BilinearFormIntegrator::AssembleInteriorFaces(const FiniteElementSpace&)
+{
+   mfem_error ("BilinearFormIntegrator::AssembleInteriorFaces (...)\n"
+               "   is not implemented for this class.");
+}
+
+void BilinearFormIntegrator::AssembleBoundaryFaces(const FiniteElementSpace&)
+{
+   mfem_error ("BilinearFormIntegrator::AssembleBoundaryFaces (...)\n"
+               "   is not implemented for this class.");
+}
+
+void BilinearFormIntegrator::AssembleMF(const FiniteElementSpace&)
+{
+   mfem_error ("BilinearFormIntegrator::AssembleMF (...)\n"
+               "   is not implemented for this class.");
+}
+
+void BilinearFormIntegrator::MultMF(Vector&, Vector&)
+{
+   mfem_error ("BilinearFormIntegrator::MultMF (...)\n"
+               "   is not implemented for this class.");
+}
+
 void BilinearFormIntegrator::AssembleElementMatrix (
    const FiniteElement &el, ElementTransformation &Trans,
    DenseMatrix &elmat )
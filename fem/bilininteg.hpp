@@ -31,12 +31,37 @@ public:
    /// Method defining partial assembly.
    virtual void Assemble(const FiniteElementSpace&);
 
+   /** Method defining partial assembly on different trial and test spaces,
+       used by MixedBilinearForm. */
+   virtual void Assemble(const FiniteElementSpace &trial_fes,
+                         const FiniteElementSpace &test_fes);
+
    /// Method for partially assembled action.
    virtual void MultAssembled(Vector&, Vector&);
 
    /// Method for partially assembled transposed action.
    virtual void MultAssembledTranspose(Vector&, Vector&);
 
+   /** Add the diagonals of the element matrices to the local (element) vector
+       diag, using the data computed by Assemble(). */
+   virtual void AssembleDiagonalPA(Vector &diag);
+
+   /** Method defining partial assembly on the interior faces, see
+       GetPAFaces(). The partially assembled action on the face vectors of the
+       FaceRestriction is computed by MultAssembled(). */
+   virtual void AssembleInteriorFaces(const FiniteElementSpace&);
+
+   /// Method defining partial assembly on the boundary faces.
+   virtual void AssembleBoundaryFaces(const FiniteElementSpace&);
+
+   /// Method defining matrix-free assembly.
+   /** Only data that is small compared to the partially assembled data, e.g.
+       the 1D bases and the element nodes of the mesh, should be stored. */
+   virtual void AssembleMF(const FiniteElementSpace&);
+
+   /// Method for matrix-free action.
+   virtual void MultMF(Vector&, Vector&);
+
    /// Given a particular Finite Element computes the element matrix elmat.
    virtual void AssembleElementMatrix(const FiniteElement &el,
                                       ElementTransformation &Trans,
@@ -169,6 +194,20 @@ public:
                                    FaceElementTransformations &Trans,
                                    DenseMatrix &elmat);
 
+   /// PA extension: the PA methods of the wrapped integrator are transposed.
+   virtual void Assemble(const FiniteElementSpace &fes)
+   { bfi->Assemble(fes); }
+   virtual void AssembleInteriorFaces(const FiniteElementSpace &fes)
+   { bfi->AssembleInteriorFaces(fes); }
+   virtual void AssembleBoundaryFaces(const FiniteElementSpace &fes)
+   { bfi->AssembleBoundaryFaces(fes); }
+   virtual void MultAssembled(Vector &x, Vector &y)
+   { bfi->MultAssembledTranspose(x, y); }
+   virtual void MultAssembledTranspose(Vector &x, Vector &y)
+   { bfi->MultAssembled(x, y); }
+   virtual void AssembleDiagonalPA(Vector &diag)
+   { bfi->AssembleDiagonalPA(diag); }
+
    virtual ~TransposeIntegrator() { if (own_bfi) { delete bfi; } }
 };
 
@@ -1647,17 +1686,26 @@ private:
    MatrixCoefficient *MQ;
    // PA extension
    DofToQuad *maps;
-   GeometryExtension *geom;
+   const GeometricFactors *geom;
    int dim, ne, dofs1D, quad1D;
+   DenseBatchPA *batch_pa; // PA on simplex and mixed meshes
+   // MF extension
+   Array<double> mf_B, mf_G, mf_BX, mf_GX;
+   Vector mf_W, mf_X;
+   int nodes1D;
+   double mf_coeff;
 public:
    /// Construct a diffusion integrator with coefficient Q = 1
-   DiffusionIntegrator() { Q = NULL; MQ = NULL; maps = NULL; geom = NULL; }
+   DiffusionIntegrator()
+      : Q(NULL), MQ(NULL), maps(NULL), geom(NULL), batch_pa(NULL) { }
 
    /// Construct a diffusion integrator with a scalar coefficient q
-   DiffusionIntegrator (Coefficient &q) : Q(&q) { MQ = NULL; maps = NULL; geom = NULL; }
+   DiffusionIntegrator (Coefficient &q)
+      : Q(&q), MQ(NULL), maps(NULL), geom(NULL), batch_pa(NULL) { }
 
    /// Construct a diffusion integrator with a matrix coefficient q
-   DiffusionIntegrator (MatrixCoefficient &q) : MQ(&q) { Q = NULL; maps = NULL; geom = NULL; }
+   DiffusionIntegrator (MatrixCoefficient &q)
+      : Q(NULL), MQ(&q), maps(NULL), geom(NULL), batch_pa(NULL) { }
 
    /** Given a particular Finite Element
        computes the element stiffness matrix elmat. */
@@ -1685,9 +1733,21 @@ public:
                                     ElementTransformation &Trans,
                                     Vector &flux, Vector *d_energy = NULL);
 
+   /// Return the scalar coefficient, or NULL if it is not set.
+   Coefficient *GetCoefficient() const { return Q; }
+   /// Return the matrix coefficient, or NULL if it is not set.
+   MatrixCoefficient *GetMatrixCoefficient() const { return MQ; }
+
    /// PA extension
    virtual void Assemble(const FiniteElementSpace&);
    virtual void MultAssembled(Vector&, Vector&);
+   virtual void AssembleDiagonalPA(Vector &diag);
+
+   /** MF extension: H1 elements on quads and hexes, constant coefficients
+       only. The Jacobians are recomputed in MultMF() from the mesh nodes or,
+       for a mesh without nodes, from its vertices. */
+   virtual void AssembleMF(const FiniteElementSpace&);
+   virtual void MultMF(Vector&, Vector&);
 
    virtual ~DiffusionIntegrator();
 };
@@ -1703,14 +1763,17 @@ protected:
    // PA extension
    Vector vec;
    DofToQuad *maps;
-   GeometryExtension *geom;
+   const GeometricFactors *geom;
    int dim, ne, nq, dofs1D, quad1D;
+   DenseBatchPA *batch_pa; // PA on simplex and mixed meshes
 public:
    MassIntegrator(const IntegrationRule *ir = NULL)
-      : BilinearFormIntegrator(ir) { Q = NULL; maps = NULL; geom = NULL; }
+      : BilinearFormIntegrator(ir), Q(NULL), maps(NULL), geom(NULL),
+        batch_pa(NULL) { }
    /// Construct a mass integrator with coefficient q
    MassIntegrator(Coefficient &q, const IntegrationRule *ir = NULL)
-      : BilinearFormIntegrator(ir), Q(&q) { maps = NULL; geom = NULL; }
+      : BilinearFormIntegrator(ir), Q(&q), maps(NULL), geom(NULL),
+        batch_pa(NULL) { }
 
    /** Given a particular Finite Element
        computes the element mass matrix elmat. */
@@ -1724,6 +1787,10 @@ public:
    /// PA extension
    virtual void Assemble(const FiniteElementSpace&);
    virtual void MultAssembled(Vector&, Vector&);
+   virtual void AssembleDiagonalPA(Vector &diag);
+
+   /// Return the coefficient, or NULL if it is not set.
+   Coefficient *GetCoefficient() const { return Q; }
 
    virtual ~MassIntegrator();
 };
@@ -1751,6 +1818,10 @@ private:
 #endif
    VectorCoefficient &Q;
    double alpha;
+   // PA extension
+   Vector pa_data;
+   Array<double> pa_B, pa_G;
+   int dim, ne, dofs1D, quad1D;
 
 public:
    ConvectionIntegrator(VectorCoefficient &q, double a = 1.0)
@@ -1758,6 +1829,11 @@ public:
    virtual void AssembleElementMatrix(const FiniteElement &,
                                       ElementTransformation &,
                                       DenseMatrix &);
+
+   /// PA extension: tensor product elements on quads and hexes.
+   virtual void Assemble(const FiniteElementSpace&);
+   virtual void MultAssembled(Vector&, Vector&);
+   virtual void MultAssembledTranspose(Vector&, Vector&);
 };
 
 /// alpha (q . grad u, v) using the "group" FE discretization
@@ -1792,6 +1868,11 @@ private:
    MatrixCoefficient *MQ;
 
    int Q_order;
+   // PA extension
+   Vector pa_data;
+   Array<double> pa_B, pa_G;
+   int dim, ne, dofs1D, quad1D, pa_vdim;
+   bool byvdim;
 
 public:
    /// Construct an integrator with coefficient 1.0
@@ -1823,6 +1904,11 @@ public:
                                        const FiniteElement &test_fe,
                                        ElementTransformation &Trans,
                                        DenseMatrix &elmat);
+
+   /** PA extension: H1 elements on quads and hexes, scalar coefficients only.
+       Both orderings of the vector space are supported. */
+   virtual void Assemble(const FiniteElementSpace&);
+   virtual void MultAssembled(Vector&, Vector&);
 };
 
 
@@ -1840,6 +1926,10 @@ private:
 #ifndef MFEM_THREAD_SAFE
    Vector divshape, shape;
 #endif
+   // PA extension
+   Vector pa_data;
+   Array<double> Bo, Gc, Bt;
+   int dim, ne, trial_dofs1D, test_dofs1D, quad1D;
 public:
    VectorFEDivergenceIntegrator() { Q = NULL; }
    VectorFEDivergenceIntegrator(Coefficient &q) { Q = &q; }
@@ -1850,6 +1940,14 @@ public:
                                        const FiniteElement &test_fe,
                                        ElementTransformation &Trans,
                                        DenseMatrix &elmat);
+
+   /** PA extension: RT trial elements and scalar tensor product test elements
+       (e.g. L2) on quads and hexes */
+   using BilinearFormIntegrator::Assemble;
+   virtual void Assemble(const FiniteElementSpace &trial_fes,
+                         const FiniteElementSpace &test_fes);
+   virtual void MultAssembled(Vector&, Vector&);
+   virtual void MultAssembledTranspose(Vector&, Vector&);
 };
 
 
@@ -1932,6 +2030,10 @@ private:
 #endif
    Coefficient *Q;
    MatrixCoefficient *MQ;
+   // PA extension
+   Vector pa_data;
+   Array<double> Bo, Bc, Gc;
+   int dim, ne, dofs1D, quad1D;
 
 public:
    CurlCurlIntegrator() { Q = NULL; MQ = NULL; }
@@ -1953,6 +2055,10 @@ public:
    virtual double ComputeFluxEnergy(const FiniteElement &fluxelem,
                                     ElementTransformation &Trans,
                                     Vector &flux, Vector *d_energy = NULL);
+
+   /// PA extension: ND elements on quads and hexes, scalar coefficients only
+   virtual void Assemble(const FiniteElementSpace&);
+   virtual void MultAssembled(Vector&, Vector&);
 };
 
 /** Integrator for (curl u, curl v) for FE spaces defined by 'dim' copies of a
@@ -1998,6 +2104,11 @@ private:
    DenseMatrix trial_vshape;
 #endif
 
+   // PA extension
+   Vector pa_data;
+   Array<double> Bo, Bc;
+   int dim, ne, dofs1D, quad1D, map_type;
+
 public:
    VectorFEMassIntegrator() { Init(NULL, NULL, NULL); }
    VectorFEMassIntegrator(Coefficient *_q) { Init(_q, NULL, NULL); }
@@ -2014,6 +2125,11 @@ public:
                                        const FiniteElement &test_fe,
                                        ElementTransformation &Trans,
                                        DenseMatrix &elmat);
+
+   /** PA extension: ND and RT elements on quads and hexes, scalar coefficients
+       only */
+   virtual void Assemble(const FiniteElementSpace&);
+   virtual void MultAssembled(Vector&, Vector&);
 };
 
 /** Integrator for (Q div u, p) where u=(v1,...,vn) and all vi are in the same
@@ -2050,6 +2166,11 @@ private:
    Vector divshape;
 #endif
 
+   // PA extension
+   Vector pa_data;
+   Array<double> Bo, Gc;
+   int dim, ne, dofs1D, quad1D;
+
 public:
    DivDivIntegrator() { Q = NULL; }
    DivDivIntegrator(Coefficient &q) : Q(&q) { }
@@ -2057,6 +2178,10 @@ public:
    virtual void AssembleElementMatrix(const FiniteElement &el,
                                       ElementTransformation &Trans,
                                       DenseMatrix &elmat);
+
+   /// PA extension: RT elements on quads and hexes
+   virtual void Assemble(const FiniteElementSpace&);
+   virtual void MultAssembled(Vector&, Vector&);
 };
 
 /** Integrator for
@@ -2075,6 +2200,12 @@ private:
    DenseMatrix gshape;
    DenseMatrix pelmat;
 
+   // PA extension
+   Vector pa_data;
+   Array<double> pa_B, pa_G;
+   int dim, ne, dofs1D, quad1D;
+   bool byvdim;
+
 public:
    VectorDiffusionIntegrator() { Q = NULL; }
    VectorDiffusionIntegrator(Coefficient &q) { Q = &q; }
@@ -2085,6 +2216,11 @@ public:
    virtual void AssembleElementVector(const FiniteElement &el,
                                       ElementTransformation &Tr,
                                       const Vector &elfun, Vector &elvect);
+
+   /** PA extension: H1 elements on quads and hexes, with vdim equal to the
+       dimension. Both orderings of the vector space are supported. */
+   virtual void Assemble(const FiniteElementSpace&);
+   virtual void MultAssembled(Vector&, Vector&);
 };
 
 /** Integrator for the linear elasticity form:
@@ -2104,6 +2240,12 @@ private:
    Vector divshape;
 #endif
 
+   // PA extension
+   Vector pa_data;
+   Array<double> pa_B, pa_G;
+   int dim, ne, dofs1D, quad1D;
+   bool byvdim;
+
 public:
    ElasticityIntegrator(Coefficient &l, Coefficient &m)
    { lambda = &l; mu = &m; }
@@ -2116,6 +2258,11 @@ public:
                                       ElementTransformation &,
                                       DenseMatrix &);
 
+   /** PA extension: H1 elements on quads and hexes, with vdim equal to the
+       dimension. Both orderings of the vector space are supported. */
+   virtual void Assemble(const FiniteElementSpace&);
+   virtual void MultAssembled(Vector&, Vector&);
+
    /** Compute the stress corresponding to the local displacement @a u and
        interpolate it at the nodes of the given @a fluxelem. Only the symmetric
        part of the stress is stored, so that the size of @a flux is equal to
@@ -2161,6 +2308,13 @@ private:
 
    Vector shape1, shape2;
 
+   // PA extension
+   Vector pa_data;
+   Array<double> pa_B;
+   int dim, nf, nsides, dofs1D, quad1D;
+
+   void AssembleFaces(const FiniteElementSpace &fes, const bool interior);
+
 public:
    /// Construct integrator with rho = 1.
    DGTraceIntegrator(VectorCoefficient &_u, double a, double b)
@@ -2175,6 +2329,15 @@ public:
                                    const FiniteElement &el2,
                                    FaceElementTransformations &Trans,
                                    DenseMatrix &elmat);
+
+   /** PA extension: tensor product elements on quads and hexes whose 1D basis
+       has nodes on the faces, e.g. BasisType::GaussLobatto. */
+   virtual void AssembleInteriorFaces(const FiniteElementSpace &fes)
+   { AssembleFaces(fes, true); }
+   virtual void AssembleBoundaryFaces(const FiniteElementSpace &fes)
+   { AssembleFaces(fes, false); }
+   virtual void MultAssembled(Vector&, Vector&);
+   virtual void MultAssembledTranspose(Vector&, Vector&);
 };
 
 /** Integrator for the DG form:
@@ -0,0 +1,320 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+// Partial assembly on batches of elements of the same geometry: simplex and
+// mixed meshes have no sum factorization, so the basis of each batch is applied
+// with dense matrices.
+
+#include "../general/forall.hpp"
+#include "bilininteg.hpp"
+
+namespace mfem
+{
+
+bool ElementBatches::UsesTensorLayout(const FiniteElementSpace &fes)
+{
+   const Mesh *mesh = fes.GetMesh();
+   if (fes.GetNE() == 0) { return true; }
+   if (mesh->GetNumGeometries(mesh->Dimension()) > 1) { return false; }
+   const FiniteElement *fe = fes.GetFE(0);
+   return dynamic_cast<const TensorBasisElement*>(fe) ||
+          dynamic_cast<const VectorTensorFiniteElement*>(fe);
+}
+
+ElementBatches::ElementBatches(const FiniteElementSpace &fes)
+{
+   const int ne = fes.GetNE();
+   const Mesh *mesh = fes.GetMesh();
+   Array<int> count(Geometry::NumGeom);
+   count = 0;
+   for (int e = 0; e < ne; e++) { count[mesh->GetElementBaseGeometry(e)]++; }
+
+   // first[g] is the next position of the elements of geometry g
+   Array<int> first(Geometry::NumGeom);
+   offsets.Append(0);
+   for (int g = 0; g < Geometry::NumGeom; g++)
+   {
+      first[g] = offsets.Last();
+      if (count[g] == 0) { continue; }
+      geoms.Append(Geometry::Type(g));
+      offsets.Append(offsets.Last() + count[g]);
+   }
+
+   elements.SetSize(ne);
+   for (int e = 0; e < ne; e++)
+   {
+      elements[first[mesh->GetElementBaseGeometry(e)]++] = e;
+   }
+
+   dof_offsets.SetSize(Size()+1);
+   dof_offsets[0] = 0;
+   for (int b = 0; b < Size(); b++)
+   {
+      const int nd = fes.GetFE(elements[offsets[b]])->GetDof();
+      dof_offsets[b+1] = dof_offsets[b] + nd*(offsets[b+1] - offsets[b]);
+   }
+}
+
+DenseBatchPA::DenseBatchPA(const FiniteElementSpace &fes,
+                           const bool diffusion_,
+                           const IntegrationRule *ir,
+                           Coefficient *Q, MatrixCoefficient *MQ)
+   : diffusion(diffusion_), dim(fes.GetMesh()->Dimension()), batches(fes)
+{
+   Mesh *mesh = fes.GetMesh();
+   MFEM_VERIFY(mesh->SpaceDimension() == dim,
+               "surface meshes are not supported with partial assembly");
+   MFEM_VERIFY(ir == NULL || batches.Size() <= 1,
+               "an integration rule can not be given on a mixed mesh");
+   const int nb = batches.Size();
+   const int symmDims = (dim * (dim + 1)) / 2;
+   const int qsize = diffusion ? symmDims : 1;
+   nd.SetSize(nb);
+   nq.SetSize(nb);
+   b_offsets.SetSize(nb+1);
+   op_offsets.SetSize(nb+1);
+   b_offsets[0] = op_offsets[0] = 0;
+
+   // Integration rules of the full assembly of the integrators.
+   Array<const IntegrationRule*> irs(nb);
+   for (int b = 0; b < nb; b++)
+   {
+      const int e0 = batches.elements[batches.offsets[b]];
+      const FiniteElement &el = *fes.GetFE(e0);
+      irs[b] = ir;
+      if (!ir)
+      {
+         const int p = el.GetOrder();
+         int order;
+         if (diffusion)
+         {
+            order = (el.Space() == FunctionSpace::Pk) ?
+                    2*p - 2 : 2*p + dim - 1;
+         }
+         else
+         {
+            order = 2*p + mesh->GetElementTransformation(e0)->OrderW();
+         }
+         irs[b] = &IntRules.Get(batches.geoms[b], order);
+      }
+      nd[b] = el.GetDof();
+      nq[b] = irs[b]->GetNPoints();
+      const int neb = batches.offsets[b+1] - batches.offsets[b];
+      b_offsets[b+1] = b_offsets[b] + nq[b]*nd[b];
+      op_offsets[b+1] = op_offsets[b] + qsize*nq[b]*neb;
+   }
+
+   // Basis and reference gradients of each batch.
+   B.SetSize(b_offsets[nb]);
+   G.SetSize(dim*b_offsets[nb]);
+   for (int b = 0; b < nb; b++)
+   {
+      const int e0 = batches.elements[batches.offsets[b]];
+      const FiniteElement &el = *fes.GetFE(e0);
+      Vector shape(nd[b]);
+      DenseMatrix dshape(nd[b], dim);
+      for (int q = 0; q < nq[b]; q++)
+      {
+         const IntegrationPoint &ip = irs[b]->IntPoint(q);
+         el.CalcShape(ip, shape);
+         el.CalcDShape(ip, dshape);
+         for (int d = 0; d < nd[b]; d++)
+         {
+            const int k = b_offsets[b] + q + nq[b]*d;
+            B[k] = shape(d);
+            for (int i = 0; i < dim; i++) { G[i + dim*k] = dshape(d,i); }
+         }
+      }
+   }
+
+   // Quadrature data: the weighted symmetric matrices adj(J) K adj(J)^T/det(J)
+   // (upper triangle, row by row) for diffusion, w det(J) Q for mass.
+   op.SetSize(op_offsets[nb]);
+   DenseMatrix adjJ(dim), K(dim), AK(dim), D(dim);
+   for (int b = 0; b < nb; b++)
+   {
+      const int neb = batches.offsets[b+1] - batches.offsets[b];
+      for (int i = 0; i < neb; i++)
+      {
+         const int e = batches.elements[batches.offsets[b] + i];
+         ElementTransformation &T = *mesh->GetElementTransformation(e);
+         for (int q = 0; q < nq[b]; q++)
+         {
+            const IntegrationPoint &ip = irs[b]->IntPoint(q);
+            T.SetIntPoint(&ip);
+            double *opq = op.GetData() + op_offsets[b] + qsize*(q + nq[b]*i);
+            if (!diffusion)
+            {
+               opq[0] = ip.weight * T.Weight() * (Q ? Q->Eval(T, ip) : 1.0);
+               continue;
+            }
+            CalcAdjugate(T.Jacobian(), adjJ);
+            const double w = ip.weight / T.Weight();
+            if (MQ)
+            {
+               MQ->Eval(K, T, ip);
+               MultABt(K, adjJ, AK);
+               Mult(adjJ, AK, D);
+               D *= w;
+            }
+            else
+            {
+               MultAAt(adjJ, D);
+               D *= w * (Q ? Q->Eval(T, ip) : 1.0);
+            }
+            for (int r = 0, k = 0; r < dim; r++)
+            {
+               for (int c = r; c < dim; c++, k++)
+               {
+                  opq[k] = 0.5*(D(r,c) + D(c,r));
+               }
+            }
+         }
+      }
+   }
+}
+
+// Apply the dense mass operator of a batch of NE elements with ND dofs and NQ
+// quadrature points. The basis B (NQ x ND) of the batch starts at the offset BO
+// of b, its quadrature data (NQ x NE) at OO and its E-vector dofs at EO.
+static void DenseBatchMassApply(const int NE, const int ND, const int NQ,
+                                const int BO, const int OO, const int EO,
+                                const double *b, const double *_op,
+                                const double *_x, double *_y)
+{
+   const DeviceVector B(b, BO + NQ*ND);
+   const DeviceVector op(_op, OO + NQ*NE);
+   const DeviceVector x(_x, EO + ND*NE);
+   DeviceVector y(_y, EO + ND*NE);
+   MFEM_FORALL(e, NE,
+   {
+      const int eo = EO + ND*e;
+      for (int q = 0; q < NQ; q++)
+      {
+         double u = 0.0;
+         for (int d = 0; d < ND; d++) { u += B(BO + q + NQ*d) * x(eo + d); }
+         u *= op(OO + q + NQ*e);
+         for (int d = 0; d < ND; d++) { y(eo + d) += B(BO + q + NQ*d) * u; }
+      }
+   });
+}
+
+// Apply the dense diffusion operator of a batch, cf. DenseBatchMassApply, with
+// the reference gradients G (DIM x NQ x ND) starting at the offset GO of g and
+// the symmetric quadrature data (SYM x NQ x NE) at OO.
+static void DenseBatchDiffusionApply(const int DIM, const int NE, const int ND,
+                                     const int NQ, const int GO, const int OO,
+                                     const int EO, const double *g,
+                                     const double *_op, const double *_x,
+                                     double *_y)
+{
+   const int SYM = (DIM * (DIM + 1)) / 2;
+   const DeviceVector G(g, GO + DIM*NQ*ND);
+   const DeviceVector op(_op, OO + SYM*NQ*NE);
+   const DeviceVector x(_x, EO + ND*NE);
+   DeviceVector y(_y, EO + ND*NE);
+   MFEM_FORALL(e, NE,
+   {
+      const int eo = EO + ND*e;
+      for (int q = 0; q < NQ; q++)
+      {
+         double grad[3] = { 0.0, 0.0, 0.0 };
+         for (int d = 0; d < ND; d++)
+         {
+            const double xd = x(eo + d);
+            for (int i = 0; i < DIM; i++)
+            {
+               grad[i] += G(GO + i + DIM*(q + NQ*d)) * xd;
+            }
+         }
+         double D[3][3];
+         for (int i = 0, k = 0; i < DIM; i++)
+         {
+            for (int j = i; j < DIM; j++, k++)
+            {
+               D[i][j] = D[j][i] = op(OO + k + SYM*(q + NQ*e));
+            }
+         }
+         double flux[3];
+         for (int i = 0; i < DIM; i++)
+         {
+            flux[i] = 0.0;
+            for (int j = 0; j < DIM; j++) { flux[i] += D[i][j] * grad[j]; }
+         }
+         for (int d = 0; d < ND; d++)
+         {
+            double yd = 0.0;
+            for (int i = 0; i < DIM; i++)
+            {
+               yd += G(GO + i + DIM*(q + NQ*d)) * flux[i];
+            }
+            y(eo + d) += yd;
+         }
+      }
+   });
+}
+
+void DenseBatchPA::AddMult(const Vector &x, Vector &y) const
+{
+   for (int b = 0; b < batches.Size(); b++)
+   {
+      const int neb = batches.offsets[b+1] - batches.offsets[b];
+      const int eo = batches.dof_offsets[b];
+      if (diffusion)
+      {
+         DenseBatchDiffusionApply(dim, neb, nd[b], nq[b], dim*b_offsets[b],
+                                  op_offsets[b], eo, G.GetData(),
+                                  op.GetData(), x.GetData(), y.GetData());
+      }
+      else
+      {
+         DenseBatchMassApply(neb, nd[b], nq[b], b_offsets[b], op_offsets[b],
+                             eo, B.GetData(), op.GetData(), x.GetData(),
+                             y.GetData());
+      }
+   }
+}
+
+void DenseBatchPA::AddDiagonal(Vector &diag) const
+{
+   const int qsize = diffusion ? (dim * (dim + 1)) / 2 : 1;
+   for (int b = 0; b < batches.Size(); b++)
+   {
+      const int neb = batches.offsets[b+1] - batches.offsets[b];
+      const int NQ = nq[b], ND = nd[b];
+      for (int i = 0; i < neb; i++)
+      {
+         double *y = diag.GetData() + batches.dof_offsets[b] + ND*i;
+         const double *opi = op.GetData() + op_offsets[b] + qsize*NQ*i;
+         for (int d = 0; d < ND; d++)
+         {
+            double val = 0.0;
+            for (int q = 0; q < NQ; q++)
+            {
+               const int k = b_offsets[b] + q + NQ*d;
+               if (!diffusion) { val += opi[q] * B[k] * B[k]; continue; }
+               const double *g = G.GetData() + dim*k;
+               const double *D = opi + qsize*q;
+               for (int r = 0, l = 0; r < dim; r++)
+               {
+                  for (int c = r; c < dim; c++, l++)
+                  {
+                     val += (c == r ? 1.0 : 2.0) * D[l] * g[r] * g[c];
+                  }
+               }
+            }
+            y[d] += val;
+         }
+      }
+   }
+}
+
+}
@@ -12,11 +12,17 @@
 #include "../general/forall.hpp"
 #include "bilininteg.hpp"
 #include "gridfunc.hpp"
+#include "bilininteg_kernels.hpp"
+#include "../general/jit.hpp"
 
 #include <map>
 #include <cmath>
+#include <sstream>
 #include <algorithm>
 #include <unordered_map>
+#ifdef MFEM_USE_JIT
+#include <mutex>
+#endif
 
 using namespace std;
 
@@ -48,6 +54,141 @@ static const IntegrationRule &DefaultGetRule(const FiniteElement &trial_fe,
    return IntRules.Get(trial_fe.GetGeomType(), order);
 }
 
+void EvalPACoefficient(Coefficient *Q, const FiniteElementSpace &fes,
+                       const IntegrationRule &ir, Vector &coeff)
+{
+   Mesh *mesh = fes.GetMesh();
+   const int NE = fes.GetNE();
+   const int NQ = ir.GetNPoints();
+   coeff.SetSize(NQ*NE);
+   ConstantCoefficient *const_coeff = dynamic_cast<ConstantCoefficient*>(Q);
+   if (Q == NULL || const_coeff)
+   {
+      coeff = const_coeff ? const_coeff->constant : 1.0;
+      return;
+   }
+   // General coefficients are evaluated on the host.
+   double *C = coeff.GetData();
+   for (int e = 0; e < NE; ++e)
+   {
+      ElementTransformation *T = mesh->GetElementTransformation(e);
+      for (int q = 0; q < NQ; ++q)
+      {
+         const IntegrationPoint &ip = ir.IntPoint(q);
+         T->SetIntPoint(&ip);
+         C[q + NQ*e] = Q->Eval(*T, ip);
+      }
+   }
+   coeff.Push();
+}
+
+void EvalPAVectorCoefficient(VectorCoefficient &VQ,
+                             const FiniteElementSpace &fes,
+                             const IntegrationRule &ir, Vector &coeff)
+{
+   Mesh *mesh = fes.GetMesh();
+   const int vdim = VQ.GetVDim();
+   const int NE = fes.GetNE();
+   const int NQ = ir.GetNPoints();
+   coeff.SetSize(vdim*NQ*NE);
+   // General coefficients are evaluated on the host.
+   DenseMatrix Q_ir;
+   for (int e = 0; e < NE; ++e)
+   {
+      ElementTransformation *T = mesh->GetElementTransformation(e);
+      VQ.Eval(Q_ir, *T, ir);
+      for (int q = 0; q < NQ; ++q)
+      {
+         for (int c = 0; c < vdim; ++c)
+         {
+            coeff(c + vdim*(q + NQ*e)) = Q_ir(c,q);
+         }
+      }
+   }
+   coeff.Push();
+}
+
+void EvalPASymmMatrixCoefficient(MatrixCoefficient *MQ,
+                                 const FiniteElementSpace &fes,
+                                 const IntegrationRule &ir, Vector &coeff)
+{
+   Mesh *mesh = fes.GetMesh();
+   const int dim = MQ->GetHeight();
+   MFEM_VERIFY(MQ->GetWidth() == dim, "the matrix coefficient must be square");
+   const int NE = fes.GetNE();
+   const int NQ = ir.GetNPoints();
+   const int SD = (dim*(dim + 1))/2;
+   coeff.SetSize(SD*NQ*NE);
+   // General coefficients are evaluated on the host.
+   double *C = coeff.GetData();
+   DenseMatrix M(dim);
+   for (int e = 0; e < NE; ++e)
+   {
+      ElementTransformation *T = mesh->GetElementTransformation(e);
+      for (int q = 0; q < NQ; ++q)
+      {
+         const IntegrationPoint &ip = ir.IntPoint(q);
+         T->SetIntPoint(&ip);
+         MQ->Eval(M, *T, ip);
+         const double tol = 1e-12*M.MaxMaxNorm();
+         double *Cq = C + SD*(q + NQ*e);
+         for (int i = 0, k = 0; i < dim; ++i)
+         {
+            for (int j = i; j < dim; ++j, ++k)
+            {
+               MFEM_VERIFY(std::abs(M(i,j) - M(j,i)) <= tol,
+                           "the matrix coefficient must be symmetric");
+               Cq[k] = M(i,j);
+            }
+         }
+      }
+   }
+   coeff.Push();
+}
+
+void PABasis1D(const FiniteElement &el, const IntegrationRule &ir1D,
+               Array<double> &B, Array<double> *G)
+{
+   const TensorBasisElement *tel = dynamic_cast<const TensorBasisElement*>(&el);
+   MFEM_VERIFY(tel, "tensor product element required for PA");
+   const Poly_1D::Basis &basis1D = tel->GetBasis1D();
+   const int Q1D = ir1D.GetNPoints();
+   const int D1D = el.GetOrder() + 1;
+   Vector u(D1D), d(D1D);
+   B.SetSize(Q1D*D1D);
+   if (G) { G->SetSize(Q1D*D1D); }
+   for (int q = 0; q < Q1D; ++q)
+   {
+      basis1D.Eval(ir1D.IntPoint(q).x, u, d);
+      for (int i = 0; i < D1D; ++i)
+      {
+         B[q + Q1D*i] = u(i);
+         if (G) { (*G)[q + Q1D*i] = d(i); }
+      }
+   }
+   mfem::Push(B.GetData(), B.Size()*sizeof(double));
+   if (G) { mfem::Push(G->GetData(), G->Size()*sizeof(double)); }
+}
+
+void GetPAFaces(const Mesh &mesh, const bool interior, Array<int> &faces)
+{
+   // Mesh::FaceIsInterior() only sees the local elements: the shared faces of
+   // a ParMesh would be handled as boundary faces, and the master/slave faces
+   // of a nonconforming mesh as conforming ones.
+   MFEM_VERIFY(mesh.Conforming(),
+               "the PA face kernels require a conforming mesh");
+#ifdef MFEM_USE_MPI
+   const ParMesh *pmesh = dynamic_cast<const ParMesh*>(&mesh);
+   MFEM_VERIFY(!pmesh || pmesh->GetNSharedFaces() == 0,
+               "the PA face kernels do not support shared faces");
+#endif
+   faces.SetSize(0);
+   for (int f = 0; f < mesh.GetNumFaces(); ++f)
+   {
+      if (mesh.FaceIsInterior(f) == interior) { faces.Append(f); }
+   }
+}
+
 // PA Diffusion Integrator
 
 // OCCA 2D Assemble kernel
@@ -173,13 +314,143 @@ static void PADiffusionSetup3D(const int Q1D,
          const double A31 = (J12 * J23) - (J13 * J22);
          const double A32 = (J13 * J21) - (J11 * J23);
          const double A33 = (J11 * J22) - (J12 * J21);
-         // adj(J)^Tadj(J)
-         y(0,q,e) = c_detJ * (A11*A11 + A21*A21 + A31*A31);
-         y(1,q,e) = c_detJ * (A11*A12 + A21*A22 + A31*A32);
-         y(2,q,e) = c_detJ * (A11*A13 + A21*A23 + A31*A33);
-         y(3,q,e) = c_detJ * (A12*A12 + A22*A22 + A32*A32);
-         y(4,q,e) = c_detJ * (A12*A13 + A22*A23 + A32*A33);
-         y(5,q,e) = c_detJ * (A13*A13 + A23*A23 + A33*A33);
+         // adj(J)adj(J)^T
+         y(0,q,e) = c_detJ * (A11*A11 + A12*A12 + A13*A13);
+         y(1,q,e) = c_detJ * (A11*A21 + A12*A22 + A13*A23);
+         y(2,q,e) = c_detJ * (A11*A31 + A12*A32 + A13*A33);
+         y(3,q,e) = c_detJ * (A21*A21 + A22*A22 + A23*A23);
+         y(4,q,e) = c_detJ * (A21*A31 + A22*A32 + A23*A33);
+         y(5,q,e) = c_detJ * (A31*A31 + A32*A32 + A33*A33);
+      }
+   });
+}
+
+// PA Diffusion Assemble 2D kernel with a coefficient given at the quadrature
+// points: C is either a scalar (CD = 1) or a symmetric matrix (CD = 3, stored
+// as C11, C12, C22) at each point.
+static void PADiffusionSetup2D(const int Q1D,
+                               const int NE,
+                               const double* w,
+                               const double* j,
+                               const int CD,
+                               const double* c,
+                               double* op)
+{
+   const int NQ = Q1D*Q1D;
+   const DeviceVector W(w, NQ);
+   const DeviceTensor<4> J(j, 2, 2, NQ, NE);
+   const DeviceTensor<3> C(c, CD, NQ, NE);
+   DeviceTensor<3> y(op, 3, NQ, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         const double J11 = J(0,0,q,e);
+         const double J12 = J(1,0,q,e);
+         const double J21 = J(0,1,q,e);
+         const double J22 = J(1,1,q,e);
+         const double w_detJ = W(q) / ((J11*J22)-(J21*J12));
+         // adj(J)
+         const double A11 =  J22, A12 = -J21;
+         const double A21 = -J12, A22 =  J11;
+         if (CD == 1)
+         {
+            const double c_detJ = w_detJ * C(0,q,e);
+            y(0,q,e) = c_detJ * (A11*A11 + A12*A12);
+            y(1,q,e) = c_detJ * (A11*A21 + A12*A22);
+            y(2,q,e) = c_detJ * (A21*A21 + A22*A22);
+         }
+         else
+         {
+            // adj(J) C adj(J)^T
+            const double C11 = C(0,q,e), C12 = C(1,q,e), C22 = C(2,q,e);
+            const double AC11 = A11*C11 + A12*C12, AC12 = A11*C12 + A12*C22;
+            const double AC21 = A21*C11 + A22*C12, AC22 = A21*C12 + A22*C22;
+            y(0,q,e) = w_detJ * (AC11*A11 + AC12*A12);
+            y(1,q,e) = w_detJ * (AC11*A21 + AC12*A22);
+            y(2,q,e) = w_detJ * (AC21*A21 + AC22*A22);
+         }
+      }
+   });
+}
+
+// PA Diffusion Assemble 3D kernel with a coefficient given at the quadrature
+// points: C is either a scalar (CD = 1) or a symmetric matrix (CD = 6, stored
+// as C11, C12, C13, C22, C23, C33) at each point.
+static void PADiffusionSetup3D(const int Q1D,
+                               const int NE,
+                               const double* w,
+                               const double* j,
+                               const int CD,
+                               const double* c,
+                               double* op)
+{
+   const int NQ = Q1D*Q1D*Q1D;
+   const DeviceVector W(w, NQ);
+   const DeviceTensor<4> J(j, 3, 3, NQ, NE);
+   const DeviceTensor<3> C(c, CD, NQ, NE);
+   DeviceTensor<3> y(op, 6, NQ, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         const double J11 = J(0,0,q,e);
+         const double J12 = J(1,0,q,e);
+         const double J13 = J(2,0,q,e);
+         const double J21 = J(0,1,q,e);
+         const double J22 = J(1,1,q,e);
+         const double J23 = J(2,1,q,e);
+         const double J31 = J(0,2,q,e);
+         const double J32 = J(1,2,q,e);
+         const double J33 = J(2,2,q,e);
+         const double detJ =
+         ((J11 * J22 * J33) + (J12 * J23 * J31) +
+         (J13 * J21 * J32) - (J13 * J22 * J31) -
+         (J12 * J21 * J33) - (J11 * J23 * J32));
+         const double w_detJ = W(q) / detJ;
+         // adj(J)
+         double A[3][3];
+         A[0][0] = (J22 * J33) - (J23 * J32);
+         A[0][1] = (J23 * J31) - (J21 * J33);
+         A[0][2] = (J21 * J32) - (J22 * J31);
+         A[1][0] = (J13 * J32) - (J12 * J33);
+         A[1][1] = (J11 * J33) - (J13 * J31);
+         A[1][2] = (J12 * J31) - (J11 * J32);
+         A[2][0] = (J12 * J23) - (J13 * J22);
+         A[2][1] = (J13 * J21) - (J11 * J23);
+         A[2][2] = (J11 * J22) - (J12 * J21);
+         // the (symmetric) coefficient matrix
+         double M[3][3];
+         if (CD == 1)
+         {
+            const double cq = C(0,q,e);
+            for (int r = 0; r < 3; ++r)
+            {
+               for (int s = 0; s < 3; ++s) { M[r][s] = (r == s) ? cq : 0.0; }
+            }
+         }
+         else
+         {
+            M[0][0] = C(0,q,e); M[0][1] = M[1][0] = C(1,q,e);
+            M[0][2] = M[2][0] = C(2,q,e); M[1][1] = C(3,q,e);
+            M[1][2] = M[2][1] = C(4,q,e); M[2][2] = C(5,q,e);
+         }
+         // adj(J) M adj(J)^T
+         for (int r = 0, k = 0; r < 3; ++r)
+         {
+            for (int s = r; s < 3; ++s, ++k)
+            {
+               double d = 0.0;
+               for (int m = 0; m < 3; ++m)
+               {
+                  for (int n = 0; n < 3; ++n)
+                  {
+                     d += A[r][m] * M[m][n] * A[s][n];
+                  }
+               }
+               y(k,q,e) = w_detJ * d;
+            }
+         }
       }
    });
 }
@@ -196,10 +467,19 @@ static bool DeviceUseOcca()
           (Device::Allows(Backend::OCCA_OMP) &&
            !Device::Allows(Backend::DEVICE_MASK)) ||
           (Device::Allows(Backend::OCCA_CPU) &&
-           !Device::Allows(Backend::DEVICE_MASK|Backend::OMP_MASK));
+           !Device::Allows(Backend::DEVICE_MASK|Backend::OMP_MASK|
+                           Backend::SIMD));
 }
 #endif
 
+// This function is currently used to determine if a SIMD kernel should be
+// used.
+static bool DeviceUseSIMD()
+{
+   return Device::Allows(Backend::SIMD) &&
+          !Device::Allows(Backend::DEVICE_MASK|Backend::OMP_MASK);
+}
+
 }
 
 static void PADiffusionSetup(const int dim,
@@ -238,6 +518,13 @@ static void PADiffusionSetup(const int dim,
 
 void DiffusionIntegrator::Assemble(const FiniteElementSpace &fes)
 {
+   delete batch_pa;
+   batch_pa = NULL;
+   if (!ElementBatches::UsesTensorLayout(fes))
+   {
+      batch_pa = new DenseBatchPA(fes, true, IntRule, Q, MQ);
+      return;
+   }
    const Mesh *mesh = fes.GetMesh();
    const IntegrationRule *rule = IntRule;
    const FiniteElement &el = *fes.GetFE(0);
@@ -249,11 +536,42 @@ void DiffusionIntegrator::Assemble(const FiniteElementSpace &fes)
    ne = fes.GetNE();
    dofs1D = el.GetOrder() + 1;
    quad1D = IntRules.Get(Geometry::SEGMENT, ir->GetOrder()).GetNPoints();
-   geom = GeometryExtension::Get(fes,*ir);
+   geom = fes.GetMesh()->GetGeometricFactors(*ir, GeometricFactors::JACOBIANS);
    maps = DofToQuad::Get(fes, fes, *ir);
    vec.SetSize(symmDims * nq * ne);
-   const double coeff = static_cast<ConstantCoefficient*>(Q)->constant;
-   PADiffusionSetup(dim, dofs1D, quad1D, ne, maps->W, geom->J, coeff, vec);
+   ConstantCoefficient *const_coeff = dynamic_cast<ConstantCoefficient*>(Q);
+   if (MQ == NULL && (Q == NULL || const_coeff))
+   {
+      const double coeff = const_coeff ? const_coeff->constant : 1.0;
+      PADiffusionSetup(dim, dofs1D, quad1D, ne, maps->W, geom->J, coeff, vec);
+      return;
+   }
+   // Variable coefficients are evaluated at all quadrature points in one pass
+   // and folded into the symmetric quadrature data.
+   Vector coeff;
+   int coeff_dim = 1;
+   if (MQ)
+   {
+      MFEM_VERIFY(MQ->GetHeight() == dim, "invalid matrix coefficient size");
+      EvalPASymmMatrixCoefficient(MQ, fes, *ir, coeff);
+      coeff_dim = symmDims;
+   }
+   else
+   {
+      EvalPACoefficient(Q, fes, *ir, coeff);
+   }
+   if (dim == 2)
+   {
+      PADiffusionSetup2D(quad1D, ne, maps->W, geom->J, coeff_dim, coeff, vec);
+   }
+   else if (dim == 3)
+   {
+      PADiffusionSetup3D(quad1D, ne, maps->W, geom->J, coeff_dim, coeff, vec);
+   }
+   else
+   {
+      MFEM_ABORT("dim==1 not supported in PADiffusionSetup");
+   }
 }
 
 #ifdef MFEM_USE_OCCA
@@ -360,391 +678,326 @@ static void OccaPADiffusionApply3D(const int D1D,
 #define QUAD_2D_ID(X, Y) (X + ((Y) * Q1D))
 #define QUAD_3D_ID(X, Y, Z) (X + ((Y) * Q1D) + ((Z) * Q1D*Q1D))
 
-const int MAX_Q1D = 10;
-const int MAX_D1D = 10;
+#ifdef MFEM_USE_JIT
+// Return the instance name<D1D,Q1D> of a kernel from bilininteg_kernels.hpp,
+// compiled at runtime with the C linkage wrapper (params) { name(args); }, or
+// NULL if it is unavailable or if a device backend is used. The kernels are
+// resolved once per name, D1D and Q1D; name must be a string literal.
+static void *PAKernelJIT(const char *name, const char *params,
+                         const char *args, const int D1D, const int Q1D)
+{
+   if (Device::Allows(Backend::DEVICE_MASK)) { return NULL; }
+   typedef std::pair<const char*, int> Key;
+   static std::map<Key, void*> resolved;
+   static std::mutex resolved_mutex;
+   std::lock_guard<std::mutex> lock(resolved_mutex);
+   const Key key(name, (D1D << 16) | Q1D);
+   std::map<Key, void*>::iterator it = resolved.find(key);
+   if (it != resolved.end()) { return it->second; }
+
+   std::ostringstream fn, src;
+   fn << "mfem_jit_" << name << "_" << D1D << "_" << Q1D;
+   src << "#include \"fem/bilininteg_kernels.hpp\"\n"
+       << "extern \"C\" void " << fn.str() << "(" << params << ")\n"
+       << "{\n   mfem::" << name << "<" << D1D << "," << Q1D << ">("
+       << args << ");\n}\n";
+   return resolved[key] = KernelCache::Lookup(fn.str(), src.str());
+}
+
+typedef void (*PADiffusionKernel)(const int, const double*, const double*,
+                                  const double*, const double*, const double*,
+                                  const double*, double*);
 
-// PA Diffusion Apply 2D kernel
-template<int T_D1D = 0, int T_Q1D = 0> static
-void PADiffusionApply2D(const int NE,
-                        const double* b,
-                        const double* g,
-                        const double* bt,
-                        const double* gt,
-                        const double* _op,
-                        const double* _x,
-                        double* _y,
-                        const int d1d = 0,
-                        const int q1d = 0)
+// The runtime compiled diffusion kernel for the given dim, D1D and Q1D.
+static PADiffusionKernel PADiffusionApplyJIT(const int dim, const int D1D,
+                                             const int Q1D)
 {
-   const int D1D = T_D1D ? T_D1D : d1d;
-   const int Q1D = T_Q1D ? T_Q1D : q1d;
-   MFEM_VERIFY(D1D <= MAX_D1D, "");
-   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   return (PADiffusionKernel) PAKernelJIT(
+             dim == 2 ? "PADiffusionApply2D" : "PADiffusionApply3D",
+             "const int NE, const double *b, const double *g, const double *bt,"
+             " const double *gt, const double *op, const double *x, double *y",
+             "NE, b, g, bt, gt, op, x, y", D1D, Q1D);
+}
 
-   const DeviceMatrix B(b, Q1D, D1D);
-   const DeviceMatrix G(g, Q1D, D1D);
-   const DeviceMatrix Bt(bt, D1D, Q1D);
-   const DeviceMatrix Gt(gt, D1D, Q1D);
-   const DeviceTensor<3> op(_op, 3, Q1D*Q1D, NE);
-   const DeviceTensor<3> x(_x, D1D, D1D, NE);
-   DeviceTensor<3> y(_y, D1D, D1D, NE);
+typedef void (*PAMassKernel)(const int, const double*, const double*,
+                             const double*, const double*, double*);
 
-   MFEM_FORALL(e, NE,
+// The runtime compiled mass kernel for the given dim, D1D and Q1D.
+static PAMassKernel PAMassApplyJIT(const int dim, const int D1D,
+                                   const int Q1D)
+{
+   return (PAMassKernel) PAKernelJIT(
+             dim == 2 ? "PAMassApply2D" : "PAMassApply3D",
+             "const int NE, const double *B, const double *Bt,"
+             " const double *op, const double *x, double *y",
+             "NE, B, Bt, op, x, y", D1D, Q1D);
+}
+#endif // MFEM_USE_JIT
+
+static void PADiffusionApply(const int dim,
+                             const int D1D,
+                             const int Q1D,
+                             const int NE,
+                             const double* B,
+                             const double* G,
+                             const double* Bt,
+                             const double* Gt,
+                             const double* op,
+                             const double* x,
+                             double* y)
+{
+#ifdef MFEM_USE_OCCA
+   if (internal::DeviceUseOcca())
+   {
+      if (dim == 2)
+      {
+         OccaPADiffusionApply2D(D1D, Q1D, NE, B, G, Bt, Gt, op, x, y);
+         return;
+      }
+      if (dim == 3)
+      {
+         OccaPADiffusionApply3D(D1D, Q1D, NE, B, G, Bt, Gt, op, x, y);
+         return;
+      }
+      MFEM_ABORT("OCCA PADiffusionApply unknown kernel!");
+   }
+#endif // MFEM_USE_OCCA
+   if (internal::DeviceUseSIMD())
    {
-      const int D1D = T_D1D ? T_D1D : d1d; // nvcc workaround
-      const int Q1D = T_Q1D ? T_Q1D : q1d;
+      internal::SIMDPADiffusionApply(dim, D1D, Q1D, NE, B, G, Bt, Gt, op, x, y);
+      return;
+   }
 
-      double grad[MAX_Q1D][MAX_Q1D][2];
-      for (int qy = 0; qy < Q1D; ++qy)
+   if (dim == 2)
+   {
+      switch ((D1D << 4) | Q1D)
       {
-         for (int qx = 0; qx < Q1D; ++qx)
+         case 0x22: PADiffusionApply2D<2,2>(NE, B, G, Bt, Gt, op, x, y); break;
+         case 0x33: PADiffusionApply2D<3,3>(NE, B, G, Bt, Gt, op, x, y); break;
+         case 0x44: PADiffusionApply2D<4,4>(NE, B, G, Bt, Gt, op, x, y); break;
+         case 0x55: PADiffusionApply2D<5,5>(NE, B, G, Bt, Gt, op, x, y); break;
+         default:
          {
-            grad[qy][qx][0] = 0.0;
-            grad[qy][qx][1] = 0.0;
+#ifdef MFEM_USE_JIT
+            PADiffusionKernel ker = PADiffusionApplyJIT(2, D1D, Q1D);
+            if (ker) { ker(NE, B, G, Bt, Gt, op, x, y); break; }
+#endif
+            PADiffusionApply2D(NE, B, G, Bt, Gt, op, x, y, D1D, Q1D);
          }
       }
-      for (int dy = 0; dy < D1D; ++dy)
+      return;
+   }
+   if (dim == 3)
+   {
+      switch ((D1D << 4) | Q1D)
       {
-         double gradX[MAX_Q1D][2];
-         for (int qx = 0; qx < Q1D; ++qx)
+         case 0x23: PADiffusionApply3D<2,3>(NE, B, G, Bt, Gt, op, x, y); break;
+         case 0x34: PADiffusionApply3D<3,4>(NE, B, G, Bt, Gt, op, x, y); break;
+         case 0x45: PADiffusionApply3D<4,5>(NE, B, G, Bt, Gt, op, x, y); break;
+         case 0x56: PADiffusionApply3D<5,6>(NE, B, G, Bt, Gt, op, x, y); break;
+         default:
          {
-            gradX[qx][0] = 0.0;
-            gradX[qx][1] = 0.0;
+#ifdef MFEM_USE_JIT
+            PADiffusionKernel ker = PADiffusionApplyJIT(3, D1D, Q1D);
+            if (ker) { ker(NE, B, G, Bt, Gt, op, x, y); break; }
+#endif
+            PADiffusionApply3D(NE, B, G, Bt, Gt, op, x, y, D1D, Q1D);
          }
-         for (int dx = 0; dx < D1D; ++dx)
+      }
+      return;
+   }
+   MFEM_ABORT("Unknown kernel.");
+}
+
+// PA Diffusion Apply kernel
+void DiffusionIntegrator::MultAssembled(Vector &x, Vector &y)
+{
+   if (batch_pa) { batch_pa->AddMult(x, y); return; }
+   PADiffusionApply(dim, dofs1D, quad1D, ne,
+                    maps->B, maps->G, maps->Bt, maps->Gt,
+                    vec, x, y);
+}
+
+// PA Diffusion Diagonal 2D kernel: the diagonal of the element matrices,
+// sum_q (grad phi_i)^T D(q) (grad phi_i), computed by contracting the
+// quadrature data first in y, then in x.
+static void PADiffusionDiagonal2D(const int NE,
+                                  const int D1D,
+                                  const int Q1D,
+                                  const double* b,
+                                  const double* g,
+                                  const double* _op,
+                                  double* _diag)
+{
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const DeviceMatrix B(b, Q1D, D1D);
+   const DeviceMatrix G(g, Q1D, D1D);
+   const DeviceTensor<3> op(_op, 3, Q1D*Q1D, NE);
+   DeviceTensor<3> diag(_diag, D1D, D1D, NE);
+   MFEM_FORALL(e, NE,
+   {
+      // QD[k][qx][dy]: y-contraction of the component k = D11, D12, D22
+      double QD[3][MAX_Q1D][MAX_D1D];
+      for (int qx = 0; qx < Q1D; ++qx)
+      {
+         for (int dy = 0; dy < D1D; ++dy)
          {
-            const double s = x(dx,dy,e);
-            for (int qx = 0; qx < Q1D; ++qx)
+            QD[0][qx][dy] = QD[1][qx][dy] = QD[2][qx][dy] = 0.0;
+            for (int qy = 0; qy < Q1D; ++qy)
             {
-               gradX[qx][0] += s * B(qx,dx);
-               gradX[qx][1] += s * G(qx,dx);
+               const int q = QUAD_2D_ID(qx, qy);
+               const double By = B(qy,dy), Gy = G(qy,dy);
+               QD[0][qx][dy] += By * By * op(0,q,e);
+               QD[1][qx][dy] += By * Gy * op(1,q,e);
+               QD[2][qx][dy] += Gy * Gy * op(2,q,e);
             }
          }
-         for (int qy = 0; qy < Q1D; ++qy)
+      }
+      for (int dy = 0; dy < D1D; ++dy)
+      {
+         for (int dx = 0; dx < D1D; ++dx)
          {
-            const double wy  = B(qy,dy);
-            const double wDy = G(qy,dy);
+            double d = 0.0;
             for (int qx = 0; qx < Q1D; ++qx)
             {
-               grad[qy][qx][0] += gradX[qx][1] * wy;
-               grad[qy][qx][1] += gradX[qx][0] * wDy;
+               const double Bx = B(qx,dx), Gx = G(qx,dx);
+               d += Gx * Gx * QD[0][qx][dy];
+               d += 2.0 * Bx * Gx * QD[1][qx][dy];
+               d += Bx * Bx * QD[2][qx][dy];
             }
+            diag(dx,dy,e) += d;
          }
       }
-      // Calculate Dxy, xDy in plane
-      for (int qy = 0; qy < Q1D; ++qy)
+   });
+}
+
+// PA Diffusion Diagonal 3D kernel, see PADiffusionDiagonal2D. The gradient
+// component c of phi_i is the product over the directions k of the 1D factors
+// G if k == c and B otherwise.
+static void PADiffusionDiagonal3D(const int NE,
+                                  const int D1D,
+                                  const int Q1D,
+                                  const double* b,
+                                  const double* g,
+                                  const double* _op,
+                                  double* _diag)
+{
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const DeviceMatrix B(b, Q1D, D1D);
+   const DeviceMatrix G(g, Q1D, D1D);
+   const DeviceTensor<3> op(_op, 6, Q1D*Q1D*Q1D, NE);
+   DeviceTensor<4> diag(_diag, D1D, D1D, D1D, NE);
+   MFEM_FORALL(e, NE,
+   {
+      // Components (i,j) of the symmetric data: D11, D12, D13, D22, D23, D33
+      const int I[6] = { 0, 0, 0, 1, 1, 2 };
+      const int J[6] = { 0, 1, 2, 1, 2, 2 };
+      double QQD[6][MAX_Q1D][MAX_Q1D][MAX_D1D];
+      double QDD[6][MAX_Q1D][MAX_D1D][MAX_D1D];
+      for (int k = 0; k < 6; ++k)
       {
+         const bool gi = (I[k] == 2), gj = (J[k] == 2);
          for (int qx = 0; qx < Q1D; ++qx)
          {
-            const int q = QUAD_2D_ID(qx, qy);
-
-            const double O11 = op(0,q,e);
-            const double O12 = op(1,q,e);
-            const double O22 = op(2,q,e);
-
-            const double gradX = grad[qy][qx][0];
-            const double gradY = grad[qy][qx][1];
-
-            grad[qy][qx][0] = (O11 * gradX) + (O12 * gradY);
-            grad[qy][qx][1] = (O12 * gradX) + (O22 * gradY);
-         }
-      }
-      for (int qy = 0; qy < Q1D; ++qy)
-      {
-         double gradX[MAX_D1D][2];
-         for (int dx = 0; dx < D1D; ++dx)
-         {
-            gradX[dx][0] = 0;
-            gradX[dx][1] = 0;
-         }
-         for (int qx = 0; qx < Q1D; ++qx)
-         {
-            const double gX = grad[qy][qx][0];
-            const double gY = grad[qy][qx][1];
-            for (int dx = 0; dx < D1D; ++dx)
-            {
-               const double wx  = Bt(dx,qx);
-               const double wDx = Gt(dx,qx);
-               gradX[dx][0] += gX * wDx;
-               gradX[dx][1] += gY * wx;
-            }
-         }
-         for (int dy = 0; dy < D1D; ++dy)
-         {
-            const double wy  = Bt(dy,qy);
-            const double wDy = Gt(dy,qy);
-            for (int dx = 0; dx < D1D; ++dx)
-            {
-               y(dx,dy,e) += ((gradX[dx][0] * wy) + (gradX[dx][1] * wDy));
-            }
-         }
-      }
-   });
-}
-
-// PA Diffusion Apply 3D kernel
-template<int T_D1D = 0, int T_Q1D = 0> static
-void PADiffusionApply3D(const int NE,
-                        const double* b,
-                        const double* g,
-                        const double* bt,
-                        const double* gt,
-                        const double* _op,
-                        const double* _x,
-                        double* _y,
-                        int d1d = 0, int q1d = 0)
-{
-   const int D1D = T_D1D ? T_D1D : d1d;
-   const int Q1D = T_Q1D ? T_Q1D : q1d;
-   MFEM_VERIFY(D1D <= MAX_D1D, "");
-   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
-
-   const DeviceMatrix B(b, Q1D, D1D);
-   const DeviceMatrix G(g, Q1D, D1D);
-   const DeviceMatrix Bt(bt, D1D, Q1D);
-   const DeviceMatrix Gt(gt, D1D, Q1D);
-   const DeviceTensor<3> op(_op, 6, Q1D*Q1D*Q1D, NE);
-   const DeviceTensor<4> x(_x, D1D, D1D, D1D, NE);
-   DeviceTensor<4> y(_y, D1D, D1D, D1D, NE);
-
-   MFEM_FORALL(e, NE,
-   {
-      const int D1D = T_D1D ? T_D1D : d1d; // nvcc workaround
-      const int Q1D = T_Q1D ? T_Q1D : q1d;
-
-      double grad[MAX_Q1D][MAX_Q1D][MAX_Q1D][4];
-      for (int qz = 0; qz < Q1D; ++qz)
-      {
-         for (int qy = 0; qy < Q1D; ++qy)
-         {
-            for (int qx = 0; qx < Q1D; ++qx)
-            {
-               grad[qz][qy][qx][0] = 0.0;
-               grad[qz][qy][qx][1] = 0.0;
-               grad[qz][qy][qx][2] = 0.0;
-            }
-         }
-      }
-      for (int dz = 0; dz < D1D; ++dz)
-      {
-         double gradXY[MAX_Q1D][MAX_Q1D][4];
-         for (int qy = 0; qy < Q1D; ++qy)
-         {
-            for (int qx = 0; qx < Q1D; ++qx)
-            {
-               gradXY[qy][qx][0] = 0.0;
-               gradXY[qy][qx][1] = 0.0;
-               gradXY[qy][qx][2] = 0.0;
-            }
-         }
-         for (int dy = 0; dy < D1D; ++dy)
-         {
-            double gradX[MAX_Q1D][2];
-            for (int qx = 0; qx < Q1D; ++qx)
-            {
-               gradX[qx][0] = 0.0;
-               gradX[qx][1] = 0.0;
-            }
-            for (int dx = 0; dx < D1D; ++dx)
-            {
-               const double s = x(dx,dy,dz,e);
-               for (int qx = 0; qx < Q1D; ++qx)
-               {
-                  gradX[qx][0] += s * B(qx,dx);
-                  gradX[qx][1] += s * G(qx,dx);
-               }
-            }
-            for (int qy = 0; qy < Q1D; ++qy)
-            {
-               const double wy  = B(qy,dy);
-               const double wDy = G(qy,dy);
-               for (int qx = 0; qx < Q1D; ++qx)
-               {
-                  const double wx  = gradX[qx][0];
-                  const double wDx = gradX[qx][1];
-                  gradXY[qy][qx][0] += wDx * wy;
-                  gradXY[qy][qx][1] += wx  * wDy;
-                  gradXY[qy][qx][2] += wx  * wy;
-               }
-            }
-         }
-         for (int qz = 0; qz < Q1D; ++qz)
-         {
-            const double wz  = B(qz,dz);
-            const double wDz = G(qz,dz);
             for (int qy = 0; qy < Q1D; ++qy)
             {
-               for (int qx = 0; qx < Q1D; ++qx)
+               for (int dz = 0; dz < D1D; ++dz)
                {
-                  grad[qz][qy][qx][0] += gradXY[qy][qx][0] * wz;
-                  grad[qz][qy][qx][1] += gradXY[qy][qx][1] * wz;
-                  grad[qz][qy][qx][2] += gradXY[qy][qx][2] * wDz;
+                  double t = 0.0;
+                  for (int qz = 0; qz < Q1D; ++qz)
+                  {
+                     const int q = QUAD_3D_ID(qx, qy, qz);
+                     const double fi = gi ? G(qz,dz) : B(qz,dz);
+                     const double fj = gj ? G(qz,dz) : B(qz,dz);
+                     t += fi * fj * op(k,q,e);
+                  }
+                  QQD[k][qx][qy][dz] = t;
                }
             }
          }
       }
-      // Calculate Dxyz, xDyz, xyDz in plane
-      for (int qz = 0; qz < Q1D; ++qz)
+      for (int k = 0; k < 6; ++k)
       {
-         for (int qy = 0; qy < Q1D; ++qy)
+         const bool gi = (I[k] == 1), gj = (J[k] == 1);
+         for (int qx = 0; qx < Q1D; ++qx)
          {
-            for (int qx = 0; qx < Q1D; ++qx)
+            for (int dy = 0; dy < D1D; ++dy)
             {
-               const int q = QUAD_3D_ID(qx, qy, qz);
-               const double O11 = op(0,q,e);
-               const double O12 = op(1,q,e);
-               const double O13 = op(2,q,e);
-               const double O22 = op(3,q,e);
-               const double O23 = op(4,q,e);
-               const double O33 = op(5,q,e);
-               const double gradX = grad[qz][qy][qx][0];
-               const double gradY = grad[qz][qy][qx][1];
-               const double gradZ = grad[qz][qy][qx][2];
-               grad[qz][qy][qx][0] = (O11*gradX)+(O12*gradY)+(O13*gradZ);
-               grad[qz][qy][qx][1] = (O12*gradX)+(O22*gradY)+(O23*gradZ);
-               grad[qz][qy][qx][2] = (O13*gradX)+(O23*gradY)+(O33*gradZ);
+               for (int dz = 0; dz < D1D; ++dz)
+               {
+                  double t = 0.0;
+                  for (int qy = 0; qy < Q1D; ++qy)
+                  {
+                     const double fi = gi ? G(qy,dy) : B(qy,dy);
+                     const double fj = gj ? G(qy,dy) : B(qy,dy);
+                     t += fi * fj * QQD[k][qx][qy][dz];
+                  }
+                  QDD[k][qx][dy][dz] = t;
+               }
             }
          }
       }
-      for (int qz = 0; qz < Q1D; ++qz)
+      for (int dz = 0; dz < D1D; ++dz)
       {
-         double gradXY[MAX_D1D][MAX_D1D][4];
          for (int dy = 0; dy < D1D; ++dy)
          {
             for (int dx = 0; dx < D1D; ++dx)
             {
-               gradXY[dy][dx][0] = 0;
-               gradXY[dy][dx][1] = 0;
-               gradXY[dy][dx][2] = 0;
-            }
-         }
-         for (int qy = 0; qy < Q1D; ++qy)
-         {
-            double gradX[MAX_D1D][4];
-            for (int dx = 0; dx < D1D; ++dx)
-            {
-               gradX[dx][0] = 0;
-               gradX[dx][1] = 0;
-               gradX[dx][2] = 0;
-            }
-            for (int qx = 0; qx < Q1D; ++qx)
-            {
-               const double gX = grad[qz][qy][qx][0];
-               const double gY = grad[qz][qy][qx][1];
-               const double gZ = grad[qz][qy][qx][2];
-               for (int dx = 0; dx < D1D; ++dx)
-               {
-                  const double wx  = Bt(dx,qx);
-                  const double wDx = Gt(dx,qx);
-                  gradX[dx][0] += gX * wDx;
-                  gradX[dx][1] += gY * wx;
-                  gradX[dx][2] += gZ * wx;
-               }
-            }
-            for (int dy = 0; dy < D1D; ++dy)
-            {
-               const double wy  = Bt(dy,qy);
-               const double wDy = Gt(dy,qy);
-               for (int dx = 0; dx < D1D; ++dx)
-               {
-                  gradXY[dy][dx][0] += gradX[dx][0] * wy;
-                  gradXY[dy][dx][1] += gradX[dx][1] * wDy;
-                  gradXY[dy][dx][2] += gradX[dx][2] * wy;
-               }
-            }
-         }
-         for (int dz = 0; dz < D1D; ++dz)
-         {
-            const double wz  = Bt(dz,qz);
-            const double wDz = Gt(dz,qz);
-            for (int dy = 0; dy < D1D; ++dy)
-            {
-               for (int dx = 0; dx < D1D; ++dx)
+               double d = 0.0;
+               for (int k = 0; k < 6; ++k)
                {
-                  y(dx,dy,dz,e) +=
-                     ((gradXY[dy][dx][0] * wz) +
-                      (gradXY[dy][dx][1] * wz) +
-                      (gradXY[dy][dx][2] * wDz));
+                  const bool gi = (I[k] == 0), gj = (J[k] == 0);
+                  const double s = (I[k] == J[k]) ? 1.0 : 2.0;
+                  for (int qx = 0; qx < Q1D; ++qx)
+                  {
+                     const double fi = gi ? G(qx,dx) : B(qx,dx);
+                     const double fj = gj ? G(qx,dx) : B(qx,dx);
+                     d += s * fi * fj * QDD[k][qx][dy][dz];
+                  }
                }
+               diag(dx,dy,dz,e) += d;
             }
          }
       }
    });
 }
 
-static void PADiffusionApply(const int dim,
-                             const int D1D,
-                             const int Q1D,
-                             const int NE,
-                             const double* B,
-                             const double* G,
-                             const double* Bt,
-                             const double* Gt,
-                             const double* op,
-                             const double* x,
-                             double* y)
+void DiffusionIntegrator::AssembleDiagonalPA(Vector &diag)
 {
-#ifdef MFEM_USE_OCCA
-   if (internal::DeviceUseOcca())
+   if (batch_pa) { batch_pa->AddDiagonal(diag); return; }
+   if (dim == 2)
    {
-      if (dim == 2)
-      {
-         OccaPADiffusionApply2D(D1D, Q1D, NE, B, G, Bt, Gt, op, x, y);
-         return;
-      }
-      if (dim == 3)
-      {
-         OccaPADiffusionApply3D(D1D, Q1D, NE, B, G, Bt, Gt, op, x, y);
-         return;
-      }
-      MFEM_ABORT("OCCA PADiffusionApply unknown kernel!");
+      PADiffusionDiagonal2D(ne, dofs1D, quad1D, maps->B, maps->G, vec, diag);
    }
-#endif // MFEM_USE_OCCA
-
-   if (dim == 2)
+   else if (dim == 3)
    {
-      switch ((D1D << 4) | Q1D)
-      {
-         case 0x22: PADiffusionApply2D<2,2>(NE, B, G, Bt, Gt, op, x, y); break;
-         case 0x33: PADiffusionApply2D<3,3>(NE, B, G, Bt, Gt, op, x, y); break;
-         case 0x44: PADiffusionApply2D<4,4>(NE, B, G, Bt, Gt, op, x, y); break;
-         case 0x55: PADiffusionApply2D<5,5>(NE, B, G, Bt, Gt, op, x, y); break;
-         default: PADiffusionApply2D(NE, B, G, Bt, Gt, op, x, y, D1D, Q1D);
-      }
-      return;
+      PADiffusionDiagonal3D(ne, dofs1D, quad1D, maps->B, maps->G, vec, diag);
    }
-   if (dim == 3)
+   else
    {
-      switch ((D1D << 4) | Q1D)
-      {
-         case 0x23: PADiffusionApply3D<2,3>(NE, B, G, Bt, Gt, op, x, y); break;
-         case 0x34: PADiffusionApply3D<3,4>(NE, B, G, Bt, Gt, op, x, y); break;
-         case 0x45: PADiffusionApply3D<4,5>(NE, B, G, Bt, Gt, op, x, y); break;
-         case 0x56: PADiffusionApply3D<5,6>(NE, B, G, Bt, Gt, op, x, y); break;
-         default: PADiffusionApply3D(NE, B, G, Bt, Gt, op, x, y, D1D, Q1D);
-      }
-      return;
+      MFEM_ABORT("dim==1 not supported in AssembleDiagonalPA");
    }
-   MFEM_ABORT("Unknown kernel.");
-}
-
-// PA Diffusion Apply kernel
-void DiffusionIntegrator::MultAssembled(Vector &x, Vector &y)
-{
-   PADiffusionApply(dim, dofs1D, quad1D, ne,
-                    maps->B, maps->G, maps->Bt, maps->Gt,
-                    vec, x, y);
 }
 
 DiffusionIntegrator::~DiffusionIntegrator()
 {
-   delete geom;
+   // geom is owned by the Mesh
    delete maps;
+   delete batch_pa;
 }
 
 // PA Mass Assemble kernel
 void MassIntegrator::Assemble(const FiniteElementSpace &fes)
 {
+   delete batch_pa;
+   batch_pa = NULL;
+   if (!ElementBatches::UsesTensorLayout(fes))
+   {
+      batch_pa = new DenseBatchPA(fes, false, IntRule, Q);
+      return;
+   }
    const Mesh *mesh = fes.GetMesh();
    const IntegrationRule *rule = IntRule;
    const FiniteElement &el = *fes.GetFE(0);
@@ -754,11 +1007,14 @@ void MassIntegrator::Assemble(const FiniteElementSpace &fes)
    nq = ir->GetNPoints();
    dofs1D = el.GetOrder() + 1;
    quad1D = IntRules.Get(Geometry::SEGMENT, ir->GetOrder()).GetNPoints();
-   geom = GeometryExtension::Get(fes,*ir);
-   maps = DofToQuad::Get(fes, fes, *ir);
-   vec.SetSize(ne*nq);
    ConstantCoefficient *const_coeff = dynamic_cast<ConstantCoefficient*>(Q);
    FunctionCoefficient *function_coeff = dynamic_cast<FunctionCoefficient*>(Q);
+   // The coordinates are only needed to evaluate function coefficients
+   const int flags = GeometricFactors::JACOBIANS |
+                     (function_coeff ? GeometricFactors::COORDINATES : 0);
+   geom = fes.GetMesh()->GetGeometricFactors(*ir, flags);
+   maps = DofToQuad::Get(fes, fes, *ir);
+   vec.SetSize(ne*nq);
    // TODO: other types of coefficients ...
    if (dim==1) { MFEM_ABORT("Not supported yet... stay tuned!"); }
    if (dim==2)
@@ -780,7 +1036,7 @@ void MassIntegrator::Assemble(const FiniteElementSpace &fes)
       const int NE = ne;
       const int NQ = nq;
       const DeviceVector w(maps->W.GetData(), NQ);
-      const DeviceTensor<3> x(geom->X.GetData(), 2,NQ,NE);
+      const DeviceTensor<3> x(geom->X.GetData(), 2,NQ,function ? NE : 0);
       const DeviceTensor<4> J(geom->J.GetData(), 2,2,NQ,NE);
       DeviceMatrix v(vec.GetData(), NQ, NE);
       MFEM_FORALL(e, NE,
@@ -792,10 +1048,9 @@ void MassIntegrator::Assemble(const FiniteElementSpace &fes)
             const double J21 = J(0,1,q,e);
             const double J22 = J(1,1,q,e);
             const double detJ = (J11*J22)-(J21*J12);
-            const Vector3 Xq(x(0,q,e), x(1,q,e));
             const double coeff =
             const_coeff ? constant
-            : function_coeff ? function(Xq)
+            : function_coeff ? function(Vector3(x(0,q,e), x(1,q,e)))
             : 0.0;
             v(q,e) =  w[q] * coeff * detJ;
          }
@@ -820,7 +1075,7 @@ void MassIntegrator::Assemble(const FiniteElementSpace &fes)
       const int NE = ne;
       const int NQ = nq;
       const DeviceVector W(maps->W.GetData(), NQ);
-      const DeviceTensor<3> x(geom->X.GetData(), 3,NQ,NE);
+      const DeviceTensor<3> x(geom->X.GetData(), 3,NQ,function ? NE : 0);
       const DeviceTensor<4> J(geom->J.GetData(), 3,3,NQ,NE);
       DeviceMatrix v(vec.GetData(), NQ,NE);
       MFEM_FORALL(e, NE,
@@ -833,10 +1088,9 @@ void MassIntegrator::Assemble(const FiniteElementSpace &fes)
             const double detJ =
             ((J11 * J22 * J33) + (J12 * J23 * J31) + (J13 * J21 * J32) -
             (J13 * J22 * J31) - (J12 * J21 * J33) - (J11 * J23 * J32));
-            const Vector3 Xq(x(0,q,e), x(1,q,e), x(2,q,e));
             const double coeff =
             const_coeff ? constant
-            : function_coeff ? function(Xq)
+            : function_coeff ? function(Vector3(x(0,q,e), x(1,q,e), x(2,q,e)))
             : 0.0;
             v(q,e) = W(q) * coeff * detJ;
          }
@@ -912,263 +1166,29 @@ static void OccaPAMassApply3D(const int D1D,
    if (!Device::Allows(Backend::OCCA_CUDA))
    {
       static occa_kernel_t OccaMassApply3D_cpu;
-      if (OccaMassApply3D_cpu.find(id) == OccaMassApply3D_cpu.end())
-      {
-         const occa::kernel MassApply3D_CPU =
-            mfem::OccaDev().buildKernel("occa://mfem/fem/occa.okl",
-                                        "MassApply3D_CPU", props);
-         OccaMassApply3D_cpu.emplace(id, MassApply3D_CPU);
-      }
-      OccaMassApply3D_cpu.at(id)(NE, o_B, o_Bt, o_op, o_x, o_y);
-   }
-   else
-   {
-      static occa_kernel_t OccaMassApply3D_gpu;
-      if (OccaMassApply3D_gpu.find(id) == OccaMassApply3D_gpu.end())
-      {
-         const occa::kernel MassApply3D_GPU =
-            mfem::OccaDev().buildKernel("occa://mfem/fem/occa.okl",
-                                        "MassApply3D_GPU", props);
-         OccaMassApply3D_gpu.emplace(id, MassApply3D_GPU);
-      }
-      OccaMassApply3D_gpu.at(id)(NE, o_B, o_Bt, o_op, o_x, o_y);
-   }
-}
-#endif // MFEM_USE_OCCA
-
-template<const int T_D1D = 0, const int T_Q1D = 0> static
-void PAMassApply2D(const int NE,
-                   const double* _B,
-                   const double* _Bt,
-                   const double* _op,
-                   const double* _x,
-                   double* _y,
-                   const int d1d = 0,
-                   const int q1d = 0)
-{
-   const int D1D = T_D1D ? T_D1D : d1d;
-   const int Q1D = T_Q1D ? T_Q1D : q1d;
-   MFEM_VERIFY(D1D <= MAX_D1D, "");
-   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
-
-   const DeviceMatrix B(_B, Q1D, D1D);
-   const DeviceMatrix Bt(_Bt, D1D, Q1D);
-   const DeviceTensor<3> op(_op, Q1D, Q1D, NE);
-   const DeviceTensor<3> x(_x, D1D, D1D, NE);
-   DeviceTensor<3> y(_y, D1D, D1D, NE);
-
-   MFEM_FORALL(e, NE,
-   {
-      const int D1D = T_D1D ? T_D1D : d1d; // nvcc workaround
-      const int Q1D = T_Q1D ? T_Q1D : q1d;
-
-      double sol_xy[MAX_Q1D][MAX_Q1D];
-      for (int qy = 0; qy < Q1D; ++qy)
-      {
-         for (int qx = 0; qx < Q1D; ++qx)
-         {
-            sol_xy[qy][qx] = 0.0;
-         }
-      }
-      for (int dy = 0; dy < D1D; ++dy)
-      {
-         double sol_x[MAX_Q1D];
-         for (int qy = 0; qy < Q1D; ++qy)
-         {
-            sol_x[qy] = 0.0;
-         }
-         for (int dx = 0; dx < D1D; ++dx)
-         {
-            const double s = x(dx,dy,e);
-            for (int qx = 0; qx < Q1D; ++qx)
-            {
-               sol_x[qx] += B(qx,dx)* s;
-            }
-         }
-         for (int qy = 0; qy < Q1D; ++qy)
-         {
-            const double d2q = B(qy,dy);
-            for (int qx = 0; qx < Q1D; ++qx)
-            {
-               sol_xy[qy][qx] += d2q * sol_x[qx];
-            }
-         }
-      }
-      for (int qy = 0; qy < Q1D; ++qy)
-      {
-         for (int qx = 0; qx < Q1D; ++qx)
-         {
-            sol_xy[qy][qx] *= op(qx,qy,e);
-         }
-      }
-      for (int qy = 0; qy < Q1D; ++qy)
-      {
-         double sol_x[MAX_D1D];
-         for (int dx = 0; dx < D1D; ++dx)
-         {
-            sol_x[dx] = 0.0;
-         }
-         for (int qx = 0; qx < Q1D; ++qx)
-         {
-            const double s = sol_xy[qy][qx];
-            for (int dx = 0; dx < D1D; ++dx)
-            {
-               sol_x[dx] += Bt(dx,qx) * s;
-            }
-         }
-         for (int dy = 0; dy < D1D; ++dy)
-         {
-            const double q2d = Bt(dy,qy);
-            for (int dx = 0; dx < D1D; ++dx)
-            {
-               y(dx,dy,e) += q2d * sol_x[dx];
-            }
-         }
-      }
-   });
-}
-
-template<const int T_D1D = 0, const int T_Q1D = 0> static
-void PAMassApply3D(const int NE,
-                   const double* _B,
-                   const double* _Bt,
-                   const double* _op,
-                   const double* _x,
-                   double* _y,
-                   const int d1d = 0,
-                   const int q1d = 0)
-{
-   const int D1D = T_D1D ? T_D1D : d1d;
-   const int Q1D = T_Q1D ? T_Q1D : q1d;
-   MFEM_VERIFY(D1D <= MAX_D1D, "");
-   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
-
-   const DeviceMatrix B(_B, Q1D, D1D);
-   const DeviceMatrix Bt(_Bt, D1D, Q1D);
-   const DeviceTensor<4> op(_op, Q1D, Q1D, Q1D,NE);
-   const DeviceTensor<4> x(_x, D1D, D1D, D1D, NE);
-   DeviceTensor<4> y(_y, D1D, D1D, D1D, NE);
-
-   MFEM_FORALL(e, NE,
-   {
-      const int D1D = T_D1D ? T_D1D : d1d; // nvcc workaround
-      const int Q1D = T_Q1D ? T_Q1D : q1d;
-
-      double sol_xyz[MAX_Q1D][MAX_Q1D][MAX_Q1D];
-      for (int qz = 0; qz < Q1D; ++qz)
-      {
-         for (int qy = 0; qy < Q1D; ++qy)
-         {
-            for (int qx = 0; qx < Q1D; ++qx)
-            {
-               sol_xyz[qz][qy][qx] = 0.0;
-            }
-         }
-      }
-      for (int dz = 0; dz < D1D; ++dz)
-      {
-         double sol_xy[MAX_Q1D][MAX_Q1D];
-         for (int qy = 0; qy < Q1D; ++qy)
-         {
-            for (int qx = 0; qx < Q1D; ++qx)
-            {
-               sol_xy[qy][qx] = 0.0;
-            }
-         }
-         for (int dy = 0; dy < D1D; ++dy)
-         {
-            double sol_x[MAX_Q1D];
-            for (int qx = 0; qx < Q1D; ++qx)
-            {
-               sol_x[qx] = 0;
-            }
-            for (int dx = 0; dx < D1D; ++dx)
-            {
-               const double s = x(dx,dy,dz,e);
-               for (int qx = 0; qx < Q1D; ++qx)
-               {
-                  sol_x[qx] += B(qx,dx) * s;
-               }
-            }
-            for (int qy = 0; qy < Q1D; ++qy)
-            {
-               const double wy = B(qy,dy);
-               for (int qx = 0; qx < Q1D; ++qx)
-               {
-                  sol_xy[qy][qx] += wy * sol_x[qx];
-               }
-            }
-         }
-         for (int qz = 0; qz < Q1D; ++qz)
-         {
-            const double wz = B(qz,dz);
-            for (int qy = 0; qy < Q1D; ++qy)
-            {
-               for (int qx = 0; qx < Q1D; ++qx)
-               {
-                  sol_xyz[qz][qy][qx] += wz * sol_xy[qy][qx];
-               }
-            }
-         }
-      }
-      for (int qz = 0; qz < Q1D; ++qz)
-      {
-         for (int qy = 0; qy < Q1D; ++qy)
-         {
-            for (int qx = 0; qx < Q1D; ++qx)
-            {
-               sol_xyz[qz][qy][qx] *= op(qx,qy,qz,e);
-            }
-         }
+      if (OccaMassApply3D_cpu.find(id) == OccaMassApply3D_cpu.end())
+      {
+         const occa::kernel MassApply3D_CPU =
+            mfem::OccaDev().buildKernel("occa://mfem/fem/occa.okl",
+                                        "MassApply3D_CPU", props);
+         OccaMassApply3D_cpu.emplace(id, MassApply3D_CPU);
       }
-      for (int qz = 0; qz < Q1D; ++qz)
+      OccaMassApply3D_cpu.at(id)(NE, o_B, o_Bt, o_op, o_x, o_y);
+   }
+   else
+   {
+      static occa_kernel_t OccaMassApply3D_gpu;
+      if (OccaMassApply3D_gpu.find(id) == OccaMassApply3D_gpu.end())
       {
-         double sol_xy[MAX_D1D][MAX_D1D];
-         for (int dy = 0; dy < D1D; ++dy)
-         {
-            for (int dx = 0; dx < D1D; ++dx)
-            {
-               sol_xy[dy][dx] = 0;
-            }
-         }
-         for (int qy = 0; qy < Q1D; ++qy)
-         {
-            double sol_x[MAX_D1D];
-            for (int dx = 0; dx < D1D; ++dx)
-            {
-               sol_x[dx] = 0;
-            }
-            for (int qx = 0; qx < Q1D; ++qx)
-            {
-               const double s = sol_xyz[qz][qy][qx];
-               for (int dx = 0; dx < D1D; ++dx)
-               {
-                  sol_x[dx] += Bt(dx,qx) * s;
-               }
-            }
-            for (int dy = 0; dy < D1D; ++dy)
-            {
-               const double wy = Bt(dy,qy);
-               for (int dx = 0; dx < D1D; ++dx)
-               {
-                  sol_xy[dy][dx] += wy * sol_x[dx];
-               }
-            }
-         }
-         for (int dz = 0; dz < D1D; ++dz)
-         {
-            const double wz = Bt(dz,qz);
-            for (int dy = 0; dy < D1D; ++dy)
-            {
-               for (int dx = 0; dx < D1D; ++dx)
-               {
-                  y(dx,dy,dz,e) += wz * sol_xy[dy][dx];
-               }
-            }
-         }
+         const occa::kernel MassApply3D_GPU =
+            mfem::OccaDev().buildKernel("occa://mfem/fem/occa.okl",
+                                        "MassApply3D_GPU", props);
+         OccaMassApply3D_gpu.emplace(id, MassApply3D_GPU);
       }
-   });
+      OccaMassApply3D_gpu.at(id)(NE, o_B, o_Bt, o_op, o_x, o_y);
+   }
 }
+#endif // MFEM_USE_OCCA
 
 static void PAMassApply(const int dim,
                         const int D1D,
@@ -1196,6 +1216,11 @@ static void PAMassApply(const int dim,
       MFEM_ABORT("OCCA PA Mass Apply unknown kernel!");
    }
 #endif // MFEM_USE_OCCA
+   if (internal::DeviceUseSIMD())
+   {
+      internal::SIMDPAMassApply(dim, D1D, Q1D, NE, B, Bt, op, x, y);
+      return;
+   }
    if (dim == 2)
    {
       switch ((D1D << 4 ) | Q1D)
@@ -1212,7 +1237,14 @@ static void PAMassApply(const int dim,
          case 0x48: PAMassApply2D<4,8>(NE, B, Bt, op, x, y); break;
          case 0x55: PAMassApply2D<5,5>(NE, B, Bt, op, x, y); break;
          case 0x58: PAMassApply2D<5,8>(NE, B, Bt, op, x, y); break;
-         default: PAMassApply2D(NE, B, Bt, op, x, y, D1D, Q1D);
+         default:
+         {
+#ifdef MFEM_USE_JIT
+            PAMassKernel ker = PAMassApplyJIT(2, D1D, Q1D);
+            if (ker) { ker(NE, B, Bt, op, x, y); break; }
+#endif
+            PAMassApply2D(NE, B, Bt, op, x, y, D1D, Q1D);
+         }
       }
       return;
    }
@@ -1226,7 +1258,14 @@ static void PAMassApply(const int dim,
          case 0x34: PAMassApply3D<3,4>(NE, B, Bt, op, x, y); break;
          case 0x45: PAMassApply3D<4,5>(NE, B, Bt, op, x, y); break;
          case 0x56: PAMassApply3D<5,6>(NE, B, Bt, op, x, y); break;
-         default: PAMassApply3D(NE, B, Bt, op, x, y, D1D, Q1D);
+         default:
+         {
+#ifdef MFEM_USE_JIT
+            PAMassKernel ker = PAMassApplyJIT(3, D1D, Q1D);
+            if (ker) { ker(NE, B, Bt, op, x, y); break; }
+#endif
+            PAMassApply3D(NE, B, Bt, op, x, y, D1D, Q1D);
+         }
       }
       return;
    }
@@ -1235,13 +1274,138 @@ static void PAMassApply(const int dim,
 
 void MassIntegrator::MultAssembled(Vector &x, Vector &y)
 {
+   if (batch_pa) { batch_pa->AddMult(x, y); return; }
    PAMassApply(dim, dofs1D, quad1D, ne, maps->B, maps->Bt, vec, x, y);
 }
 
+// PA Mass Diagonal 2D kernel: the diagonal of the element matrices,
+// sum_q phi_i(q)^2 D(q), contracted first in y, then in x.
+static void PAMassDiagonal2D(const int NE,
+                             const int D1D,
+                             const int Q1D,
+                             const double* b,
+                             const double* _op,
+                             double* _diag)
+{
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const DeviceMatrix B(b, Q1D, D1D);
+   const DeviceTensor<3> op(_op, Q1D, Q1D, NE);
+   DeviceTensor<3> diag(_diag, D1D, D1D, NE);
+   MFEM_FORALL(e, NE,
+   {
+      double QD[MAX_Q1D][MAX_D1D];
+      for (int qx = 0; qx < Q1D; ++qx)
+      {
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            QD[qx][dy] = 0.0;
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               QD[qx][dy] += B(qy,dy) * B(qy,dy) * op(qx,qy,e);
+            }
+         }
+      }
+      for (int dy = 0; dy < D1D; ++dy)
+      {
+         for (int dx = 0; dx < D1D; ++dx)
+         {
+            double d = 0.0;
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               d += B(qx,dx) * B(qx,dx) * QD[qx][dy];
+            }
+            diag(dx,dy,e) += d;
+         }
+      }
+   });
+}
+
+// PA Mass Diagonal 3D kernel, see PAMassDiagonal2D.
+static void PAMassDiagonal3D(const int NE,
+                             const int D1D,
+                             const int Q1D,
+                             const double* b,
+                             const double* _op,
+                             double* _diag)
+{
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const DeviceMatrix B(b, Q1D, D1D);
+   const DeviceTensor<4> op(_op, Q1D, Q1D, Q1D, NE);
+   DeviceTensor<4> diag(_diag, D1D, D1D, D1D, NE);
+   MFEM_FORALL(e, NE,
+   {
+      double QQD[MAX_Q1D][MAX_Q1D][MAX_D1D];
+      double QDD[MAX_Q1D][MAX_D1D][MAX_D1D];
+      for (int qx = 0; qx < Q1D; ++qx)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int dz = 0; dz < D1D; ++dz)
+            {
+               QQD[qx][qy][dz] = 0.0;
+               for (int qz = 0; qz < Q1D; ++qz)
+               {
+                  QQD[qx][qy][dz] += B(qz,dz) * B(qz,dz) * op(qx,qy,qz,e);
+               }
+            }
+         }
+      }
+      for (int qx = 0; qx < Q1D; ++qx)
+      {
+         for (int dz = 0; dz < D1D; ++dz)
+         {
+            for (int dy = 0; dy < D1D; ++dy)
+            {
+               QDD[qx][dy][dz] = 0.0;
+               for (int qy = 0; qy < Q1D; ++qy)
+               {
+                  QDD[qx][dy][dz] += B(qy,dy) * B(qy,dy) * QQD[qx][qy][dz];
+               }
+            }
+         }
+      }
+      for (int dz = 0; dz < D1D; ++dz)
+      {
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               double d = 0.0;
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  d += B(qx,dx) * B(qx,dx) * QDD[qx][dy][dz];
+               }
+               diag(dx,dy,dz,e) += d;
+            }
+         }
+      }
+   });
+}
+
+void MassIntegrator::AssembleDiagonalPA(Vector &diag)
+{
+   if (batch_pa) { batch_pa->AddDiagonal(diag); return; }
+   if (dim == 2)
+   {
+      PAMassDiagonal2D(ne, dofs1D, quad1D, maps->B, vec, diag);
+   }
+   else if (dim == 3)
+   {
+      PAMassDiagonal3D(ne, dofs1D, quad1D, maps->B, vec, diag);
+   }
+   else
+   {
+      MFEM_ABORT("dim==1 not supported in AssembleDiagonalPA");
+   }
+}
+
 MassIntegrator::~MassIntegrator()
 {
-   delete geom;
+   // geom is owned by the Mesh
    delete maps;
+   delete batch_pa;
 }
 
 // DofToQuad
@@ -1281,16 +1445,18 @@ DofToQuad* DofToQuad::GetTensorMaps(const FiniteElement& trialFE,
                                     const IntegrationRule& ir,
                                     const bool transpose)
 {
-   const TensorBasisElement& trialTFE =
-      dynamic_cast<const TensorBasisElement&>(trialFE);
-   const TensorBasisElement& testTFE =
-      dynamic_cast<const TensorBasisElement&>(testFE);
+   const TensorBasisElement *trialTFE =
+      dynamic_cast<const TensorBasisElement*>(&trialFE);
+   const TensorBasisElement *testTFE =
+      dynamic_cast<const TensorBasisElement*>(&testFE);
+   MFEM_VERIFY(trialTFE && testTFE, "partial assembly of this integrator "
+               "requires tensor product elements");
    std::stringstream ss;
    ss << "TensorMap:"
       << " O1:"  << trialFE.GetOrder()
       << " O2:"  << testFE.GetOrder()
-      << " BT1:" << trialTFE.GetBasisType()
-      << " BT2:" << testTFE.GetBasisType()
+      << " BT1:" << trialTFE->GetBasisType()
+      << " BT2:" << testTFE->GetBasisType()
       << " Q:"   << ir.GetNPoints();
    std::string hash = ss.str();
    // If we've already made the dof-quad maps, reuse them
@@ -1503,401 +1669,4 @@ DofToQuad* DofToQuad::GetD2QSimplexMaps(const FiniteElement& fe,
    return maps;
 }
 
-
-static long sequence = -1;
-static GeometryExtension *geom = NULL;
-
-static void GeomFill(const int vdim,
-                     const int NE, const int ND, const int NX,
-                     const int* elementMap, int* eMap,
-                     const double *_X, double *meshNodes)
-{
-   const DeviceArray d_elementMap(elementMap, ND*NE);
-   DeviceArray d_eMap(eMap, ND*NE);
-   const DeviceVector X(_X, NX);
-   DeviceVector d_meshNodes(meshNodes, vdim*ND*NE);
-   MFEM_FORALL(e, NE,
-   {
-      for (int d = 0; d < ND; ++d)
-      {
-         const int lid = d+ND*e;
-         const int gid = d_elementMap[lid];
-         d_eMap[lid] = gid;
-         for (int v = 0; v < vdim; ++v)
-         {
-            const int moffset = v+vdim*lid;
-            const int xoffset = v+vdim*gid;
-            d_meshNodes[moffset] = X[xoffset];
-         }
-      }
-   });
-}
-
-static void NodeCopyByVDim(const int elements,
-                           const int numDofs,
-                           const int ndofs,
-                           const int dims,
-                           const int* eMap,
-                           const double* Sx,
-                           double* nodes)
-{
-   MFEM_FORALL(e,elements,
-   {
-      for (int dof = 0; dof < numDofs; ++dof)
-      {
-         const int lid = dof+numDofs*e;
-         const int gid = eMap[lid];
-         for (int v = 0; v < dims; ++v)
-         {
-            const int moffset = v+dims*lid;
-            const int voffset = gid+v*ndofs;
-            nodes[moffset] = Sx[voffset];
-         }
-      }
-   });
-}
-
-template<int T_D1D = 0, int T_Q1D = 0> static
-void PAGeom2D(const int NE,
-              const double* _B,
-              const double* _G,
-              const double* _X,
-              double* _Xq,
-              double* _J,
-              double* _invJ,
-              double* _detJ,
-              const int d1d = 0,
-              const int q1d = 0)
-{
-   const int D1D = T_D1D ? T_D1D : d1d;
-   const int Q1D = T_Q1D ? T_Q1D : q1d;
-   MFEM_VERIFY(D1D <= MAX_D1D, "");
-   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
-   const int ND = D1D*D1D;
-   const int NQ = Q1D*Q1D;
-
-   const DeviceTensor<2> B(_B, NQ, ND);
-   const DeviceTensor<3> G(_G, 2,NQ, ND);
-   const DeviceTensor<3> X(_X, 2,ND, NE);
-   DeviceTensor<3> Xq(_Xq, 2, NQ, NE);
-   DeviceTensor<4> J(_J, 2, 2, NQ, NE);
-   DeviceTensor<4> invJ(_invJ, 2, 2, NQ, NE);
-   DeviceMatrix detJ(_detJ, NQ, NE);
-
-   MFEM_FORALL(e, NE,
-   {
-      const int D1D = T_D1D ? T_D1D : d1d; // nvcc workaround
-      const int Q1D = T_Q1D ? T_Q1D : q1d;
-      const int ND = D1D*D1D;
-      const int NQ = Q1D*Q1D;
-
-      double s_X[2*MAX_D1D*MAX_D1D];
-      for (int q = 0; q < NQ; ++q)
-      {
-         for (int d = q; d < ND; d +=NQ)
-         {
-            s_X[0+d*2] = X(0,d,e);
-            s_X[1+d*2] = X(1,d,e);
-         }
-      }
-      for (int q = 0; q < NQ; ++q)
-      {
-         double X0  = 0; double X1  = 0;
-         double J11 = 0; double J12 = 0;
-         double J21 = 0; double J22 = 0;
-         for (int d = 0; d < ND; ++d)
-         {
-            const double b = B(q,d);
-            const double wx = G(0,q,d);
-            const double wy = G(1,q,d);
-            const double x = s_X[0+d*2];
-            const double y = s_X[1+d*2];
-            J11 += (wx * x); J12 += (wx * y);
-            J21 += (wy * x); J22 += (wy * y);
-            X0 += b*x; X1 += b*y;
-         }
-         Xq(0,q,e) = X0; Xq(1,q,e) = X1;
-         const double r_detJ = (J11 * J22)-(J12 * J21);
-         J(0,0,q,e) = J11;
-         J(1,0,q,e) = J12;
-         J(0,1,q,e) = J21;
-         J(1,1,q,e) = J22;
-         const double r_idetJ = 1.0 / r_detJ;
-         invJ(0,0,q,e) =  J22 * r_idetJ;
-         invJ(1,0,q,e) = -J12 * r_idetJ;
-         invJ(0,1,q,e) = -J21 * r_idetJ;
-         invJ(1,1,q,e) =  J11 * r_idetJ;
-         detJ(q,e) = r_detJ;
-      }
-   });
-}
-
-template<int T_D1D = 0, int T_Q1D = 0> static
-void PAGeom3D(const int NE,
-              const double* _B,
-              const double* _G,
-              const double* _X,
-              double* _Xq,
-              double* _J,
-              double* _invJ,
-              double* _detJ,
-              const int d1d = 0,
-              const int q1d = 0)
-{
-   const int D1D = T_D1D ? T_D1D : d1d;
-   const int Q1D = T_Q1D ? T_Q1D : q1d;
-   MFEM_VERIFY(D1D <= MAX_D1D, "");
-   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
-   const int ND = D1D*D1D*D1D;
-   const int NQ = Q1D*Q1D*Q1D;
-
-   const DeviceTensor<2> B(_B, NQ, NE);
-   const DeviceTensor<3> G(_G, 3, NQ, NE);
-   const DeviceTensor<3> X(_X, 3, ND, NE);
-   DeviceTensor<3> Xq(_Xq, 3, NQ, NE);
-   DeviceTensor<4> J(_J, 3, 3, NQ, NE);
-   DeviceTensor<4> invJ(_invJ, 3, 3, NQ, NE);
-   DeviceMatrix detJ(_detJ, NQ, NE);
-
-   MFEM_FORALL(e,NE,
-   {
-      const int D1D = T_D1D ? T_D1D : d1d; // nvcc workaround
-      const int Q1D = T_Q1D ? T_Q1D : q1d;
-      const int ND = D1D*D1D*D1D;
-      const int NQ = Q1D*Q1D*Q1D;
-
-      double s_nodes[3*MAX_D1D*MAX_D1D*MAX_D1D];
-      for (int q = 0; q < NQ; ++q)
-      {
-         for (int d = q; d < ND; d += NQ)
-         {
-            s_nodes[0+d*3] = X(0,d,e);
-            s_nodes[1+d*3] = X(1,d,e);
-            s_nodes[2+d*3] = X(2,d,e);
-         }
-      }
-      for (int q = 0; q < NQ; ++q)
-      {
-         double J11 = 0; double J12 = 0; double J13 = 0;
-         double J21 = 0; double J22 = 0; double J23 = 0;
-         double J31 = 0; double J32 = 0; double J33 = 0;
-         for (int d = 0; d < ND; ++d)
-         {
-            const double b = B(q,d);
-            const double wx = G(0,q,d);
-            const double wy = G(1,q,d);
-            const double wz = G(2,q,d);
-            const double x = s_nodes[0+d*3];
-            const double y = s_nodes[1+d*3];
-            const double z = s_nodes[2+d*3];
-            J11 += (wx * x); J12 += (wx * y); J13 += (wx * z);
-            J21 += (wy * x); J22 += (wy * y); J23 += (wy * z);
-            J31 += (wz * x); J32 += (wz * y); J33 += (wz * z);
-            Xq(0,q,e) = b*x; Xq(1,q,e) = b*y; Xq(2,q,e) = b*z;
-         }
-         const double r_detJ = ((J11 * J22 * J33) + (J12 * J23 * J31) +
-                                (J13 * J21 * J32) - (J13 * J22 * J31) -
-                                (J12 * J21 * J33) - (J11 * J23 * J32));
-         J(0,0,q,e) = J11;
-         J(1,0,q,e) = J12;
-         J(2,0,q,e) = J13;
-         J(0,1,q,e) = J21;
-         J(1,1,q,e) = J22;
-         J(2,1,q,e) = J23;
-         J(0,2,q,e) = J31;
-         J(1,2,q,e) = J32;
-         J(2,2,q,e) = J33;
-         const double r_idetJ = 1.0 / r_detJ;
-         invJ(0,0,q,e) = r_idetJ * ((J22 * J33)-(J23 * J32));
-         invJ(1,0,q,e) = r_idetJ * ((J32 * J13)-(J33 * J12));
-         invJ(2,0,q,e) = r_idetJ * ((J12 * J23)-(J13 * J22));
-         invJ(0,1,q,e) = r_idetJ * ((J23 * J31)-(J21 * J33));
-         invJ(1,1,q,e) = r_idetJ * ((J33 * J11)-(J31 * J13));
-         invJ(2,1,q,e) = r_idetJ * ((J13 * J21)-(J11 * J23));
-         invJ(0,2,q,e) = r_idetJ * ((J21 * J32)-(J22 * J31));
-         invJ(1,2,q,e) = r_idetJ * ((J31 * J12)-(J32 * J11));
-         invJ(2,2,q,e) = r_idetJ * ((J11 * J22)-(J12 * J21));
-         detJ(q,e) = r_detJ;
-      }
-   });
-}
-
-static void PAGeom(const int dim,
-                   const int D1D,
-                   const int Q1D,
-                   const int NE,
-                   const double* B,
-                   const double* G,
-                   const double* X,
-                   double* Xq,
-                   double* J,
-                   double* invJ,
-                   double* detJ)
-{
-   if (dim == 2)
-   {
-      switch ((D1D << 4) | Q1D)
-      {
-         case 0x22: PAGeom2D<2,2>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x23: PAGeom2D<2,3>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x24: PAGeom2D<2,4>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x25: PAGeom2D<2,5>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x32: PAGeom2D<3,2>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x34: PAGeom2D<3,4>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x42: PAGeom2D<4,2>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x44: PAGeom2D<4,4>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x45: PAGeom2D<4,5>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x46: PAGeom2D<4,6>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x58: PAGeom2D<5,8>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         default: PAGeom2D(NE, B, G, X, Xq, J, invJ, detJ, D1D, Q1D); break;
-      }
-      return;
-   }
-   if (dim == 3)
-   {
-      switch ((D1D << 4) | Q1D)
-      {
-         case 0x23: PAGeom3D<2,3>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x24: PAGeom3D<2,4>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x25: PAGeom3D<2,5>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x26: PAGeom3D<2,6>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         case 0x34: PAGeom3D<3,4>(NE, B, G, X, Xq, J, invJ, detJ); break;
-         default: PAGeom3D(NE, B, G, X, Xq, J, invJ, detJ, D1D, Q1D); break;
-      }
-      return;
-   }
-   MFEM_ABORT("Unknown kernel.");
-}
-
-GeometryExtension* GeometryExtension::Get(const FiniteElementSpace& fes,
-                                          const IntegrationRule& ir,
-                                          const Vector& Sx)
-{
-   const Mesh *mesh = fes.GetMesh();
-   const GridFunction *nodes = mesh->GetNodes();
-   const FiniteElementSpace *fespace = nodes->FESpace();
-   const FiniteElement *fe = fespace->GetFE(0);
-   const IntegrationRule& ir1D = IntRules.Get(Geometry::SEGMENT,ir.GetOrder());
-   const int dims     = fe->GetDim();
-   const int numDofs  = fe->GetDof();
-   const int D1D      = fe->GetOrder() + 1;
-   const int Q1D      = ir1D.GetNPoints();
-   const int elements = fespace->GetNE();
-   const int ndofs    = fespace->GetNDofs();
-   const DofToQuad* maps = DofToQuad::GetSimplexMaps(*fe, ir);
-   NodeCopyByVDim(elements,numDofs,ndofs,dims,geom->eMap,Sx,geom->nodes);
-   PAGeom(dims, D1D, Q1D, elements,
-          maps->B, maps->G, geom->nodes,
-          geom->X, geom->J, geom->invJ, geom->detJ);
-   return geom;
-}
-
-GeometryExtension* GeometryExtension::Get(const FiniteElementSpace& fes,
-                                          const IntegrationRule& ir)
-{
-   Mesh *mesh = fes.GetMesh();
-   const bool geom_to_allocate = sequence < fes.GetSequence();
-   sequence = fes.GetSequence();
-   if (geom_to_allocate)
-   {
-      if (geom) { delete geom; }
-      geom = new GeometryExtension();
-   }
-
-   const bool dev_enabled = Device::IsEnabled();
-   if (dev_enabled) { Device::Disable(); }
-   mesh->EnsureNodes();
-   if (dev_enabled) { Device::Enable(); }
-
-   const GridFunction *nodes = mesh->GetNodes();
-   const mfem::FiniteElementSpace *fespace = nodes->FESpace();
-   const mfem::FiniteElement *fe = fespace->GetFE(0);
-   const IntegrationRule& ir1D = IntRules.Get(Geometry::SEGMENT,ir.GetOrder());
-   const int dims     = fe->GetDim();
-   const int elements = fespace->GetNE();
-   const int numDofs  = fe->GetDof();
-   const int D1D      = fe->GetOrder() + 1;
-   const int Q1D      = ir1D.GetNPoints();
-   const int numQuad  = ir.GetNPoints();
-   const bool orderedByNODES = (fespace->GetOrdering() == Ordering::byNODES);
-   if (orderedByNODES) { ReorderByVDim(nodes); }
-   const int asize = dims*numDofs*elements;
-   mfem::Array<double> meshNodes(asize);
-   const Table& e2dTable = fespace->GetElementToDofTable();
-   const int* elementMap = e2dTable.GetJ();
-   mfem::Array<int> eMap(numDofs*elements);
-   GeomFill(dims,
-            elements,
-            numDofs,
-            nodes->Size(),
-            elementMap,
-            eMap,
-            nodes->GetData(),
-            meshNodes);
-   if (geom_to_allocate)
-   {
-      geom->nodes.SetSize(dims*numDofs*elements);
-      geom->eMap.SetSize(numDofs*elements);
-   }
-   geom->nodes = meshNodes;
-   geom->eMap = eMap;
-   // Reorder the original gf back
-   if (orderedByNODES) { ReorderByNodes(nodes); }
-   if (geom_to_allocate)
-   {
-      geom->X.SetSize(dims*numQuad*elements);
-      geom->J.SetSize(dims*dims*numQuad*elements);
-      geom->invJ.SetSize(dims*dims*numQuad*elements);
-      geom->detJ.SetSize(numQuad*elements);
-   }
-   const DofToQuad* maps = DofToQuad::GetSimplexMaps(*fe, ir);
-   PAGeom(dims, D1D, Q1D, elements,
-          maps->B, maps->G, geom->nodes,
-          geom->X, geom->J, geom->invJ, geom->detJ);
-   delete maps;
-   return geom;
-}
-
-void GeometryExtension::ReorderByVDim(const GridFunction *nodes)
-{
-   const mfem::FiniteElementSpace *fes = nodes->FESpace();
-   const int size = nodes->Size();
-   const int vdim = fes->GetVDim();
-   const int ndofs = fes->GetNDofs();
-   double *data = nodes->GetData();
-   double *temp = new double[size];
-   int k=0;
-   for (int d = 0; d < ndofs; d++)
-      for (int v = 0; v < vdim; v++)
-      {
-         temp[k++] = data[d+v*ndofs];
-      }
-   for (int i = 0; i < size; i++)
-   {
-      data[i] = temp[i];
-   }
-   delete [] temp;
-}
-
-void GeometryExtension::ReorderByNodes(const GridFunction *nodes)
-{
-   const mfem::FiniteElementSpace *fes = nodes->FESpace();
-   const int size = nodes->Size();
-   const int vdim = fes->GetVDim();
-   const int ndofs = fes->GetNDofs();
-   double *data = nodes->GetData();
-   double *temp = new double[size];
-   int k = 0;
-   for (int j = 0; j < ndofs; j++)
-      for (int i = 0; i < vdim; i++)
-      {
-         temp[j+i*ndofs] = data[k++];
-      }
-   for (int i = 0; i < size; i++)
-   {
-      data[i] = temp[i];
-   }
-   delete [] temp;
-}
-
 } // namespace mfem
@@ -17,20 +17,113 @@
 namespace mfem
 {
 
-/// GeometryExtension
-class GeometryExtension
+/// Maximum number of 1D dofs and 1D quadrature points in the PA kernels
+const int MAX_D1D = 10;
+const int MAX_Q1D = 10;
+
+class Coefficient;
+class VectorCoefficient;
+class MatrixCoefficient;
+
+/** @brief Evaluate the scalar coefficient @a Q at the points of @a ir in all
+    elements of @a fes and store the values in @a coeff, as an NQ x NE array.
+    A NULL coefficient is evaluated as 1. */
+void EvalPACoefficient(Coefficient *Q, const FiniteElementSpace &fes,
+                       const IntegrationRule &ir, Vector &coeff);
+
+/** @brief Evaluate the vector coefficient @a VQ at the points of @a ir in all
+    elements of @a fes and store the values in @a coeff, as a vdim x NQ x NE
+    array. */
+void EvalPAVectorCoefficient(VectorCoefficient &VQ,
+                             const FiniteElementSpace &fes,
+                             const IntegrationRule &ir, Vector &coeff);
+
+/** @brief Evaluate the symmetric matrix coefficient @a MQ at the points of
+    @a ir in all elements of @a fes and store its upper triangle, row by row,
+    in @a coeff, as an (dim*(dim+1)/2) x NQ x NE array. The coefficient must
+    be symmetric up to a relative tolerance of 1e-12. */
+void EvalPASymmMatrixCoefficient(MatrixCoefficient *MQ,
+                                 const FiniteElementSpace &fes,
+                                 const IntegrationRule &ir, Vector &coeff);
+
+/** @brief Evaluate the 1D basis of the tensor product element @a el at the
+    points of @a ir1D, B[q + Q1D*d], and its derivatives G if @a G is not
+    NULL. */
+void PABasis1D(const FiniteElement &el, const IntegrationRule &ir1D,
+               Array<double> &B, Array<double> *G);
+
+/** @brief Return the faces handled by the PA face kernels, in increasing
+    order: the interior faces if @a interior is true, the boundary faces
+    otherwise. The mesh must be conforming, without faces shared between
+    processors. */
+void GetPAFaces(const Mesh &mesh, const bool interior, Array<int> &faces);
+
+/** @brief The elements of a space grouped in batches of the same geometry.
+
+    Spaces of tensor product elements on meshes of a single geometry use the
+    lexicographic E-vector layout of the tensor PA kernels. For all other
+    spaces, e.g. on simplex or mixed meshes, the E-vectors of ElemRestriction
+    store the dofs of each element in the native ordering of the element, batch
+    by batch. The batches are in increasing order of Geometry::Type and the
+    elements of each batch are in increasing order. */
+class ElementBatches
 {
 public:
-   Array<int> eMap;
-   Array<double> nodes;
-   Array<double> X, J, invJ, detJ;
-   static GeometryExtension* Get(const FiniteElementSpace&,
-                                 const IntegrationRule&);
-   static GeometryExtension* Get(const FiniteElementSpace&,
-                                 const IntegrationRule&,
-                                 const Vector&);
-   static void ReorderByVDim(const GridFunction*);
-   static void ReorderByNodes(const GridFunction*);
+   /// Geometry of each batch
+   Array<Geometry::Type> geoms;
+   /// Batch b has the entries offsets[b] to offsets[b+1]-1 of elements
+   Array<int> offsets;
+   /// The elements of all batches
+   Array<int> elements;
+   /// Offset of each batch in a scalar E-vector, of size Size()+1
+   Array<int> dof_offsets;
+
+   ElementBatches(const FiniteElementSpace &fes);
+
+   /// Return the number of batches.
+   int Size() const { return geoms.Size(); }
+
+   /** @brief Check if the E-vectors of @a fes use the lexicographic layout of
+       the tensor product elements, i.e. if all elements are tensor product
+       elements of the same geometry. */
+   static bool UsesTensorLayout(const FiniteElementSpace &fes);
+};
+
+/** @brief Partial assembly of the scalar H1 mass or diffusion integrator on
+    the ElementBatches of a space, e.g. on simplex or mixed meshes.
+
+    The quadrature data of each batch is computed on the host with the element
+    transformations, so all coefficient types are supported. The action and the
+    diagonal are computed with the dense matrices B (nq x nd) and G (dim x nq x
+    nd) of the basis of each batch and its reference gradients. */
+class DenseBatchPA
+{
+protected:
+   const bool diffusion;
+   const int dim;
+   ElementBatches batches;
+   /// Number of dofs and quadrature points of each batch
+   Array<int> nd, nq;
+   /// Offsets of each batch in B (nq x nd), G (dim x nq x nd) and op
+   Array<int> b_offsets, op_offsets;
+   Array<double> B, G;
+   /// Quadrature data: symmetric dim x dim matrices (diffusion) or scalars
+   Vector op;
+
+public:
+   /** @brief Assemble the quadrature data on @a fes with the scalar coefficient
+       @a Q or the matrix coefficient @a MQ (diffusion only), which may be
+       NULL. If @a ir is NULL, the integration rules of the full assembly of
+       the integrator are used. */
+   DenseBatchPA(const FiniteElementSpace &fes, const bool diffusion,
+                const IntegrationRule *ir, Coefficient *Q,
+                MatrixCoefficient *MQ = NULL);
+
+   /// Add the action of the operator on the E-vector @a x to @a y.
+   void AddMult(const Vector &x, Vector &y) const;
+
+   /// Add the diagonal of the element matrices to the E-vector @a diag.
+   void AddDiagonal(Vector &diag) const;
 };
 
 /// DofToQuad
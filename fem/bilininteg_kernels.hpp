@@ -0,0 +1,895 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#ifndef MFEM_BILININTEG_KERNELS
+#define MFEM_BILININTEG_KERNELS
+
+#include "../general/forall.hpp"
+#include "../linalg/dtensor.hpp"
+#include "bilininteg_ext.hpp"
+
+namespace mfem
+{
+
+// Sum factorization building blocks for the tensor product PA and MF kernels,
+// acting on the data of a single element. The 1D bases are stored as
+// B[q + Q*d], the element dofs and the quadrature points in lexicographic
+// order.
+namespace internal
+{
+
+// Add the reference gradient of the D x D tensor x at the Q x Q quadrature
+// points to g, where g[k + s*q] is the k-th component at the point q.
+MFEM_ATTR_HOST_DEVICE inline
+void PAGrad2D(const int D, const int Q, const double *B, const double *G,
+              const double *x, double *g, const int s)
+{
+   for (int dy = 0; dy < D; ++dy)
+   {
+      double gx[2*MAX_Q1D];
+      for (int qx = 0; qx < Q; ++qx) { gx[2*qx] = gx[2*qx+1] = 0.0; }
+      for (int dx = 0; dx < D; ++dx)
+      {
+         const double xv = x[dx + D*dy];
+         for (int qx = 0; qx < Q; ++qx)
+         {
+            gx[2*qx]   += xv * B[qx + Q*dx];
+            gx[2*qx+1] += xv * G[qx + Q*dx];
+         }
+      }
+      for (int qy = 0; qy < Q; ++qy)
+      {
+         const double wy = B[qy + Q*dy], wDy = G[qy + Q*dy];
+         for (int qx = 0; qx < Q; ++qx)
+         {
+            const int q = qx + Q*qy;
+            g[s*q]   += gx[2*qx+1] * wy;
+            g[s*q+1] += gx[2*qx] * wDy;
+         }
+      }
+   }
+}
+
+// Transpose of PAGrad2D: add the projection of the reference gradients g to y.
+MFEM_ATTR_HOST_DEVICE inline
+void PAGradT2D(const int D, const int Q, const double *B, const double *G,
+               const double *g, const int s, double *y)
+{
+   for (int qy = 0; qy < Q; ++qy)
+   {
+      double gx[2*MAX_D1D];
+      for (int dx = 0; dx < D; ++dx) { gx[2*dx] = gx[2*dx+1] = 0.0; }
+      for (int qx = 0; qx < Q; ++qx)
+      {
+         const int q = qx + Q*qy;
+         const double g0 = g[s*q], g1 = g[s*q+1];
+         for (int dx = 0; dx < D; ++dx)
+         {
+            gx[2*dx]   += g0 * G[qx + Q*dx];
+            gx[2*dx+1] += g1 * B[qx + Q*dx];
+         }
+      }
+      for (int dy = 0; dy < D; ++dy)
+      {
+         const double wy = B[qy + Q*dy], wDy = G[qy + Q*dy];
+         for (int dx = 0; dx < D; ++dx)
+         {
+            y[dx + D*dy] += gx[2*dx] * wy + gx[2*dx+1] * wDy;
+         }
+      }
+   }
+}
+
+// 3D version of PAGrad2D.
+MFEM_ATTR_HOST_DEVICE inline
+void PAGrad3D(const int D, const int Q, const double *B, const double *G,
+              const double *x, double *g, const int s)
+{
+   for (int dz = 0; dz < D; ++dz)
+   {
+      double gxy[3*MAX_Q1D*MAX_Q1D];
+      for (int i = 0; i < 3*Q*Q; ++i) { gxy[i] = 0.0; }
+      for (int dy = 0; dy < D; ++dy)
+      {
+         double gx[2*MAX_Q1D];
+         for (int qx = 0; qx < Q; ++qx) { gx[2*qx] = gx[2*qx+1] = 0.0; }
+         for (int dx = 0; dx < D; ++dx)
+         {
+            const double xv = x[dx + D*(dy + D*dz)];
+            for (int qx = 0; qx < Q; ++qx)
+            {
+               gx[2*qx]   += xv * B[qx + Q*dx];
+               gx[2*qx+1] += xv * G[qx + Q*dx];
+            }
+         }
+         for (int qy = 0; qy < Q; ++qy)
+         {
+            const double wy = B[qy + Q*dy], wDy = G[qy + Q*dy];
+            for (int qx = 0; qx < Q; ++qx)
+            {
+               double *gq = gxy + 3*(qx + Q*qy);
+               gq[0] += gx[2*qx+1] * wy;
+               gq[1] += gx[2*qx] * wDy;
+               gq[2] += gx[2*qx] * wy;
+            }
+         }
+      }
+      for (int qz = 0; qz < Q; ++qz)
+      {
+         const double wz = B[qz + Q*dz], wDz = G[qz + Q*dz];
+         for (int qy = 0; qy < Q; ++qy)
+         {
+            for (int qx = 0; qx < Q; ++qx)
+            {
+               const int q = qx + Q*(qy + Q*qz);
+               const double *gq = gxy + 3*(qx + Q*qy);
+               g[s*q]   += gq[0] * wz;
+               g[s*q+1] += gq[1] * wz;
+               g[s*q+2] += gq[2] * wDz;
+            }
+         }
+      }
+   }
+}
+
+// 3D version of PAGradT2D.
+MFEM_ATTR_HOST_DEVICE inline
+void PAGradT3D(const int D, const int Q, const double *B, const double *G,
+               const double *g, const int s, double *y)
+{
+   for (int qz = 0; qz < Q; ++qz)
+   {
+      double gxy[3*MAX_D1D*MAX_D1D];
+      for (int i = 0; i < 3*D*D; ++i) { gxy[i] = 0.0; }
+      for (int qy = 0; qy < Q; ++qy)
+      {
+         double gx[3*MAX_D1D];
+         for (int i = 0; i < 3*D; ++i) { gx[i] = 0.0; }
+         for (int qx = 0; qx < Q; ++qx)
+         {
+            const int q = qx + Q*(qy + Q*qz);
+            const double g0 = g[s*q], g1 = g[s*q+1], g2 = g[s*q+2];
+            for (int dx = 0; dx < D; ++dx)
+            {
+               const double wx = B[qx + Q*dx], wDx = G[qx + Q*dx];
+               gx[3*dx]   += g0 * wDx;
+               gx[3*dx+1] += g1 * wx;
+               gx[3*dx+2] += g2 * wx;
+            }
+         }
+         for (int dy = 0; dy < D; ++dy)
+         {
+            const double wy = B[qy + Q*dy], wDy = G[qy + Q*dy];
+            for (int dx = 0; dx < D; ++dx)
+            {
+               double *gd = gxy + 3*(dx + D*dy);
+               gd[0] += gx[3*dx] * wy;
+               gd[1] += gx[3*dx+1] * wDy;
+               gd[2] += gx[3*dx+2] * wy;
+            }
+         }
+      }
+      for (int dz = 0; dz < D; ++dz)
+      {
+         const double wz = B[qz + Q*dz], wDz = G[qz + Q*dz];
+         for (int dy = 0; dy < D; ++dy)
+         {
+            for (int dx = 0; dx < D; ++dx)
+            {
+               const double *gd = gxy + 3*(dx + D*dy);
+               y[dx + D*(dy + D*dz)] += (gd[0] + gd[1]) * wz + gd[2] * wDz;
+            }
+         }
+      }
+   }
+}
+
+// Add the values of the 1D data x at the Q quadrature points to u.
+MFEM_ATTR_HOST_DEVICE inline
+void PAEval1D(const int D, const int Q, const double *B,
+              const double *x, double *u)
+{
+   for (int d = 0; d < D; ++d)
+   {
+      const double xv = x[d];
+      for (int q = 0; q < Q; ++q) { u[q] += xv * B[q + Q*d]; }
+   }
+}
+
+// Transpose of PAEval1D: add the projection of the values u to y.
+MFEM_ATTR_HOST_DEVICE inline
+void PAEvalT1D(const int D, const int Q, const double *B,
+               const double *u, double *y)
+{
+   for (int d = 0; d < D; ++d)
+   {
+      double yd = 0.0;
+      for (int q = 0; q < Q; ++q) { yd += u[q] * B[q + Q*d]; }
+      y[d] += yd;
+   }
+}
+
+// Add the values of the D x D tensor x at the Q x Q quadrature points to u.
+MFEM_ATTR_HOST_DEVICE inline
+void PAEval2D(const int D, const int Q, const double *B,
+              const double *x, double *u)
+{
+   for (int dy = 0; dy < D; ++dy)
+   {
+      double ux[MAX_Q1D];
+      for (int qx = 0; qx < Q; ++qx) { ux[qx] = 0.0; }
+      for (int dx = 0; dx < D; ++dx)
+      {
+         const double xv = x[dx + D*dy];
+         for (int qx = 0; qx < Q; ++qx) { ux[qx] += xv * B[qx + Q*dx]; }
+      }
+      for (int qy = 0; qy < Q; ++qy)
+      {
+         const double wy = B[qy + Q*dy];
+         for (int qx = 0; qx < Q; ++qx) { u[qx + Q*qy] += ux[qx] * wy; }
+      }
+   }
+}
+
+// Transpose of PAEval2D: add the projection of the values u to y.
+MFEM_ATTR_HOST_DEVICE inline
+void PAEvalT2D(const int D, const int Q, const double *B,
+               const double *u, double *y)
+{
+   for (int qy = 0; qy < Q; ++qy)
+   {
+      double yx[MAX_D1D];
+      for (int dx = 0; dx < D; ++dx) { yx[dx] = 0.0; }
+      for (int qx = 0; qx < Q; ++qx)
+      {
+         const double uq = u[qx + Q*qy];
+         for (int dx = 0; dx < D; ++dx) { yx[dx] += uq * B[qx + Q*dx]; }
+      }
+      for (int dy = 0; dy < D; ++dy)
+      {
+         const double wy = B[qy + Q*dy];
+         for (int dx = 0; dx < D; ++dx) { y[dx + D*dy] += yx[dx] * wy; }
+      }
+   }
+}
+
+// 3D version of PAEval2D.
+MFEM_ATTR_HOST_DEVICE inline
+void PAEval3D(const int D, const int Q, const double *B,
+              const double *x, double *u)
+{
+   for (int dz = 0; dz < D; ++dz)
+   {
+      double uxy[MAX_Q1D*MAX_Q1D];
+      for (int i = 0; i < Q*Q; ++i) { uxy[i] = 0.0; }
+      PAEval2D(D, Q, B, x + D*D*dz, uxy);
+      for (int qz = 0; qz < Q; ++qz)
+      {
+         const double wz = B[qz + Q*dz];
+         for (int i = 0; i < Q*Q; ++i) { u[i + Q*Q*qz] += uxy[i] * wz; }
+      }
+   }
+}
+
+// 3D version of PAEvalT2D.
+MFEM_ATTR_HOST_DEVICE inline
+void PAEvalT3D(const int D, const int Q, const double *B,
+               const double *u, double *y)
+{
+   for (int qz = 0; qz < Q; ++qz)
+   {
+      double yxy[MAX_D1D*MAX_D1D];
+      for (int i = 0; i < D*D; ++i) { yxy[i] = 0.0; }
+      PAEvalT2D(D, Q, B, u + Q*Q*qz, yxy);
+      for (int dz = 0; dz < D; ++dz)
+      {
+         const double wz = B[qz + Q*dz];
+         for (int i = 0; i < D*D; ++i) { y[i + D*D*dz] += yxy[i] * wz; }
+      }
+   }
+}
+
+// Inverse and determinant of the Jacobian J(r,c,q,e) = dx_r/dxi_c at the point
+// q of the element e: invJ[k + dim*j] = dxi_k/dx_j.
+MFEM_ATTR_HOST_DEVICE inline
+double PAInvJacobian(const int dim, const DeviceTensor<4> &J,
+                     const int q, const int e, double *invJ)
+{
+   if (dim == 2)
+   {
+      const double J11 = J(0,0,q,e), J12 = J(0,1,q,e);
+      const double J21 = J(1,0,q,e), J22 = J(1,1,q,e);
+      const double detJ = J11*J22 - J12*J21;
+      invJ[0] =  J22/detJ; invJ[2] = -J12/detJ;
+      invJ[1] = -J21/detJ; invJ[3] =  J11/detJ;
+      return detJ;
+   }
+   double A[9];
+   // adj(J)[k + 3*j], using the cyclic structure of the cofactors
+   for (int k = 0; k < 3; ++k)
+   {
+      const int k1 = (k+1)%3, k2 = (k+2)%3;
+      for (int j = 0; j < 3; ++j)
+      {
+         const int j1 = (j+1)%3, j2 = (j+2)%3;
+         A[k + 3*j] = J(j1,k1,q,e)*J(j2,k2,q,e) - J(j1,k2,q,e)*J(j2,k1,q,e);
+      }
+   }
+   const double detJ = J(0,0,q,e)*A[0] + J(0,1,q,e)*A[1] + J(0,2,q,e)*A[2];
+   for (int i = 0; i < 9; ++i) { invJ[i] = A[i]/detJ; }
+   return detJ;
+}
+
+// PA diffusion and mass apply kernels of the Backend::SIMD backend, see
+// bilininteg_simd.cpp.
+void SIMDPADiffusionApply(const int dim, const int D1D, const int Q1D,
+                          const int NE, const double* B, const double* G,
+                          const double* Bt, const double* Gt,
+                          const double* op, const double* x, double* y);
+void SIMDPAMassApply(const int dim, const int D1D, const int Q1D,
+                     const int NE, const double* B, const double* Bt,
+                     const double* op, const double* x, double* y);
+
+} // namespace internal
+
+// The PA diffusion and mass apply kernels. The template parameters T_D1D and
+// T_Q1D, if nonzero, set the number of 1D dofs and quadrature points at
+// compile time; otherwise they are given by the arguments d1d and q1d. The
+// kernels are defined here so that any instance can be compiled at runtime,
+// see PAKernelJIT() in bilininteg_ext.cpp.
+
+// PA Diffusion Apply 2D kernel
+template<int T_D1D = 0, int T_Q1D = 0>
+void PADiffusionApply2D(const int NE,
+                        const double* b,
+                        const double* g,
+                        const double* bt,
+                        const double* gt,
+                        const double* _op,
+                        const double* _x,
+                        double* _y,
+                        const int d1d = 0,
+                        const int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+
+   const DeviceMatrix B(b, Q1D, D1D);
+   const DeviceMatrix G(g, Q1D, D1D);
+   const DeviceMatrix Bt(bt, D1D, Q1D);
+   const DeviceMatrix Gt(gt, D1D, Q1D);
+   const DeviceTensor<3> op(_op, 3, Q1D*Q1D, NE);
+   const DeviceTensor<3> x(_x, D1D, D1D, NE);
+   DeviceTensor<3> y(_y, D1D, D1D, NE);
+
+   MFEM_FORALL(e, NE,
+   {
+      const int D1D = T_D1D ? T_D1D : d1d; // nvcc workaround
+      const int Q1D = T_Q1D ? T_Q1D : q1d;
+
+      double grad[MAX_Q1D][MAX_Q1D][2];
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            grad[qy][qx][0] = 0.0;
+            grad[qy][qx][1] = 0.0;
+         }
+      }
+      for (int dy = 0; dy < D1D; ++dy)
+      {
+         double gradX[MAX_Q1D][2];
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            gradX[qx][0] = 0.0;
+            gradX[qx][1] = 0.0;
+         }
+         for (int dx = 0; dx < D1D; ++dx)
+         {
+            const double s = x(dx,dy,e);
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               gradX[qx][0] += s * B(qx,dx);
+               gradX[qx][1] += s * G(qx,dx);
+            }
+         }
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            const double wy  = B(qy,dy);
+            const double wDy = G(qy,dy);
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               grad[qy][qx][0] += gradX[qx][1] * wy;
+               grad[qy][qx][1] += gradX[qx][0] * wDy;
+            }
+         }
+      }
+      // Calculate Dxy, xDy in plane
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            const int q = qx + Q1D*qy;
+
+            const double O11 = op(0,q,e);
+            const double O12 = op(1,q,e);
+            const double O22 = op(2,q,e);
+
+            const double gradX = grad[qy][qx][0];
+            const double gradY = grad[qy][qx][1];
+
+            grad[qy][qx][0] = (O11 * gradX) + (O12 * gradY);
+            grad[qy][qx][1] = (O12 * gradX) + (O22 * gradY);
+         }
+      }
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         double gradX[MAX_D1D][2];
+         for (int dx = 0; dx < D1D; ++dx)
+         {
+            gradX[dx][0] = 0;
+            gradX[dx][1] = 0;
+         }
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            const double gX = grad[qy][qx][0];
+            const double gY = grad[qy][qx][1];
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               const double wx  = Bt(dx,qx);
+               const double wDx = Gt(dx,qx);
+               gradX[dx][0] += gX * wDx;
+               gradX[dx][1] += gY * wx;
+            }
+         }
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            const double wy  = Bt(dy,qy);
+            const double wDy = Gt(dy,qy);
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               y(dx,dy,e) += ((gradX[dx][0] * wy) + (gradX[dx][1] * wDy));
+            }
+         }
+      }
+   });
+}
+
+// PA Diffusion Apply 3D kernel
+template<int T_D1D = 0, int T_Q1D = 0>
+void PADiffusionApply3D(const int NE,
+                        const double* b,
+                        const double* g,
+                        const double* bt,
+                        const double* gt,
+                        const double* _op,
+                        const double* _x,
+                        double* _y,
+                        int d1d = 0, int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+
+   const DeviceMatrix B(b, Q1D, D1D);
+   const DeviceMatrix G(g, Q1D, D1D);
+   const DeviceMatrix Bt(bt, D1D, Q1D);
+   const DeviceMatrix Gt(gt, D1D, Q1D);
+   const DeviceTensor<3> op(_op, 6, Q1D*Q1D*Q1D, NE);
+   const DeviceTensor<4> x(_x, D1D, D1D, D1D, NE);
+   DeviceTensor<4> y(_y, D1D, D1D, D1D, NE);
+
+   MFEM_FORALL(e, NE,
+   {
+      const int D1D = T_D1D ? T_D1D : d1d; // nvcc workaround
+      const int Q1D = T_Q1D ? T_Q1D : q1d;
+
+      double grad[MAX_Q1D][MAX_Q1D][MAX_Q1D][4];
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               grad[qz][qy][qx][0] = 0.0;
+               grad[qz][qy][qx][1] = 0.0;
+               grad[qz][qy][qx][2] = 0.0;
+            }
+         }
+      }
+      for (int dz = 0; dz < D1D; ++dz)
+      {
+         double gradXY[MAX_Q1D][MAX_Q1D][4];
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               gradXY[qy][qx][0] = 0.0;
+               gradXY[qy][qx][1] = 0.0;
+               gradXY[qy][qx][2] = 0.0;
+            }
+         }
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            double gradX[MAX_Q1D][2];
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               gradX[qx][0] = 0.0;
+               gradX[qx][1] = 0.0;
+            }
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               const double s = x(dx,dy,dz,e);
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  gradX[qx][0] += s * B(qx,dx);
+                  gradX[qx][1] += s * G(qx,dx);
+               }
+            }
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               const double wy  = B(qy,dy);
+               const double wDy = G(qy,dy);
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  const double wx  = gradX[qx][0];
+                  const double wDx = gradX[qx][1];
+                  gradXY[qy][qx][0] += wDx * wy;
+                  gradXY[qy][qx][1] += wx  * wDy;
+                  gradXY[qy][qx][2] += wx  * wy;
+               }
+            }
+         }
+         for (int qz = 0; qz < Q1D; ++qz)
+         {
+            const double wz  = B(qz,dz);
+            const double wDz = G(qz,dz);
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  grad[qz][qy][qx][0] += gradXY[qy][qx][0] * wz;
+                  grad[qz][qy][qx][1] += gradXY[qy][qx][1] * wz;
+                  grad[qz][qy][qx][2] += gradXY[qy][qx][2] * wDz;
+               }
+            }
+         }
+      }
+      // Calculate Dxyz, xDyz, xyDz in plane
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               const int q = qx + Q1D*(qy + Q1D*qz);
+               const double O11 = op(0,q,e);
+               const double O12 = op(1,q,e);
+               const double O13 = op(2,q,e);
+               const double O22 = op(3,q,e);
+               const double O23 = op(4,q,e);
+               const double O33 = op(5,q,e);
+               const double gradX = grad[qz][qy][qx][0];
+               const double gradY = grad[qz][qy][qx][1];
+               const double gradZ = grad[qz][qy][qx][2];
+               grad[qz][qy][qx][0] = (O11*gradX)+(O12*gradY)+(O13*gradZ);
+               grad[qz][qy][qx][1] = (O12*gradX)+(O22*gradY)+(O23*gradZ);
+               grad[qz][qy][qx][2] = (O13*gradX)+(O23*gradY)+(O33*gradZ);
+            }
+         }
+      }
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         double gradXY[MAX_D1D][MAX_D1D][4];
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               gradXY[dy][dx][0] = 0;
+               gradXY[dy][dx][1] = 0;
+               gradXY[dy][dx][2] = 0;
+            }
+         }
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            double gradX[MAX_D1D][4];
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               gradX[dx][0] = 0;
+               gradX[dx][1] = 0;
+               gradX[dx][2] = 0;
+            }
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               const double gX = grad[qz][qy][qx][0];
+               const double gY = grad[qz][qy][qx][1];
+               const double gZ = grad[qz][qy][qx][2];
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  const double wx  = Bt(dx,qx);
+                  const double wDx = Gt(dx,qx);
+                  gradX[dx][0] += gX * wDx;
+                  gradX[dx][1] += gY * wx;
+                  gradX[dx][2] += gZ * wx;
+               }
+            }
+            for (int dy = 0; dy < D1D; ++dy)
+            {
+               const double wy  = Bt(dy,qy);
+               const double wDy = Gt(dy,qy);
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  gradXY[dy][dx][0] += gradX[dx][0] * wy;
+                  gradXY[dy][dx][1] += gradX[dx][1] * wDy;
+                  gradXY[dy][dx][2] += gradX[dx][2] * wy;
+               }
+            }
+         }
+         for (int dz = 0; dz < D1D; ++dz)
+         {
+            const double wz  = Bt(dz,qz);
+            const double wDz = Gt(dz,qz);
+            for (int dy = 0; dy < D1D; ++dy)
+            {
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  y(dx,dy,dz,e) +=
+                     ((gradXY[dy][dx][0] * wz) +
+                      (gradXY[dy][dx][1] * wz) +
+                      (gradXY[dy][dx][2] * wDz));
+               }
+            }
+         }
+      }
+   });
+}
+
+// PA Mass Apply 2D kernel
+template<const int T_D1D = 0, const int T_Q1D = 0>
+void PAMassApply2D(const int NE,
+                   const double* _B,
+                   const double* _Bt,
+                   const double* _op,
+                   const double* _x,
+                   double* _y,
+                   const int d1d = 0,
+                   const int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+
+   const DeviceMatrix B(_B, Q1D, D1D);
+   const DeviceMatrix Bt(_Bt, D1D, Q1D);
+   const DeviceTensor<3> op(_op, Q1D, Q1D, NE);
+   const DeviceTensor<3> x(_x, D1D, D1D, NE);
+   DeviceTensor<3> y(_y, D1D, D1D, NE);
+
+   MFEM_FORALL(e, NE,
+   {
+      const int D1D = T_D1D ? T_D1D : d1d; // nvcc workaround
+      const int Q1D = T_Q1D ? T_Q1D : q1d;
+
+      double sol_xy[MAX_Q1D][MAX_Q1D];
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            sol_xy[qy][qx] = 0.0;
+         }
+      }
+      for (int dy = 0; dy < D1D; ++dy)
+      {
+         double sol_x[MAX_Q1D];
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            sol_x[qy] = 0.0;
+         }
+         for (int dx = 0; dx < D1D; ++dx)
+         {
+            const double s = x(dx,dy,e);
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               sol_x[qx] += B(qx,dx)* s;
+            }
+         }
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            const double d2q = B(qy,dy);
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               sol_xy[qy][qx] += d2q * sol_x[qx];
+            }
+         }
+      }
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            sol_xy[qy][qx] *= op(qx,qy,e);
+         }
+      }
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         double sol_x[MAX_D1D];
+         for (int dx = 0; dx < D1D; ++dx)
+         {
+            sol_x[dx] = 0.0;
+         }
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            const double s = sol_xy[qy][qx];
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               sol_x[dx] += Bt(dx,qx) * s;
+            }
+         }
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            const double q2d = Bt(dy,qy);
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               y(dx,dy,e) += q2d * sol_x[dx];
+            }
+         }
+      }
+   });
+}
+
+template<const int T_D1D = 0, const int T_Q1D = 0>
+void PAMassApply3D(const int NE,
+                   const double* _B,
+                   const double* _Bt,
+                   const double* _op,
+                   const double* _x,
+                   double* _y,
+                   const int d1d = 0,
+                   const int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+
+   const DeviceMatrix B(_B, Q1D, D1D);
+   const DeviceMatrix Bt(_Bt, D1D, Q1D);
+   const DeviceTensor<4> op(_op, Q1D, Q1D, Q1D,NE);
+   const DeviceTensor<4> x(_x, D1D, D1D, D1D, NE);
+   DeviceTensor<4> y(_y, D1D, D1D, D1D, NE);
+
+   MFEM_FORALL(e, NE,
+   {
+      const int D1D = T_D1D ? T_D1D : d1d; // nvcc workaround
+      const int Q1D = T_Q1D ? T_Q1D : q1d;
+
+      double sol_xyz[MAX_Q1D][MAX_Q1D][MAX_Q1D];
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               sol_xyz[qz][qy][qx] = 0.0;
+            }
+         }
+      }
+      for (int dz = 0; dz < D1D; ++dz)
+      {
+         double sol_xy[MAX_Q1D][MAX_Q1D];
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               sol_xy[qy][qx] = 0.0;
+            }
+         }
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            double sol_x[MAX_Q1D];
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               sol_x[qx] = 0;
+            }
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               const double s = x(dx,dy,dz,e);
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  sol_x[qx] += B(qx,dx) * s;
+               }
+            }
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               const double wy = B(qy,dy);
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  sol_xy[qy][qx] += wy * sol_x[qx];
+               }
+            }
+         }
+         for (int qz = 0; qz < Q1D; ++qz)
+         {
+            const double wz = B(qz,dz);
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  sol_xyz[qz][qy][qx] += wz * sol_xy[qy][qx];
+               }
+            }
+         }
+      }
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               sol_xyz[qz][qy][qx] *= op(qx,qy,qz,e);
+            }
+         }
+      }
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         double sol_xy[MAX_D1D][MAX_D1D];
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               sol_xy[dy][dx] = 0;
+            }
+         }
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            double sol_x[MAX_D1D];
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               sol_x[dx] = 0;
+            }
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               const double s = sol_xyz[qz][qy][qx];
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  sol_x[dx] += Bt(dx,qx) * s;
+               }
+            }
+            for (int dy = 0; dy < D1D; ++dy)
+            {
+               const double wy = Bt(dy,qy);
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  sol_xy[dy][dx] += wy * sol_x[dx];
+               }
+            }
+         }
+         for (int dz = 0; dz < D1D; ++dz)
+         {
+            const double wz = Bt(dz,qz);
+            for (int dy = 0; dy < D1D; ++dy)
+            {
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  y(dx,dy,dz,e) += wz * sol_xy[dy][dx];
+               }
+            }
+         }
+      }
+   });
+}
+
+} // namespace mfem
+
+#endif
@@ -0,0 +1,275 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+// Matrix-free kernels: unlike the partial assembly kernels, no data is stored
+// at the quadrature points. The Jacobians of the element transformations are
+// recomputed in the apply kernels from the element nodes of the mesh, using
+// the same sum factorization as for the solution.
+
+#include "../general/forall.hpp"
+#include "bilininteg.hpp"
+#include "gridfunc.hpp"
+#include "bilininteg_kernels.hpp"
+
+namespace mfem
+{
+
+// MF Diffusion Apply 2D kernel: the Jacobians are computed from the element
+// nodes X, with DX nodes in each direction and 1D bases BX and GX.
+template<int T_D1D = 0, int T_DX = 0, int T_Q1D = 0>
+static void MFDiffusionApply2D(const int NE,
+                               const double *b,
+                               const double *g,
+                               const double *bx,
+                               const double *gx,
+                               const double *w,
+                               const double COEFF,
+                               const double *_X,
+                               const double *_x,
+                               double *_y,
+                               const int d1d = 0,
+                               const int dx = 0,
+                               const int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int DX = T_DX ? T_DX : dx;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   MFEM_VERIFY(D1D <= MAX_D1D && DX <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const int NQ = Q1D*Q1D;
+   const DeviceVector B(b, Q1D*D1D);
+   const DeviceVector G(g, Q1D*D1D);
+   const DeviceVector BX(bx, Q1D*DX);
+   const DeviceVector GX(gx, Q1D*DX);
+   const DeviceVector W(w, NQ);
+   const DeviceTensor<3> X(_X, DX*DX, 2, NE);
+   const DeviceMatrix x(_x, D1D*D1D, NE);
+   DeviceMatrix y(_y, D1D*D1D, NE);
+   MFEM_FORALL(e, NE,
+   {
+      constexpr int max_Q1D = T_Q1D ? T_Q1D : MAX_Q1D;
+      double grad[2*max_Q1D*max_Q1D];
+      double jac[4*max_Q1D*max_Q1D];
+      for (int i = 0; i < 2*NQ; ++i) { grad[i] = 0.0; }
+      for (int i = 0; i < 4*NQ; ++i) { jac[i] = 0.0; }
+      internal::PAGrad2D(D1D, Q1D, &B[0], &G[0], &x(0,e), grad, 2);
+      // jac[2*c + k + 4*q] = dX_c/dxi_k
+      internal::PAGrad2D(DX, Q1D, &BX[0], &GX[0], &X(0,0,e), jac, 4);
+      internal::PAGrad2D(DX, Q1D, &BX[0], &GX[0], &X(0,1,e), jac + 2, 4);
+      for (int q = 0; q < NQ; ++q)
+      {
+         const double J11 = jac[4*q], J12 = jac[4*q+1];
+         const double J21 = jac[4*q+2], J22 = jac[4*q+3];
+         const double c_detJ = W(q) * COEFF / ((J11*J22)-(J21*J12));
+         // c/det(J) adj(J) adj(J)^T
+         const double D11 =  c_detJ * (J22*J22 + J12*J12);
+         const double D12 = -c_detJ * (J22*J21 + J12*J11);
+         const double D22 =  c_detJ * (J21*J21 + J11*J11);
+         const double g0 = grad[2*q], g1 = grad[2*q+1];
+         grad[2*q]   = D11*g0 + D12*g1;
+         grad[2*q+1] = D12*g0 + D22*g1;
+      }
+      internal::PAGradT2D(D1D, Q1D, &B[0], &G[0], grad, 2, &y(0,e));
+   });
+}
+
+// MF Diffusion Apply 3D kernel, see MFDiffusionApply2D.
+template<int T_D1D = 0, int T_DX = 0, int T_Q1D = 0>
+static void MFDiffusionApply3D(const int NE,
+                               const double *b,
+                               const double *g,
+                               const double *bx,
+                               const double *gx,
+                               const double *w,
+                               const double COEFF,
+                               const double *_X,
+                               const double *_x,
+                               double *_y,
+                               const int d1d = 0,
+                               const int dx = 0,
+                               const int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int DX = T_DX ? T_DX : dx;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   MFEM_VERIFY(D1D <= MAX_D1D && DX <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const int NQ = Q1D*Q1D*Q1D;
+   const DeviceVector B(b, Q1D*D1D);
+   const DeviceVector G(g, Q1D*D1D);
+   const DeviceVector BX(bx, Q1D*DX);
+   const DeviceVector GX(gx, Q1D*DX);
+   const DeviceVector W(w, NQ);
+   const DeviceTensor<3> X(_X, DX*DX*DX, 3, NE);
+   const DeviceMatrix x(_x, D1D*D1D*D1D, NE);
+   DeviceMatrix y(_y, D1D*D1D*D1D, NE);
+   MFEM_FORALL(e, NE,
+   {
+      constexpr int max_Q1D = T_Q1D ? T_Q1D : MAX_Q1D;
+      double grad[3*max_Q1D*max_Q1D*max_Q1D];
+      double jac[9*max_Q1D*max_Q1D*max_Q1D];
+      for (int i = 0; i < 3*NQ; ++i) { grad[i] = 0.0; }
+      for (int i = 0; i < 9*NQ; ++i) { jac[i] = 0.0; }
+      internal::PAGrad3D(D1D, Q1D, &B[0], &G[0], &x(0,e), grad, 3);
+      // jac[3*c + k + 9*q] = dX_c/dxi_k
+      for (int c = 0; c < 3; ++c)
+      {
+         internal::PAGrad3D(DX, Q1D, &BX[0], &GX[0], &X(0,c,e), jac + 3*c, 9);
+      }
+      for (int q = 0; q < NQ; ++q)
+      {
+         const double *J = jac + 9*q;
+         const double J11 = J[0], J12 = J[1], J13 = J[2];
+         const double J21 = J[3], J22 = J[4], J23 = J[5];
+         const double J31 = J[6], J32 = J[7], J33 = J[8];
+         // adj(J)
+         const double A11 = (J22 * J33) - (J23 * J32);
+         const double A12 = (J13 * J32) - (J12 * J33);
+         const double A13 = (J12 * J23) - (J13 * J22);
+         const double A21 = (J23 * J31) - (J21 * J33);
+         const double A22 = (J11 * J33) - (J13 * J31);
+         const double A23 = (J13 * J21) - (J11 * J23);
+         const double A31 = (J21 * J32) - (J22 * J31);
+         const double A32 = (J12 * J31) - (J11 * J32);
+         const double A33 = (J11 * J22) - (J12 * J21);
+         const double detJ = J11*A11 + J12*A21 + J13*A31;
+         const double c_detJ = W(q) * COEFF / detJ;
+         // c/det(J) adj(J) adj(J)^T
+         const double D11 = c_detJ * (A11*A11 + A12*A12 + A13*A13);
+         const double D12 = c_detJ * (A11*A21 + A12*A22 + A13*A23);
+         const double D13 = c_detJ * (A11*A31 + A12*A32 + A13*A33);
+         const double D22 = c_detJ * (A21*A21 + A22*A22 + A23*A23);
+         const double D23 = c_detJ * (A21*A31 + A22*A32 + A23*A33);
+         const double D33 = c_detJ * (A31*A31 + A32*A32 + A33*A33);
+         const double g0 = grad[3*q], g1 = grad[3*q+1], g2 = grad[3*q+2];
+         grad[3*q]   = D11*g0 + D12*g1 + D13*g2;
+         grad[3*q+1] = D12*g0 + D22*g1 + D23*g2;
+         grad[3*q+2] = D13*g0 + D23*g1 + D33*g2;
+      }
+      internal::PAGradT3D(D1D, Q1D, &B[0], &G[0], grad, 3, &y(0,e));
+   });
+}
+
+void DiffusionIntegrator::AssembleMF(const FiniteElementSpace &fes)
+{
+   MFEM_VERIFY(MQ == NULL && (Q == NULL ||
+                              dynamic_cast<ConstantCoefficient*>(Q)),
+               "MF supports only constant scalar coefficients");
+   Mesh *mesh = fes.GetMesh();
+   const FiniteElement &el = *fes.GetFE(0);
+   const TensorBasisElement *tel = dynamic_cast<const TensorBasisElement*>(&el);
+   MFEM_VERIFY(tel && mesh->Dimension() == mesh->SpaceDimension() &&
+               mesh->Dimension() > 1,
+               "MF requires H1 elements on quads or hexes");
+   // The nodal element of the mesh: the one of the nodes or, for a mesh
+   // without nodes, the order 1 H1 element on the vertices.
+   const GridFunction *nodes = mesh->GetNodes();
+   const FiniteElementSpace *nfes = nodes ? nodes->FESpace() : NULL;
+   H1_FECollection vfec(1, mesh->Dimension());
+   const FiniteElement *nfe =
+      nfes ? nfes->GetFE(0) : vfec.FiniteElementForGeometry(el.GetGeomType());
+   const TensorBasisElement *nel = dynamic_cast<const TensorBasisElement*>(nfe);
+   MFEM_VERIFY(nel, "MF requires tensor product mesh nodes");
+
+   const IntegrationRule *ir = IntRule;
+   if (ir == NULL)
+   {
+      const int order = 2*el.GetOrder() + el.GetDim() - 1;
+      ir = &IntRules.Get(el.GetGeomType(), order);
+   }
+   const IntegrationRule &ir1D = IntRules.Get(Geometry::SEGMENT,
+                                              ir->GetOrder());
+   dim = mesh->Dimension();
+   ne = fes.GetNE();
+   dofs1D = el.GetOrder() + 1;
+   quad1D = ir1D.GetNPoints();
+   nodes1D = nfe->GetOrder() + 1;
+   mf_coeff = Q ? static_cast<ConstantCoefficient*>(Q)->constant : 1.0;
+   PABasis1D(el, ir1D, mf_B, &mf_G);
+   PABasis1D(*nfe, ir1D, mf_BX, &mf_GX);
+
+   const int nq = (dim == 2) ? quad1D*quad1D : quad1D*quad1D*quad1D;
+   mf_W.SetSize(nq);
+   for (int q = 0; q < nq; q++)
+   {
+      const int qx = q % quad1D, qy = (q / quad1D) % quad1D;
+      const int qz = q / (quad1D*quad1D);
+      mf_W(q) = ir1D.IntPoint(qx).weight * ir1D.IntPoint(qy).weight *
+                ((dim == 3) ? ir1D.IntPoint(qz).weight : 1.0);
+   }
+   mf_W.Push();
+
+   // Element nodes in lexicographic order: X(i, c, e)
+   const Array<int> &dof_map = nel->GetDofMap();
+   const int nd = nfe->GetDof();
+   Array<int> vdofs;
+   mf_X.SetSize(nd*dim*ne);
+   for (int e = 0; e < ne; e++)
+   {
+      if (nfes) { nfes->GetElementVDofs(e, vdofs); }
+      else { mesh->GetElementVertices(e, vdofs); }
+      for (int c = 0; c < dim; c++)
+      {
+         for (int i = 0; i < nd; i++)
+         {
+            const int j = (dof_map.Size() == 0) ? i : dof_map[i];
+            mf_X(i + nd*(c + dim*e)) = nodes ? (*nodes)(vdofs[j + nd*c]) :
+                                       mesh->GetVertex(vdofs[j])[c];
+         }
+      }
+   }
+   mf_X.Push();
+}
+
+void DiffusionIntegrator::MultMF(Vector &x, Vector &y)
+{
+   const double *B = mf_B, *G = mf_G, *BX = mf_BX, *GX = mf_GX, *W = mf_W;
+   const double *X = mf_X;
+   const double C = mf_coeff;
+   const int D1D = dofs1D, DX = nodes1D, Q1D = quad1D;
+   if (dim == 2)
+   {
+      switch ((D1D << 8) | (DX << 4) | Q1D)
+      {
+         case 0x222:
+            return MFDiffusionApply2D<2,2,2>(ne, B, G, BX, GX, W, C, X, x, y);
+         case 0x323:
+            return MFDiffusionApply2D<3,2,3>(ne, B, G, BX, GX, W, C, X, x, y);
+         case 0x333:
+            return MFDiffusionApply2D<3,3,3>(ne, B, G, BX, GX, W, C, X, x, y);
+         case 0x424:
+            return MFDiffusionApply2D<4,2,4>(ne, B, G, BX, GX, W, C, X, x, y);
+         case 0x444:
+            return MFDiffusionApply2D<4,4,4>(ne, B, G, BX, GX, W, C, X, x, y);
+         default:
+            return MFDiffusionApply2D(ne, B, G, BX, GX, W, C, X, x, y,
+                                      D1D, DX, Q1D);
+      }
+   }
+   switch ((D1D << 8) | (DX << 4) | Q1D)
+   {
+      case 0x223:
+         return MFDiffusionApply3D<2,2,3>(ne, B, G, BX, GX, W, C, X, x, y);
+      case 0x324:
+         return MFDiffusionApply3D<3,2,4>(ne, B, G, BX, GX, W, C, X, x, y);
+      case 0x334:
+         return MFDiffusionApply3D<3,3,4>(ne, B, G, BX, GX, W, C, X, x, y);
+      case 0x425:
+         return MFDiffusionApply3D<4,2,5>(ne, B, G, BX, GX, W, C, X, x, y);
+      case 0x445:
+         return MFDiffusionApply3D<4,4,5>(ne, B, G, BX, GX, W, C, X, x, y);
+      default:
+         return MFDiffusionApply3D(ne, B, G, BX, GX, W, C, X, x, y,
+                                   D1D, DX, Q1D);
+   }
+}
+
+} // namespace mfem
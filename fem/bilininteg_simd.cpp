@@ -0,0 +1,716 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+// Implementation of the SIMD backend of the PA diffusion and mass kernels
+
+#include "../general/forall.hpp"
+#include "../linalg/simd.hpp"
+#include "bilininteg_kernels.hpp"
+
+namespace mfem
+{
+
+namespace internal
+{
+
+// The kernels below follow the ones in bilininteg_kernels.hpp, with the
+// elements processed in batches of SIMD_SIZE, one element per lane.
+static const int SIMD_SIZE = MFEM_SIMD_BYTES / sizeof(double);
+typedef AutoSIMD<double, SIMD_SIZE> simd_t;
+
+// Set the elements of the lanes of the batch starting at element e0. The
+// lanes beyond the last element repeat e0, and their results are discarded.
+// Return the number of elements in the batch.
+static inline int SIMDLanes(const int e0, const int NE, int el[SIMD_SIZE])
+{
+   const int nl = (NE - e0 < SIMD_SIZE) ? NE - e0 : SIMD_SIZE;
+   for (int l = 0; l < SIMD_SIZE; l++) { el[l] = (l < nl) ? e0 + l : e0; }
+   return nl;
+}
+
+// PA Diffusion Apply 2D kernel, SIMD version
+template<int T_D1D = 0, int T_Q1D = 0>
+static void SIMDPADiffusionApply2D(const int NE,
+                                   const double* b,
+                                   const double* g,
+                                   const double* bt,
+                                   const double* gt,
+                                   const double* _op,
+                                   const double* _x,
+                                   double* _y,
+                                   const int d1d = 0,
+                                   const int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   constexpr int MD1 = T_D1D ? T_D1D : MAX_D1D;
+   constexpr int MQ1 = T_Q1D ? T_Q1D : MAX_Q1D;
+   MFEM_VERIFY(D1D <= MD1, "");
+   MFEM_VERIFY(Q1D <= MQ1, "");
+
+   const DeviceMatrix B(b, Q1D, D1D);
+   const DeviceMatrix G(g, Q1D, D1D);
+   const DeviceMatrix Bt(bt, D1D, Q1D);
+   const DeviceMatrix Gt(gt, D1D, Q1D);
+   const DeviceTensor<3> op(_op, 3, Q1D*Q1D, NE);
+   const DeviceTensor<3> x(_x, D1D, D1D, NE);
+   DeviceTensor<3> y(_y, D1D, D1D, NE);
+
+   for (int e0 = 0; e0 < NE; e0 += SIMD_SIZE)
+   {
+      int el[SIMD_SIZE];
+      const int nl = SIMDLanes(e0, NE, el);
+
+      simd_t grad[MQ1][MQ1][2];
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            grad[qy][qx][0] = 0.0;
+            grad[qy][qx][1] = 0.0;
+         }
+      }
+      for (int dy = 0; dy < D1D; ++dy)
+      {
+         simd_t gradX[MQ1][2];
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            gradX[qx][0] = 0.0;
+            gradX[qx][1] = 0.0;
+         }
+         for (int dx = 0; dx < D1D; ++dx)
+         {
+            simd_t s;
+            for (int l = 0; l < SIMD_SIZE; l++) { s[l] = x(dx,dy,el[l]); }
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               gradX[qx][0].fma(s, B(qx,dx));
+               gradX[qx][1].fma(s, G(qx,dx));
+            }
+         }
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            const double wy  = B(qy,dy);
+            const double wDy = G(qy,dy);
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               grad[qy][qx][0].fma(gradX[qx][1], wy);
+               grad[qy][qx][1].fma(gradX[qx][0], wDy);
+            }
+         }
+      }
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            const int q = qx + Q1D*qy;
+            simd_t O11, O12, O22;
+            for (int l = 0; l < SIMD_SIZE; l++)
+            {
+               O11[l] = op(0,q,el[l]);
+               O12[l] = op(1,q,el[l]);
+               O22[l] = op(2,q,el[l]);
+            }
+            const simd_t gradX = grad[qy][qx][0];
+            const simd_t gradY = grad[qy][qx][1];
+            grad[qy][qx][0] = (O11 * gradX) + (O12 * gradY);
+            grad[qy][qx][1] = (O12 * gradX) + (O22 * gradY);
+         }
+      }
+      simd_t Y[MD1][MD1];
+      for (int dy = 0; dy < D1D; ++dy)
+      {
+         for (int dx = 0; dx < D1D; ++dx) { Y[dy][dx] = 0.0; }
+      }
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         simd_t gradX[MD1][2];
+         for (int dx = 0; dx < D1D; ++dx)
+         {
+            gradX[dx][0] = 0.0;
+            gradX[dx][1] = 0.0;
+         }
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            const simd_t &gX = grad[qy][qx][0];
+            const simd_t &gY = grad[qy][qx][1];
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               gradX[dx][0].fma(gX, Gt(dx,qx));
+               gradX[dx][1].fma(gY, Bt(dx,qx));
+            }
+         }
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            const double wy  = Bt(dy,qy);
+            const double wDy = Gt(dy,qy);
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               Y[dy][dx].fma(gradX[dx][0], wy);
+               Y[dy][dx].fma(gradX[dx][1], wDy);
+            }
+         }
+      }
+      for (int l = 0; l < nl; l++)
+      {
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            for (int dx = 0; dx < D1D; ++dx) { y(dx,dy,e0+l) += Y[dy][dx][l]; }
+         }
+      }
+   }
+}
+
+// PA Diffusion Apply 3D kernel, SIMD version
+template<int T_D1D = 0, int T_Q1D = 0>
+static void SIMDPADiffusionApply3D(const int NE,
+                                   const double* b,
+                                   const double* g,
+                                   const double* bt,
+                                   const double* gt,
+                                   const double* _op,
+                                   const double* _x,
+                                   double* _y,
+                                   const int d1d = 0,
+                                   const int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   constexpr int MD1 = T_D1D ? T_D1D : MAX_D1D;
+   constexpr int MQ1 = T_Q1D ? T_Q1D : MAX_Q1D;
+   MFEM_VERIFY(D1D <= MD1, "");
+   MFEM_VERIFY(Q1D <= MQ1, "");
+
+   const DeviceMatrix B(b, Q1D, D1D);
+   const DeviceMatrix G(g, Q1D, D1D);
+   const DeviceMatrix Bt(bt, D1D, Q1D);
+   const DeviceMatrix Gt(gt, D1D, Q1D);
+   const DeviceTensor<3> op(_op, 6, Q1D*Q1D*Q1D, NE);
+   const DeviceTensor<4> x(_x, D1D, D1D, D1D, NE);
+   DeviceTensor<4> y(_y, D1D, D1D, D1D, NE);
+
+   for (int e0 = 0; e0 < NE; e0 += SIMD_SIZE)
+   {
+      int el[SIMD_SIZE];
+      const int nl = SIMDLanes(e0, NE, el);
+
+      simd_t grad[MQ1][MQ1][MQ1][3];
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               grad[qz][qy][qx][0] = 0.0;
+               grad[qz][qy][qx][1] = 0.0;
+               grad[qz][qy][qx][2] = 0.0;
+            }
+         }
+      }
+      for (int dz = 0; dz < D1D; ++dz)
+      {
+         simd_t gradXY[MQ1][MQ1][3];
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               gradXY[qy][qx][0] = 0.0;
+               gradXY[qy][qx][1] = 0.0;
+               gradXY[qy][qx][2] = 0.0;
+            }
+         }
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            simd_t gradX[MQ1][2];
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               gradX[qx][0] = 0.0;
+               gradX[qx][1] = 0.0;
+            }
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               simd_t s;
+               for (int l = 0; l < SIMD_SIZE; l++) { s[l] = x(dx,dy,dz,el[l]); }
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  gradX[qx][0].fma(s, B(qx,dx));
+                  gradX[qx][1].fma(s, G(qx,dx));
+               }
+            }
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               const double wy  = B(qy,dy);
+               const double wDy = G(qy,dy);
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  gradXY[qy][qx][0].fma(gradX[qx][1], wy);
+                  gradXY[qy][qx][1].fma(gradX[qx][0], wDy);
+                  gradXY[qy][qx][2].fma(gradX[qx][0], wy);
+               }
+            }
+         }
+         for (int qz = 0; qz < Q1D; ++qz)
+         {
+            const double wz  = B(qz,dz);
+            const double wDz = G(qz,dz);
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  grad[qz][qy][qx][0].fma(gradXY[qy][qx][0], wz);
+                  grad[qz][qy][qx][1].fma(gradXY[qy][qx][1], wz);
+                  grad[qz][qy][qx][2].fma(gradXY[qy][qx][2], wDz);
+               }
+            }
+         }
+      }
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               const int q = qx + Q1D*(qy + Q1D*qz);
+               simd_t O[6];
+               for (int l = 0; l < SIMD_SIZE; l++)
+               {
+                  for (int k = 0; k < 6; k++) { O[k][l] = op(k,q,el[l]); }
+               }
+               const simd_t gradX = grad[qz][qy][qx][0];
+               const simd_t gradY = grad[qz][qy][qx][1];
+               const simd_t gradZ = grad[qz][qy][qx][2];
+               grad[qz][qy][qx][0] = (O[0]*gradX)+(O[1]*gradY)+(O[2]*gradZ);
+               grad[qz][qy][qx][1] = (O[1]*gradX)+(O[3]*gradY)+(O[4]*gradZ);
+               grad[qz][qy][qx][2] = (O[2]*gradX)+(O[4]*gradY)+(O[5]*gradZ);
+            }
+         }
+      }
+      simd_t Y[MD1][MD1][MD1];
+      for (int dz = 0; dz < D1D; ++dz)
+      {
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            for (int dx = 0; dx < D1D; ++dx) { Y[dz][dy][dx] = 0.0; }
+         }
+      }
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         simd_t gradXY[MD1][MD1][3];
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               gradXY[dy][dx][0] = 0.0;
+               gradXY[dy][dx][1] = 0.0;
+               gradXY[dy][dx][2] = 0.0;
+            }
+         }
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            simd_t gradX[MD1][3];
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               gradX[dx][0] = 0.0;
+               gradX[dx][1] = 0.0;
+               gradX[dx][2] = 0.0;
+            }
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               const simd_t &gX = grad[qz][qy][qx][0];
+               const simd_t &gY = grad[qz][qy][qx][1];
+               const simd_t &gZ = grad[qz][qy][qx][2];
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  const double wx  = Bt(dx,qx);
+                  const double wDx = Gt(dx,qx);
+                  gradX[dx][0].fma(gX, wDx);
+                  gradX[dx][1].fma(gY, wx);
+                  gradX[dx][2].fma(gZ, wx);
+               }
+            }
+            for (int dy = 0; dy < D1D; ++dy)
+            {
+               const double wy  = Bt(dy,qy);
+               const double wDy = Gt(dy,qy);
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  gradXY[dy][dx][0].fma(gradX[dx][0], wy);
+                  gradXY[dy][dx][1].fma(gradX[dx][1], wDy);
+                  gradXY[dy][dx][2].fma(gradX[dx][2], wy);
+               }
+            }
+         }
+         for (int dz = 0; dz < D1D; ++dz)
+         {
+            const double wz  = Bt(dz,qz);
+            const double wDz = Gt(dz,qz);
+            for (int dy = 0; dy < D1D; ++dy)
+            {
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  Y[dz][dy][dx].fma(gradXY[dy][dx][0], wz);
+                  Y[dz][dy][dx].fma(gradXY[dy][dx][1], wz);
+                  Y[dz][dy][dx].fma(gradXY[dy][dx][2], wDz);
+               }
+            }
+         }
+      }
+      for (int l = 0; l < nl; l++)
+      {
+         for (int dz = 0; dz < D1D; ++dz)
+         {
+            for (int dy = 0; dy < D1D; ++dy)
+            {
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  y(dx,dy,dz,e0+l) += Y[dz][dy][dx][l];
+               }
+            }
+         }
+      }
+   }
+}
+
+// PA Mass Apply 2D kernel, SIMD version
+template<int T_D1D = 0, int T_Q1D = 0>
+static void SIMDPAMassApply2D(const int NE,
+                              const double* _B,
+                              const double* _Bt,
+                              const double* _op,
+                              const double* _x,
+                              double* _y,
+                              const int d1d = 0,
+                              const int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   constexpr int MD1 = T_D1D ? T_D1D : MAX_D1D;
+   constexpr int MQ1 = T_Q1D ? T_Q1D : MAX_Q1D;
+   MFEM_VERIFY(D1D <= MD1, "");
+   MFEM_VERIFY(Q1D <= MQ1, "");
+
+   const DeviceMatrix B(_B, Q1D, D1D);
+   const DeviceMatrix Bt(_Bt, D1D, Q1D);
+   const DeviceTensor<3> op(_op, Q1D, Q1D, NE);
+   const DeviceTensor<3> x(_x, D1D, D1D, NE);
+   DeviceTensor<3> y(_y, D1D, D1D, NE);
+
+   for (int e0 = 0; e0 < NE; e0 += SIMD_SIZE)
+   {
+      int el[SIMD_SIZE];
+      const int nl = SIMDLanes(e0, NE, el);
+
+      simd_t sol_xy[MQ1][MQ1];
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int qx = 0; qx < Q1D; ++qx) { sol_xy[qy][qx] = 0.0; }
+      }
+      for (int dy = 0; dy < D1D; ++dy)
+      {
+         simd_t sol_x[MQ1];
+         for (int qx = 0; qx < Q1D; ++qx) { sol_x[qx] = 0.0; }
+         for (int dx = 0; dx < D1D; ++dx)
+         {
+            simd_t s;
+            for (int l = 0; l < SIMD_SIZE; l++) { s[l] = x(dx,dy,el[l]); }
+            for (int qx = 0; qx < Q1D; ++qx) { sol_x[qx].fma(s, B(qx,dx)); }
+         }
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            const double d2q = B(qy,dy);
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               sol_xy[qy][qx].fma(sol_x[qx], d2q);
+            }
+         }
+      }
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            simd_t O;
+            for (int l = 0; l < SIMD_SIZE; l++) { O[l] = op(qx,qy,el[l]); }
+            sol_xy[qy][qx] *= O;
+         }
+      }
+      simd_t Y[MD1][MD1];
+      for (int dy = 0; dy < D1D; ++dy)
+      {
+         for (int dx = 0; dx < D1D; ++dx) { Y[dy][dx] = 0.0; }
+      }
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         simd_t sol_x[MD1];
+         for (int dx = 0; dx < D1D; ++dx) { sol_x[dx] = 0.0; }
+         for (int qx = 0; qx < Q1D; ++qx)
+         {
+            const simd_t &s = sol_xy[qy][qx];
+            for (int dx = 0; dx < D1D; ++dx) { sol_x[dx].fma(s, Bt(dx,qx)); }
+         }
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            const double q2d = Bt(dy,qy);
+            for (int dx = 0; dx < D1D; ++dx) { Y[dy][dx].fma(sol_x[dx], q2d); }
+         }
+      }
+      for (int l = 0; l < nl; l++)
+      {
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            for (int dx = 0; dx < D1D; ++dx) { y(dx,dy,e0+l) += Y[dy][dx][l]; }
+         }
+      }
+   }
+}
+
+// PA Mass Apply 3D kernel, SIMD version
+template<int T_D1D = 0, int T_Q1D = 0>
+static void SIMDPAMassApply3D(const int NE,
+                              const double* _B,
+                              const double* _Bt,
+                              const double* _op,
+                              const double* _x,
+                              double* _y,
+                              const int d1d = 0,
+                              const int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   constexpr int MD1 = T_D1D ? T_D1D : MAX_D1D;
+   constexpr int MQ1 = T_Q1D ? T_Q1D : MAX_Q1D;
+   MFEM_VERIFY(D1D <= MD1, "");
+   MFEM_VERIFY(Q1D <= MQ1, "");
+
+   const DeviceMatrix B(_B, Q1D, D1D);
+   const DeviceMatrix Bt(_Bt, D1D, Q1D);
+   const DeviceTensor<4> op(_op, Q1D, Q1D, Q1D, NE);
+   const DeviceTensor<4> x(_x, D1D, D1D, D1D, NE);
+   DeviceTensor<4> y(_y, D1D, D1D, D1D, NE);
+
+   for (int e0 = 0; e0 < NE; e0 += SIMD_SIZE)
+   {
+      int el[SIMD_SIZE];
+      const int nl = SIMDLanes(e0, NE, el);
+
+      simd_t sol_xyz[MQ1][MQ1][MQ1];
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx) { sol_xyz[qz][qy][qx] = 0.0; }
+         }
+      }
+      for (int dz = 0; dz < D1D; ++dz)
+      {
+         simd_t sol_xy[MQ1][MQ1];
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx) { sol_xy[qy][qx] = 0.0; }
+         }
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            simd_t sol_x[MQ1];
+            for (int qx = 0; qx < Q1D; ++qx) { sol_x[qx] = 0.0; }
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               simd_t s;
+               for (int l = 0; l < SIMD_SIZE; l++) { s[l] = x(dx,dy,dz,el[l]); }
+               for (int qx = 0; qx < Q1D; ++qx) { sol_x[qx].fma(s, B(qx,dx)); }
+            }
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               const double wy = B(qy,dy);
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  sol_xy[qy][qx].fma(sol_x[qx], wy);
+               }
+            }
+         }
+         for (int qz = 0; qz < Q1D; ++qz)
+         {
+            const double wz = B(qz,dz);
+            for (int qy = 0; qy < Q1D; ++qy)
+            {
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  sol_xyz[qz][qy][qx].fma(sol_xy[qy][qx], wz);
+               }
+            }
+         }
+      }
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               simd_t O;
+               for (int l = 0; l < SIMD_SIZE; l++)
+               {
+                  O[l] = op(qx,qy,qz,el[l]);
+               }
+               sol_xyz[qz][qy][qx] *= O;
+            }
+         }
+      }
+      simd_t Y[MD1][MD1][MD1];
+      for (int dz = 0; dz < D1D; ++dz)
+      {
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            for (int dx = 0; dx < D1D; ++dx) { Y[dz][dy][dx] = 0.0; }
+         }
+      }
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         simd_t sol_xy[MD1][MD1];
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            for (int dx = 0; dx < D1D; ++dx) { sol_xy[dy][dx] = 0.0; }
+         }
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            simd_t sol_x[MD1];
+            for (int dx = 0; dx < D1D; ++dx) { sol_x[dx] = 0.0; }
+            for (int qx = 0; qx < Q1D; ++qx)
+            {
+               const simd_t &s = sol_xyz[qz][qy][qx];
+               for (int dx = 0; dx < D1D; ++dx) { sol_x[dx].fma(s, Bt(dx,qx)); }
+            }
+            for (int dy = 0; dy < D1D; ++dy)
+            {
+               const double wy = Bt(dy,qy);
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  sol_xy[dy][dx].fma(sol_x[dx], wy);
+               }
+            }
+         }
+         for (int dz = 0; dz < D1D; ++dz)
+         {
+            const double wz = Bt(dz,qz);
+            for (int dy = 0; dy < D1D; ++dy)
+            {
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  Y[dz][dy][dx].fma(sol_xy[dy][dx], wz);
+               }
+            }
+         }
+      }
+      for (int l = 0; l < nl; l++)
+      {
+         for (int dz = 0; dz < D1D; ++dz)
+         {
+            for (int dy = 0; dy < D1D; ++dy)
+            {
+               for (int dx = 0; dx < D1D; ++dx)
+               {
+                  y(dx,dy,dz,e0+l) += Y[dz][dy][dx][l];
+               }
+            }
+         }
+      }
+   }
+}
+
+void SIMDPADiffusionApply(const int dim,
+                          const int D1D,
+                          const int Q1D,
+                          const int NE,
+                          const double* B,
+                          const double* G,
+                          const double* Bt,
+                          const double* Gt,
+                          const double* op,
+                          const double* x,
+                          double* y)
+{
+   if (dim == 2)
+   {
+      switch ((D1D << 4) | Q1D)
+      {
+         case 0x22: SIMDPADiffusionApply2D<2,2>(NE, B, G, Bt, Gt, op, x, y);
+            break;
+         case 0x33: SIMDPADiffusionApply2D<3,3>(NE, B, G, Bt, Gt, op, x, y);
+            break;
+         case 0x44: SIMDPADiffusionApply2D<4,4>(NE, B, G, Bt, Gt, op, x, y);
+            break;
+         case 0x55: SIMDPADiffusionApply2D<5,5>(NE, B, G, Bt, Gt, op, x, y);
+            break;
+         default:
+            SIMDPADiffusionApply2D(NE, B, G, Bt, Gt, op, x, y, D1D, Q1D);
+      }
+      return;
+   }
+   if (dim == 3)
+   {
+      switch ((D1D << 4) | Q1D)
+      {
+         case 0x23: SIMDPADiffusionApply3D<2,3>(NE, B, G, Bt, Gt, op, x, y);
+            break;
+         case 0x34: SIMDPADiffusionApply3D<3,4>(NE, B, G, Bt, Gt, op, x, y);
+            break;
+         case 0x45: SIMDPADiffusionApply3D<4,5>(NE, B, G, Bt, Gt, op, x, y);
+            break;
+         case 0x56: SIMDPADiffusionApply3D<5,6>(NE, B, G, Bt, Gt, op, x, y);
+            break;
+         default:
+            SIMDPADiffusionApply3D(NE, B, G, Bt, Gt, op, x, y, D1D, Q1D);
+      }
+      return;
+   }
+   MFEM_ABORT("Unknown kernel.");
+}
+
+void SIMDPAMassApply(const int dim,
+                     const int D1D,
+                     const int Q1D,
+                     const int NE,
+                     const double* B,
+                     const double* Bt,
+                     const double* op,
+                     const double* x,
+                     double* y)
+{
+   if (dim == 2)
+   {
+      switch ((D1D << 4) | Q1D)
+      {
+         case 0x23: SIMDPAMassApply2D<2,3>(NE, B, Bt, op, x, y); break;
+         case 0x33: SIMDPAMassApply2D<3,3>(NE, B, Bt, op, x, y); break;
+         case 0x34: SIMDPAMassApply2D<3,4>(NE, B, Bt, op, x, y); break;
+         case 0x44: SIMDPAMassApply2D<4,4>(NE, B, Bt, op, x, y); break;
+         case 0x45: SIMDPAMassApply2D<4,5>(NE, B, Bt, op, x, y); break;
+         case 0x55: SIMDPAMassApply2D<5,5>(NE, B, Bt, op, x, y); break;
+         case 0x56: SIMDPAMassApply2D<5,6>(NE, B, Bt, op, x, y); break;
+         default: SIMDPAMassApply2D(NE, B, Bt, op, x, y, D1D, Q1D);
+      }
+      return;
+   }
+   if (dim == 3)
+   {
+      switch ((D1D << 4) | Q1D)
+      {
+         case 0x23: SIMDPAMassApply3D<2,3>(NE, B, Bt, op, x, y); break;
+         case 0x34: SIMDPAMassApply3D<3,4>(NE, B, Bt, op, x, y); break;
+         case 0x45: SIMDPAMassApply3D<4,5>(NE, B, Bt, op, x, y); break;
+         case 0x56: SIMDPAMassApply3D<5,6>(NE, B, Bt, op, x, y); break;
+         default: SIMDPAMassApply3D(NE, B, Bt, op, x, y, D1D, Q1D);
+      }
+      return;
+   }
+   MFEM_ABORT("Unknown kernel.");
+}
+
+} // namespace internal
+
+} // namespace mfem
@@ -0,0 +1,336 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+// PA kernels for the advection integrators: ConvectionIntegrator on the
+// elements and DGTraceIntegrator on the faces. The face kernels act on the face
+// vectors of the FaceRestriction: the values of the element dofs on the faces,
+// in the lexicographic order of the face reference coordinates.
+
+#include "../general/forall.hpp"
+#include "bilininteg.hpp"
+#include "bilininteg_kernels.hpp"
+
+#include <cmath>
+
+namespace mfem
+{
+
+// Return the 1D rule of the tensor product rule ir of dimension dim.
+static const IntegrationRule &PAGetRule1D(const int dim,
+                                          const IntegrationRule &ir)
+{
+   // The order of the segment rules created along with the tensor rules is not
+   // set, so 1D rules are returned as is.
+   if (dim == 1) { return ir; }
+   const IntegrationRule &ir1D = IntRules.Get(Geometry::SEGMENT, ir.GetOrder());
+   int nq = 1;
+   for (int d = 0; d < dim; d++) { nq *= ir1D.GetNPoints(); }
+   MFEM_VERIFY(nq == ir.GetNPoints(), "tensor product rule required for PA");
+   MFEM_VERIFY(ir1D.GetNPoints() <= MAX_Q1D, "order too high for PA");
+   return ir1D;
+}
+
+// PA Convection Assemble kernel: D(k,q,e) = (adj(J) Q)_k, where the velocity
+// Q(c,q,e) is already scaled by alpha and the quadrature weight.
+static void PAConvectionSetup(const int dim,
+                              const int NQ,
+                              const int NE,
+                              const double *j,
+                              const double *q,
+                              double *op)
+{
+   const DeviceTensor<4> J(j, dim, dim, NQ, NE);
+   const DeviceTensor<3> Q(q, dim, NQ, NE);
+   DeviceTensor<3> D(op, dim, NQ, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int p = 0; p < NQ; ++p)
+      {
+         double invJ[9];
+         const double detJ = internal::PAInvJacobian(dim, J, p, e, invJ);
+         for (int k = 0; k < dim; ++k)
+         {
+            double d = 0.0;
+            for (int c = 0; c < dim; ++c) { d += invJ[k + dim*c] * Q(c,p,e); }
+            D(k,p,e) = detJ * d;
+         }
+      }
+   });
+}
+
+// PA Convection Apply kernel: y += A x, or y += A^T x if transpose is true.
+static void PAConvectionApply(const int dim,
+                              const int NE,
+                              const int D1D,
+                              const int Q1D,
+                              const bool transpose,
+                              const double *b,
+                              const double *g,
+                              const double *op,
+                              const double *_x,
+                              double *_y)
+{
+   MFEM_VERIFY(D1D <= MAX_D1D && Q1D <= MAX_Q1D, "");
+   const int ND = (dim == 2) ? D1D*D1D : D1D*D1D*D1D;
+   const int NQ = (dim == 2) ? Q1D*Q1D : Q1D*Q1D*Q1D;
+   const DeviceVector B(b, Q1D*D1D);
+   const DeviceVector G(g, Q1D*D1D);
+   const DeviceTensor<3> D(op, dim, NQ, NE);
+   const DeviceMatrix x(_x, ND, NE);
+   DeviceMatrix y(_y, ND, NE);
+   MFEM_FORALL(e, NE,
+   {
+      const int MQ = MAX_Q1D*MAX_Q1D*MAX_Q1D;
+      double grad[3*MQ], val[MQ];
+      for (int i = 0; i < dim*NQ; ++i) { grad[i] = 0.0; }
+      for (int i = 0; i < NQ; ++i) { val[i] = 0.0; }
+      if (!transpose)
+      {
+         // (D . grad(u)) at the quadrature points, tested with the values
+         if (dim == 2)
+         {
+            internal::PAGrad2D(D1D, Q1D, &B[0], &G[0], &x(0,e), grad, 2);
+         }
+         else
+         {
+            internal::PAGrad3D(D1D, Q1D, &B[0], &G[0], &x(0,e), grad, 3);
+         }
+         for (int q = 0; q < NQ; ++q)
+         {
+            double s = 0.0;
+            for (int k = 0; k < dim; ++k) { s += D(k,q,e) * grad[k + dim*q]; }
+            val[q] = s;
+         }
+         if (dim == 2) { internal::PAEvalT2D(D1D, Q1D, &B[0], val, &y(0,e)); }
+         else { internal::PAEvalT3D(D1D, Q1D, &B[0], val, &y(0,e)); }
+      }
+      else
+      {
+         // (D u) at the quadrature points, tested with the gradients
+         if (dim == 2) { internal::PAEval2D(D1D, Q1D, &B[0], &x(0,e), val); }
+         else { internal::PAEval3D(D1D, Q1D, &B[0], &x(0,e), val); }
+         for (int q = 0; q < NQ; ++q)
+         {
+            for (int k = 0; k < dim; ++k) { grad[k + dim*q] = D(k,q,e) * val[q]; }
+         }
+         if (dim == 2)
+         {
+            internal::PAGradT2D(D1D, Q1D, &B[0], &G[0], grad, 2, &y(0,e));
+         }
+         else
+         {
+            internal::PAGradT3D(D1D, Q1D, &B[0], &G[0], grad, 3, &y(0,e));
+         }
+      }
+   });
+}
+
+void ConvectionIntegrator::Assemble(const FiniteElementSpace &fes)
+{
+   Mesh *mesh = fes.GetMesh();
+   const FiniteElement &el = *fes.GetFE(0);
+   MFEM_VERIFY(dynamic_cast<const TensorBasisElement*>(&el) &&
+               el.GetDim() > 1 && fes.GetVDim() == 1 &&
+               mesh->SpaceDimension() == el.GetDim(),
+               "PA requires scalar tensor product elements on quads or hexes");
+   const IntegrationRule *ir = IntRule;
+   if (ir == NULL)
+   {
+      ElementTransformation &T = *mesh->GetElementTransformation(0);
+      const int order = T.OrderGrad(&el) + T.Order() + el.GetOrder();
+      ir = &IntRules.Get(el.GetGeomType(), order);
+   }
+   dim = el.GetDim();
+   ne = fes.GetNE();
+   dofs1D = el.GetOrder() + 1;
+   const IntegrationRule &ir1D = PAGetRule1D(dim, *ir);
+   quad1D = ir1D.GetNPoints();
+   PABasis1D(el, ir1D, pa_B, &pa_G);
+
+   const int nq = ir->GetNPoints();
+   Vector vel;
+   EvalPAVectorCoefficient(Q, fes, *ir, vel);
+   for (int e = 0; e < ne; ++e)
+   {
+      for (int q = 0; q < nq; ++q)
+      {
+         const double w = alpha * ir->IntPoint(q).weight;
+         for (int c = 0; c < dim; ++c) { vel(c + dim*(q + nq*e)) *= w; }
+      }
+   }
+   vel.Push();
+   const GeometricFactors *geom =
+      fes.GetMesh()->GetGeometricFactors(*ir, GeometricFactors::JACOBIANS);
+   pa_data.SetSize(dim*nq*ne);
+   PAConvectionSetup(dim, nq, ne, geom->J, vel, pa_data);
+}
+
+void ConvectionIntegrator::MultAssembled(Vector &x, Vector &y)
+{
+   PAConvectionApply(dim, ne, dofs1D, quad1D, false, pa_B, pa_G, pa_data,
+                     x, y);
+}
+
+void ConvectionIntegrator::MultAssembledTranspose(Vector &x, Vector &y)
+{
+   PAConvectionApply(dim, ne, dofs1D, quad1D, true, pa_B, pa_G, pa_data,
+                     x, y);
+}
+
+void DGTraceIntegrator::AssembleFaces(const FiniteElementSpace &fes,
+                                      const bool interior)
+{
+   Mesh *mesh = fes.GetMesh();
+   const FiniteElement &el = *fes.GetFE(0);
+   MFEM_VERIFY(dynamic_cast<const TensorBasisElement*>(&el) &&
+               el.GetDim() > 1 && fes.GetVDim() == 1 &&
+               mesh->SpaceDimension() == el.GetDim(),
+               "PA requires scalar tensor product elements on quads or hexes");
+   Array<int> faces;
+   GetPAFaces(*mesh, interior, faces);
+   dim = el.GetDim();
+   nf = faces.Size();
+   nsides = interior ? 2 : 1;
+   dofs1D = el.GetOrder() + 1;
+   quad1D = 0;
+   pa_data.SetSize(0);
+   if (nf == 0) { return; }
+
+   const IntegrationRule *ir = IntRule;
+   if (ir == NULL)
+   {
+      // Same rule as AssembleFaceMatrix, assuming all the faces are alike.
+      FaceElementTransformations &T =
+         *mesh->GetFaceElementTransformations(faces[0]);
+      int order = interior ?
+                  std::min(T.Elem1->OrderW(), T.Elem2->OrderW()) :
+                  T.Elem1->OrderW();
+      order += 2*el.GetOrder();
+      ir = &IntRules.Get(T.FaceGeom, order);
+   }
+   const IntegrationRule &ir1D = PAGetRule1D(dim-1, *ir);
+   quad1D = ir1D.GetNPoints();
+   PABasis1D(el, ir1D, pa_B, NULL);
+
+   // The coefficients are evaluated on the host, face by face. At each point
+   // the data (w1, w2) defines the contributions
+   //    y1 = w1 u1 - w2 u2,   y2 = -(w1 u1 - w2 u2)
+   // from the traces u1, u2 of the two neighboring elements.
+   const int nq = ir->GetNPoints();
+   pa_data.SetSize(2*nq*nf);
+   Vector vu(dim), nor(dim);
+   for (int f = 0; f < nf; ++f)
+   {
+      FaceElementTransformations &T =
+         *mesh->GetFaceElementTransformations(faces[f]);
+      for (int q = 0; q < nq; ++q)
+      {
+         const IntegrationPoint &ip = ir->IntPoint(q);
+         IntegrationPoint eip1, eip2;
+         T.Loc1.Transform(ip, eip1);
+         if (interior) { T.Loc2.Transform(ip, eip2); }
+         T.Face->SetIntPoint(&ip);
+         T.Elem1->SetIntPoint(&eip1);
+         u->Eval(vu, *T.Elem1, eip1);
+         CalcOrtho(T.Face->Jacobian(), nor);
+         const double un = vu * nor;
+         double a = 0.5 * alpha * un;
+         double b = beta * std::fabs(un);
+         if (rho)
+         {
+            double rho_p;
+            if (un >= 0.0 && interior)
+            {
+               T.Elem2->SetIntPoint(&eip2);
+               rho_p = rho->Eval(*T.Elem2, eip2);
+            }
+            else
+            {
+               rho_p = rho->Eval(*T.Elem1, eip1);
+            }
+            a *= rho_p;
+            b *= rho_p;
+         }
+         pa_data(2*(q + nq*f))   = ip.weight * (a+b);
+         pa_data(2*(q + nq*f)+1) = ip.weight * (b-a);
+      }
+   }
+   pa_data.Push();
+}
+
+// PA DGTrace Apply kernel: y += A x, or y += A^T x if transpose is true, on
+// the face vectors x(i,s,f) of the FaceRestriction with NS sides per face.
+static void PADGTraceApply(const int dim,
+                           const int NF,
+                           const int NS,
+                           const int D1D,
+                           const int Q1D,
+                           const bool transpose,
+                           const double *b,
+                           const double *op,
+                           const double *_x,
+                           double *_y)
+{
+   MFEM_VERIFY(D1D <= MAX_D1D && Q1D <= MAX_Q1D, "");
+   const int FD = (dim == 2) ? D1D : D1D*D1D;
+   const int FQ = (dim == 2) ? Q1D : Q1D*Q1D;
+   const DeviceVector B(b, Q1D*D1D);
+   const DeviceTensor<3> W(op, 2, FQ, NF);
+   const DeviceTensor<3> x(_x, FD, NS, NF);
+   DeviceTensor<3> y(_y, FD, NS, NF);
+   MFEM_FORALL(f, NF,
+   {
+      double u[2][MAX_Q1D*MAX_Q1D];
+      for (int s = 0; s < NS; ++s)
+      {
+         for (int q = 0; q < FQ; ++q) { u[s][q] = 0.0; }
+         if (dim == 2) { internal::PAEval1D(D1D, Q1D, &B[0], &x(0,s,f), u[s]); }
+         else { internal::PAEval2D(D1D, Q1D, &B[0], &x(0,s,f), u[s]); }
+      }
+      for (int q = 0; q < FQ; ++q)
+      {
+         const double w1 = W(0,q,f), w2 = W(1,q,f);
+         const double u1 = u[0][q], u2 = (NS == 2) ? u[1][q] : 0.0;
+         if (!transpose || NS == 1)
+         {
+            const double t = w1*u1 - w2*u2;
+            u[0][q] = t;
+            if (NS == 2) { u[1][q] = -t; }
+         }
+         else
+         {
+            u[0][q] = w1*(u1 - u2);
+            u[1][q] = w2*(u2 - u1);
+         }
+      }
+      for (int s = 0; s < NS; ++s)
+      {
+         if (dim == 2) { internal::PAEvalT1D(D1D, Q1D, &B[0], u[s], &y(0,s,f)); }
+         else { internal::PAEvalT2D(D1D, Q1D, &B[0], u[s], &y(0,s,f)); }
+      }
+   });
+}
+
+void DGTraceIntegrator::MultAssembled(Vector &x, Vector &y)
+{
+   if (nf == 0) { return; }
+   PADGTraceApply(dim, nf, nsides, dofs1D, quad1D, false, pa_B, pa_data,
+                  x, y);
+}
+
+void DGTraceIntegrator::MultAssembledTranspose(Vector &x, Vector &y)
+{
+   if (nf == 0) { return; }
+   PADGTraceApply(dim, nf, nsides, dofs1D, quad1D, true, pa_B, pa_data,
+                  x, y);
+}
+
+} // namespace mfem
@@ -0,0 +1,865 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+// Partial assembly kernels for the integrators of vector finite elements on
+// quads and hexes, where each component of the basis is a tensor product of
+// the 1D closed and open bases, see VectorTensorFiniteElement.
+
+#include "../general/forall.hpp"
+#include "bilininteg.hpp"
+
+namespace mfem
+{
+
+// Return the 1D rule of the tensor product rule ir.
+static const IntegrationRule &GetRule1D(const FiniteElement &el,
+                                        const IntegrationRule &ir)
+{
+   const IntegrationRule &ir1D = IntRules.Get(Geometry::SEGMENT, ir.GetOrder());
+   int nq = ir1D.GetNPoints();
+   for (int d = 1; d < el.GetDim(); d++) { nq *= ir1D.GetNPoints(); }
+   MFEM_VERIFY(nq == ir.GetNPoints(), "tensor product rule required for PA");
+   return ir1D;
+}
+
+// Evaluate the 1D open and closed bases of el, and optionally the derivatives
+// of the closed basis, at the points of ir1D. The layout is B[q + Q1D*d].
+static void PAVectorBasis1D(const VectorTensorFiniteElement &el,
+                            const IntegrationRule &ir1D,
+                            Array<double> &Bo, Array<double> &Bc,
+                            Array<double> *Gc)
+{
+   const int Q1D = ir1D.GetNPoints();
+   const int DC = el.GetOrder() + 1;
+   const int DO = el.GetOrder();
+   Vector uo(DO), uc(DC), dc(DC);
+   Bo.SetSize(Q1D*DO);
+   Bc.SetSize(Q1D*DC);
+   if (Gc) { Gc->SetSize(Q1D*DC); }
+   for (int q = 0; q < Q1D; ++q)
+   {
+      const double x = ir1D.IntPoint(q).x;
+      el.GetOpenBasis().Eval(x, uo);
+      el.GetClosedBasis().Eval(x, uc, dc);
+      for (int d = 0; d < DO; ++d) { Bo[q + Q1D*d] = uo(d); }
+      for (int d = 0; d < DC; ++d) { Bc[q + Q1D*d] = uc(d); }
+      if (Gc) { for (int d = 0; d < DC; ++d) { (*Gc)[q + Q1D*d] = dc(d); } }
+   }
+   mfem::Push(Bo.GetData(), Bo.Size()*sizeof(double));
+   mfem::Push(Bc.GetData(), Bc.Size()*sizeof(double));
+   if (Gc) { mfem::Push(Gc->GetData(), Gc->Size()*sizeof(double)); }
+}
+
+// Quadrature weights of the rule ir.
+static void PAWeights(const IntegrationRule &ir, Vector &W)
+{
+   W.SetSize(ir.GetNPoints());
+   for (int q = 0; q < ir.GetNPoints(); ++q) { W(q) = ir.IntPoint(q).weight; }
+   W.Push();
+}
+
+// Add s times the interpolation of the DX x DY tensor x to the Q1D x Q1D
+// points, with the 1D bases Bx and By, to qv.
+MFEM_ATTR_HOST_DEVICE static inline
+void PAInterp2D(const int DX, const int DY, const int Q1D,
+                const double *Bx, const double *By,
+                const double *x, const double s, double *qv)
+{
+   for (int dy = 0; dy < DY; ++dy)
+   {
+      double xq[MAX_Q1D];
+      for (int qx = 0; qx < Q1D; ++qx) { xq[qx] = 0.0; }
+      for (int dx = 0; dx < DX; ++dx)
+      {
+         const double t = x[dx + DX*dy];
+         for (int qx = 0; qx < Q1D; ++qx) { xq[qx] += t * Bx[qx + Q1D*dx]; }
+      }
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         const double w = s * By[qy + Q1D*dy];
+         for (int qx = 0; qx < Q1D; ++qx) { qv[qx + Q1D*qy] += w * xq[qx]; }
+      }
+   }
+}
+
+// Transpose of PAInterp2D: add s times the projection of the Q1D x Q1D values
+// qv to the DX x DY tensor y.
+MFEM_ATTR_HOST_DEVICE static inline
+void PAInterpT2D(const int DX, const int DY, const int Q1D,
+                 const double *Bx, const double *By,
+                 const double *qv, const double s, double *y)
+{
+   for (int qy = 0; qy < Q1D; ++qy)
+   {
+      double yd[MAX_D1D];
+      for (int dx = 0; dx < DX; ++dx) { yd[dx] = 0.0; }
+      for (int qx = 0; qx < Q1D; ++qx)
+      {
+         const double t = qv[qx + Q1D*qy];
+         for (int dx = 0; dx < DX; ++dx) { yd[dx] += t * Bx[qx + Q1D*dx]; }
+      }
+      for (int dy = 0; dy < DY; ++dy)
+      {
+         const double w = s * By[qy + Q1D*dy];
+         for (int dx = 0; dx < DX; ++dx) { y[dx + DX*dy] += w * yd[dx]; }
+      }
+   }
+}
+
+// 3D version of PAInterp2D.
+MFEM_ATTR_HOST_DEVICE static inline
+void PAInterp3D(const int DX, const int DY, const int DZ, const int Q1D,
+                const double *Bx, const double *By, const double *Bz,
+                const double *x, const double s, double *qv)
+{
+   const int QQ = Q1D*Q1D;
+   for (int dz = 0; dz < DZ; ++dz)
+   {
+      double xy[MAX_Q1D*MAX_Q1D];
+      for (int q = 0; q < QQ; ++q) { xy[q] = 0.0; }
+      PAInterp2D(DX, DY, Q1D, Bx, By, x + DX*DY*dz, 1.0, xy);
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         const double w = s * Bz[qz + Q1D*dz];
+         for (int q = 0; q < QQ; ++q) { qv[q + QQ*qz] += w * xy[q]; }
+      }
+   }
+}
+
+// 3D version of PAInterpT2D.
+MFEM_ATTR_HOST_DEVICE static inline
+void PAInterpT3D(const int DX, const int DY, const int DZ, const int Q1D,
+                 const double *Bx, const double *By, const double *Bz,
+                 const double *qv, const double s, double *y)
+{
+   const int QQ = Q1D*Q1D;
+   const int DD = DX*DY;
+   for (int qz = 0; qz < Q1D; ++qz)
+   {
+      double yd[MAX_D1D*MAX_D1D];
+      for (int d = 0; d < DD; ++d) { yd[d] = 0.0; }
+      PAInterpT2D(DX, DY, Q1D, Bx, By, qv + QQ*qz, 1.0, yd);
+      for (int dz = 0; dz < DZ; ++dz)
+      {
+         const double w = s * Bz[qz + Q1D*dz];
+         for (int d = 0; d < DD; ++d) { y[d + DD*dz] += w * yd[d]; }
+      }
+   }
+}
+
+// PA H(curl) Mass Assemble 2D kernel: W*COEFF/det(J) adj(J) adj(J)^T
+static void PAHcurlMassSetup2D(const int NQ,
+                               const int NE,
+                               const double *w,
+                               const double *j,
+                               const double *c,
+                               double *op)
+{
+   const DeviceVector W(w, NQ);
+   const DeviceTensor<4> J(j, 2, 2, NQ, NE);
+   const DeviceMatrix C(c, NQ, NE);
+   DeviceTensor<3> y(op, 3, NQ, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         const double J11 = J(0,0,q,e);
+         const double J21 = J(1,0,q,e);
+         const double J12 = J(0,1,q,e);
+         const double J22 = J(1,1,q,e);
+         const double c_detJ = W(q) * C(q,e) / ((J11*J22)-(J21*J12));
+         y(0,q,e) =  c_detJ * (J22*J22 + J12*J12);
+         y(1,q,e) = -c_detJ * (J22*J21 + J12*J11);
+         y(2,q,e) =  c_detJ * (J21*J21 + J11*J11);
+      }
+   });
+}
+
+// PA H(curl) Mass Assemble 3D kernel: W*COEFF/det(J) adj(J) adj(J)^T
+static void PAHcurlMassSetup3D(const int NQ,
+                               const int NE,
+                               const double *w,
+                               const double *j,
+                               const double *c,
+                               double *op)
+{
+   const DeviceVector W(w, NQ);
+   const DeviceTensor<4> J(j, 3, 3, NQ, NE);
+   const DeviceMatrix C(c, NQ, NE);
+   DeviceTensor<3> y(op, 6, NQ, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         const double J11 = J(0,0,q,e);
+         const double J21 = J(1,0,q,e);
+         const double J31 = J(2,0,q,e);
+         const double J12 = J(0,1,q,e);
+         const double J22 = J(1,1,q,e);
+         const double J32 = J(2,1,q,e);
+         const double J13 = J(0,2,q,e);
+         const double J23 = J(1,2,q,e);
+         const double J33 = J(2,2,q,e);
+         // adj(J)
+         const double A11 = (J22 * J33) - (J23 * J32);
+         const double A12 = (J13 * J32) - (J12 * J33);
+         const double A13 = (J12 * J23) - (J13 * J22);
+         const double A21 = (J23 * J31) - (J21 * J33);
+         const double A22 = (J11 * J33) - (J13 * J31);
+         const double A23 = (J13 * J21) - (J11 * J23);
+         const double A31 = (J21 * J32) - (J22 * J31);
+         const double A32 = (J12 * J31) - (J11 * J32);
+         const double A33 = (J11 * J22) - (J12 * J21);
+         const double detJ = J11*A11 + J12*A21 + J13*A31;
+         const double c_detJ = W(q) * C(q,e) / detJ;
+         // adj(J) adj(J)^T
+         y(0,q,e) = c_detJ * (A11*A11 + A12*A12 + A13*A13);
+         y(1,q,e) = c_detJ * (A11*A21 + A12*A22 + A13*A23);
+         y(2,q,e) = c_detJ * (A11*A31 + A12*A32 + A13*A33);
+         y(3,q,e) = c_detJ * (A21*A21 + A22*A22 + A23*A23);
+         y(4,q,e) = c_detJ * (A21*A31 + A22*A32 + A23*A33);
+         y(5,q,e) = c_detJ * (A31*A31 + A32*A32 + A33*A33);
+      }
+   });
+}
+
+// PA J^T J Assemble 2D kernel: W*COEFF/det(J) J^T J, used by the H(div) mass
+static void PAJtJSetup2D(const int NQ,
+                         const int NE,
+                         const double *w,
+                         const double *j,
+                         const double *c,
+                         double *op)
+{
+   const DeviceVector W(w, NQ);
+   const DeviceTensor<4> J(j, 2, 2, NQ, NE);
+   const DeviceMatrix C(c, NQ, NE);
+   DeviceTensor<3> y(op, 3, NQ, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         const double J11 = J(0,0,q,e);
+         const double J21 = J(1,0,q,e);
+         const double J12 = J(0,1,q,e);
+         const double J22 = J(1,1,q,e);
+         const double c_detJ = W(q) * C(q,e) / ((J11*J22)-(J21*J12));
+         y(0,q,e) = c_detJ * (J11*J11 + J21*J21);
+         y(1,q,e) = c_detJ * (J11*J12 + J21*J22);
+         y(2,q,e) = c_detJ * (J12*J12 + J22*J22);
+      }
+   });
+}
+
+// PA J^T J Assemble 3D kernel: W*COEFF/det(J) J^T J, used by the H(div) mass
+// and the 3D curl-curl
+static void PAJtJSetup3D(const int NQ,
+                         const int NE,
+                         const double *w,
+                         const double *j,
+                         const double *c,
+                         double *op)
+{
+   const DeviceVector W(w, NQ);
+   const DeviceTensor<4> J(j, 3, 3, NQ, NE);
+   const DeviceMatrix C(c, NQ, NE);
+   DeviceTensor<3> y(op, 6, NQ, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         const double J11 = J(0,0,q,e);
+         const double J21 = J(1,0,q,e);
+         const double J31 = J(2,0,q,e);
+         const double J12 = J(0,1,q,e);
+         const double J22 = J(1,1,q,e);
+         const double J32 = J(2,1,q,e);
+         const double J13 = J(0,2,q,e);
+         const double J23 = J(1,2,q,e);
+         const double J33 = J(2,2,q,e);
+         const double detJ =
+         ((J11 * J22 * J33) + (J12 * J23 * J31) +
+         (J13 * J21 * J32) - (J13 * J22 * J31) -
+         (J12 * J21 * J33) - (J11 * J23 * J32));
+         const double c_detJ = W(q) * C(q,e) / detJ;
+         // J^T J
+         y(0,q,e) = c_detJ * (J11*J11 + J21*J21 + J31*J31);
+         y(1,q,e) = c_detJ * (J11*J12 + J21*J22 + J31*J32);
+         y(2,q,e) = c_detJ * (J11*J13 + J21*J23 + J31*J33);
+         y(3,q,e) = c_detJ * (J12*J12 + J22*J22 + J32*J32);
+         y(4,q,e) = c_detJ * (J12*J13 + J22*J23 + J32*J33);
+         y(5,q,e) = c_detJ * (J13*J13 + J23*J23 + J33*J33);
+      }
+   });
+}
+
+// PA scalar Assemble kernel: W*COEFF/det(J), used by the div-div and the 2D
+// curl-curl. If detJ is NULL, the determinant is not used: W*COEFF.
+static void PAScalarSetup(const int NQ,
+                          const int NE,
+                          const double *w,
+                          const double *detj,
+                          const double *c,
+                          double *op)
+{
+   const bool use_det = (detj != NULL);
+   const DeviceVector W(w, NQ);
+   const DeviceMatrix detJ(detj, use_det ? NQ : 0, use_det ? NE : 0);
+   const DeviceMatrix C(c, NQ, NE);
+   DeviceMatrix y(op, NQ, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         y(q,e) = W(q) * C(q,e) / (use_det ? detJ(q,e) : 1.0);
+      }
+   });
+}
+
+// Multiply the vectors (u0,u1) or (u0,u1,u2) at each point by the symmetric
+// matrix stored in D.
+MFEM_ATTR_HOST_DEVICE static inline
+void PASymmMult2D(const int NQ, const double *D, double *u0, double *u1)
+{
+   for (int q = 0; q < NQ; ++q)
+   {
+      const double D00 = D[0+3*q], D01 = D[1+3*q], D11 = D[2+3*q];
+      const double v0 = u0[q], v1 = u1[q];
+      u0[q] = D00*v0 + D01*v1;
+      u1[q] = D01*v0 + D11*v1;
+   }
+}
+
+MFEM_ATTR_HOST_DEVICE static inline
+void PASymmMult3D(const int NQ, const double *D,
+                  double *u0, double *u1, double *u2)
+{
+   for (int q = 0; q < NQ; ++q)
+   {
+      const double *d = D + 6*q;
+      const double v0 = u0[q], v1 = u1[q], v2 = u2[q];
+      u0[q] = d[0]*v0 + d[1]*v1 + d[2]*v2;
+      u1[q] = d[1]*v0 + d[3]*v1 + d[4]*v2;
+      u2[q] = d[2]*v0 + d[4]*v1 + d[5]*v2;
+   }
+}
+
+// In the vector mass kernels below, the c-th component of the basis uses the
+// 1D basis Ba, with DA dofs, in the c-th direction and the 1D basis Bb, with
+// DB dofs, in the other directions. For ND elements Ba and Bb are the open
+// and closed bases, respectively, and for RT elements it is the opposite.
+
+// PA Vector Mass Apply 2D kernel
+static void PAVectorMassApply2D(const int DA,
+                                const int DB,
+                                const int Q1D,
+                                const int NE,
+                                const double *ba,
+                                const double *bb,
+                                const double *_op,
+                                const double *_x,
+                                double *_y)
+{
+   MFEM_VERIFY(DA <= MAX_D1D && DB <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const int NQ = Q1D*Q1D;
+   const int NC = DA*DB;
+   const DeviceVector Ba(ba, Q1D*DA);
+   const DeviceVector Bb(bb, Q1D*DB);
+   const DeviceMatrix op(_op, 3*NQ, NE);
+   const DeviceMatrix x(_x, 2*NC, NE);
+   DeviceMatrix y(_y, 2*NC, NE);
+   MFEM_FORALL(e, NE,
+   {
+      double u0[MAX_Q1D*MAX_Q1D], u1[MAX_Q1D*MAX_Q1D];
+      for (int q = 0; q < NQ; ++q) { u0[q] = u1[q] = 0.0; }
+      const double *X = &x(0,e);
+      PAInterp2D(DA, DB, Q1D, &Ba[0], &Bb[0], X, 1.0, u0);
+      PAInterp2D(DB, DA, Q1D, &Bb[0], &Ba[0], X + NC, 1.0, u1);
+      PASymmMult2D(NQ, &op(0,e), u0, u1);
+      double *Y = &y(0,e);
+      PAInterpT2D(DA, DB, Q1D, &Ba[0], &Bb[0], u0, 1.0, Y);
+      PAInterpT2D(DB, DA, Q1D, &Bb[0], &Ba[0], u1, 1.0, Y + NC);
+   });
+}
+
+// PA Vector Mass Apply 3D kernel
+static void PAVectorMassApply3D(const int DA,
+                                const int DB,
+                                const int Q1D,
+                                const int NE,
+                                const double *ba,
+                                const double *bb,
+                                const double *_op,
+                                const double *_x,
+                                double *_y)
+{
+   MFEM_VERIFY(DA <= MAX_D1D && DB <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const int NQ = Q1D*Q1D*Q1D;
+   const int NC = DA*DB*DB;
+   const DeviceVector Ba(ba, Q1D*DA);
+   const DeviceVector Bb(bb, Q1D*DB);
+   const DeviceMatrix op(_op, 6*NQ, NE);
+   const DeviceMatrix x(_x, 3*NC, NE);
+   DeviceMatrix y(_y, 3*NC, NE);
+   MFEM_FORALL(e, NE,
+   {
+      double u0[MAX_Q1D*MAX_Q1D*MAX_Q1D];
+      double u1[MAX_Q1D*MAX_Q1D*MAX_Q1D];
+      double u2[MAX_Q1D*MAX_Q1D*MAX_Q1D];
+      for (int q = 0; q < NQ; ++q) { u0[q] = u1[q] = u2[q] = 0.0; }
+      const double *ba = &Ba[0], *bb = &Bb[0];
+      const double *X = &x(0,e);
+      PAInterp3D(DA, DB, DB, Q1D, ba, bb, bb, X, 1.0, u0);
+      PAInterp3D(DB, DA, DB, Q1D, bb, ba, bb, X + NC, 1.0, u1);
+      PAInterp3D(DB, DB, DA, Q1D, bb, bb, ba, X + 2*NC, 1.0, u2);
+      PASymmMult3D(NQ, &op(0,e), u0, u1, u2);
+      double *Y = &y(0,e);
+      PAInterpT3D(DA, DB, DB, Q1D, ba, bb, bb, u0, 1.0, Y);
+      PAInterpT3D(DB, DA, DB, Q1D, bb, ba, bb, u1, 1.0, Y + NC);
+      PAInterpT3D(DB, DB, DA, Q1D, bb, bb, ba, u2, 1.0, Y + 2*NC);
+   });
+}
+
+// PA Curl-Curl Apply 2D kernel
+static void PACurlCurlApply2D(const int D1D,
+                              const int Q1D,
+                              const int NE,
+                              const double *bo,
+                              const double *gc,
+                              const double *_op,
+                              const double *_x,
+                              double *_y)
+{
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const int DO = D1D - 1;
+   const int NQ = Q1D*Q1D;
+   const int ND = 2*DO*D1D;
+   const DeviceVector Bo(bo, Q1D*DO);
+   const DeviceVector Gc(gc, Q1D*D1D);
+   const DeviceMatrix op(_op, NQ, NE);
+   const DeviceMatrix x(_x, ND, NE);
+   DeviceMatrix y(_y, ND, NE);
+   MFEM_FORALL(e, NE,
+   {
+      // curl(u_x e_x + u_y e_y) = d_x u_y - d_y u_x
+      double c[MAX_Q1D*MAX_Q1D];
+      for (int q = 0; q < NQ; ++q) { c[q] = 0.0; }
+      const double *X = &x(0,e);
+      PAInterp2D(DO, D1D, Q1D, &Bo[0], &Gc[0], X, -1.0, c);
+      PAInterp2D(D1D, DO, Q1D, &Gc[0], &Bo[0], X + DO*D1D, 1.0, c);
+      for (int q = 0; q < NQ; ++q) { c[q] *= op(q,e); }
+      double *Y = &y(0,e);
+      PAInterpT2D(DO, D1D, Q1D, &Bo[0], &Gc[0], c, -1.0, Y);
+      PAInterpT2D(D1D, DO, Q1D, &Gc[0], &Bo[0], c, 1.0, Y + DO*D1D);
+   });
+}
+
+// PA Curl-Curl Apply 3D kernel
+static void PACurlCurlApply3D(const int D1D,
+                              const int Q1D,
+                              const int NE,
+                              const double *bo,
+                              const double *bc,
+                              const double *gc,
+                              const double *_op,
+                              const double *_x,
+                              double *_y)
+{
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const int DO = D1D - 1;
+   const int NQ = Q1D*Q1D*Q1D;
+   const int NC = DO*D1D*D1D;
+   const DeviceVector Bo(bo, Q1D*DO);
+   const DeviceVector Bc(bc, Q1D*D1D);
+   const DeviceVector Gc(gc, Q1D*D1D);
+   const DeviceMatrix op(_op, 6*NQ, NE);
+   const DeviceMatrix x(_x, 3*NC, NE);
+   DeviceMatrix y(_y, 3*NC, NE);
+   MFEM_FORALL(e, NE,
+   {
+      double c0[MAX_Q1D*MAX_Q1D*MAX_Q1D];
+      double c1[MAX_Q1D*MAX_Q1D*MAX_Q1D];
+      double c2[MAX_Q1D*MAX_Q1D*MAX_Q1D];
+      for (int q = 0; q < NQ; ++q) { c0[q] = c1[q] = c2[q] = 0.0; }
+      const double *bo = &Bo[0], *bc = &Bc[0], *gc = &Gc[0];
+      const double *X = &x(0,e);
+      // curl(u_x e_x) = (0, d_z u_x, -d_y u_x)
+      PAInterp3D(DO, D1D, D1D, Q1D, bo, bc, gc, X, 1.0, c1);
+      PAInterp3D(DO, D1D, D1D, Q1D, bo, gc, bc, X, -1.0, c2);
+      // curl(u_y e_y) = (-d_z u_y, 0, d_x u_y)
+      PAInterp3D(D1D, DO, D1D, Q1D, bc, bo, gc, X + NC, -1.0, c0);
+      PAInterp3D(D1D, DO, D1D, Q1D, gc, bo, bc, X + NC, 1.0, c2);
+      // curl(u_z e_z) = (d_y u_z, -d_x u_z, 0)
+      PAInterp3D(D1D, D1D, DO, Q1D, bc, gc, bo, X + 2*NC, 1.0, c0);
+      PAInterp3D(D1D, D1D, DO, Q1D, gc, bc, bo, X + 2*NC, -1.0, c1);
+      PASymmMult3D(NQ, &op(0,e), c0, c1, c2);
+      double *Y = &y(0,e);
+      PAInterpT3D(DO, D1D, D1D, Q1D, bo, bc, gc, c1, 1.0, Y);
+      PAInterpT3D(DO, D1D, D1D, Q1D, bo, gc, bc, c2, -1.0, Y);
+      PAInterpT3D(D1D, DO, D1D, Q1D, bc, bo, gc, c0, -1.0, Y + NC);
+      PAInterpT3D(D1D, DO, D1D, Q1D, gc, bo, bc, c2, 1.0, Y + NC);
+      PAInterpT3D(D1D, D1D, DO, Q1D, bc, gc, bo, c0, 1.0, Y + 2*NC);
+      PAInterpT3D(D1D, D1D, DO, Q1D, gc, bc, bo, c1, -1.0, Y + 2*NC);
+   });
+}
+
+// Add the reference divergence of the RT function x, at the quadrature points,
+// to div.
+MFEM_ATTR_HOST_DEVICE static inline
+void PADivergence2D(const int DC, const int DO, const int Q1D,
+                    const double *bo, const double *gc,
+                    const double *x, double *div)
+{
+   PAInterp2D(DC, DO, Q1D, gc, bo, x, 1.0, div);
+   PAInterp2D(DO, DC, Q1D, bo, gc, x + DC*DO, 1.0, div);
+}
+
+// Transpose of PADivergence2D.
+MFEM_ATTR_HOST_DEVICE static inline
+void PADivergenceT2D(const int DC, const int DO, const int Q1D,
+                     const double *bo, const double *gc,
+                     const double *div, double *y)
+{
+   PAInterpT2D(DC, DO, Q1D, gc, bo, div, 1.0, y);
+   PAInterpT2D(DO, DC, Q1D, bo, gc, div, 1.0, y + DC*DO);
+}
+
+// 3D version of PADivergence2D.
+MFEM_ATTR_HOST_DEVICE static inline
+void PADivergence3D(const int DC, const int DO, const int Q1D,
+                    const double *bo, const double *gc,
+                    const double *x, double *div)
+{
+   const int NC = DC*DO*DO;
+   PAInterp3D(DC, DO, DO, Q1D, gc, bo, bo, x, 1.0, div);
+   PAInterp3D(DO, DC, DO, Q1D, bo, gc, bo, x + NC, 1.0, div);
+   PAInterp3D(DO, DO, DC, Q1D, bo, bo, gc, x + 2*NC, 1.0, div);
+}
+
+// 3D version of PADivergenceT2D.
+MFEM_ATTR_HOST_DEVICE static inline
+void PADivergenceT3D(const int DC, const int DO, const int Q1D,
+                     const double *bo, const double *gc,
+                     const double *div, double *y)
+{
+   const int NC = DC*DO*DO;
+   PAInterpT3D(DC, DO, DO, Q1D, gc, bo, bo, div, 1.0, y);
+   PAInterpT3D(DO, DC, DO, Q1D, bo, gc, bo, div, 1.0, y + NC);
+   PAInterpT3D(DO, DO, DC, Q1D, bo, bo, gc, div, 1.0, y + 2*NC);
+}
+
+// PA Div-Div Apply kernel
+static void PADivDivApply(const int dim,
+                          const int D1D,
+                          const int Q1D,
+                          const int NE,
+                          const double *bo,
+                          const double *gc,
+                          const double *_op,
+                          const double *_x,
+                          double *_y)
+{
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const int DO = D1D - 1;
+   const int NQ = (dim == 2) ? Q1D*Q1D : Q1D*Q1D*Q1D;
+   const int ND = (dim == 2) ? 2*D1D*DO : 3*D1D*DO*DO;
+   const DeviceVector Bo(bo, Q1D*DO);
+   const DeviceVector Gc(gc, Q1D*D1D);
+   const DeviceMatrix op(_op, NQ, NE);
+   const DeviceMatrix x(_x, ND, NE);
+   DeviceMatrix y(_y, ND, NE);
+   MFEM_FORALL(e, NE,
+   {
+      double div[MAX_Q1D*MAX_Q1D*MAX_Q1D];
+      for (int q = 0; q < NQ; ++q) { div[q] = 0.0; }
+      if (dim == 2)
+      {
+         PADivergence2D(D1D, DO, Q1D, &Bo[0], &Gc[0], &x(0,e), div);
+      }
+      else
+      {
+         PADivergence3D(D1D, DO, Q1D, &Bo[0], &Gc[0], &x(0,e), div);
+      }
+      for (int q = 0; q < NQ; ++q) { div[q] *= op(q,e); }
+      if (dim == 2)
+      {
+         PADivergenceT2D(D1D, DO, Q1D, &Bo[0], &Gc[0], div, &y(0,e));
+      }
+      else
+      {
+         PADivergenceT3D(D1D, DO, Q1D, &Bo[0], &Gc[0], div, &y(0,e));
+      }
+   });
+}
+
+// PA Mixed Divergence Apply kernel: the action of (div u, v), where u is in
+// the RT space and v is in the scalar tensor space with 1D basis Bt and DT
+// dofs, or its transpose.
+static void PAMixedDivApply(const int dim,
+                            const int D1D,
+                            const int DT,
+                            const int Q1D,
+                            const int NE,
+                            const bool transpose,
+                            const double *bo,
+                            const double *gc,
+                            const double *bt,
+                            const double *_op,
+                            const double *_x,
+                            double *_y)
+{
+   MFEM_VERIFY(D1D <= MAX_D1D && DT <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const int DO = D1D - 1;
+   const int NQ = (dim == 2) ? Q1D*Q1D : Q1D*Q1D*Q1D;
+   const int ND = (dim == 2) ? 2*D1D*DO : 3*D1D*DO*DO;
+   const int NT = (dim == 2) ? DT*DT : DT*DT*DT;
+   const DeviceVector Bo(bo, Q1D*DO);
+   const DeviceVector Gc(gc, Q1D*D1D);
+   const DeviceVector Bt(bt, Q1D*DT);
+   const DeviceMatrix op(_op, NQ, NE);
+   const DeviceMatrix x(_x, transpose ? NT : ND, NE);
+   DeviceMatrix y(_y, transpose ? ND : NT, NE);
+   MFEM_FORALL(e, NE,
+   {
+      double u[MAX_Q1D*MAX_Q1D*MAX_Q1D];
+      for (int q = 0; q < NQ; ++q) { u[q] = 0.0; }
+      const double *bo = &Bo[0], *gc = &Gc[0], *bt = &Bt[0];
+      if (!transpose)
+      {
+         if (dim == 2) { PADivergence2D(D1D, DO, Q1D, bo, gc, &x(0,e), u); }
+         else { PADivergence3D(D1D, DO, Q1D, bo, gc, &x(0,e), u); }
+      }
+      else
+      {
+         if (dim == 2) { PAInterp2D(DT, DT, Q1D, bt, bt, &x(0,e), 1.0, u); }
+         else { PAInterp3D(DT, DT, DT, Q1D, bt, bt, bt, &x(0,e), 1.0, u); }
+      }
+      for (int q = 0; q < NQ; ++q) { u[q] *= op(q,e); }
+      if (!transpose)
+      {
+         if (dim == 2) { PAInterpT2D(DT, DT, Q1D, bt, bt, u, 1.0, &y(0,e)); }
+         else { PAInterpT3D(DT, DT, DT, Q1D, bt, bt, bt, u, 1.0, &y(0,e)); }
+      }
+      else
+      {
+         if (dim == 2) { PADivergenceT2D(D1D, DO, Q1D, bo, gc, u, &y(0,e)); }
+         else { PADivergenceT3D(D1D, DO, Q1D, bo, gc, u, &y(0,e)); }
+      }
+   });
+}
+
+// Return the element of fes, checking that it is an ND (deriv_type = CURL) or
+// RT (deriv_type = DIV) element supported by PA.
+static const VectorTensorFiniteElement &GetPAVectorElement(
+   const FiniteElementSpace &fes, const int deriv_type)
+{
+   const VectorTensorFiniteElement *el =
+      dynamic_cast<const VectorTensorFiniteElement*>(fes.GetFE(0));
+   MFEM_VERIFY(el != NULL && (deriv_type < 0 ||
+                              el->GetDerivType() == deriv_type),
+               "PA requires ND or RT elements on quadrilaterals or hexahedra");
+   MFEM_VERIFY(fes.GetMesh()->Dimension() == el->GetDim(),
+               "PA is not supported for ND or RT elements on surfaces");
+   return *el;
+}
+
+void VectorFEMassIntegrator::Assemble(const FiniteElementSpace &fes)
+{
+   MFEM_VERIFY(VQ == NULL && MQ == NULL,
+               "PA supports only scalar coefficients");
+   Mesh *mesh = fes.GetMesh();
+   const VectorTensorFiniteElement &el = GetPAVectorElement(fes, -1);
+   const IntegrationRule *ir = IntRule;
+   if (ir == NULL)
+   {
+      const int order = mesh->GetElementTransformation(0)->OrderW() +
+                        2*el.GetOrder();
+      ir = &IntRules.Get(el.GetGeomType(), order);
+   }
+   const IntegrationRule &ir1D = GetRule1D(el, *ir);
+   const int nq = ir->GetNPoints();
+   dim = el.GetDim();
+   ne = fes.GetNE();
+   dofs1D = el.GetOrder() + 1;
+   quad1D = ir1D.GetNPoints();
+   map_type = el.GetMapType();
+   PAVectorBasis1D(el, ir1D, Bo, Bc, NULL);
+   Vector W, coeff;
+   PAWeights(*ir, W);
+   EvalPACoefficient(Q, fes, *ir, coeff);
+   const GeometricFactors *geom =
+      fes.GetMesh()->GetGeometricFactors(*ir, GeometricFactors::JACOBIANS);
+   pa_data.SetSize(((dim == 2) ? 3 : 6)*nq*ne);
+   if (map_type == FiniteElement::H_CURL)
+   {
+      if (dim == 2) { PAHcurlMassSetup2D(nq, ne, W, geom->J, coeff, pa_data); }
+      else { PAHcurlMassSetup3D(nq, ne, W, geom->J, coeff, pa_data); }
+   }
+   else
+   {
+      if (dim == 2) { PAJtJSetup2D(nq, ne, W, geom->J, coeff, pa_data); }
+      else { PAJtJSetup3D(nq, ne, W, geom->J, coeff, pa_data); }
+   }
+}
+
+void VectorFEMassIntegrator::MultAssembled(Vector &x, Vector &y)
+{
+   const bool nd = (map_type == FiniteElement::H_CURL);
+   const int DA = nd ? dofs1D - 1 : dofs1D;
+   const int DB = nd ? dofs1D : dofs1D - 1;
+   const Array<double> &Ba = nd ? Bo : Bc;
+   const Array<double> &Bb = nd ? Bc : Bo;
+   if (dim == 2)
+   {
+      PAVectorMassApply2D(DA, DB, quad1D, ne, Ba, Bb, pa_data, x, y);
+   }
+   else
+   {
+      PAVectorMassApply3D(DA, DB, quad1D, ne, Ba, Bb, pa_data, x, y);
+   }
+}
+
+void CurlCurlIntegrator::Assemble(const FiniteElementSpace &fes)
+{
+   MFEM_VERIFY(MQ == NULL, "PA supports only scalar coefficients");
+   const VectorTensorFiniteElement &el =
+      GetPAVectorElement(fes, FiniteElement::CURL);
+   const IntegrationRule *ir = IntRule;
+   if (ir == NULL)
+   {
+      ir = &IntRules.Get(el.GetGeomType(), 2*el.GetOrder());
+   }
+   const IntegrationRule &ir1D = GetRule1D(el, *ir);
+   const int nq = ir->GetNPoints();
+   dim = el.GetDim();
+   ne = fes.GetNE();
+   dofs1D = el.GetOrder() + 1;
+   quad1D = ir1D.GetNPoints();
+   PAVectorBasis1D(el, ir1D, Bo, Bc, &Gc);
+   Vector W, coeff;
+   PAWeights(*ir, W);
+   EvalPACoefficient(Q, fes, *ir, coeff);
+   const int flags = (dim == 2) ? GeometricFactors::DETERMINANTS :
+                     GeometricFactors::JACOBIANS;
+   const GeometricFactors *geom =
+      fes.GetMesh()->GetGeometricFactors(*ir, flags);
+   if (dim == 2)
+   {
+      pa_data.SetSize(nq*ne);
+      PAScalarSetup(nq, ne, W, geom->detJ, coeff, pa_data);
+   }
+   else
+   {
+      pa_data.SetSize(6*nq*ne);
+      PAJtJSetup3D(nq, ne, W, geom->J, coeff, pa_data);
+   }
+}
+
+void CurlCurlIntegrator::MultAssembled(Vector &x, Vector &y)
+{
+   if (dim == 2)
+   {
+      PACurlCurlApply2D(dofs1D, quad1D, ne, Bo, Gc, pa_data, x, y);
+   }
+   else
+   {
+      PACurlCurlApply3D(dofs1D, quad1D, ne, Bo, Bc, Gc, pa_data, x, y);
+   }
+}
+
+void DivDivIntegrator::Assemble(const FiniteElementSpace &fes)
+{
+   const VectorTensorFiniteElement &el =
+      GetPAVectorElement(fes, FiniteElement::DIV);
+   const IntegrationRule *ir = IntRule;
+   if (ir == NULL)
+   {
+      ir = &IntRules.Get(el.GetGeomType(), 2*el.GetOrder() - 2);
+   }
+   const IntegrationRule &ir1D = GetRule1D(el, *ir);
+   dim = el.GetDim();
+   ne = fes.GetNE();
+   dofs1D = el.GetOrder() + 1;
+   quad1D = ir1D.GetNPoints();
+   Array<double> Bc;
+   PAVectorBasis1D(el, ir1D, Bo, Bc, &Gc);
+   Vector W, coeff;
+   PAWeights(*ir, W);
+   EvalPACoefficient(Q, fes, *ir, coeff);
+   const GeometricFactors *geom =
+      fes.GetMesh()->GetGeometricFactors(*ir, GeometricFactors::DETERMINANTS);
+   pa_data.SetSize(ir->GetNPoints()*ne);
+   PAScalarSetup(ir->GetNPoints(), ne, W, geom->detJ, coeff, pa_data);
+}
+
+void DivDivIntegrator::MultAssembled(Vector &x, Vector &y)
+{
+   PADivDivApply(dim, dofs1D, quad1D, ne, Bo, Gc, pa_data, x, y);
+}
+
+void VectorFEDivergenceIntegrator::Assemble(const FiniteElementSpace &trial_fes,
+                                            const FiniteElementSpace &test_fes)
+{
+   const VectorTensorFiniteElement &trial_el =
+      GetPAVectorElement(trial_fes, FiniteElement::DIV);
+   const TensorBasisElement *test_el =
+      dynamic_cast<const TensorBasisElement*>(test_fes.GetFE(0));
+   MFEM_VERIFY(test_el != NULL && test_fes.GetVDim() == 1,
+               "PA requires a scalar tensor product test space");
+   const int test_order = test_fes.GetFE(0)->GetOrder();
+   const IntegrationRule *ir = IntRule;
+   if (ir == NULL)
+   {
+      ir = &IntRules.Get(trial_el.GetGeomType(),
+                         trial_el.GetOrder() + test_order - 1);
+   }
+   const IntegrationRule &ir1D = GetRule1D(trial_el, *ir);
+   dim = trial_el.GetDim();
+   ne = trial_fes.GetNE();
+   trial_dofs1D = trial_el.GetOrder() + 1;
+   test_dofs1D = test_order + 1;
+   quad1D = ir1D.GetNPoints();
+   Array<double> Bc;
+   PAVectorBasis1D(trial_el, ir1D, Bo, Bc, &Gc);
+   Bt.SetSize(quad1D*test_dofs1D);
+   Vector u(test_dofs1D);
+   for (int q = 0; q < quad1D; ++q)
+   {
+      test_el->GetBasis1D().Eval(ir1D.IntPoint(q).x, u);
+      for (int d = 0; d < test_dofs1D; ++d) { Bt[q + quad1D*d] = u(d); }
+   }
+   mfem::Push(Bt.GetData(), Bt.Size()*sizeof(double));
+   Vector W, coeff;
+   PAWeights(*ir, W);
+   EvalPACoefficient(Q, trial_fes, *ir, coeff);
+   pa_data.SetSize(ir->GetNPoints()*ne);
+   PAScalarSetup(ir->GetNPoints(), ne, W, NULL, coeff, pa_data);
+}
+
+void VectorFEDivergenceIntegrator::MultAssembled(Vector &x, Vector &y)
+{
+   PAMixedDivApply(dim, trial_dofs1D, test_dofs1D, quad1D, ne, false,
+                   Bo, Gc, Bt, pa_data, x, y);
+}
+
+void VectorFEDivergenceIntegrator::MultAssembledTranspose(Vector &x, Vector &y)
+{
+   PAMixedDivApply(dim, trial_dofs1D, test_dofs1D, quad1D, ne, true,
+                   Bo, Gc, Bt, pa_data, x, y);
+}
+
+} // namespace mfem
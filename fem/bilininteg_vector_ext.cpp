@@ -0,0 +1,384 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+// PA kernels for the integrators on vector H1 spaces: VectorMassIntegrator,
+// VectorDiffusionIntegrator and ElasticityIntegrator. The local vectors are in
+// the layout of the ElemRestriction, i.e. the components are either blocked
+// (Ordering::byNODES) or interleaved (Ordering::byVDIM).
+
+#include "../general/forall.hpp"
+#include "bilininteg.hpp"
+#include "bilininteg_kernels.hpp"
+
+namespace mfem
+{
+
+// Return the H1 tensor element of fes, which must be a vector space with
+// vdim equal to the dimension.
+static const FiniteElement &GetPAVectorH1Element(const FiniteElementSpace &fes,
+                                                 const bool vdim_is_dim)
+{
+   const FiniteElement &el = *fes.GetFE(0);
+   MFEM_VERIFY(dynamic_cast<const TensorBasisElement*>(&el) &&
+               el.GetDim() > 1 && el.GetMapType() == FiniteElement::VALUE,
+               "PA requires H1 elements on quads or hexes");
+   MFEM_VERIFY(fes.GetMesh()->SpaceDimension() == el.GetDim(),
+               "PA requires the space dimension to equal the dimension");
+   MFEM_VERIFY(!vdim_is_dim || fes.GetVDim() == el.GetDim(),
+               "the vector dimension must equal the dimension");
+   return el;
+}
+
+// Setup the 1D rule, the 1D bases B and G (B[q + Q1D*d]) and the weights W of
+// the tensor product rule ir.
+static void PAVectorH1Basis(const FiniteElement &el,
+                            const IntegrationRule &ir,
+                            int &D1D, int &Q1D,
+                            Array<double> &B, Array<double> &G, Vector &W)
+{
+   const IntegrationRule &ir1D = IntRules.Get(Geometry::SEGMENT, ir.GetOrder());
+   D1D = el.GetOrder() + 1;
+   Q1D = ir1D.GetNPoints();
+   int nq = Q1D;
+   for (int d = 1; d < el.GetDim(); d++) { nq *= Q1D; }
+   MFEM_VERIFY(nq == ir.GetNPoints(), "tensor product rule required for PA");
+   MFEM_VERIFY(D1D <= MAX_D1D && Q1D <= MAX_Q1D, "order too high for PA");
+
+   PABasis1D(el, ir1D, B, &G);
+
+   W.SetSize(nq);
+   for (int q = 0; q < nq; ++q) { W(q) = ir.IntPoint(q).weight; }
+   W.Push();
+}
+
+// Strides of the local vectors of the ElemRestriction: the entry i of the
+// component c of the element e is at e*es + c*cs + i*is.
+static void PAVectorStrides(const int NE, const int ND, const int VD,
+                            const bool byvdim, int &es, int &cs, int &is)
+{
+   es = byvdim ? VD*ND : ND;
+   cs = byvdim ? 1 : NE*ND;
+   is = byvdim ? VD : 1;
+}
+
+// PA Vector H1 Assemble kernel: store at each quadrature point
+//  - kind 0 (mass):       w det(J) c1
+//  - kind 1 (diffusion):  w det(J) c1 J^{-1} J^{-T}, symmetric
+//  - kind 2 (elasticity): J^{-1}, w det(J) c1, w det(J) c2
+static void PAVectorH1Setup(const int kind,
+                            const int dim,
+                            const int NQ,
+                            const int NE,
+                            const double *w,
+                            const double *j,
+                            const double *c1,
+                            const double *c2,
+                            double *op)
+{
+   const int SD = (dim*(dim+1))/2;
+   const int QD = (kind == 0) ? 1 : (kind == 1) ? SD : dim*dim + 2;
+   const DeviceVector W(w, NQ);
+   const DeviceTensor<4> J(j, dim, dim, NQ, NE);
+   const DeviceMatrix C1(c1, NQ, NE);
+   const DeviceMatrix C2(c2, NQ, NE);
+   DeviceTensor<3> y(op, QD, NQ, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         double invJ[9];
+         const double wdetJ = W(q) * internal::PAInvJacobian(dim, J, q, e, invJ);
+         if (kind == 0)
+         {
+            y(0,q,e) = wdetJ * C1(q,e);
+         }
+         else if (kind == 1)
+         {
+            for (int k = 0, s = 0; k < dim; ++k)
+            {
+               for (int l = k; l < dim; ++l, ++s)
+               {
+                  double d = 0.0;
+                  for (int m = 0; m < dim; ++m)
+                  {
+                     d += invJ[k + dim*m] * invJ[l + dim*m];
+                  }
+                  y(s,q,e) = wdetJ * C1(q,e) * d;
+               }
+            }
+         }
+         else
+         {
+            for (int i = 0; i < dim*dim; ++i) { y(i,q,e) = invJ[i]; }
+            y(dim*dim,q,e) = wdetJ * C1(q,e);
+            y(dim*dim+1,q,e) = wdetJ * C2(q,e);
+         }
+      }
+   });
+}
+
+// PA Vector H1 Apply kernel, for the quadrature data of PAVectorH1Setup.
+static void PAVectorH1Apply(const int kind,
+                            const int dim,
+                            const int NE,
+                            const int D1D,
+                            const int Q1D,
+                            const int VD,
+                            const bool byvdim,
+                            const double *b,
+                            const double *g,
+                            const double *op,
+                            const double *_x,
+                            double *_y)
+{
+   const int ND = (dim == 2) ? D1D*D1D : D1D*D1D*D1D;
+   const int NQ = (dim == 2) ? Q1D*Q1D : Q1D*Q1D*Q1D;
+   const int SD = (dim*(dim+1))/2;
+   const int QD = (kind == 0) ? 1 : (kind == 1) ? SD : dim*dim + 2;
+   const int GD = (kind == 0) ? 1 : dim;
+   MFEM_VERIFY(GD*VD <= 9, "too many vector components for PA");
+   int es, cs, is;
+   PAVectorStrides(NE, ND, VD, byvdim, es, cs, is);
+   const DeviceVector B(b, Q1D*D1D);
+   const DeviceVector G(g, Q1D*D1D);
+   const DeviceTensor<3> D(op, QD, NQ, NE);
+   const DeviceVector x(_x, VD*ND*NE);
+   DeviceVector y(_y, VD*ND*NE);
+   MFEM_FORALL(e, NE,
+   {
+      const int MQ = MAX_Q1D*MAX_Q1D*MAX_Q1D;
+      double xe[MAX_D1D*MAX_D1D*MAX_D1D];
+      // u[k + GD*(q + NQ*c)]: values or reference gradients of the components
+      double u[3*3*MQ];
+      for (int i = 0; i < GD*NQ*VD; ++i) { u[i] = 0.0; }
+      for (int c = 0; c < VD; ++c)
+      {
+         for (int i = 0; i < ND; ++i) { xe[i] = x[e*es + c*cs + i*is]; }
+         double *uc = u + GD*NQ*c;
+         if (kind == 0)
+         {
+            if (dim == 2) { internal::PAEval2D(D1D, Q1D, &B[0], xe, uc); }
+            else { internal::PAEval3D(D1D, Q1D, &B[0], xe, uc); }
+         }
+         else
+         {
+            if (dim == 2)
+            {
+               internal::PAGrad2D(D1D, Q1D, &B[0], &G[0], xe, uc, 2);
+            }
+            else
+            {
+               internal::PAGrad3D(D1D, Q1D, &B[0], &G[0], xe, uc, 3);
+            }
+         }
+      }
+      for (int q = 0; q < NQ; ++q)
+      {
+         if (kind == 0)
+         {
+            for (int c = 0; c < VD; ++c) { u[q + NQ*c] *= D(0,q,e); }
+         }
+         else if (kind == 1)
+         {
+            double Dq[9];
+            for (int k = 0, s = 0; k < dim; ++k)
+            {
+               for (int l = k; l < dim; ++l, ++s)
+               {
+                  Dq[k + dim*l] = Dq[l + dim*k] = D(s,q,e);
+               }
+            }
+            for (int c = 0; c < VD; ++c)
+            {
+               double *uq = u + dim*(q + NQ*c);
+               double gq[3];
+               for (int k = 0; k < dim; ++k) { gq[k] = uq[k]; }
+               for (int k = 0; k < dim; ++k)
+               {
+                  double s = 0.0;
+                  for (int l = 0; l < dim; ++l) { s += Dq[k + dim*l] * gq[l]; }
+                  uq[k] = s;
+               }
+            }
+         }
+         else
+         {
+            const double lambda = D(dim*dim,q,e), mu = D(dim*dim+1,q,e);
+            // physical gradient: Gp[c + dim*j] = du_c/dx_j
+            double Gp[9], div = 0.0;
+            for (int c = 0; c < dim; ++c)
+            {
+               const double *uq = u + dim*(q + NQ*c);
+               for (int j = 0; j < dim; ++j)
+               {
+                  double s = 0.0;
+                  for (int k = 0; k < dim; ++k)
+                  {
+                     s += uq[k] * D(k + dim*j,q,e);
+                  }
+                  Gp[c + dim*j] = s;
+               }
+               div += Gp[c + dim*c];
+            }
+            // stress: lambda div(u) I + mu (grad(u) + grad(u)^T)
+            double S[9];
+            for (int c = 0; c < dim; ++c)
+            {
+               for (int j = 0; j < dim; ++j)
+               {
+                  S[c + dim*j] = mu * (Gp[c + dim*j] + Gp[j + dim*c]) +
+                                 ((c == j) ? lambda * div : 0.0);
+               }
+            }
+            for (int c = 0; c < dim; ++c)
+            {
+               double *uq = u + dim*(q + NQ*c);
+               for (int k = 0; k < dim; ++k)
+               {
+                  double s = 0.0;
+                  for (int j = 0; j < dim; ++j)
+                  {
+                     s += D(k + dim*j,q,e) * S[c + dim*j];
+                  }
+                  uq[k] = s;
+               }
+            }
+         }
+      }
+      for (int c = 0; c < VD; ++c)
+      {
+         for (int i = 0; i < ND; ++i) { xe[i] = 0.0; }
+         const double *uc = u + GD*NQ*c;
+         if (kind == 0)
+         {
+            if (dim == 2) { internal::PAEvalT2D(D1D, Q1D, &B[0], uc, xe); }
+            else { internal::PAEvalT3D(D1D, Q1D, &B[0], uc, xe); }
+         }
+         else
+         {
+            if (dim == 2)
+            {
+               internal::PAGradT2D(D1D, Q1D, &B[0], &G[0], uc, 2, xe);
+            }
+            else
+            {
+               internal::PAGradT3D(D1D, Q1D, &B[0], &G[0], uc, 3, xe);
+            }
+         }
+         for (int i = 0; i < ND; ++i) { y[e*es + c*cs + i*is] += xe[i]; }
+      }
+   });
+}
+
+void VectorMassIntegrator::Assemble(const FiniteElementSpace &fes)
+{
+   MFEM_VERIFY(VQ == NULL && MQ == NULL,
+               "PA supports only scalar coefficients");
+   const FiniteElement &el = GetPAVectorH1Element(fes, false);
+   Mesh *mesh = fes.GetMesh();
+   MFEM_VERIFY(vdim == -1 || vdim == fes.GetVDim(), "invalid vdim");
+   const IntegrationRule *ir = IntRule;
+   if (ir == NULL)
+   {
+      const int order = 2*el.GetOrder() +
+                        mesh->GetElementTransformation(0)->OrderW() + Q_order;
+      ir = &IntRules.Get(el.GetGeomType(), order);
+   }
+   dim = el.GetDim();
+   ne = fes.GetNE();
+   pa_vdim = fes.GetVDim();
+   byvdim = (fes.GetOrdering() == Ordering::byVDIM);
+   Vector W, coeff;
+   PAVectorH1Basis(el, *ir, dofs1D, quad1D, pa_B, pa_G, W);
+   EvalPACoefficient(Q, fes, *ir, coeff);
+   const GeometricFactors *geom =
+      fes.GetMesh()->GetGeometricFactors(*ir, GeometricFactors::JACOBIANS);
+   const int nq = ir->GetNPoints();
+   pa_data.SetSize(nq*ne);
+   PAVectorH1Setup(0, dim, nq, ne, W, geom->J, coeff, coeff, pa_data);
+}
+
+void VectorMassIntegrator::MultAssembled(Vector &x, Vector &y)
+{
+   PAVectorH1Apply(0, dim, ne, dofs1D, quad1D, pa_vdim, byvdim,
+                   pa_B, pa_G, pa_data, x, y);
+}
+
+void VectorDiffusionIntegrator::Assemble(const FiniteElementSpace &fes)
+{
+   const FiniteElement &el = GetPAVectorH1Element(fes, true);
+   Mesh *mesh = fes.GetMesh();
+   const IntegrationRule *ir = IntRule;
+   if (ir == NULL)
+   {
+      const int order = 2*mesh->GetElementTransformation(0)->OrderGrad(&el);
+      ir = &IntRules.Get(el.GetGeomType(), order);
+   }
+   dim = el.GetDim();
+   ne = fes.GetNE();
+   byvdim = (fes.GetOrdering() == Ordering::byVDIM);
+   Vector W, coeff;
+   PAVectorH1Basis(el, *ir, dofs1D, quad1D, pa_B, pa_G, W);
+   EvalPACoefficient(Q, fes, *ir, coeff);
+   const GeometricFactors *geom =
+      fes.GetMesh()->GetGeometricFactors(*ir, GeometricFactors::JACOBIANS);
+   const int nq = ir->GetNPoints();
+   pa_data.SetSize(((dim*(dim+1))/2)*nq*ne);
+   PAVectorH1Setup(1, dim, nq, ne, W, geom->J, coeff, coeff, pa_data);
+}
+
+void VectorDiffusionIntegrator::MultAssembled(Vector &x, Vector &y)
+{
+   PAVectorH1Apply(1, dim, ne, dofs1D, quad1D, dim, byvdim,
+                   pa_B, pa_G, pa_data, x, y);
+}
+
+void ElasticityIntegrator::Assemble(const FiniteElementSpace &fes)
+{
+   const FiniteElement &el = GetPAVectorH1Element(fes, true);
+   Mesh *mesh = fes.GetMesh();
+   const IntegrationRule *ir = IntRule;
+   if (ir == NULL)
+   {
+      const int order = 2*mesh->GetElementTransformation(0)->OrderGrad(&el);
+      ir = &IntRules.Get(el.GetGeomType(), order);
+   }
+   dim = el.GetDim();
+   ne = fes.GetNE();
+   byvdim = (fes.GetOrdering() == Ordering::byVDIM);
+   Vector W, lambda_q, mu_q;
+   PAVectorH1Basis(el, *ir, dofs1D, quad1D, pa_B, pa_G, W);
+   EvalPACoefficient(mu, fes, *ir, mu_q);
+   if (lambda)
+   {
+      EvalPACoefficient(lambda, fes, *ir, lambda_q);
+   }
+   else
+   {
+      // lambda = q_lambda * m and mu = q_mu * m
+      lambda_q = mu_q;
+      lambda_q *= q_lambda;
+      mu_q *= q_mu;
+   }
+   const GeometricFactors *geom =
+      fes.GetMesh()->GetGeometricFactors(*ir, GeometricFactors::JACOBIANS);
+   const int nq = ir->GetNPoints();
+   pa_data.SetSize((dim*dim + 2)*nq*ne);
+   PAVectorH1Setup(2, dim, nq, ne, W, geom->J, lambda_q, mu_q, pa_data);
+}
+
+void ElasticityIntegrator::MultAssembled(Vector &x, Vector &y)
+{
+   PAVectorH1Apply(2, dim, ne, dofs1D, quad1D, dim, byvdim,
+                   pa_B, pa_G, pa_data, x, y);
+}
+
+} // namespace mfem
@@ -105,7 +105,12 @@ public:
 };
 
 
-/// The inverse transformation of a given ElementTransformation.
+/** @brief The inverse transformation of a given ElementTransformation.
+
+    This class only inverts the transformation of one element and does not
+    search the mesh: the elements to try for a physical point are selected by
+    Mesh::FindPoints(), using the ElementBinGrid of Mesh::GetElementBinGrid(),
+    which then calls Transform() for each of them. */
 class InverseElementTransformation
 {
 public:
@@ -7064,6 +7064,23 @@ NodalTensorFiniteElement::NodalTensorFiniteElement(const int dims,
      TensorBasisElement(dims, p, VerifyNodal(btype), dmtype) { }
 
 
+VectorTensorFiniteElement::VectorTensorFiniteElement(const int dims,
+                                                     const int d,
+                                                     const int p,
+                                                     const int cp,
+                                                     const int op,
+                                                     const int cbtype,
+                                                     const int obtype,
+                                                     const int M)
+   : VectorFiniteElement(dims,
+                         TensorBasisElement::GetTensorProductGeometry(dims),
+                         d, p, M, FunctionSpace::Qk),
+     cb_type(cbtype), ob_type(obtype),
+     cbasis1d(poly1d.GetBasis(cp, VerifyClosed(cbtype))),
+     obasis1d(poly1d.GetBasis(op, VerifyOpen(obtype))),
+     dof_map(d) { }
+
+
 PositiveTensorFiniteElement::PositiveTensorFiniteElement(
    const int dims, const int p, const DofMapType dmtype)
    : PositiveFiniteElement(dims, GetTensorProductGeometry(dims),
@@ -9777,11 +9794,9 @@ const double RT_QuadrilateralElement::nk[8] =
 RT_QuadrilateralElement::RT_QuadrilateralElement(const int p,
                                                  const int cb_type,
                                                  const int ob_type)
-   : VectorFiniteElement(2, Geometry::SQUARE, 2*(p + 1)*(p + 2), p + 1,
-                         H_DIV, FunctionSpace::Qk),
-     cbasis1d(poly1d.GetBasis(p + 1, VerifyClosed(cb_type))),
-     obasis1d(poly1d.GetBasis(p, VerifyOpen(ob_type))),
-     dof_map(Dof), dof2nk(Dof)
+   : VectorTensorFiniteElement(2, 2*(p + 1)*(p + 2), p + 1, p + 1, p,
+                               cb_type, ob_type, H_DIV),
+     dof2nk(Dof)
 {
    const double *cp = poly1d.ClosedPoints(p + 1, cb_type);
    const double *op = poly1d.OpenPoints(p, ob_type);
@@ -9988,11 +10003,9 @@ const double RT_HexahedronElement::nk[18] =
 RT_HexahedronElement::RT_HexahedronElement(const int p,
                                            const int cb_type,
                                            const int ob_type)
-   : VectorFiniteElement(3, Geometry::CUBE, 3*(p + 1)*(p + 1)*(p + 2), p + 1,
-                         H_DIV, FunctionSpace::Qk),
-     cbasis1d(poly1d.GetBasis(p + 1, VerifyClosed(cb_type))),
-     obasis1d(poly1d.GetBasis(p, VerifyOpen(ob_type))),
-     dof_map(Dof), dof2nk(Dof)
+   : VectorTensorFiniteElement(3, 3*(p + 1)*(p + 1)*(p + 2), p + 1, p + 1, p,
+                               cb_type, ob_type, H_DIV),
+     dof2nk(Dof)
 {
    const double *cp = poly1d.ClosedPoints(p + 1, cb_type);
    const double *op = poly1d.OpenPoints(p, ob_type);
@@ -10637,11 +10650,9 @@ const double ND_HexahedronElement::tk[18] =
 
 ND_HexahedronElement::ND_HexahedronElement(const int p,
                                            const int cb_type, const int ob_type)
-   : VectorFiniteElement(3, Geometry::CUBE, 3*p*(p + 1)*(p + 1), p,
-                         H_CURL, FunctionSpace::Qk),
-     cbasis1d(poly1d.GetBasis(p, VerifyClosed(cb_type))),
-     obasis1d(poly1d.GetBasis(p - 1, VerifyOpen(ob_type))),
-     dof_map(Dof), dof2tk(Dof)
+   : VectorTensorFiniteElement(3, 3*p*(p + 1)*(p + 1), p, p, p - 1,
+                               cb_type, ob_type, H_CURL),
+     dof2tk(Dof)
 {
    const double *cp = poly1d.ClosedPoints(p, cb_type);
    const double *op = poly1d.OpenPoints(p - 1, ob_type);
@@ -11009,11 +11020,9 @@ const double ND_QuadrilateralElement::tk[8] =
 ND_QuadrilateralElement::ND_QuadrilateralElement(const int p,
                                                  const int cb_type,
                                                  const int ob_type)
-   : VectorFiniteElement(2, Geometry::SQUARE, 2*p*(p + 1), p,
-                         H_CURL, FunctionSpace::Qk),
-     cbasis1d(poly1d.GetBasis(p, VerifyClosed(cb_type))),
-     obasis1d(poly1d.GetBasis(p - 1, VerifyOpen(ob_type))),
-     dof_map(Dof), dof2tk(Dof)
+   : VectorTensorFiniteElement(2, 2*p*(p + 1), p, p, p - 1,
+                               cb_type, ob_type, H_CURL),
+     dof2tk(Dof)
 {
    const double *cp = poly1d.ClosedPoints(p, cb_type);
    const double *op = poly1d.OpenPoints(p - 1, ob_type);
@@ -1752,6 +1752,41 @@ public:
                             const DofMapType dmtype);
 };
 
+/** @brief Base class for the Nedelec and Raviart-Thomas elements on squares and
+    cubes, where each vector component is a tensor product of 1D closed and open
+    bases.
+
+    The dof map returned by GetDofMap() maps the lexicographically ordered
+    indices of the components (first all x-component dofs, then all
+    y-component dofs, etc.) to the element dofs. A negative entry, -1-i,
+    indicates that the tensor basis function is -1 times the i-th basis
+    function of the element. */
+class VectorTensorFiniteElement : public VectorFiniteElement
+{
+protected:
+   const int cb_type, ob_type;
+   Poly_1D::Basis &cbasis1d, &obasis1d;
+   Array<int> dof_map;
+
+public:
+   /** @brief Construct a tensor vector element of dimension @a dims with @a d
+       dofs, order @a p, map type @a M, and 1D closed and open bases of orders
+       @a cp and @a op, respectively. */
+   VectorTensorFiniteElement(const int dims, const int d, const int p,
+                             const int cp, const int op,
+                             const int cbtype, const int obtype,
+                             const int M);
+
+   int GetClosedBasisType() const { return cb_type; }
+   int GetOpenBasisType() const { return ob_type; }
+
+   const Poly_1D::Basis &GetClosedBasis() const { return cbasis1d; }
+   const Poly_1D::Basis &GetOpenBasis() const { return obasis1d; }
+
+   /// Get the signed map from the lexicographic component dofs, see above.
+   const Array<int> &GetDofMap() const { return dof_map; }
+};
+
 class PositiveTensorFiniteElement : public PositiveFiniteElement,
    public TensorBasisElement
 {
@@ -2246,17 +2281,16 @@ public:
 };
 
 
-class RT_QuadrilateralElement : public VectorFiniteElement
+class RT_QuadrilateralElement : public VectorTensorFiniteElement
 {
 private:
    static const double nk[8];
 
-   Poly_1D::Basis &cbasis1d, &obasis1d;
 #ifndef MFEM_THREAD_SAFE
    mutable Vector shape_cx, shape_ox, shape_cy, shape_oy;
    mutable Vector dshape_cx, dshape_cy;
 #endif
-   Array<int> dof_map, dof2nk;
+   Array<int> dof2nk;
 
 public:
    RT_QuadrilateralElement(const int p,
@@ -2302,16 +2336,15 @@ public:
 };
 
 
-class RT_HexahedronElement : public VectorFiniteElement
+class RT_HexahedronElement : public VectorTensorFiniteElement
 {
    static const double nk[18];
 
-   Poly_1D::Basis &cbasis1d, &obasis1d;
 #ifndef MFEM_THREAD_SAFE
    mutable Vector shape_cx, shape_ox, shape_cy, shape_oy, shape_cz, shape_oz;
    mutable Vector dshape_cx, dshape_cy, dshape_cz;
 #endif
-   Array<int> dof_map, dof2nk;
+   Array<int> dof2nk;
 
 public:
    RT_HexahedronElement(const int p,
@@ -2456,16 +2489,15 @@ public:
 };
 
 
-class ND_HexahedronElement : public VectorFiniteElement
+class ND_HexahedronElement : public VectorTensorFiniteElement
 {
    static const double tk[18];
 
-   Poly_1D::Basis &cbasis1d, &obasis1d;
 #ifndef MFEM_THREAD_SAFE
    mutable Vector shape_cx, shape_ox, shape_cy, shape_oy, shape_cz, shape_oz;
    mutable Vector dshape_cx, dshape_cy, dshape_cz;
 #endif
-   Array<int> dof_map, dof2tk;
+   Array<int> dof2tk;
 
 public:
    ND_HexahedronElement(const int p,
@@ -2522,16 +2554,15 @@ public:
 };
 
 
-class ND_QuadrilateralElement : public VectorFiniteElement
+class ND_QuadrilateralElement : public VectorTensorFiniteElement
 {
    static const double tk[8];
 
-   Poly_1D::Basis &cbasis1d, &obasis1d;
 #ifndef MFEM_THREAD_SAFE
    mutable Vector shape_cx, shape_ox, shape_cy, shape_oy;
    mutable Vector dshape_cx, dshape_cy;
 #endif
-   Array<int> dof_map, dof2tk;
+   Array<int> dof2tk;
 
 public:
    ND_QuadrilateralElement(const int p,
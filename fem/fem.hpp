@@ -26,6 +26,9 @@
 #include "linearform.hpp"
 #include "nonlinearform.hpp"
 #include "bilinearform.hpp"
+#include "tbilinearform_registry.hpp"
+#include "multigrid.hpp"
+#include "lor.hpp"
 #include "hybridization.hpp"
 #include "datacollection.hpp"
 #include "estimators.hpp"
@@ -2190,6 +2190,92 @@ GridTransfer::GridTransfer(FiniteElementSpace &dom_fes_,
 #endif
 }
 
+PRefinementTransferOperator::PRefinementTransferOperator(
+   const FiniteElementSpace &lFESpace_, const FiniteElementSpace &hFESpace_)
+   : Operator(hFESpace_.GetVSize(), lFESpace_.GetVSize()),
+     lFESpace(lFESpace_), hFESpace(hFESpace_)
+{
+   MFEM_VERIFY(lFESpace.GetMesh() == hFESpace.GetMesh(),
+               "the two spaces must be defined on the same mesh");
+   MFEM_VERIFY(lFESpace.GetVDim() == hFESpace.GetVDim() &&
+               lFESpace.GetOrdering() == hFESpace.GetOrdering(),
+               "incompatible vector dimensions");
+   Mesh::GeometryList elem_geoms(*hFESpace.GetMesh());
+   IsoparametricTransformation isotr;
+   for (int i = 0; i < elem_geoms.Size(); i++)
+   {
+      const Geometry::Type geom = elem_geoms[i];
+      const FiniteElement *h_fe =
+         hFESpace.FEColl()->FiniteElementForGeometry(geom);
+      const FiniteElement *l_fe =
+         lFESpace.FEColl()->FiniteElementForGeometry(geom);
+      isotr.SetIdentityTransformation(geom);
+      localP[geom].SetSize(h_fe->GetDof(), l_fe->GetDof());
+      h_fe->GetTransferMatrix(*l_fe, isotr, localP[geom]);
+   }
+}
+
+void PRefinementTransferOperator::Mult(const Vector &x, Vector &y) const
+{
+   Mesh *mesh = hFESpace.GetMesh();
+   const int vdim = hFESpace.GetVDim();
+   Array<int> l_dofs, h_dofs, l_vdofs, h_vdofs;
+   Vector l_loc, h_loc;
+   for (int e = 0; e < mesh->GetNE(); e++)
+   {
+      lFESpace.GetElementDofs(e, l_dofs);
+      hFESpace.GetElementDofs(e, h_dofs);
+      const DenseMatrix &P = localP[mesh->GetElementBaseGeometry(e)];
+      h_loc.SetSize(h_dofs.Size());
+      for (int c = 0; c < vdim; c++)
+      {
+         l_vdofs = l_dofs; lFESpace.DofsToVDofs(c, l_vdofs);
+         h_vdofs = h_dofs; hFESpace.DofsToVDofs(c, h_vdofs);
+         x.GetSubVector(l_vdofs, l_loc);
+         P.Mult(l_loc, h_loc);
+         y.SetSubVector(h_vdofs, h_loc);
+      }
+   }
+}
+
+void PRefinementTransferOperator::MultTranspose(const Vector &x,
+                                                Vector &y) const
+{
+   // Each high-order dof is interpolated once: its row of the interpolation
+   // is the one of the first element containing it.
+   Mesh *mesh = hFESpace.GetMesh();
+   const int vdim = hFESpace.GetVDim();
+   Array<int> l_dofs, h_dofs, l_vdofs, h_vdofs;
+   Array<char> processed(hFESpace.GetNDofs());
+   Vector l_loc, h_loc;
+   processed = 0;
+   y = 0.0;
+   for (int e = 0; e < mesh->GetNE(); e++)
+   {
+      lFESpace.GetElementDofs(e, l_dofs);
+      hFESpace.GetElementDofs(e, h_dofs);
+      const DenseMatrix &P = localP[mesh->GetElementBaseGeometry(e)];
+      l_loc.SetSize(l_dofs.Size());
+      for (int c = 0; c < vdim; c++)
+      {
+         l_vdofs = l_dofs; lFESpace.DofsToVDofs(c, l_vdofs);
+         h_vdofs = h_dofs; hFESpace.DofsToVDofs(c, h_vdofs);
+         x.GetSubVector(h_vdofs, h_loc);
+         for (int i = 0; i < h_dofs.Size(); i++)
+         {
+            const int d = h_dofs[i] >= 0 ? h_dofs[i] : -1-h_dofs[i];
+            if (processed[d]) { h_loc(i) = 0.0; }
+         }
+         P.MultTranspose(h_loc, l_loc);
+         y.AddElementVector(l_vdofs, l_loc);
+      }
+      for (int i = 0; i < h_dofs.Size(); i++)
+      {
+         processed[h_dofs[i] >= 0 ? h_dofs[i] : -1-h_dofs[i]] = 1;
+      }
+   }
+}
+
 const Operator &GridTransfer::MakeTrueOperator(
    FiniteElementSpace &fes_in, FiniteElementSpace &fes_out,
    const Operator &oper, OperatorHandle &t_oper)
@@ -2318,7 +2404,13 @@ const Operator &InterpolationGridTransfer::ForwardOperator()
    }
 
    // Costruct F
-   if (oper_type == Operator::ANY_TYPE)
+   if (dom_fes.GetMesh() == ran_fes.GetMesh())
+   {
+      MFEM_VERIFY(oper_type == Operator::ANY_TYPE,
+                  "Operator::Type is not supported: " << oper_type);
+      F.Reset(new PRefinementTransferOperator(dom_fes, ran_fes));
+   }
+   else if (oper_type == Operator::ANY_TYPE)
    {
       F.Reset(new FiniteElementSpace::RefinementOperator(&ran_fes, &dom_fes));
    }
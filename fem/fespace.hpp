@@ -598,6 +598,33 @@ public:
 };
 
 
+/** @brief Transfer operator between two FE spaces of different orders on the
+    same mesh, e.g. for p-multigrid. */
+/** The action interpolates the low-order space at the nodes of the high-order
+    space, element by element, using the local interpolation matrices
+    FiniteElement::GetTransferMatrix(). The transpose is the exact transpose of
+    the interpolation, as needed for the restriction of residuals. Both spaces
+    must use the same map-type and the same (nodal) interpolation must be valid
+    in all elements sharing a dof, e.g. conforming H1 or L2 spaces. */
+class PRefinementTransferOperator : public Operator
+{
+protected:
+   const FiniteElementSpace &lFESpace; ///< Low-order (domain) space
+   const FiniteElementSpace &hFESpace; ///< High-order (range) space
+   DenseMatrix localP[Geometry::NumGeom];
+
+public:
+   PRefinementTransferOperator(const FiniteElementSpace &lFESpace_,
+                               const FiniteElementSpace &hFESpace_);
+
+   /// Interpolate the low-order vector @a x into the high-order vector @a y.
+   virtual void Mult(const Vector &x, Vector &y) const;
+
+   /// Apply the transpose of the interpolation.
+   virtual void MultTranspose(const Vector &x, Vector &y) const;
+};
+
+
 /** @brief Base class for transfer algorithms that construct transfer Operator%s
     between two finite element (FE) spaces. */
 /** Generally, the two FE spaces (domain and range) can be defined on different
@@ -693,7 +720,10 @@ public:
     (VALUE, INTEGRAL, H_DIV, H_CURL - see class FiniteElement). Generally, the
     FE spaces can have different orders, however, in order for the backward
     operator to be well-defined, the (local) number of the fine dofs should not
-    be smaller than the number of coarse dofs. */
+    be smaller than the number of coarse dofs.
+
+    If both FE spaces are defined on the same mesh, the forward operator is a
+    PRefinementTransferOperator, interpolating between the two orders. */
 class InterpolationGridTransfer : public GridTransfer
 {
 protected:
@@ -886,7 +886,8 @@ const IntegrationRule &IntegrationRules::Get(int GeomType, int Order)
 
    if (!HaveIntRule(*ir_array, Order))
    {
-#ifdef MFEM_USE_LEGACY_OPENMP
+#if defined(MFEM_USE_LEGACY_OPENMP) || \
+    (defined(MFEM_USE_OPENMP) && defined(MFEM_THREAD_SAFE))
       #pragma omp critical
 #endif
       {
@@ -12,6 +12,7 @@
 // Implementation of class LinearForm
 
 #include "fem.hpp"
+#include "bilinearform_ext.hpp"
 
 namespace mfem
 {
@@ -21,6 +22,8 @@ LinearForm::LinearForm(FiniteElementSpace *f, LinearForm *lf)
 {
    fes = f;
    extern_lfs = 1;
+   fast_assembly = lf->fast_assembly;
+   elem_restrict = NULL;
 
    // Copy the pointers to the integrators
    dlfi = lf->dlfi;
@@ -83,7 +86,37 @@ void LinearForm::Assemble()
 
    Vector::operator=(0.0);
 
-   if (dlfi.Size())
+   // Domain integrators assembled on all the elements at once
+   Array<bool> batched(dlfi.Size());
+   int num_batched = 0;
+   for (int k = 0; k < dlfi.Size(); k++)
+   {
+      batched[k] = fast_assembly && dlfi[k]->SupportsPA(*fes);
+      if (batched[k]) { num_batched++; }
+   }
+   if (num_batched)
+   {
+      if (elem_restrict && elem_restrict_sequence != fes->GetSequence())
+      {
+         DeleteElemRestriction();
+      }
+      if (!elem_restrict)
+      {
+         elem_restrict = new ElemRestriction(*fes);
+         elem_restrict_sequence = fes->GetSequence();
+      }
+      Vector b(elem_restrict->nedofs);
+      b = 0.0;
+      b.Push();
+      for (int k = 0; k < dlfi.Size(); k++)
+      {
+         if (batched[k]) { dlfi[k]->AssemblePA(*fes, b); }
+      }
+      elem_restrict->MultTranspose(b, *this);
+      Pull();
+   }
+
+   if (num_batched < dlfi.Size())
    {
       for (i = 0; i < fes -> GetNE(); i++)
       {
@@ -91,6 +124,7 @@ void LinearForm::Assemble()
          eltrans = fes -> GetElementTransformation (i);
          for (int k=0; k < dlfi.Size(); k++)
          {
+            if (batched[k]) { continue; }
             dlfi[k]->AssembleRHSElementVect(*fes->GetFE(i), *eltrans, elemvect);
             AddElementVector (vdofs, elemvect);
          }
@@ -190,6 +224,13 @@ void LinearForm::Update(FiniteElementSpace *f, Vector &v, int v_offset)
    fes = f;
    NewDataAndSize((double *)v + v_offset, fes->GetVSize());
    ResetDeltaLocations();
+   DeleteElemRestriction();
+}
+
+void LinearForm::DeleteElemRestriction()
+{
+   delete elem_restrict;
+   elem_restrict = NULL;
 }
 
 void LinearForm::AssembleDelta()
@@ -247,6 +288,7 @@ LinearForm & LinearForm::operator=(const Vector &v)
 
 LinearForm::~LinearForm()
 {
+   DeleteElemRestriction();
    if (!extern_lfs)
    {
       int k;
@@ -19,6 +19,8 @@
 namespace mfem
 {
 
+class ElemRestriction;
+
 /// Class for linear form - Vector with associated FE space and LFIntegrators.
 class LinearForm : public Vector
 {
@@ -56,6 +58,17 @@ protected:
    /// Force (re)computation of delta locations.
    void ResetDeltaLocations() { dlfi_delta_elem_id.SetSize(0); }
 
+   /// Use the batched assembly of the domain integrators, UseFastAssembly().
+   bool fast_assembly;
+
+   /** @brief Element restriction of #fes used by the batched assembly, built on
+       demand and deleted when #fes changes. */
+   ElemRestriction *elem_restrict;
+   long elem_restrict_sequence;
+
+   /// Delete the element restriction of the batched assembly.
+   void DeleteElemRestriction();
+
 private:
    /// Copy construction is not supported; body is undefined.
    LinearForm(const LinearForm &);
@@ -64,7 +77,7 @@ public:
    /// Creates linear form associated with FE space @a *f.
    /** The pointer @a f is not owned by the newly constructed object. */
    LinearForm(FiniteElementSpace *f) : Vector(f->GetVSize())
-   { fes = f; extern_lfs = 0; }
+   { fes = f; extern_lfs = 0; fast_assembly = false; elem_restrict = NULL; }
 
    /** @brief Create a LinearForm on the FiniteElementSpace @a f, using the
        same integrators as the LinearForm @a lf.
@@ -79,7 +92,8 @@ public:
    /** The associated FiniteElementSpace can be set later using one of the
        methods: Update(FiniteElementSpace *) or
        Update(FiniteElementSpace *, Vector &, int). */
-   LinearForm() { fes = NULL; extern_lfs = 0; }
+   LinearForm()
+   { fes = NULL; extern_lfs = 0; fast_assembly = false; elem_restrict = NULL; }
 
    /// Copy assignment. Only the data of the base class Vector is copied.
    /** It is assumed that this object and @a rhs use FiniteElementSpace%s that
@@ -144,6 +158,16 @@ public:
        corresponding pointer (to Array<int>) will be NULL. */
    Array<Array<int>*> *GetFLFI_Marker() { return &flfi_marker; }
 
+   /** @brief Enable or disable the batched assembly of the domain integrators.
+
+       When enabled, the domain integrators whose SupportsPA() method returns
+       true compute the element vectors of all the elements at once with
+       AssemblePA(), e.g. with device kernels, and the result is added to the
+       LinearForm with the ElemRestriction of the space. The other integrators
+       are assembled element by element. The batched assembly is disabled by
+       default. */
+   void UseFastAssembly(bool use_fa) { fast_assembly = use_fa; }
+
    /// Assembles the linear form i.e. sums over all domain/bdr integrators.
    void Assemble();
 
@@ -155,11 +179,15 @@ public:
        updated, e.g. after its associated Mesh object has been refined.
 
        @note This method does not perform assembly. */
-   void Update() { SetSize(fes->GetVSize()); ResetDeltaLocations(); }
+   void Update()
+   { SetSize(fes->GetVSize()); ResetDeltaLocations(); DeleteElemRestriction(); }
 
    /// Associate a new FE space, @a *f, with this object and Update() it. */
    void Update(FiniteElementSpace *f)
-   { fes = f; SetSize(f->GetVSize()); ResetDeltaLocations(); }
+   {
+      fes = f; SetSize(f->GetVSize()); ResetDeltaLocations();
+      DeleteElemRestriction();
+   }
 
    /** @brief Associate a new FE space, @a *f, with this object and use the data
        of @a v, offset by @a v_offset, to initialize this object's Vector::data.
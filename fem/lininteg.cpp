@@ -22,6 +22,12 @@ void LinearFormIntegrator::AssembleRHSElementVect(
    mfem_error("LinearFormIntegrator::AssembleRHSElementVect(...)");
 }
 
+void LinearFormIntegrator::AssemblePA(const FiniteElementSpace &fes,
+                                      Vector &b)
+{
+   mfem_error("LinearFormIntegrator::AssemblePA(...)");
+}
+
 
 void DomainLFIntegrator::AssembleRHSElementVect(const FiniteElement &el,
                                                 ElementTransformation &Tr,
@@ -18,6 +18,8 @@
 namespace mfem
 {
 
+class FiniteElementSpace;
+
 /// Abstract base class LinearFormIntegrator
 class LinearFormIntegrator
 {
@@ -39,6 +41,17 @@ public:
    void SetIntRule(const IntegrationRule *ir) { IntRule = ir; }
    const IntegrationRule* GetIntRule() { return IntRule; }
 
+   /** @brief Return true if the element vectors of all the elements of @a fes
+       can be computed at once with AssemblePA(). */
+   virtual bool SupportsPA(const FiniteElementSpace &fes) const
+   { return false; }
+
+   /** @brief Add the element vectors of all the elements of @a fes to the
+       E-vector @a b, in the layout of the ElemRestriction of @a fes. */
+   /** This batched assembly is used by LinearForm::Assemble() when enabled
+       with LinearForm::UseFastAssembly() and SupportsPA() returns true. */
+   virtual void AssemblePA(const FiniteElementSpace &fes, Vector &b);
+
    virtual ~LinearFormIntegrator() { }
 };
 
@@ -117,6 +130,14 @@ public:
                                          Vector &elvect);
 
    using LinearFormIntegrator::AssembleRHSElementVect;
+
+   /** @brief The batched assembly is supported for non-delta coefficients on
+       scalar spaces of tensor product elements in 2D and 3D. */
+   virtual bool SupportsPA(const FiniteElementSpace &fes) const;
+
+   /** @brief The coefficient is evaluated at all the quadrature points in one
+       pass and the transposed basis is applied by sum factorization. */
+   virtual void AssemblePA(const FiniteElementSpace &fes, Vector &b);
 };
 
 /// Class for boundary integration L(v) := (g, v)
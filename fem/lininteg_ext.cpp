@@ -0,0 +1,208 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+// Batched assembly of the linear form integrators on all the elements
+
+#include "../general/forall.hpp"
+#include "lininteg.hpp"
+#include "bilininteg.hpp"
+
+namespace mfem
+{
+
+// Quadrature data of the DomainLFIntegrator: D(q,e) = w(q) det(J) f, where f is
+// the constant C0 when F and c are NULL, the function F at the coordinates X,
+// or the values c(q,e).
+static void PADomainLFSetup(const int dim, const int NQ, const int NE,
+                            const double *w, const double *detj,
+                            const double C0, DeviceFunctionCoefficientPtr F,
+                            const double *_X, const double *_c, double *_D)
+{
+   const bool use_c = _c, use_F = F;
+   const DeviceVector W(w, NQ);
+   const DeviceMatrix detJ(detj, NQ, NE);
+   const DeviceTensor<3> X(_X, dim, NQ, use_F ? NE : 0);
+   const DeviceMatrix c(_c, NQ, use_c ? NE : 0);
+   DeviceMatrix D(_D, NQ, NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int q = 0; q < NQ; ++q)
+      {
+         const double f =
+         use_c ? c(q,e)
+         : use_F ? F(Vector3(X(0,q,e), X(1,q,e), dim == 3 ? X(2,q,e) : 0.0))
+         : C0;
+         D(q,e) = W(q) * detJ(q,e) * f;
+      }
+   });
+}
+
+// Add B^T D to the E-vector y, contracted first in x, then in y.
+static void PADomainLFApply2D(const int D1D, const int Q1D, const int NE,
+                              const double *b, const double *_D, double *_y)
+{
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const DeviceMatrix B(b, Q1D, D1D);
+   const DeviceTensor<3> D(_D, Q1D, Q1D, NE);
+   DeviceTensor<3> y(_y, D1D, D1D, NE);
+   MFEM_FORALL(e, NE,
+   {
+      double sol_x[MAX_Q1D][MAX_D1D];
+      for (int qy = 0; qy < Q1D; ++qy)
+      {
+         for (int dx = 0; dx < D1D; ++dx)
+         {
+            double s = 0.0;
+            for (int qx = 0; qx < Q1D; ++qx) { s += B(qx,dx) * D(qx,qy,e); }
+            sol_x[qy][dx] = s;
+         }
+      }
+      for (int dy = 0; dy < D1D; ++dy)
+      {
+         for (int dx = 0; dx < D1D; ++dx)
+         {
+            double s = 0.0;
+            for (int qy = 0; qy < Q1D; ++qy) { s += B(qy,dy) * sol_x[qy][dx]; }
+            y(dx,dy,e) += s;
+         }
+      }
+   });
+}
+
+// Add B^T D to the E-vector y, contracted in x, y, then z.
+static void PADomainLFApply3D(const int D1D, const int Q1D, const int NE,
+                              const double *b, const double *_D, double *_y)
+{
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const DeviceMatrix B(b, Q1D, D1D);
+   const DeviceTensor<4> D(_D, Q1D, Q1D, Q1D, NE);
+   DeviceTensor<4> y(_y, D1D, D1D, D1D, NE);
+   MFEM_FORALL(e, NE,
+   {
+      double sol_x[MAX_Q1D][MAX_Q1D][MAX_D1D];
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int qy = 0; qy < Q1D; ++qy)
+         {
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               double s = 0.0;
+               for (int qx = 0; qx < Q1D; ++qx)
+               {
+                  s += B(qx,dx) * D(qx,qy,qz,e);
+               }
+               sol_x[qz][qy][dx] = s;
+            }
+         }
+      }
+      double sol_xy[MAX_Q1D][MAX_D1D][MAX_D1D];
+      for (int qz = 0; qz < Q1D; ++qz)
+      {
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               double s = 0.0;
+               for (int qy = 0; qy < Q1D; ++qy)
+               {
+                  s += B(qy,dy) * sol_x[qz][qy][dx];
+               }
+               sol_xy[qz][dy][dx] = s;
+            }
+         }
+      }
+      for (int dz = 0; dz < D1D; ++dz)
+      {
+         for (int dy = 0; dy < D1D; ++dy)
+         {
+            for (int dx = 0; dx < D1D; ++dx)
+            {
+               double s = 0.0;
+               for (int qz = 0; qz < Q1D; ++qz)
+               {
+                  s += B(qz,dz) * sol_xy[qz][dy][dx];
+               }
+               y(dx,dy,dz,e) += s;
+            }
+         }
+      }
+   });
+}
+
+// The integration rule of DomainLFIntegrator::AssembleRHSElementVect().
+static const IntegrationRule &DomainLFRule(const IntegrationRule *ir,
+                                           const FiniteElement &el,
+                                           const int oa, const int ob)
+{
+   return ir ? *ir : IntRules.Get(el.GetGeomType(), oa*el.GetOrder() + ob);
+}
+
+bool DomainLFIntegrator::SupportsPA(const FiniteElementSpace &fes) const
+{
+   const Mesh *mesh = fes.GetMesh();
+   const int dim = mesh->Dimension();
+   if (IsDelta() || fes.GetNE() == 0 || fes.GetVDim() != 1 ||
+       (dim != 2 && dim != 3) || !ElementBatches::UsesTensorLayout(fes))
+   {
+      return false;
+   }
+   const FiniteElement &el = *fes.GetFE(0);
+   if (!dynamic_cast<const TensorBasisElement*>(&el)) { return false; }
+   const IntegrationRule &ir = DomainLFRule(IntRule, el, oa, ob);
+   const int D1D = el.GetOrder() + 1;
+   const int Q1D = IntRules.Get(Geometry::SEGMENT, ir.GetOrder()).GetNPoints();
+   return D1D <= MAX_D1D && Q1D <= MAX_Q1D &&
+          ir.GetNPoints() == (dim == 2 ? Q1D*Q1D : Q1D*Q1D*Q1D);
+}
+
+void DomainLFIntegrator::AssemblePA(const FiniteElementSpace &fes, Vector &b)
+{
+   MFEM_ASSERT(SupportsPA(fes), "batched assembly is not supported");
+   Mesh *mesh = fes.GetMesh();
+   const int dim = mesh->Dimension();
+   const int NE = fes.GetNE();
+   const FiniteElement &el = *fes.GetFE(0);
+   const IntegrationRule &ir = DomainLFRule(IntRule, el, oa, ob);
+   const IntegrationRule &ir1D = IntRules.Get(Geometry::SEGMENT, ir.GetOrder());
+   const int NQ = ir.GetNPoints();
+   const int D1D = el.GetOrder() + 1;
+   const int Q1D = ir1D.GetNPoints();
+
+   Array<double> B;
+   PABasis1D(el, ir1D, B, NULL);
+   Vector W(NQ);
+   for (int q = 0; q < NQ; ++q) { W(q) = ir.IntPoint(q).weight; }
+   W.Push();
+
+   // Constants and functions of the coordinates are evaluated in the setup
+   // kernel, the other coefficients at all the points in one host pass.
+   ConstantCoefficient *const_coeff = dynamic_cast<ConstantCoefficient*>(&Q);
+   FunctionCoefficient *function_coeff = dynamic_cast<FunctionCoefficient*>(&Q);
+   DeviceFunctionCoefficientPtr F =
+      function_coeff ? function_coeff->GetDeviceFunction() : NULL;
+   const int flags = GeometricFactors::DETERMINANTS |
+                     (F ? GeometricFactors::COORDINATES : 0);
+   const GeometricFactors *geom = mesh->GetGeometricFactors(ir, flags);
+   Vector coeff;
+   if (!const_coeff && !F) { EvalPACoefficient(&Q, fes, ir, coeff); }
+
+   Vector D(NQ*NE);
+   PADomainLFSetup(dim, NQ, NE, W, geom->detJ,
+                   const_coeff ? const_coeff->constant : 0.0, F,
+                   F ? geom->X.GetData() : NULL,
+                   coeff.Size() ? coeff.GetData() : NULL, D);
+   if (dim == 2) { PADomainLFApply2D(D1D, Q1D, NE, B, D, b); }
+   else { PADomainLFApply3D(D1D, Q1D, NE, B, D, b); }
+}
+
+}
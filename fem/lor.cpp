@@ -0,0 +1,82 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+// Implementation of the low-order-refined preconditioner
+
+#include "lor.hpp"
+#include "../linalg/linalg.hpp"
+
+namespace mfem
+{
+
+LORSolver::LORSolver(BilinearForm &a_ho, const Array<int> &ess_tdof_list,
+                     int ref_type)
+   : Solver(a_ho.FESpace()->GetTrueVSize()), solver(NULL), own_solver(false)
+{
+   const FiniteElementSpace &fes_ho = *a_ho.FESpace();
+   Mesh *mesh = fes_ho.GetMesh();
+   const H1_FECollection *fec_ho =
+      dynamic_cast<const H1_FECollection*>(fes_ho.FEColl());
+   MFEM_VERIFY(fec_ho && !mesh->Nonconforming(),
+               "an H1 space on a conforming mesh is required");
+#ifdef MFEM_USE_MPI
+   MFEM_VERIFY(!dynamic_cast<ParBilinearForm*>(&a_ho),
+               "LORSolver does not support ParBilinearForm");
+#endif
+   const int order = fes_ho.GetFE(0)->GetOrder();
+   if (ref_type < 0) { ref_type = fec_ho->GetBasisType(); }
+   fec_lor = new H1_FECollection(1, mesh->Dimension());
+
+   mesh_lor = new Mesh(mesh, order, ref_type);
+   fes_lor = new FiniteElementSpace(mesh_lor, fec_lor, fes_ho.GetVDim(),
+                                    fes_ho.GetOrdering());
+   a_lor = new BilinearForm(fes_lor, &a_ho);
+   MFEM_VERIFY(fes_lor->GetVSize() == fes_ho.GetVSize() &&
+               fes_lor->GetTrueVSize() == height,
+               "the LOR space does not match the high-order space");
+
+   // The true dofs of the two spaces are the same, so are the essential ones.
+   a_lor->Assemble();
+   a_lor->FormSystemMatrix(ess_tdof_list, A_lor);
+
+   SetSolver(new GSSmoother);
+}
+
+void LORSolver::SetSolver(Solver *s, bool own)
+{
+   if (own_solver) { delete solver; }
+   solver = s;
+   own_solver = own;
+   solver->iterative_mode = false;
+   solver->SetOperator(*A_lor);
+}
+
+void LORSolver::Mult(const Vector &b, Vector &x) const
+{
+   solver->Mult(b, x);
+}
+
+void LORSolver::SetOperator(const Operator &op)
+{
+   MFEM_VERIFY(op.Height() == height && op.Width() == width,
+               "the operator does not match the LOR operator");
+}
+
+LORSolver::~LORSolver()
+{
+   if (own_solver) { delete solver; }
+   delete a_lor;
+   delete fes_lor;
+   delete fec_lor;
+   delete mesh_lor;
+}
+
+}
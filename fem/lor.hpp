@@ -0,0 +1,84 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#ifndef MFEM_LOR
+#define MFEM_LOR
+
+#include "../config/config.hpp"
+#include "bilinearform.hpp"
+#ifdef MFEM_USE_MPI
+#include "pbilinearform.hpp"
+#endif
+
+namespace mfem
+{
+
+/** @brief Low-order-refined (LOR) preconditioner for a high-order H1
+    BilinearForm, e.g. a partially assembled one.
+
+    The mesh of the high-order space of order p is refined with
+    Mesh(Mesh*, int, int) with refinement factor p,
+    placing the new vertices at the nodes of the high-order basis. The refined
+    vertices are numbered as the dofs of the high-order space, so the order 1
+    space on the LOR mesh has the same (true) dofs as the high-order space. The
+    LOR form uses the integrators of the high-order form and is fully assembled
+    into a SparseMatrix, which is spectrally equivalent to the high-order
+    operator. The preconditioner applies a solver of the LOR matrix, by default
+    GSSmoother.
+
+    The high-order space must be an H1 space with a closed nodal basis, e.g.
+    BasisType::GaussLobatto, on a conforming mesh of segments, quadrilaterals
+    or hexahedra. ParBilinearForm is not supported. */
+class LORSolver : public Solver
+{
+protected:
+   Mesh *mesh_lor;
+   FiniteElementCollection *fec_lor;
+   FiniteElementSpace *fes_lor;
+   BilinearForm *a_lor;
+   OperatorHandle A_lor;
+   Solver *solver;
+   bool own_solver;
+
+public:
+   /** @brief Assemble the LOR operator of the form @a a_ho with the essential
+       true dofs @a ess_tdof_list of the high-order space.
+
+       The vertices of the LOR mesh are placed at the points of @a ref_type;
+       by default the basis type of the high-order H1_FECollection is used. */
+   LORSolver(BilinearForm &a_ho, const Array<int> &ess_tdof_list,
+             int ref_type = -1);
+
+   /** @brief Replace the solver of the LOR system, e.g. with UMFPackSolver or
+       AMGSolver. The operator of @a s is set to the LOR matrix and its
+       iterative_mode is disabled. */
+   void SetSolver(Solver *s, bool own = true);
+
+   /// Return the assembled LOR operator, a SparseMatrix.
+   const Operator &GetAssembledOperator() const { return *A_lor.Ptr(); }
+
+   /// Return the order 1 space on the LOR mesh.
+   const FiniteElementSpace &GetLORSpace() const { return *fes_lor; }
+
+   /// Return the solver of the LOR system.
+   Solver &GetSolver() const { return *solver; }
+
+   virtual void Mult(const Vector &b, Vector &x) const;
+
+   /// The operator is defined by the high-order form.
+   virtual void SetOperator(const Operator &op);
+
+   virtual ~LORSolver();
+};
+
+}
+
+#endif
@@ -0,0 +1,794 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+// Implementation of the multigrid solvers
+
+#include "multigrid.hpp"
+#include "../linalg/linalg.hpp"
+
+namespace mfem
+{
+
+ConstrainedTransferOperator::ConstrainedTransferOperator(
+   const Operator &P_, const Array<int> &coarse_ess_tdof_list,
+   const Array<int> &fine_ess_tdof_list)
+   : Operator(P_.Height(), P_.Width()), P(P_),
+     coarse_ess_tdofs(coarse_ess_tdof_list),
+     fine_ess_tdofs(fine_ess_tdof_list), zc(P_.Width()), zf(P_.Height())
+{ }
+
+void ConstrainedTransferOperator::Mult(const Vector &x, Vector &y) const
+{
+   zc = x;
+   zc.SetSubVector(coarse_ess_tdofs, 0.0);
+   P.Mult(zc, y);
+   y.SetSubVector(fine_ess_tdofs, 0.0);
+}
+
+void ConstrainedTransferOperator::MultTranspose(const Vector &x,
+                                                Vector &y) const
+{
+   zf = x;
+   zf.SetSubVector(fine_ess_tdofs, 0.0);
+   P.MultTranspose(zf, y);
+   y.SetSubVector(coarse_ess_tdofs, 0.0);
+}
+
+
+MultigridSolver::MultigridSolver()
+   : Solver(0, false), cycle_type(1), pre_smoothing_steps(1),
+     post_smoothing_steps(1)
+{ }
+
+void MultigridSolver::AddLevel(Operator *op, Solver *smoother,
+                               Operator *prolongation, bool own_op,
+                               bool own_smoother, bool own_prolongation)
+{
+   MFEM_VERIFY(op && smoother, "the operator and smoother must be given");
+   MFEM_VERIFY((NumLevels() == 0) == (prolongation == NULL),
+               "a prolongation is required on all levels but the coarsest");
+   if (prolongation)
+   {
+      MFEM_VERIFY(prolongation->Height() == op->Height() &&
+                  prolongation->Width() == operators.Last()->Height(),
+                  "invalid prolongation size");
+   }
+   smoother->iterative_mode = false;
+   operators.Append(op);
+   smoothers.Append(smoother);
+   prolongations.Append(prolongation);
+   own_operators.Append(own_op);
+   own_smoothers.Append(own_smoother);
+   own_prolongations.Append(own_prolongation);
+   X.Append(new Vector(op->Height()));
+   B.Append(new Vector(op->Height()));
+   R.Append(new Vector(op->Height()));
+   Z.Append(new Vector(op->Height()));
+   height = width = op->Height();
+}
+
+void MultigridSolver::SetCycle(int cycle_type_, int pre_smoothing_steps_,
+                               int post_smoothing_steps_)
+{
+   MFEM_VERIFY(cycle_type_ > 0 && pre_smoothing_steps_ >= 0 &&
+               post_smoothing_steps_ >= 0, "invalid cycle");
+   cycle_type = cycle_type_;
+   pre_smoothing_steps = pre_smoothing_steps_;
+   post_smoothing_steps = post_smoothing_steps_;
+}
+
+void MultigridSolver::Smooth(int level, int steps) const
+{
+   Vector &x = *X[level], &b = *B[level], &r = *R[level], &z = *Z[level];
+   for (int s = 0; s < steps; s++)
+   {
+      operators[level]->Mult(x, r);
+      subtract(b, r, r);
+      smoothers[level]->Mult(r, z);
+      x += z;
+   }
+}
+
+void MultigridSolver::Cycle(int level) const
+{
+   if (level == 0)
+   {
+      smoothers[0]->Mult(*B[0], *X[0]);
+      return;
+   }
+   Smooth(level, pre_smoothing_steps);
+   for (int c = 0; c < cycle_type; c++)
+   {
+      operators[level]->Mult(*X[level], *R[level]);
+      subtract(*B[level], *R[level], *R[level]);
+      prolongations[level]->MultTranspose(*R[level], *B[level-1]);
+      *X[level-1] = 0.0;
+      Cycle(level-1);
+      prolongations[level]->Mult(*X[level-1], *Z[level]);
+      *X[level] += *Z[level];
+   }
+   Smooth(level, post_smoothing_steps);
+}
+
+void MultigridSolver::Mult(const Vector &b, Vector &x) const
+{
+   MFEM_VERIFY(NumLevels() > 0, "no levels");
+   const int fine = NumLevels() - 1;
+   if (iterative_mode)
+   {
+      operators[fine]->Mult(x, *B[fine]);
+      subtract(b, *B[fine], *B[fine]);
+   }
+   else
+   {
+      *B[fine] = b;
+   }
+   *X[fine] = 0.0;
+   Cycle(fine);
+   if (iterative_mode) { x += *X[fine]; }
+   else { x = *X[fine]; }
+}
+
+void MultigridSolver::SetOperator(const Operator &op)
+{
+   MFEM_VERIFY(NumLevels() > 0 && op.Height() == height && op.Width() == width,
+               "the operator does not match the finest level");
+}
+
+void MultigridSolver::ClearLevels()
+{
+   for (int l = 0; l < NumLevels(); l++)
+   {
+      if (own_operators[l]) { delete operators[l]; }
+      if (own_smoothers[l]) { delete smoothers[l]; }
+      if (own_prolongations[l]) { delete prolongations[l]; }
+      delete X[l];
+      delete B[l];
+      delete R[l];
+      delete Z[l];
+   }
+   operators.SetSize(0);
+   smoothers.SetSize(0);
+   prolongations.SetSize(0);
+   own_operators.SetSize(0);
+   own_smoothers.SetSize(0);
+   own_prolongations.SetSize(0);
+   X.SetSize(0);
+   B.SetSize(0);
+   R.SetSize(0);
+   Z.SetSize(0);
+   height = width = 0;
+}
+
+MultigridSolver::~MultigridSolver()
+{
+   ClearLevels();
+}
+
+
+PMultigridSolver::PMultigridSolver(FiniteElementSpace &fes,
+                                   const Array<int> &ess_bdr,
+                                   Coefficient *coeff, int cheby_order)
+   : coarse_prec(NULL)
+{
+   Mesh *mesh = fes.GetMesh();
+   const H1_FECollection *fine_fec =
+      dynamic_cast<const H1_FECollection*>(fes.FEColl());
+   MFEM_VERIFY(fine_fec && fes.GetVDim() == 1 &&
+               fes.GetConformingProlongation() == NULL,
+               "a conforming scalar H1 space is required");
+#ifdef MFEM_USE_MPI
+   MFEM_VERIFY(!dynamic_cast<ParFiniteElementSpace*>(&fes),
+               "PMultigridSolver does not support ParFiniteElementSpace");
+#endif
+   const int dim = mesh->Dimension();
+   const int btype = fine_fec->GetBasisType();
+
+   // Orders of the levels, from the coarsest to the finest.
+   Array<int> orders;
+   for (int p = fes.GetFE(0)->GetOrder(); p > 1; p /= 2) { orders.Prepend(p); }
+   orders.Prepend(1);
+
+   for (int l = 0; l < orders.Size(); l++)
+   {
+      const bool finest = (l == orders.Size() - 1);
+      FiniteElementCollection *fec = NULL;
+      FiniteElementSpace *space = &fes;
+      if (!finest)
+      {
+         fec = new H1_FECollection(orders[l], dim, btype);
+         space = new FiniteElementSpace(mesh, fec);
+      }
+      fecs.Append(fec);
+      spaces.Append(space);
+
+      Array<int> *ess = new Array<int>;
+      space->GetEssentialTrueDofs(ess_bdr, *ess);
+      ess_tdofs.Append(ess);
+
+      BilinearForm *form = new BilinearForm(space);
+      if (l > 0) { form->SetAssemblyLevel(AssemblyLevel::PARTIAL); }
+      form->AddDomainIntegrator(coeff ? new DiffusionIntegrator(*coeff) :
+                                new DiffusionIntegrator);
+      form->Assemble();
+      if (l == 0) { form->Finalize(); }
+      forms.Append(form);
+      OperatorHandle *A = new OperatorHandle;
+      form->FormSystemMatrix(*ess, *A);
+      handles.Append(A);
+
+      Solver *smoother;
+      Operator *P = NULL;
+      if (l == 0)
+      {
+         SparseMatrix &A0 = *A->As<SparseMatrix>();
+#ifdef MFEM_USE_SUITESPARSE
+         smoother = new UMFPackSolver(A0);
+#else
+         coarse_prec = new GSSmoother(A0);
+         CGSolver *cg = new CGSolver;
+         cg->SetRelTol(1e-12);
+         cg->SetMaxIter(1000);
+         cg->SetPrintLevel(-1);
+         cg->SetPreconditioner(*coarse_prec);
+         cg->SetOperator(A0);
+         smoother = cg;
+#endif
+         transfers.Append(NULL);
+      }
+      else
+      {
+         Vector diag;
+         form->AssembleDiagonal(diag);
+         smoother = new OperatorChebyshevSmoother(A->Ptr(), diag, *ess,
+                                                  cheby_order);
+         InterpolationGridTransfer *T =
+            new InterpolationGridTransfer(*spaces[l-1], *space);
+         transfers.Append(T);
+         P = new ConstrainedTransferOperator(T->TrueForwardOperator(),
+                                             *ess_tdofs[l-1], *ess);
+      }
+      AddLevel(A->Ptr(), smoother, P, false, true, true);
+   }
+}
+
+PMultigridSolver::~PMultigridSolver()
+{
+   delete coarse_prec;
+   for (int l = 0; l < NumLevels(); l++)
+   {
+      delete handles[l];
+      delete transfers[l];
+      delete forms[l];
+      delete ess_tdofs[l];
+      if (fecs[l])
+      {
+         delete spaces[l];
+         delete fecs[l];
+      }
+   }
+}
+
+
+HMultigridSolver::HMultigridSolver(FiniteElementSpace &fes_)
+   : fes(fes_), sequence(fes_.GetSequence()), ndofs(0), last_cP(NULL)
+#ifdef MFEM_USE_MPI
+   , last_PT(NULL)
+#endif
+{
+   fes.SetUpdateOperatorType(Operator::MFEM_SPARSEMAT);
+}
+
+void HMultigridSolver::SaveLevel(const Array<int> &ess_tdof_list)
+{
+   ess_tdofs.Append(new Array<int>(ess_tdof_list));
+   sequence = fes.GetSequence();
+   ndofs = fes.GetVSize();
+   delete last_cP;
+   last_cP = NULL;
+#ifdef MFEM_USE_MPI
+   delete last_PT;
+   last_PT = NULL;
+   ParFiniteElementSpace *pfes = dynamic_cast<ParFiniteElementSpace*>(&fes);
+   if (pfes)
+   {
+      last_PT = pfes->Dof_TrueDof_Matrix()->Transpose();
+      return;
+   }
+#endif
+   const SparseMatrix *cP = fes.GetConformingProlongation();
+   if (cP) { last_cP = new SparseMatrix(*cP); }
+}
+
+Operator *HMultigridSolver::AssembleProlongation(const SparseMatrix &T) const
+{
+#ifdef MFEM_USE_MPI
+   ParFiniteElementSpace *pfes = dynamic_cast<ParFiniteElementSpace*>(&fes);
+   if (pfes)
+   {
+      // P = R_f T P_c, where the local product R_f T multiplies the rows of
+      // the coarse Dof_TrueDof_Matrix P_c.
+      SparseMatrix *RT = mfem::Mult(*pfes->GetRestrictionMatrix(), T);
+      HypreParMatrix *Pc = last_PT->Transpose();
+      HypreParMatrix *P = Pc->LeftDiagMult(*RT, pfes->GetTrueDofOffsets());
+      delete Pc;
+      delete RT;
+      return P;
+   }
+#endif
+   const SparseMatrix *cR = fes.GetConformingRestriction();
+   SparseMatrix *P = cR ? mfem::Mult(*cR, T) : new SparseMatrix(T);
+   if (last_cP)
+   {
+      SparseMatrix *RTP = mfem::Mult(*P, *last_cP);
+      delete P;
+      P = RTP;
+   }
+   return P;
+}
+
+void HMultigridSolver::AddCoarseLevel(Operator *op, Solver *solver,
+                                      const Array<int> &ess_tdof_list,
+                                      bool own_op, bool own_solver)
+{
+   MFEM_VERIFY(NumLevels() == 0, "the coarse level is already defined");
+   AddLevel(op, solver, NULL, own_op, own_solver, false);
+   transfer_mats.Append(NULL);
+   SaveLevel(ess_tdof_list);
+}
+
+void HMultigridSolver::AddRefinedLevel(Operator *op, Solver *smoother,
+                                       const Array<int> &ess_tdof_list,
+                                       bool own_op, bool own_smoother)
+{
+   MFEM_VERIFY(NumLevels() > 0, "the coarse level must be added first");
+   const SparseMatrix *T =
+      dynamic_cast<const SparseMatrix*>(fes.GetUpdateOperator());
+   MFEM_VERIFY(fes.GetSequence() != sequence &&
+               fes.GetMesh()->GetLastOperation() == Mesh::REFINE &&
+               T && T->Width() == ndofs && T->Height() == fes.GetVSize(),
+               "the mesh must be refined once between two levels, and the"
+               " update operator type must be Operator::MFEM_SPARSEMAT");
+   Operator *P = AssembleProlongation(*T);
+   transfer_mats.Append(P);
+   Array<int> &coarse_ess = *ess_tdofs.Last();
+   SaveLevel(ess_tdof_list);
+   AddLevel(op, smoother,
+            new ConstrainedTransferOperator(*P, coarse_ess, *ess_tdofs.Last()),
+            own_op, own_smoother, true);
+}
+
+HMultigridSolver::~HMultigridSolver()
+{
+   for (int l = 0; l < transfer_mats.Size(); l++)
+   {
+      delete transfer_mats[l];
+      delete ess_tdofs[l];
+   }
+   delete last_cP;
+#ifdef MFEM_USE_MPI
+   delete last_PT;
+#endif
+}
+
+
+AMGSolver::AMGSolver()
+   : block_size(1), by_nodes(false), theta(0.08), max_levels(10),
+     coarse_size(200), smoother_type(GAUSS_SEIDEL), coarse_prec(NULL)
+{ }
+
+AMGSolver::AMGSolver(const SparseMatrix &A)
+   : block_size(1), by_nodes(false), theta(0.08), max_levels(10),
+     coarse_size(200), smoother_type(GAUSS_SEIDEL), coarse_prec(NULL)
+{
+   SetOperator(A);
+}
+
+void AMGSolver::SetSystemsOptions(int dim, bool order_bynodes)
+{
+   MFEM_VERIFY(dim > 0, "invalid number of dofs per node");
+   block_size = dim;
+   by_nodes = order_bynodes;
+   near_null.Clear();
+}
+
+void AMGSolver::SetElasticityOptions(FiniteElementSpace *fes)
+{
+   const int dim = fes->GetMesh()->SpaceDimension();
+   MFEM_VERIFY(fes->GetVDim() == dim,
+               "the vector dimension must be the space dimension");
+   SetSystemsOptions(dim, fes->GetOrdering() == Ordering::byNODES);
+
+   // The translations, and the rotations in the planes (i,j) computed from
+   // the coordinates of the dofs.
+   GridFunction coords(fes);
+   VectorFunctionCoefficient x_coeff(dim, [](const Vector &x, Vector &y)
+   { y = x; });
+   coords.ProjectCoefficient(x_coeff);
+   const int ndofs = fes->GetNDofs();
+   DenseMatrix rbms(fes->GetVSize(), dim*(dim+1)/2);
+   rbms = 0.0;
+   for (int i = 0, m = dim; i < dim; i++)
+   {
+      for (int n = 0; n < ndofs; n++) { rbms(fes->DofToVDof(n, i), i) = 1.0; }
+      for (int j = i+1; j < dim; j++, m++)
+      {
+         for (int n = 0; n < ndofs; n++)
+         {
+            const int vi = fes->DofToVDof(n, i), vj = fes->DofToVDof(n, j);
+            rbms(vi, m) = -coords(vj);
+            rbms(vj, m) = coords(vi);
+         }
+      }
+   }
+
+   const SparseMatrix *R = fes->GetConformingRestriction();
+   if (!R)
+   {
+      near_null = rbms;
+      return;
+   }
+   near_null.SetSize(R->Height(), rbms.Width());
+   for (int m = 0; m < rbms.Width(); m++)
+   {
+      Vector rbm, true_rbm;
+      rbms.GetColumnReference(m, rbm);
+      near_null.GetColumnReference(m, true_rbm);
+      R->Mult(rbm, true_rbm);
+   }
+}
+
+int AMGSolver::Aggregate(const SparseMatrix &A, int bs, bool bynodes,
+                         Array<int> &agg) const
+{
+   const int nn = A.Height()/bs;
+   const int *Ip = A.GetI(), *Jp = A.GetJ();
+   const double *Ap = A.GetData();
+
+   // Squared Frobenius norms of the nonzero blocks of the node rows. The
+   // position of node J in the current node row I is pos[J] if >= NI[I].
+   Array<int> NI(nn+1), NJ, pos(nn);
+   Array<double> NV;
+   Vector diag(nn);
+   pos = -1;
+   NI[0] = 0;
+   diag = 0.0;
+   for (int I = 0; I < nn; I++)
+   {
+      for (int c = 0; c < bs; c++)
+      {
+         const int i = bynodes ? c*nn + I : I*bs + c;
+         for (int k = Ip[i]; k < Ip[i+1]; k++)
+         {
+            const int J = bynodes ? Jp[k] % nn : Jp[k]/bs;
+            if (pos[J] < NI[I])
+            {
+               pos[J] = NJ.Size();
+               NJ.Append(J);
+               NV.Append(0.0);
+            }
+            NV[pos[J]] += Ap[k]*Ap[k];
+         }
+      }
+      NI[I+1] = NJ.Size();
+      if (pos[I] >= NI[I]) { diag(I) = NV[pos[I]]; }
+   }
+
+   // Strong connections, with their relative strength
+   Array<int> SI(nn+1), SJ;
+   Array<double> SV;
+   SI[0] = 0;
+   for (int I = 0; I < nn; I++)
+   {
+      for (int k = NI[I]; k < NI[I+1]; k++)
+      {
+         const int J = NJ[k];
+         const double djj = sqrt(diag(I)*diag(J));
+         if (J != I && NV[k] > 0.0 && NV[k] >= theta*theta*djj)
+         {
+            SJ.Append(J);
+            SV.Append(NV[k]/djj);
+         }
+      }
+      SI[I+1] = SJ.Size();
+   }
+
+   // Phase 1: the nodes whose strong neighbors are all free form aggregates
+   // with them.
+   agg.SetSize(nn);
+   agg = -1;
+   int naggs = 0;
+   for (int I = 0; I < nn; I++)
+   {
+      if (agg[I] >= 0 || SI[I] == SI[I+1]) { continue; }
+      bool free = true;
+      for (int k = SI[I]; k < SI[I+1] && free; k++)
+      {
+         free = (agg[SJ[k]] < 0);
+      }
+      if (!free) { continue; }
+      agg[I] = naggs;
+      for (int k = SI[I]; k < SI[I+1]; k++) { agg[SJ[k]] = naggs; }
+      naggs++;
+   }
+
+   // Phase 2: the remaining nodes join the aggregate of their strongest
+   // neighbor aggregated in phase 1.
+   Array<int> agg1(agg);
+   for (int I = 0; I < nn; I++)
+   {
+      if (agg[I] >= 0 || SI[I] == SI[I+1]) { continue; }
+      double max_s = 0.0;
+      for (int k = SI[I]; k < SI[I+1]; k++)
+      {
+         if (agg1[SJ[k]] >= 0 && SV[k] > max_s)
+         {
+            agg[I] = agg1[SJ[k]];
+            max_s = SV[k];
+         }
+      }
+   }
+
+   // Phase 3: the nodes left form aggregates with their free strong
+   // neighbors.
+   for (int I = 0; I < nn; I++)
+   {
+      if (agg[I] >= 0 || SI[I] == SI[I+1]) { continue; }
+      agg[I] = naggs;
+      for (int k = SI[I]; k < SI[I+1]; k++)
+      {
+         if (agg[SJ[k]] < 0) { agg[SJ[k]] = naggs; }
+      }
+      naggs++;
+   }
+   return naggs;
+}
+
+SparseMatrix *AMGSolver::TentativeProlongation(const Array<int> &agg,
+                                               int naggs, int bs,
+                                               bool bynodes,
+                                               DenseMatrix &B) const
+{
+   const int nn = agg.Size(), n = nn*bs, nb = B.Width();
+
+   // The dofs of the aggregates, and the rows of P with nb entries for the
+   // aggregated dofs and no entries for the others.
+   Array<int> agg_I(naggs+1), agg_J(n), next(naggs);
+   int *I = new int[n+1];
+   agg_I = 0;
+   I[0] = 0;
+   for (int i = 0; i < n; i++)
+   {
+      const int a = agg[bynodes ? i % nn : i/bs];
+      if (a >= 0) { agg_I[a+1]++; }
+      I[i+1] = I[i] + ((a >= 0) ? nb : 0);
+   }
+   agg_I.PartialSum();
+   for (int a = 0; a < naggs; a++) { next[a] = agg_I[a]; }
+   for (int i = 0; i < n; i++)
+   {
+      const int a = agg[bynodes ? i % nn : i/bs];
+      if (a >= 0) { agg_J[next[a]++] = i; }
+   }
+   int *J = new int[I[n]];
+   double *data = new double[I[n]];
+
+   // The QR factorization of the near nullspace restricted to each aggregate,
+   // by modified Gram-Schmidt, gives the columns of P (Q) and the coarse near
+   // nullspace (R). Dependent columns are set to zero.
+   DenseMatrix Bc(naggs*nb, nb);
+   Bc = 0.0;
+#ifdef MFEM_USE_OPENMP
+   #pragma omp parallel for
+#endif
+   for (int a = 0; a < naggs; a++)
+   {
+      const int m = agg_I[a+1] - agg_I[a];
+      const int *dofs = agg_J.GetData() + agg_I[a];
+      DenseMatrix Q(m, nb);
+      for (int k = 0; k < nb; k++)
+      {
+         double *qk = Q.GetColumn(k), norm0 = 0.0, norm = 0.0;
+         for (int l = 0; l < m; l++)
+         {
+            qk[l] = B(dofs[l], k);
+            norm0 += qk[l]*qk[l];
+         }
+         for (int j = 0; j < k; j++)
+         {
+            const double *qj = Q.GetColumn(j);
+            double r = 0.0;
+            for (int l = 0; l < m; l++) { r += qj[l]*qk[l]; }
+            for (int l = 0; l < m; l++) { qk[l] -= r*qj[l]; }
+            Bc(a*nb + j, k) = r;
+         }
+         for (int l = 0; l < m; l++) { norm += qk[l]*qk[l]; }
+         norm = sqrt(norm);
+         const bool independent = (norm > 1e-10*sqrt(norm0));
+         for (int l = 0; l < m; l++) { qk[l] = independent ? qk[l]/norm : 0.0; }
+         Bc(a*nb + k, k) = independent ? norm : 0.0;
+      }
+      for (int l = 0; l < m; l++)
+      {
+         for (int k = 0; k < nb; k++)
+         {
+            J[I[dofs[l]] + k] = a*nb + k;
+            data[I[dofs[l]] + k] = Q(l, k);
+         }
+      }
+   }
+   B = Bc;
+   return new SparseMatrix(I, J, data, n, naggs*nb);
+}
+
+SparseMatrix *AMGSolver::SmoothProlongation(const SparseMatrix &A,
+                                            const SparseMatrix &Pt) const
+{
+   const int n = A.Height();
+   Vector dinv(n), v(n), w(n);
+   A.GetDiag(dinv);
+   for (int i = 0; i < n; i++) { dinv(i) = 1.0/dinv(i); }
+
+   // Power iteration for the spectral radius of D^{-1} A, with the Rayleigh
+   // quotient (A v, v) / (D v, v).
+   v.Randomize(1);
+   double rho = 0.0;
+   for (int it = 0; it < 15; it++)
+   {
+      v /= v.Norml2();
+      A.Mult(v, w);
+      double vDv = 0.0;
+      for (int i = 0; i < n; i++) { vDv += v(i)*v(i)/dinv(i); }
+      rho = (w*v)/vDv;
+      for (int i = 0; i < n; i++) { v(i) = dinv(i)*w(i); }
+   }
+
+   dinv *= 4.0/(3.0*rho);
+   SparseMatrix DA(A);
+   DA.ScaleRows(dinv);
+   SparseMatrix *DAP = mfem::Mult(DA, Pt);
+   SparseMatrix *P = mfem::Add(1.0, Pt, -1.0, *DAP);
+   delete DAP;
+   return P;
+}
+
+Solver *AMGSolver::NewSmoother(const SparseMatrix &A) const
+{
+   switch (smoother_type)
+   {
+      case JACOBI:
+         return new DSmoother(A, 0, 2.0/3.0);
+      case GAUSS_SEIDEL:
+      {
+         GSSmoother *gs = new GSSmoother(A, 0);
+         gs->SetMulticolor();
+         return gs;
+      }
+      case CHEBYSHEV:
+      {
+         Vector diag;
+         A.GetDiag(diag);
+         return new OperatorChebyshevSmoother(&A, diag, Array<int>(), 2);
+      }
+      case INCOMPLETE_CHOLESKY:
+         return new ICSmoother(A);
+   }
+   MFEM_ABORT("unknown smoother type " << smoother_type);
+   return NULL;
+}
+
+void AMGSolver::SetOperator(const Operator &op)
+{
+   const SparseMatrix *A = dynamic_cast<const SparseMatrix*>(&op);
+   MFEM_VERIFY(A && A->Finalized() && A->Height() == A->Width(),
+               "a finalized square SparseMatrix is required");
+   MFEM_VERIFY(A->Height() % block_size == 0,
+               "the size is not a multiple of the block size " << block_size);
+   MFEM_VERIFY(max_levels > 0, "invalid maximum number of levels");
+   ClearLevels();
+   delete coarse_prec;
+   coarse_prec = NULL;
+
+   DenseMatrix B;
+   if (near_null.Width() > 0)
+   {
+      MFEM_VERIFY(near_null.Height() == A->Height(),
+                  "invalid size of the near-nullspace vectors");
+      B = near_null;
+   }
+   else
+   {
+      const int nn = A->Height()/block_size;
+      B.SetSize(A->Height(), block_size);
+      B = 0.0;
+      for (int i = 0; i < A->Height(); i++)
+      {
+         B(i, by_nodes ? i/nn : i % block_size) = 1.0;
+      }
+   }
+
+   // The operators from the finest to the coarsest level, and the
+   // prolongations to each level from the next one. The coarse levels are
+   // ordered byVDIM, with one dof per near-nullspace vector on each node.
+   Array<SparseMatrix*> mats, prols;
+   mats.Append(const_cast<SparseMatrix*>(A));
+   int bs = block_size;
+   bool bynodes = by_nodes;
+   while (mats.Size() < max_levels && mats.Last()->Height() > coarse_size)
+   {
+      const SparseMatrix &Af = *mats.Last();
+      Array<int> agg;
+      const int naggs = Aggregate(Af, bs, bynodes, agg);
+      if (naggs == 0 || naggs*B.Width() > 0.9*Af.Height()) { break; }
+      SparseMatrix *Pt = TentativeProlongation(agg, naggs, bs, bynodes, B);
+      SparseMatrix *P = SmoothProlongation(Af, *Pt);
+      delete Pt;
+      SparseMatrix *Ac = RAP(*P, Af, *P);
+
+      // The coarse dofs of dependent near-nullspace vectors, with zero
+      // columns in P, are decoupled with a unit diagonal.
+      Vector diag;
+      Ac->GetDiag(diag);
+      SparseMatrix D(Ac->Height());
+      bool fix = false;
+      for (int i = 0; i < diag.Size(); i++)
+      {
+         if (diag(i) == 0.0) { D.Add(i, i, 1.0); fix = true; }
+      }
+      if (fix)
+      {
+         D.Finalize();
+         SparseMatrix *AcD = mfem::Add(*Ac, D);
+         delete Ac;
+         Ac = AcD;
+      }
+      prols.Append(P);
+      mats.Append(Ac);
+      bs = B.Width();
+      bynodes = false;
+   }
+
+   // Add the levels from the coarsest one, whose operator is factored if it
+   // is small enough.
+   const int nl = mats.Size();
+   const SparseMatrix &Ac = *mats[nl-1];
+   Solver *coarse_solver;
+   if (Ac.Height() <= coarse_size)
+   {
+      Ac.ToDenseMatrix(coarse_mat);
+      coarse_solver = new DenseMatrixInverse(coarse_mat);
+   }
+   else
+   {
+      MFEM_WARNING("the coarsest level has size " << Ac.Height()
+                   << " > " << coarse_size << ", solving it with PCG");
+      coarse_mat.Clear();
+      coarse_prec = NewSmoother(Ac);
+      CGSolver *cg = new CGSolver;
+      cg->SetRelTol(1e-12);
+      cg->SetMaxIter(std::max(Ac.Height(), 100));
+      cg->SetOperator(Ac);
+      cg->SetPreconditioner(*coarse_prec);
+      coarse_solver = cg;
+   }
+   AddLevel(mats[nl-1], coarse_solver, NULL, nl > 1, true, false);
+   for (int l = nl-2; l >= 0; l--)
+   {
+      AddLevel(mats[l], NewSmoother(*mats[l]), prols[l], l > 0, true, true);
+   }
+}
+
+AMGSolver::~AMGSolver()
+{
+   delete coarse_prec;
+}
+
+}
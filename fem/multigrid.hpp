@@ -0,0 +1,306 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#ifndef MFEM_MULTIGRID
+#define MFEM_MULTIGRID
+
+#include "../config/config.hpp"
+#include "bilinearform.hpp"
+#ifdef MFEM_USE_MPI
+#include "pfespace.hpp"
+#endif
+
+namespace mfem
+{
+
+/** @brief Transfer operator between the true dofs of two levels of a
+    multigrid hierarchy, with zero values at the essential dofs.
+
+    Given a prolongation P, the action is I_f P I_c, where I_c and I_f zero
+    the essential true dofs of the coarse and fine levels. Combined with
+    ConstrainedOperator%s on all levels, the coarse-grid corrections do not
+    change the essential dofs. */
+class ConstrainedTransferOperator : public Operator
+{
+protected:
+   const Operator &P;
+   const Array<int> &coarse_ess_tdofs, &fine_ess_tdofs;
+   mutable Vector zc, zf;
+
+public:
+   /// The operator and the lists are not owned and must remain valid.
+   ConstrainedTransferOperator(const Operator &P_,
+                               const Array<int> &coarse_ess_tdof_list,
+                               const Array<int> &fine_ess_tdof_list);
+
+   virtual void Mult(const Vector &x, Vector &y) const;
+   virtual void MultTranspose(const Vector &x, Vector &y) const;
+};
+
+/** @brief Multigrid cycle defined by a hierarchy of operators, smoothers and
+    prolongations.
+
+    The levels are added from the coarsest to the finest with AddLevel(). On
+    the coarsest level the "smoother" is the coarse solver, applied once; on
+    the other levels the smoother is applied as a stationary iteration
+    x <- x + S (b - A x), before and after the coarse-grid correction, whose
+    residual is restricted with the transpose of the prolongation. With
+    symmetric smoothers, the cycle is a symmetric preconditioner. */
+class MultigridSolver : public Solver
+{
+protected:
+   Array<Operator*> operators;
+   Array<Solver*> smoothers;
+   Array<Operator*> prolongations; ///< prolongations[0] is NULL
+   Array<bool> own_operators, own_smoothers, own_prolongations;
+   int cycle_type, pre_smoothing_steps, post_smoothing_steps;
+   mutable Array<Vector*> X, B, R, Z;
+
+   /// Apply the smoother of the given level to the residual of B, X.
+   void Smooth(int level, int steps) const;
+   /// Apply one cycle on the given level to the system B, X, with X = 0.
+   void Cycle(int level) const;
+   /// Remove all levels, deleting the owned objects.
+   void ClearLevels();
+
+public:
+   MultigridSolver();
+
+   /** @brief Add the next (finer) level, with @a prolongation from the
+       previous level. For the first (coarsest) level, @a prolongation must be
+       NULL and @a smoother is the coarse solver. */
+   void AddLevel(Operator *op, Solver *smoother, Operator *prolongation,
+                 bool own_op, bool own_smoother, bool own_prolongation);
+
+   /// Return the number of levels.
+   int NumLevels() const { return operators.Size(); }
+
+   /// Return the operator of the given level, 0 being the coarsest.
+   Operator *GetOperatorAtLevel(int level) const { return operators[level]; }
+
+   /** @brief Set the number of recursive coarse-grid corrections per level,
+       1 for a V-cycle and 2 for a W-cycle, and the number of smoothing
+       steps. */
+   void SetCycle(int cycle_type_, int pre_smoothing_steps_ = 1,
+                 int post_smoothing_steps_ = 1);
+
+   /// Apply the cycle to @a b, with initial guess @a x in iterative_mode.
+   virtual void Mult(const Vector &b, Vector &x) const;
+
+   /// The operators are defined by the levels: @a op must match the finest.
+   virtual void SetOperator(const Operator &op);
+
+   virtual ~MultigridSolver();
+};
+
+/** @brief Geometric p-multigrid preconditioner for the diffusion operator,
+    using partial assembly on the high-order levels.
+
+    The hierarchy is made of H1 spaces on the mesh of the given space, with
+    orders halved from the order of the space down to 1. On the high-order
+    levels, the operator is a partially assembled DiffusionIntegrator and the
+    smoother is an OperatorChebyshevSmoother built from its diagonal. The
+    transfers are the p-interpolations of InterpolationGridTransfer. The order
+    1 operator is fully assembled and solved with UMFPackSolver if available,
+    and otherwise with CG preconditioned by GSSmoother. The given space must be
+    a serial, conforming, scalar H1 space on quads or hexes. */
+class PMultigridSolver : public MultigridSolver
+{
+protected:
+   Array<FiniteElementCollection*> fecs;
+   Array<FiniteElementSpace*> spaces; ///< The finest level is not owned
+   Array<BilinearForm*> forms;
+   Array<Array<int>*> ess_tdofs;
+   Array<InterpolationGridTransfer*> transfers;
+   Array<OperatorHandle*> handles;
+   Solver *coarse_prec; ///< Preconditioner of the coarse CG solver, or NULL
+
+public:
+   /** @brief Construct the hierarchy for the space @a fes, with essential
+       boundary attributes @a ess_bdr and optional diffusion coefficient
+       @a coeff (not owned). */
+   PMultigridSolver(FiniteElementSpace &fes, const Array<int> &ess_bdr,
+                    Coefficient *coeff = NULL, int cheby_order = 2);
+
+   /// Return the order of the space of the given level.
+   int GetOrderAtLevel(int level) const
+   { return spaces[level]->GetFE(0)->GetOrder(); }
+
+   /// Return the essential true dofs of the finest level.
+   const Array<int> &GetEssentialTrueDofs() const
+   { return *ess_tdofs.Last(); }
+
+   virtual ~PMultigridSolver();
+};
+
+/** @brief Geometric h-multigrid solver on a hierarchy of uniform refinements
+    of the mesh of a FiniteElementSpace or ParFiniteElementSpace.
+
+    The coarsest level is added with AddCoarseLevel(). Then, after each
+    refinement of the mesh followed by FiniteElementSpace::Update(), the new
+    level is added with AddRefinedLevel(). The prolongation from the previous
+    level is assembled from the update operator of the space, which the
+    constructor sets to the Operator::MFEM_SPARSEMAT type, and from the true dof
+    prolongation/restriction of the two levels. It is a SparseMatrix in serial
+    and a HypreParMatrix in parallel, so conforming and nonconforming meshes
+    are supported. The operators and smoothers of all levels are given by the
+    user: the operators are the ones of FormSystemMatrix() with the given
+    essential true dofs, e.g. SparseMatrix, HypreParMatrix or partially
+    assembled operators, and the smoothers can be any Solver%s. */
+class HMultigridSolver : public MultigridSolver
+{
+protected:
+   FiniteElementSpace &fes;
+   long sequence; ///< Sequence of the space at the last level
+   int ndofs;     ///< Number of dofs (L-vector size) at the last level
+   Array<Array<int>*> ess_tdofs;
+   Array<Operator*> transfer_mats; ///< Unconstrained prolongations, owned
+   /// Copy of the conforming prolongation of the last level, or NULL.
+   SparseMatrix *last_cP;
+#ifdef MFEM_USE_MPI
+   /// Transpose of the parallel prolongation of the last level, or NULL.
+   HypreParMatrix *last_PT;
+#endif
+
+   /** Save the data of the current space needed by the prolongation to the
+       next level, which is destroyed by FiniteElementSpace::Update(). */
+   void SaveLevel(const Array<int> &ess_tdof_list);
+   /// Assemble the true dof prolongation from the update operator @a T.
+   Operator *AssembleProlongation(const SparseMatrix &T) const;
+
+public:
+   /// The space @a fes_ is not owned and defines the coarsest level.
+   HMultigridSolver(FiniteElementSpace &fes_);
+
+   /** @brief Add the coarsest level, with the operator @a op of the space and
+       the coarse solver @a solver. */
+   void AddCoarseLevel(Operator *op, Solver *solver,
+                       const Array<int> &ess_tdof_list,
+                       bool own_op = false, bool own_solver = false);
+
+   /** @brief Add the level of the space after one refinement of its mesh,
+       with the operator @a op and the smoother @a smoother. */
+   void AddRefinedLevel(Operator *op, Solver *smoother,
+                        const Array<int> &ess_tdof_list,
+                        bool own_op = false, bool own_smoother = false);
+
+   virtual ~HMultigridSolver();
+};
+
+/** @brief Smoothed aggregation algebraic multigrid solver for a SparseMatrix.
+
+    The hierarchy is built from the matrix by SetOperator(). The nodes of the
+    matrix, i.e. the groups of block_size dofs of a vector problem, are grouped
+    into aggregates of strongly connected nodes, where nodes I and J are
+    strongly connected if the Frobenius norms of the blocks satisfy
+    |A_IJ| >= theta sqrt(|A_II| |A_JJ|). Nodes without strong connections, such
+    as eliminated essential dofs, are left to the smoothers. The tentative
+    prolongation interpolates the near-nullspace vectors exactly on each
+    aggregate, orthonormalized by a QR factorization per aggregate, and is
+    smoothed by one damped Jacobi step, P = (I - 4/(3 rho) D^{-1} A) P_tent,
+    with rho the spectral radius of D^{-1} A. The coarse operators are the
+    Galerkin products P^T A P, computed with the sparse matrix products which
+    are parallelized with OpenMP when MFEM_USE_OPENMP is enabled. The coarsest
+    operator is factored as a dense matrix.
+
+    The default near nullspace is the constant vector of each component, which
+    suits scalar and weakly coupled vector problems. For linear elasticity, the
+    rigid body modes are set with SetElasticityOptions(). The options must be
+    set before SetOperator(), which rebuilds the hierarchy. The cycle is a
+    symmetric preconditioner for symmetric positive definite matrices. */
+class AMGSolver : public MultigridSolver
+{
+public:
+   /// Smoothers of the levels, all symmetric.
+   enum SmootherType
+   {
+      JACOBI,        ///< Jacobi with weight 2/3, DSmoother
+      GAUSS_SEIDEL,  ///< Symmetric multicolor Gauss-Seidel, GSSmoother
+      CHEBYSHEV,     ///< Order 2 OperatorChebyshevSmoother
+      INCOMPLETE_CHOLESKY ///< IC(0) factorization, ICSmoother
+   };
+
+protected:
+   int block_size;
+   bool by_nodes; ///< Ordering of the components on the finest level
+   DenseMatrix near_null; ///< Near-nullspace vectors in columns, or empty
+   double theta;
+   int max_levels, coarse_size;
+   SmootherType smoother_type;
+   DenseMatrix coarse_mat; ///< Coarsest operator, factored by the solver
+   /// Preconditioner of the coarse CG solver, used above the coarse size.
+   Solver *coarse_prec;
+
+   /** @brief Group the nodes of @a A, with @a bs dofs each, into aggregates.
+       Return the number of aggregates; @a agg is the aggregate of each node,
+       -1 for the nodes without strong connections. */
+   int Aggregate(const SparseMatrix &A, int bs, bool bynodes,
+                 Array<int> &agg) const;
+
+   /** @brief Return the tentative prolongation of the aggregates @a agg, with
+       the near-nullspace vectors @a B on input and their coarse
+       representation on output. */
+   SparseMatrix *TentativeProlongation(const Array<int> &agg, int naggs,
+                                       int bs, bool bynodes,
+                                       DenseMatrix &B) const;
+
+   /// Return the smoothed prolongation (I - omega D^{-1} A) @a Pt.
+   SparseMatrix *SmoothProlongation(const SparseMatrix &A,
+                                    const SparseMatrix &Pt) const;
+
+   /// Return a new smoother of the selected type for @a A.
+   Solver *NewSmoother(const SparseMatrix &A) const;
+
+public:
+   AMGSolver();
+
+   /// Build the hierarchy of the scalar matrix @a A.
+   AMGSolver(const SparseMatrix &A);
+
+   /** @brief Set the number of dofs per node, ordered byNODES or byVDIM, of
+       a vector problem, e.g. the vector dimension of the space. */
+   void SetSystemsOptions(int dim, bool order_bynodes = false);
+
+   /** @brief Use the rigid body modes of the space @a fes, with vector
+       dimension equal to the space dimension, as near nullspace. The matrix
+       must be defined on the true dofs of @a fes. */
+   void SetElasticityOptions(FiniteElementSpace *fes);
+
+   /** @brief Set the near-nullspace vectors, given in the columns of @a B,
+       with the node structure of SetSystemsOptions(). */
+   void SetNearNullspace(const DenseMatrix &B) { near_null = B; }
+
+   /// Set the strength of connection threshold, default 0.08.
+   void SetStrengthThreshold(double theta_) { theta = theta_; }
+
+   /// Set the maximum number of levels, default 10.
+   void SetMaxLevels(int max_levels_) { max_levels = max_levels_; }
+
+   /** @brief Set the size below which a level is the coarsest, default 200.
+
+       The coarsest level is factored with a dense LU factorization if its
+       size is at most @a coarse_size_. When the coarsening stops earlier,
+       e.g. with the maximum number of levels, it is solved with CG
+       preconditioned by the smoother, to a relative tolerance of 1e-12. */
+   void SetCoarseSize(int coarse_size_) { coarse_size = coarse_size_; }
+
+   /// Set the smoother of the levels, default GAUSS_SEIDEL.
+   void SetSmoother(SmootherType type) { smoother_type = type; }
+
+   /// Build the hierarchy of @a op, which must be a SparseMatrix.
+   virtual void SetOperator(const Operator &op);
+
+   virtual ~AMGSolver();
+};
+
+}
+
+#endif
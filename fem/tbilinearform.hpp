@@ -105,6 +105,23 @@ public:
         in_fes(sol_fes)
    { }
 
+   /** Construct the form on the mesh of @a sol_fes with the given mesh
+       @a nodes, e.g. when the mesh does not have nodes. */
+   TBilinearForm(const IntegratorType &integ, const FiniteElementSpace &sol_fes,
+                 const GridFunction &nodes)
+      : Operator(sol_fes.GetNDofs()*vdim),
+        mesh(*sol_fes.GetMesh(), nodes),
+        meshEval(mesh.fe),
+        sol_fe(*sol_fes.FEColl()),
+        solEval(sol_fe),
+        solFES(sol_fe, sol_fes),
+        solVecLayout(sol_fes),
+        int_rule(),
+        coeff(integ.coeff),
+        assembled_data(NULL),
+        in_fes(sol_fes)
+   { }
+
    virtual ~TBilinearForm()
    {
       delete [] assembled_data;
@@ -0,0 +1,157 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+// Implementation of the registry of templated bilinear forms
+
+#include "tbilinearform_registry.hpp"
+#include "tbilininteg.hpp"
+#include "../general/device.hpp"
+#include <typeinfo>
+
+namespace mfem
+{
+
+// Templated operator which owns the order 1 nodes built from the vertices of a
+// mesh without nodes.
+class TBilinearFormOperator : public Operator
+{
+protected:
+   H1_FECollection *nodes_fec;
+   FiniteElementSpace *nodes_fes;
+   GridFunction *nodes;
+   Operator *form;
+
+public:
+   TBilinearFormOperator(const FiniteElementSpace &fes,
+                         TBilinearFormRegistry::Factory factory, double coeff)
+      : Operator(fes.GetVSize()), nodes_fec(NULL), nodes_fes(NULL),
+        nodes(NULL), form(NULL)
+   {
+      Mesh *mesh = fes.GetMesh();
+      const GridFunction *mesh_nodes = mesh->GetNodes();
+      if (!mesh_nodes)
+      {
+         nodes_fec = new H1_FECollection(1, mesh->Dimension());
+         nodes_fes = new FiniteElementSpace(mesh, nodes_fec,
+                                            mesh->SpaceDimension(),
+                                            Ordering::byNODES);
+         nodes = new GridFunction(nodes_fes);
+         mesh->GetNodes(*nodes);
+         mesh_nodes = nodes;
+      }
+      form = factory(fes, *mesh_nodes, coeff);
+   }
+
+   bool Valid() const { return form != NULL; }
+
+   virtual void Mult(const Vector &x, Vector &y) const { form->Mult(x, y); }
+
+   virtual ~TBilinearFormOperator()
+   {
+      delete form;
+      delete nodes;
+      delete nodes_fes;
+      delete nodes_fec;
+   }
+};
+
+template <Geometry::Type G, int P>
+void TBilinearFormRegistry::RegisterDefault(map_t &map)
+{
+   map[Key(G, P, MASS)] = NewTBilinearForm<G,P,TMassKernel>;
+   map[Key(G, P, DIFFUSION)] = NewTBilinearForm<G,P,TDiffusionKernel>;
+}
+
+TBilinearFormRegistry::map_t TBilinearFormRegistry::BuildMap()
+{
+   map_t map;
+   RegisterDefault<Geometry::SQUARE,1>(map);
+   RegisterDefault<Geometry::SQUARE,2>(map);
+   RegisterDefault<Geometry::SQUARE,3>(map);
+   RegisterDefault<Geometry::SQUARE,4>(map);
+   RegisterDefault<Geometry::CUBE,1>(map);
+   RegisterDefault<Geometry::CUBE,2>(map);
+   RegisterDefault<Geometry::CUBE,3>(map);
+   RegisterDefault<Geometry::CUBE,4>(map);
+   return map;
+}
+
+TBilinearFormRegistry::map_t &TBilinearFormRegistry::Map()
+{
+   // The initialization of a local static is thread-safe in C++11.
+   static map_t map = BuildMap();
+   return map;
+}
+
+void TBilinearFormRegistry::Register(Geometry::Type geom, int order,
+                                     IntegratorKind kind, Factory factory)
+{
+   Map()[Key(geom, order, kind)] = factory;
+}
+
+bool TBilinearFormRegistry::Find(Geometry::Type geom, int order,
+                                 IntegratorKind kind)
+{
+   return Map().count(Key(geom, order, kind)) > 0;
+}
+
+Operator *TBilinearFormRegistry::Create(const BilinearFormIntegrator &integ,
+                                        const FiniteElementSpace &fes)
+{
+   if (Device::Allows(~Backend::CPU)) { return NULL; }
+   const Mesh *mesh = fes.GetMesh();
+   if (mesh->GetNE() == 0 || fes.GetVDim() != 1 || integ.GetIntRule())
+   {
+      return NULL;
+   }
+
+   IntegratorKind kind;
+   const Coefficient *Q;
+   if (typeid(integ) == typeid(MassIntegrator))
+   {
+      kind = MASS;
+      Q = static_cast<const MassIntegrator&>(integ).GetCoefficient();
+   }
+   else if (typeid(integ) == typeid(DiffusionIntegrator))
+   {
+      const DiffusionIntegrator &di =
+         static_cast<const DiffusionIntegrator&>(integ);
+      if (di.GetMatrixCoefficient()) { return NULL; }
+      kind = DIFFUSION;
+      Q = di.GetCoefficient();
+   }
+   else { return NULL; }
+
+   double coeff = 1.0;
+   if (Q)
+   {
+      const ConstantCoefficient *cQ =
+         dynamic_cast<const ConstantCoefficient*>(Q);
+      if (!cQ) { return NULL; }
+      coeff = cQ->constant;
+   }
+
+   const Geometry::Type geom = mesh->GetElementBaseGeometry(0);
+   const int order = fes.GetFE(0)->GetOrder();
+   map_t::const_iterator it = Map().find(Key(geom, order, kind));
+   if (it == Map().end()) { return NULL; }
+
+   TBilinearFormOperator *op =
+      new TBilinearFormOperator(fes, it->second, coeff);
+   if (!op->Valid())
+   {
+      delete op;
+      return NULL;
+   }
+   return op;
+}
+
+}
@@ -0,0 +1,94 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#ifndef MFEM_TEMPLATE_BILINEAR_FORM_REGISTRY
+#define MFEM_TEMPLATE_BILINEAR_FORM_REGISTRY
+
+#include "../config/config.hpp"
+#include "../linalg/operator.hpp"
+#include "geom.hpp"
+#include <map>
+
+namespace mfem
+{
+
+class FiniteElementSpace;
+class GridFunction;
+class BilinearFormIntegrator;
+
+/** @brief Registry of precompiled TBilinearForm specializations, used by the
+    partial assembly of BilinearForm.
+
+    The entries are keyed by the tuple (geometry, order, integrator kind). When
+    a BilinearForm with AssemblyLevel::PARTIAL is assembled, each of its domain
+    integrators is looked up with Create(); if all of them match an entry, the
+    action of the form is computed with the templated operators instead of the
+    generic PA kernels.
+
+    An integrator matches when it is exactly a MassIntegrator or a scalar
+    DiffusionIntegrator, without a prescribed IntegrationRule, with no
+    coefficient or a ConstantCoefficient, on a scalar H1 space whose mesh has
+    a single element geometry and no nodes or order 1 H1 nodes ordered byNODES.
+    The templated operators are only used when the Device is not enabled or
+    allows only the CPU backend.
+
+    The mass and diffusion integrators on quadrilaterals and hexahedra of
+    orders 1 to 4 are registered by default. Other specializations can be added
+    with Register(), e.g. with a NewTBilinearForm() instantiation from
+    tbilininteg.hpp. */
+class TBilinearFormRegistry
+{
+public:
+   /// Kinds of integrators with a templated counterpart.
+   enum IntegratorKind { MASS, DIFFUSION };
+
+   /** @brief Function creating the assembled templated operator on the
+       L-vectors of @a fes, with the mesh @a nodes and the constant coefficient
+       @a coeff. It returns NULL if the arguments do not match. */
+   typedef Operator *(*Factory)(const FiniteElementSpace &fes,
+                                const GridFunction &nodes, double coeff);
+
+   /** @brief Add (or replace) the entry for the given geometry, order and
+       kind. This modifies the shared map: it must not be called concurrently
+       with the other methods. */
+   static void Register(Geometry::Type geom, int order, IntegratorKind kind,
+                        Factory factory);
+
+   /// Check if there is an entry for the given geometry, order and kind.
+   static bool Find(Geometry::Type geom, int order, IntegratorKind kind);
+
+   /** @brief Return a new templated operator for the domain integrator @a integ
+       on @a fes, or NULL if no registered specialization matches.
+
+       The returned operator acts on the L-vectors of @a fes. */
+   static Operator *Create(const BilinearFormIntegrator &integ,
+                           const FiniteElementSpace &fes);
+
+private:
+   typedef std::map<int, Factory> map_t;
+
+   static int Key(Geometry::Type geom, int order, IntegratorKind kind)
+   { return (order*Geometry::NumGeom + geom)*2 + kind; }
+
+   /// Add the mass and diffusion specializations of geometry G and order P.
+   template <Geometry::Type G, int P> static void RegisterDefault(map_t &map);
+
+   /// Return a new map with the default specializations.
+   static map_t BuildMap();
+
+   /** @brief Return the map of entries, initialized with BuildMap() on first
+       use (thread-safe). */
+   static map_t &Map();
+};
+
+}
+
+#endif
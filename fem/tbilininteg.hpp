@@ -13,6 +13,10 @@
 #define MFEM_TEMPLATE_BILININTEG
 
 #include "../config/tconfig.hpp"
+#include "../mesh/tmesh.hpp"
+#include "tintrules.hpp"
+#include "tfe.hpp"
+#include "tfespace.hpp"
 #include "tcoefficient.hpp"
 #include "tbilinearform.hpp"
 
@@ -554,6 +558,43 @@ struct TDiffusionKernel<3,3,complex_t>
    }
 };
 
+
+/** @brief Create a partially assembled TBilinearForm with the kernel @a
+    kernel_t and a constant coefficient @a coeff on the H1 space @a fes of order
+    @a P, on a mesh of geometry @a G with order 1 @a nodes ordered byNODES.
+
+    The quadrature rule is the one used by the PA kernels, of order 2*P+dim-1.
+    Returns NULL if @a fes or @a nodes do not match the template parameters.
+    The returned operator acts on the L-vectors of @a fes and keeps references
+    to @a fes and @a nodes. This function can be passed as a factory to
+    TBilinearFormRegistry::Register(). */
+template <Geometry::Type G, int P, template<int,int,typename> class kernel_t>
+Operator *NewTBilinearForm(const FiniteElementSpace &fes,
+                           const GridFunction &nodes, double coeff)
+{
+   static const int dim = Geometry::Constants<G>::Dimension;
+   typedef H1_FiniteElement<G,1>               mesh_fe_t;
+   typedef H1_FiniteElementSpace<mesh_fe_t>    mesh_fes_t;
+   typedef TMesh<mesh_fes_t>                   mesh_t;
+   typedef H1_FiniteElement<G,P>               sol_fe_t;
+   typedef H1_FiniteElementSpace<sol_fe_t>     sol_fes_t;
+   typedef TIntegrationRule<G,2*P+dim-1>       int_rule_t;
+   typedef TConstantCoefficient<>              coeff_t;
+   typedef TIntegrator<coeff_t,kernel_t>       integ_t;
+   typedef TBilinearForm<mesh_t,sol_fes_t,int_rule_t,integ_t> form_t;
+   typedef typename mesh_t::nodeLayout_type    node_layout_t;
+
+   if (!mesh_t::MatchesGeometry(*fes.GetMesh()) ||
+       !mesh_fes_t::template VectorMatches<node_layout_t>(*nodes.FESpace()) ||
+       !sol_fes_t::Matches(fes) || fes.GetVDim() != 1)
+   {
+      return NULL;
+   }
+   form_t *form = new form_t(integ_t(coeff_t(coeff)), fes, nodes);
+   form->Assemble();
+   return form;
+}
+
 } // namespace mfem
 
 #endif // MFEM_TEMPLATE_BILININTEG
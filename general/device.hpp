@@ -50,7 +50,11 @@ struct Backend
       OCCA_OMP = 1 << 7,
       /** @brief [device] OCCA CUDA backend. Enabled when MFEM_USE_OCCA = YES
           and MFEM_USE_CUDA = YES. */
-      OCCA_CUDA = 1 << 8
+      OCCA_CUDA = 1 << 8,
+      /** @brief [host] SIMD backend: sequential execution on each MPI rank,
+          with the PA kernels vectorized across batches of elements, see
+          AutoSIMD. Always available. */
+      SIMD = 1 << 9
    };
 
    /** @brief Additional useful constants. For example, the *_MASK constants can
@@ -58,7 +62,7 @@ struct Backend
    enum
    {
       /// Number of backends: from (1 << 0) to (1 << (NUM_BACKENDS-1)).
-      NUM_BACKENDS = 9,
+      NUM_BACKENDS = 10,
       /// Biwise-OR of all CUDA backends
       CUDA_MASK = CUDA | RAJA_CUDA | OCCA_CUDA,
       /// Biwise-OR of all RAJA backends
@@ -126,8 +130,8 @@ public:
          string name of 'RAJA_CPU' is 'raja-cpu'.
        * The 'cpu' backend is always enabled with lowest priority.
        * The current backend priority from highest to lowest is: 'occa-cuda',
-         'raja-cuda', 'cuda', 'occa-omp', 'raja-omp', 'omp', 'occa-cpu',
-         'raja-cpu', 'cpu'.
+         'raja-cuda', 'cuda', 'occa-omp', 'raja-omp', 'omp', 'simd',
+         'occa-cpu', 'raja-cpu', 'cpu'.
        * Multiple backends can be configured at the same time.
        * Only one 'occa-*' backend can be configured at a time.
        * The backend 'occa-cuda' enables the 'cuda' backend unless 'raja-cuda'
@@ -0,0 +1,217 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#include "jit.hpp"
+#include "error.hpp"
+#include "version.hpp"
+
+#ifdef MFEM_USE_JIT
+#include <map>
+#include <set>
+#include <mutex>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+namespace mfem
+{
+
+#ifdef MFEM_USE_JIT
+
+// Return the value of the environment variable var, or def if it is not set.
+static std::string GetEnv(const char *var, const char *def)
+{
+   const char *val = getenv(var);
+   return (val && *val) ? val : def;
+}
+
+// The 64-bit FNV-1a hash of str, continuing from the hash h.
+static unsigned long long Hash(const std::string &str,
+                               unsigned long long h = 14695981039346656037ULL)
+{
+   for (size_t i = 0; i < str.size(); i++)
+   {
+      h = (h ^ (unsigned char) str[i]) * 1099511628211ULL;
+   }
+   return h;
+}
+
+// Return the directories of the -I options in flags.
+static std::vector<std::string> IncludeDirs(const std::string &flags)
+{
+   std::vector<std::string> dirs;
+   std::istringstream in(flags);
+   std::string word;
+   while (in >> word)
+   {
+      if (word.compare(0, 2, "-I") != 0) { continue; }
+      if (word.size() > 2) { dirs.push_back(word.substr(2)); }
+      else if (in >> word) { dirs.push_back(word); }
+   }
+   return dirs;
+}
+
+// Fold into the hash h the contents of the files included by text with
+// #include "file", recursively. The files are searched in the directory dir of
+// the including file (if not empty), then in the include directories inc.
+// The files in visited, by real path, are skipped.
+static unsigned long long HashIncludes(const std::string &text,
+                                       const std::string &dir,
+                                       const std::vector<std::string> &inc,
+                                       std::set<std::string> &visited,
+                                       unsigned long long h)
+{
+   std::istringstream in(text);
+   std::string line;
+   while (std::getline(in, line))
+   {
+      size_t p = line.find_first_not_of(" \t");
+      if (p == std::string::npos || line[p] != '#') { continue; }
+      p = line.find_first_not_of(" \t", p+1);
+      if (p == std::string::npos || line.compare(p, 7, "include") != 0)
+      {
+         continue;
+      }
+      const size_t b = line.find('"', p+7);
+      const size_t e = (b == std::string::npos) ? b : line.find('"', b+1);
+      if (e == std::string::npos) { continue; }
+      const std::string file = line.substr(b+1, e-b-1);
+
+      std::vector<std::string> dirs(1, dir);
+      dirs.insert(dirs.end(), inc.begin(), inc.end());
+      for (size_t i = 0; i < dirs.size(); i++)
+      {
+         if (dirs[i].empty()) { continue; }
+         char *real = realpath((dirs[i] + "/" + file).c_str(), NULL);
+         if (!real) { continue; }
+         const std::string path(real);
+         free(real);
+         if (visited.insert(path).second)
+         {
+            std::ifstream f(path.c_str());
+            std::ostringstream contents;
+            contents << f.rdbuf();
+            h = Hash(contents.str(), h);
+            h = HashIncludes(contents.str(), path.substr(0, path.rfind('/')),
+                             inc, visited, h);
+         }
+         break;
+      }
+   }
+   return h;
+}
+
+// Create the directory dir and its parents, if they do not exist.
+static void MakeDirectory(const std::string &dir)
+{
+   for (size_t i = 1; i <= dir.size(); i++)
+   {
+      if (i == dir.size() || dir[i] == '/')
+      {
+         mkdir(dir.substr(0, i).c_str(), 0755);
+      }
+   }
+}
+
+std::string KernelCache::GetDirectory()
+{
+   const char *dir = getenv("MFEM_JIT_CACHE_DIR");
+   if (dir && *dir) { return dir; }
+   const char *home = getenv("HOME");
+   return std::string(home ? home : "/tmp") + "/.cache/mfem/jit";
+}
+
+void *KernelCache::Lookup(const std::string &name, const std::string &source)
+{
+   // Failures are cached too, so that they are reported only once. The lock is
+   // held during the compilation, so that a kernel is compiled only once.
+   static std::map<std::string, void*> kernels;
+   static std::mutex kernels_mutex;
+   std::lock_guard<std::mutex> lock(kernels_mutex);
+   std::map<std::string, void*>::iterator it = kernels.find(name);
+   if (it != kernels.end()) { return it->second; }
+   void *&kernel = kernels[name];
+   kernel = NULL;
+
+   const std::string cxx = GetEnv("MFEM_JIT_CXX", MFEM_JIT_CXX);
+   const std::string flags = GetEnv("MFEM_JIT_FLAGS", MFEM_JIT_FLAGS);
+   unsigned long long h = Hash(cxx);
+   h = Hash(flags, h);
+   h = Hash(GetVersionStr(), h);
+   h = Hash(GetGitStr(), h);
+   h = Hash(source, h);
+   // The included MFEM headers may change without a change of the version.
+   std::set<std::string> visited;
+   h = HashIncludes(source, std::string(), IncludeDirs(flags), visited, h);
+   char hash[17];
+   snprintf(hash, sizeof(hash), "%016llx", h);
+   const std::string dir = GetDirectory();
+   const std::string lib = dir + "/" + name + "_" + hash + ".so";
+
+   if (access(lib.c_str(), R_OK) != 0)
+   {
+      // Compile into temporary files, unique to the process, and rename the
+      // library, so concurrent processes, e.g. MPI tasks, do not interfere.
+      MakeDirectory(dir);
+      std::ostringstream tmp;
+      tmp << dir << "/" << name << "_" << hash << "." << getpid();
+      const std::string src = tmp.str() + ".cpp", so = tmp.str() + ".so",
+                        log = tmp.str() + ".log";
+      {
+         std::ofstream out(src.c_str());
+         out << source;
+      }
+      const std::string cmd = cxx + " " + flags + " -fPIC -shared -o " + so +
+                              " " + src + " > " + log + " 2>&1";
+      const int status = system(cmd.c_str());
+      remove(src.c_str());
+      if (status != 0 || rename(so.c_str(), lib.c_str()) != 0)
+      {
+         remove(so.c_str());
+         MFEM_WARNING("the compilation of kernel " << name << " failed, see "
+                      << log);
+         return NULL;
+      }
+      remove(log.c_str());
+   }
+
+   void *handle = dlopen(lib.c_str(), RTLD_NOW | RTLD_LOCAL);
+   if (!handle)
+   {
+      MFEM_WARNING("unable to load kernel " << name << ": " << dlerror());
+      return NULL;
+   }
+   kernel = dlsym(handle, name.c_str());
+   if (!kernel)
+   {
+      MFEM_WARNING("kernel " << name << " not found in " << lib);
+   }
+   return kernel;
+}
+
+#else // MFEM_USE_JIT
+
+void *KernelCache::Lookup(const std::string &, const std::string &)
+{
+   return NULL;
+}
+
+std::string KernelCache::GetDirectory() { return std::string(); }
+
+#endif // MFEM_USE_JIT
+
+} // namespace mfem
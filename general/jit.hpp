@@ -0,0 +1,53 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#ifndef MFEM_JIT_HPP
+#define MFEM_JIT_HPP
+
+#include "../config/config.hpp"
+#include <string>
+
+namespace mfem
+{
+
+/** @brief Cache of kernels compiled at runtime, enabled with MFEM_USE_JIT.
+
+    A kernel is a function with C linkage defined in a source file, which may
+    include the MFEM headers relative to the source directory, e.g.
+    "fem/bilininteg_kernels.hpp". At the first lookup of a kernel, the source is
+    compiled into a shared library with the compiler and flags of the library,
+    MFEM_JIT_CXX and MFEM_JIT_FLAGS, which can be overridden by the environment
+    variables with the same names. The libraries are kept in the directory
+    GetDirectory(), named after a hash of the source, the contents of the
+    headers it includes with #include "file" (searched recursively in the -I
+    directories of the flags), the compiler, the flags and the MFEM version, so
+    later runs load them without compilation, and a change of the headers
+    leads to a new compilation. Lookup() is thread-safe.
+
+    The libraries are loaded with dlopen(), so the MFEM symbols used by the
+    kernels must be exported by the executable (e.g. linked with -rdynamic) or
+    by the shared MFEM library. */
+class KernelCache
+{
+public:
+   /** @brief Return the address of the kernel @a name defined in @a source,
+       compiling and loading it if needed. Return NULL if the compilation or
+       the loading fails (with a warning) or if MFEM_USE_JIT is disabled. */
+   static void *Lookup(const std::string &name, const std::string &source);
+
+   /** @brief Return the cache directory: $MFEM_JIT_CACHE_DIR if set, and
+       otherwise $HOME/.cache/mfem/jit. */
+   static std::string GetDirectory();
+};
+
+} // namespace mfem
+
+#endif // MFEM_JIT_HPP
@@ -212,4 +212,29 @@ void ConstrainedOperator::Mult(const Vector &x, Vector &y) const
    });
 }
 
+double ConstrainedOperator::MultAndDot(const Vector &x, Vector &y) const
+{
+   const int csz = constraint_list.Size();
+   if (csz == 0) { return A->MultAndDot(x, y); }
+   // The correction of the constrained entries below runs on the host.
+   if (Device::Allows(Backend::DEVICE_MASK))
+   {
+      return Operator::MultAndDot(x, y);
+   }
+
+   z = x;
+   for (int i = 0; i < csz; i++) { z(constraint_list[i]) = 0.0; }
+
+   // Since z_b = 0, (z, A z) is the contribution of the unconstrained entries.
+   double dot = A->MultAndDot(z, y);
+
+   for (int i = 0; i < csz; i++)
+   {
+      const int id = constraint_list[i];
+      y(id) = x(id);
+      dot += x(id) * x(id);
+   }
+   return dot;
+}
+
 }
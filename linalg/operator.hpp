@@ -52,6 +52,16 @@ public:
    virtual void MultTranspose(const Vector &x, Vector &y) const
    { mfem_error("Operator::MultTranspose() is not overloaded!"); }
 
+   /** @brief Operator application `y=A(x)`, returning the local (on this MPI
+       rank) dot product of @a x and @a y.
+
+       Derived classes may fuse the computation of the dot product with the
+       last pass over @a y, e.g. to save one pass over memory in CGSolver. The
+       default behavior in class Operator is to call Mult() and then compute
+       the dot product. */
+   virtual double MultAndDot(const Vector &x, Vector &y) const
+   { Mult(x, y); return x * y; }
+
    /** @brief Evaluate the gradient operator at the point @a x. The default
        behavior in class Operator is to generate an error. */
    virtual Operator &GetGradient(const Vector &x) const
@@ -440,6 +450,11 @@ public:
        the vectors, and "_i" -- the rest of the entries. */
    virtual void Mult(const Vector &x, Vector &y) const;
 
+   /** @brief Constrained operator action, returning the local dot product of
+       @a x and @a y, using Operator::MultAndDot() of the unconstrained
+       Operator. */
+   virtual double MultAndDot(const Vector &x, Vector &y) const;
+
    /// Destructor: destroys the unconstrained Operator @a A if @a own_A is true.
    virtual ~ConstrainedOperator() { if (own_A) { delete A; } }
 };
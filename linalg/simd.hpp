@@ -0,0 +1,130 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#ifndef MFEM_SIMD_HPP
+#define MFEM_SIMD_HPP
+
+#include "../config/tconfig.hpp"
+
+// The size in bytes of the SIMD vectors used by the SIMD backend: 64 with
+// AVX-512 (8 doubles), 32 otherwise (4 doubles, AVX/AVX2).
+#ifndef MFEM_SIMD_BYTES
+#if defined(__AVX512F__)
+#define MFEM_SIMD_BYTES 64
+#else
+#define MFEM_SIMD_BYTES 32
+#endif
+#endif
+
+namespace mfem
+{
+
+/** @brief A vector of @a S scalars with element-wise arithmetic, i.e. a SIMD
+    register.
+
+    The operations are loops of fixed length on aligned data, which the
+    compiler maps to the SIMD instructions enabled by the compiler flags, e.g.
+    -mavx2 or -mavx512f. The PA kernels of the Backend::SIMD backend store one
+    mesh element per lane, so that the tensor contractions of S elements run
+    in parallel. */
+template <typename scalar_t, int S>
+struct alignas(S*sizeof(scalar_t)) AutoSIMD
+{
+   static const int size = S;
+
+   scalar_t vec[S];
+
+   MFEM_ALWAYS_INLINE scalar_t &operator[](int i) { return vec[i]; }
+   MFEM_ALWAYS_INLINE const scalar_t &operator[](int i) const { return vec[i]; }
+
+   MFEM_ALWAYS_INLINE AutoSIMD &operator=(const scalar_t &e)
+   {
+      for (int i = 0; i < S; i++) { vec[i] = e; }
+      return *this;
+   }
+
+   MFEM_ALWAYS_INLINE AutoSIMD &operator+=(const AutoSIMD &v)
+   {
+      for (int i = 0; i < S; i++) { vec[i] += v[i]; }
+      return *this;
+   }
+
+   MFEM_ALWAYS_INLINE AutoSIMD &operator-=(const AutoSIMD &v)
+   {
+      for (int i = 0; i < S; i++) { vec[i] -= v[i]; }
+      return *this;
+   }
+
+   MFEM_ALWAYS_INLINE AutoSIMD &operator*=(const AutoSIMD &v)
+   {
+      for (int i = 0; i < S; i++) { vec[i] *= v[i]; }
+      return *this;
+   }
+
+   MFEM_ALWAYS_INLINE AutoSIMD &operator*=(const scalar_t &e)
+   {
+      for (int i = 0; i < S; i++) { vec[i] *= e; }
+      return *this;
+   }
+
+   MFEM_ALWAYS_INLINE AutoSIMD operator+(const AutoSIMD &v) const
+   {
+      AutoSIMD r;
+      for (int i = 0; i < S; i++) { r[i] = vec[i] + v[i]; }
+      return r;
+   }
+
+   MFEM_ALWAYS_INLINE AutoSIMD operator-(const AutoSIMD &v) const
+   {
+      AutoSIMD r;
+      for (int i = 0; i < S; i++) { r[i] = vec[i] - v[i]; }
+      return r;
+   }
+
+   MFEM_ALWAYS_INLINE AutoSIMD operator*(const AutoSIMD &v) const
+   {
+      AutoSIMD r;
+      for (int i = 0; i < S; i++) { r[i] = vec[i] * v[i]; }
+      return r;
+   }
+
+   MFEM_ALWAYS_INLINE AutoSIMD operator*(const scalar_t &e) const
+   {
+      AutoSIMD r;
+      for (int i = 0; i < S; i++) { r[i] = vec[i] * e; }
+      return r;
+   }
+
+   /// Multiply-add: this += v * e.
+   MFEM_ALWAYS_INLINE AutoSIMD &fma(const AutoSIMD &v, const scalar_t &e)
+   {
+      for (int i = 0; i < S; i++) { vec[i] += v[i] * e; }
+      return *this;
+   }
+
+   /// Multiply-add: this += v * w.
+   MFEM_ALWAYS_INLINE AutoSIMD &fma(const AutoSIMD &v, const AutoSIMD &w)
+   {
+      for (int i = 0; i < S; i++) { vec[i] += v[i] * w[i]; }
+      return *this;
+   }
+};
+
+template <typename scalar_t, int S>
+MFEM_ALWAYS_INLINE inline
+AutoSIMD<scalar_t,S> operator*(const scalar_t &e, const AutoSIMD<scalar_t,S> &v)
+{
+   return v * e;
+}
+
+} // namespace mfem
+
+#endif // MFEM_SIMD_HPP
@@ -10,6 +10,8 @@
 // Software Foundation) version 2.1 dated February 1999.
 
 #include "linalg.hpp"
+#include "dtensor.hpp"
+#include "../general/forall.hpp"
 #include "../general/globals.hpp"
 #include <iostream>
 #include <iomanip>
@@ -49,22 +51,54 @@ IterativeSolver::IterativeSolver(MPI_Comm _comm)
 #endif
 
 double IterativeSolver::Dot(const Vector &x, const Vector &y) const
+{
+   return GlobalSum(x * y);
+}
+
+double IterativeSolver::GlobalSum(double loc) const
 {
 #ifndef MFEM_USE_MPI
-   return (x * y);
+   return loc;
 #else
    if (dot_prod_type == 0)
    {
-      return (x * y);
+      return loc;
    }
    else
    {
-      double local_dot = (x * y);
-      double global_dot;
+      double glob;
 
-      MPI_Allreduce(&local_dot, &global_dot, 1, MPI_DOUBLE, MPI_SUM, comm);
+      MPI_Allreduce(&loc, &glob, 1, MPI_DOUBLE, MPI_SUM, comm);
+
+      return glob;
+   }
+#endif
+}
 
-      return global_dot;
+void IterativeSolver::StartGlobalSum(const double *loc, double *glob,
+                                     int n) const
+{
+#ifdef MFEM_USE_MPI
+   if (dot_prod_type != 0)
+   {
+#if MPI_VERSION >= 3
+      MPI_Iallreduce(loc, glob, n, MPI_DOUBLE, MPI_SUM, comm, &sum_request);
+#else
+      MPI_Allreduce(const_cast<double*>(loc), glob, n, MPI_DOUBLE, MPI_SUM,
+                    comm);
+#endif
+      return;
+   }
+#endif
+   for (int i = 0; i < n; i++) { glob[i] = loc[i]; }
+}
+
+void IterativeSolver::FinishGlobalSum() const
+{
+#if defined(MFEM_USE_MPI) && MPI_VERSION >= 3
+   if (dot_prod_type != 0)
+   {
+      MPI_Wait(&sum_request, MPI_STATUS_IGNORE);
    }
 #endif
 }
@@ -335,8 +369,7 @@ void CGSolver::Mult(const Vector &b, Vector &x) const
       return;
    }
 
-   oper->Mult(d, z);  // z = A d
-   den = Dot(z, d);
+   den = GlobalSum(oper->MultAndDot(d, z)); // z = A d, den = (A d, d)
    MFEM_ASSERT(IsFinite(den), "den = " << den);
 
    if (print_level >= 0 && den < 0.0)
@@ -408,8 +441,7 @@ void CGSolver::Mult(const Vector &b, Vector &x) const
       {
          add(r, beta, d, d);
       }
-      oper->Mult(d, z);       //  z = A d
-      den = Dot(d, z);
+      den = GlobalSum(oper->MultAndDot(d, z)); //  z = A d
       MFEM_ASSERT(IsFinite(den), "den = " << den);
       if (den <= 0.0)
       {
@@ -441,6 +473,147 @@ void CGSolver::Mult(const Vector &b, Vector &x) const
    final_norm = sqrt(betanom);
 }
 
+void PipelinedCGSolver::UpdateVectors()
+{
+   r.SetSize(width);
+   u.SetSize(width);
+   w.SetSize(width);
+   m.SetSize(width);
+   n.SetSize(width);
+   p.SetSize(width);
+   s.SetSize(width);
+   q.SetSize(width);
+   z.SetSize(width);
+}
+
+void PipelinedCGSolver::Mult(const Vector &b, Vector &x) const
+{
+   double r0 = 0.0, gamma = 0.0, gamma0 = 0.0, gamma_old = 0.0, delta;
+   double alpha = 0.0, beta = 0.0, den, loc[2], glob[2];
+
+   if (iterative_mode)
+   {
+      oper->Mult(x, r);
+      subtract(b, r, r); // r = b - A x
+   }
+   else
+   {
+      r = b;
+      x = 0.0;
+   }
+   if (prec) { prec->Mult(r, u); } // u = B r
+   else { u = r; }
+   oper->Mult(u, w);                // w = A u
+   p = 0.0;
+   s = 0.0;
+   q = 0.0;
+   z = 0.0;
+
+   const int N = width;
+   converged = 0;
+   final_iter = max_iter;
+   for (int i = 0; true; i++)
+   {
+      // gamma = (r, u) and delta = (w, u), in one pass and one global sum
+      if (Device::Allows(Backend::DEVICE_MASK))
+      {
+         loc[0] = r * u;
+         loc[1] = w * u;
+      }
+      else
+      {
+         const double *d_r = r.GetData(), *d_u = u.GetData();
+         const double *d_w = w.GetData();
+         double dot_ru = 0.0, dot_wu = 0.0;
+         for (int k = 0; k < N; k++)
+         {
+            dot_ru += d_r[k] * d_u[k];
+            dot_wu += d_w[k] * d_u[k];
+         }
+         loc[0] = dot_ru;
+         loc[1] = dot_wu;
+      }
+      StartGlobalSum(loc, glob, 2);
+      if (prec) { prec->Mult(w, m); } // m = B w
+      else { m = w; }
+      oper->Mult(m, n);                // n = A m
+      FinishGlobalSum();
+      gamma = glob[0];
+      delta = glob[1];
+      MFEM_ASSERT(IsFinite(gamma) && IsFinite(delta),
+                  "gamma = " << gamma << ", delta = " << delta);
+
+      if (i == 0)
+      {
+         gamma0 = gamma;
+         r0 = std::max(gamma*rel_tol*rel_tol, abs_tol*abs_tol);
+      }
+      if (print_level == 1 || (print_level == 3 && i == 0))
+      {
+         mfem::out << "   Iteration : " << setw(3) << i << "  (B r, r) = "
+                   << gamma << (print_level == 3 ? " ...\n" : "\n");
+      }
+      if (gamma <= r0 && (i == 0 || gamma < r0))
+      {
+         if (print_level == 2)
+         {
+            mfem::out << "Number of pipelined PCG iterations: " << i << '\n';
+         }
+         else if (print_level == 3 && i > 0)
+         {
+            mfem::out << "   Iteration : " << setw(3) << i << "  (B r, r) = "
+                      << gamma << '\n';
+         }
+         converged = 1;
+         final_iter = i;
+         break;
+      }
+      if (i >= max_iter) { break; }
+
+      beta = (i > 0) ? gamma/gamma_old : 0.0;
+      den = (i > 0) ? delta - beta*gamma/alpha : delta;
+      if (den <= 0.0)
+      {
+         if (print_level >= 0)
+         {
+            mfem::out << "Pipelined PCG: The operator is not positive definite."
+                      << " (A p, p) = " << den << '\n';
+         }
+         if (den == 0.0) { final_iter = i; break; }
+      }
+      alpha = gamma/den;
+      gamma_old = gamma;
+
+      // z = n + beta z,  q = m + beta q,  s = w + beta s,  p = u + beta p,
+      // x = x + alpha p, r = r - alpha s, u = u - alpha q, w = w - alpha z
+      const double a = alpha, bt = beta;
+      const DeviceVector d_n(n, N), d_m(m, N);
+      DeviceVector d_z(z, N), d_q(q, N), d_s(s, N), d_p(p, N);
+      DeviceVector d_x(x, N), d_r(r, N), d_u(u, N), d_w(w, N);
+      MFEM_FORALL(k, N,
+      {
+         d_z[k] = d_n[k] + bt*d_z[k];
+         d_q[k] = d_m[k] + bt*d_q[k];
+         d_s[k] = d_w[k] + bt*d_s[k];
+         d_p[k] = d_u[k] + bt*d_p[k];
+         d_x[k] += a*d_p[k];
+         d_r[k] -= a*d_s[k];
+         d_u[k] -= a*d_q[k];
+         d_w[k] -= a*d_z[k];
+      });
+   }
+   if (print_level >= 0 && !converged)
+   {
+      mfem::out << "Pipelined PCG: No convergence!" << '\n';
+   }
+   if (print_level >= 1 || (print_level >= 0 && !converged))
+   {
+      mfem::out << "Average reduction factor = "
+                << pow(gamma/gamma0, 0.5/std::max(final_iter, 1)) << '\n';
+   }
+   final_norm = sqrt(gamma);
+}
+
 void CG(const Operator &A, const Vector &b, Vector &x,
         int print_iter, int max_num_iter,
         double RTOLERANCE, double ATOLERANCE)
@@ -1673,6 +1846,154 @@ slbqp_done:
    }
 }
 
+OperatorJacobiSmoother::OperatorJacobiSmoother(const Vector &d,
+                                               const Array<int> &ess_tdof_list,
+                                               const double dmpng)
+   : Solver(d.Size()), dinv(d.Size()), damping(dmpng)
+{
+   for (int i = 0; i < d.Size(); i++)
+   {
+      MFEM_VERIFY(d(i) != 0.0, "zero diagonal entry " << i);
+      dinv(i) = 1.0 / d(i);
+   }
+   for (int i = 0; i < ess_tdof_list.Size(); i++)
+   {
+      dinv(ess_tdof_list[i]) = 1.0;
+   }
+}
+
+void OperatorJacobiSmoother::Mult(const Vector &b, Vector &x) const
+{
+   MFEM_VERIFY(b.Size() == dinv.Size(), "invalid input vector");
+   x.SetSize(b.Size());
+   for (int i = 0; i < b.Size(); i++)
+   {
+      x(i) = damping * dinv(i) * b(i);
+   }
+}
+
+OperatorChebyshevSmoother::OperatorChebyshevSmoother(
+   const Operator *op, const Vector &diag, const Array<int> &ess_tdof_list,
+   const int ordr, const double max_eig_estimate, const double lfrac)
+   : Solver(diag.Size()), oper(op), dinv(diag.Size()), order(ordr),
+     max_eig(max_eig_estimate), lower_frac(lfrac),
+     r(diag.Size()), z(diag.Size()), d(diag.Size())
+{
+#ifdef MFEM_USE_MPI
+   global = false;
+#endif
+   Setup(diag, ess_tdof_list);
+}
+
+#ifdef MFEM_USE_MPI
+OperatorChebyshevSmoother::OperatorChebyshevSmoother(
+   MPI_Comm comm_, const Operator *op, const Vector &diag,
+   const Array<int> &ess_tdof_list, const int ordr,
+   const double max_eig_estimate, const double lfrac)
+   : Solver(diag.Size()), oper(op), dinv(diag.Size()), order(ordr),
+     max_eig(max_eig_estimate), lower_frac(lfrac),
+     r(diag.Size()), z(diag.Size()), d(diag.Size()), global(true),
+     comm(comm_)
+{
+   Setup(diag, ess_tdof_list);
+}
+#endif
+
+double OperatorChebyshevSmoother::GlobalSum(double loc) const
+{
+#ifdef MFEM_USE_MPI
+   if (global)
+   {
+      double glob;
+      MPI_Allreduce(&loc, &glob, 1, MPI_DOUBLE, MPI_SUM, comm);
+      return glob;
+   }
+#endif
+   return loc;
+}
+
+void OperatorChebyshevSmoother::Setup(const Vector &diag,
+                                      const Array<int> &ess_tdof_list)
+{
+   MFEM_VERIFY(oper->Height() == diag.Size() && oper->Width() == diag.Size(),
+               "invalid diagonal size");
+   MFEM_VERIFY(order > 0 && lower_frac > 0.0 && lower_frac < 1.0,
+               "invalid smoother parameters");
+   for (int i = 0; i < diag.Size(); i++)
+   {
+      MFEM_VERIFY(diag(i) != 0.0, "zero diagonal entry " << i);
+      dinv(i) = 1.0 / diag(i);
+   }
+   for (int i = 0; i < ess_tdof_list.Size(); i++)
+   {
+      dinv(ess_tdof_list[i]) = 1.0;
+   }
+   if (max_eig <= 0.0)
+   {
+      // Power iteration for the largest eigenvalue of D^{-1} A, with the
+      // Rayleigh quotient (A v, v) / (D v, v). The result is increased by 10%
+      // since the iteration converges from below.
+      z.Randomize(1);
+      double lambda = 0.0;
+      for (int it = 0; it < 10; it++)
+      {
+         z /= sqrt(GlobalSum(z * z));
+         oper->Mult(z, r);
+         double zDz = 0.0;
+         for (int i = 0; i < z.Size(); i++) { zDz += z(i) * z(i) / dinv(i); }
+         lambda = GlobalSum(r * z) / GlobalSum(zDz);
+         for (int i = 0; i < z.Size(); i++) { z(i) = dinv(i) * r(i); }
+      }
+      max_eig = 1.1 * lambda;
+   }
+}
+
+void OperatorChebyshevSmoother::SetOperator(const Operator &op)
+{
+   MFEM_VERIFY(op.Height() == height && op.Width() == width,
+               "invalid operator size");
+   oper = &op;
+}
+
+void OperatorChebyshevSmoother::Mult(const Vector &b, Vector &x) const
+{
+   // Chebyshev iteration for D^{-1} A x = D^{-1} b on [lower, upper], see
+   // Y. Saad, Iterative Methods for Sparse Linear Systems, Algorithm 12.1.
+   const double upper = max_eig, lower = lower_frac * max_eig;
+   const double theta = 0.5 * (upper + lower);
+   const double delta = 0.5 * (upper - lower);
+   const double sigma = theta / delta;
+   double rho = 1.0 / sigma;
+
+   x.SetSize(b.Size());
+   if (iterative_mode)
+   {
+      oper->Mult(x, r);
+      subtract(b, r, r); // r = b - A x
+   }
+   else
+   {
+      r = b;
+      x = 0.0;
+   }
+   for (int i = 0; i < r.Size(); i++) { d(i) = dinv(i) * r(i) / theta; }
+   for (int k = 1; k <= order; k++)
+   {
+      x += d;
+      if (k == order) { break; }
+      oper->Mult(d, z);
+      r -= z; // r = b - A x
+      const double rho_new = 1.0 / (2.0 * sigma - rho);
+      const double s = 2.0 * rho_new / delta;
+      for (int i = 0; i < r.Size(); i++)
+      {
+         d(i) = rho_new * rho * d(i) + s * dinv(i) * r(i);
+      }
+      rho = rho_new;
+   }
+}
+
+
 #ifdef MFEM_USE_SUITESPARSE
 
 void UMFPackSolver::Init()
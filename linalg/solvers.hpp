@@ -35,6 +35,7 @@ class IterativeSolver : public Solver
 private:
    int dot_prod_type; // 0 - local, 1 - global over 'comm'
    MPI_Comm comm;
+   mutable MPI_Request sum_request;
 #endif
 
 protected:
@@ -50,6 +51,12 @@ protected:
 
    double Dot(const Vector &x, const Vector &y) const;
    double Norm(const Vector &x) const { return sqrt(Dot(x, x)); }
+   /// Return the sum of the local value @a loc over all MPI ranks.
+   double GlobalSum(double loc) const;
+   /** @brief Start the sum of the @a n local values @a loc over all MPI ranks
+       into @a glob, which is complete after FinishGlobalSum(). */
+   void StartGlobalSum(const double *loc, double *glob, int n) const;
+   void FinishGlobalSum() const;
 
 public:
    IterativeSolver();
@@ -128,6 +135,34 @@ public:
    virtual void Mult(const Vector &b, Vector &x) const;
 };
 
+/** @brief Pipelined conjugate gradient method.
+
+    The pipelined variant of Ghysels and Vanroose is mathematically equivalent
+    to CGSolver. The two dot products of each iteration are computed in one
+    pass and summed over the MPI ranks with one non-blocking (with MPI 3)
+    reduction, which overlaps the application of the preconditioner and of the
+    operator. All vector updates of an iteration are fused in one pass. It
+    uses more vectors and is less stable in finite precision than CGSolver. */
+class PipelinedCGSolver : public IterativeSolver
+{
+protected:
+   mutable Vector r, u, w, m, n, p, s, q, z;
+
+   void UpdateVectors();
+
+public:
+   PipelinedCGSolver() { }
+
+#ifdef MFEM_USE_MPI
+   PipelinedCGSolver(MPI_Comm _comm) : IterativeSolver(_comm) { }
+#endif
+
+   virtual void SetOperator(const Operator &op)
+   { IterativeSolver::SetOperator(op); UpdateVectors(); }
+
+   virtual void Mult(const Vector &b, Vector &x) const;
+};
+
 /// Conjugate gradient method. (tolerances are squared)
 void CG(const Operator &A, const Vector &b, Vector &x,
         int print_iter = 0, int max_num_iter = 1000,
@@ -338,6 +373,82 @@ public:
 };
 
 
+/** @brief Jacobi smoother defined by the diagonal of an operator, e.g. from
+    BilinearForm::AssembleDiagonal(): x = damping D^{-1} b.
+
+    The diagonal is replaced by 1 at the essential dofs, matching the identity
+    rows of a ConstrainedOperator. The operator itself is not needed, so it can
+    be applied to any (e.g. partially assembled) operator. */
+class OperatorJacobiSmoother : public Solver
+{
+protected:
+   Vector dinv;
+   double damping;
+
+public:
+   OperatorJacobiSmoother(const Vector &d, const Array<int> &ess_tdof_list,
+                          const double damping = 1.0);
+
+   virtual void Mult(const Vector &b, Vector &x) const;
+
+   /// The operator is not used, only its diagonal given to the constructor.
+   virtual void SetOperator(const Operator &op) { }
+};
+
+/** @brief Chebyshev polynomial smoother of the given order for the operator
+    D^{-1} A, where D is the diagonal of A, e.g. from
+    BilinearForm::AssembleDiagonal().
+
+    The polynomial damps the eigenmodes of D^{-1} A in the interval
+    [lower_frac*max_eig, max_eig], using only the action of the operator. If
+    the estimate @a max_eig_estimate is not positive, it is computed by a power
+    iteration. In parallel, the constructor with an MPI_Comm must be used, so
+    that the dot products of the power iteration are global. The diagonal is
+    replaced by 1 at the essential dofs. */
+class OperatorChebyshevSmoother : public Solver
+{
+protected:
+   const Operator *oper; ///< Not owned
+   Vector dinv;
+   int order;
+   double max_eig, lower_frac;
+   mutable Vector r, z, d;
+#ifdef MFEM_USE_MPI
+   bool global; ///< Are the dot products reduced over #comm?
+   MPI_Comm comm;
+#endif
+
+   /// Set up the inverse diagonal and estimate the largest eigenvalue.
+   void Setup(const Vector &diag, const Array<int> &ess_tdof_list);
+
+   /// Return the sum of @a loc over #comm in parallel, or @a loc.
+   double GlobalSum(double loc) const;
+
+public:
+   OperatorChebyshevSmoother(const Operator *oper, const Vector &diag,
+                             const Array<int> &ess_tdof_list, const int order,
+                             const double max_eig_estimate = 0.0,
+                             const double lower_frac = 0.3);
+
+#ifdef MFEM_USE_MPI
+   /// Parallel version, where the vectors are distributed over @a comm.
+   OperatorChebyshevSmoother(MPI_Comm comm, const Operator *oper,
+                             const Vector &diag,
+                             const Array<int> &ess_tdof_list, const int order,
+                             const double max_eig_estimate = 0.0,
+                             const double lower_frac = 0.3);
+#endif
+
+   /// Return the upper bound of the smoothed interval.
+   double GetMaxEigenvalue() const { return max_eig; }
+
+   /// Apply the smoother; the initial guess is used in iterative_mode.
+   virtual void Mult(const Vector &b, Vector &x) const;
+
+   /// The operator must have the same size; the diagonal is not updated.
+   virtual void SetOperator(const Operator &op);
+};
+
 #ifdef MFEM_USE_SUITESPARSE
 
 /// Direct sparse solver using UMFPACK
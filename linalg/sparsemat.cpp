@@ -2944,69 +2944,68 @@ SparseMatrix *TransposeAbstractSparseMatrix (const AbstractSparseMatrix &A,
 SparseMatrix *Mult (const SparseMatrix &A, const SparseMatrix &B,
                     SparseMatrix *OAB)
 {
-   int nrowsA, ncolsA, nrowsB, ncolsB;
-   int *A_i, *A_j, *B_i, *B_j, *C_i, *C_j, *B_marker;
-   double *A_data, *B_data, *C_data;
-   int ia, ib, ic, ja, jb, num_nonzeros;
-   int row_start, counter;
-   double a_entry, b_entry;
-   SparseMatrix *C;
-
-   nrowsA = A.Height();
-   ncolsA = A.Width();
-   nrowsB = B.Height();
-   ncolsB = B.Width();
+   const int nrowsA = A.Height();
+   const int ncolsA = A.Width();
+   const int nrowsB = B.Height();
+   const int ncolsB = B.Width();
 
    MFEM_VERIFY(ncolsA == nrowsB,
                "number of columns of A (" << ncolsA
                << ") must equal number of rows of B (" << nrowsB << ")");
 
-   A_i    = A.GetI();
-   A_j    = A.GetJ();
-   A_data = A.GetData();
-   B_i    = B.GetI();
-   B_j    = B.GetJ();
-   B_data = B.GetData();
-
-   B_marker = new int[ncolsB];
-
-   for (ib = 0; ib < ncolsB; ib++)
-   {
-      B_marker[ib] = -1;
-   }
+   const int *A_i = A.GetI(), *A_j = A.GetJ();
+   const double *A_data = A.GetData();
+   const int *B_i = B.GetI(), *B_j = B.GetJ();
+   const double *B_data = B.GetData();
+   int *C_i, *C_j;
+   double *C_data;
+   SparseMatrix *C;
 
+   // The rows of C are computed independently, in parallel with OpenMP. Each
+   // thread uses its own dense marker array over the columns of B: in the
+   // symbolic phase, B_marker[jb] == ic if column jb is already counted in row
+   // ic; in the numeric phase, B_marker[jb] is the position of column jb in
+   // the current row ic if B_marker[jb] >= C_i[ic].
    if (OAB == NULL)
    {
       C_i = mfem::New<int>(nrowsA+1);
+      C_i[0] = 0;
 
-      C_i[0] = num_nonzeros = 0;
-      for (ic = 0; ic < nrowsA; ic++)
+#ifdef MFEM_USE_OPENMP
+      #pragma omp parallel
+#endif
       {
-         for (ia = A_i[ic]; ia < A_i[ic+1]; ia++)
+         Array<int> B_marker(ncolsB);
+         B_marker = -1;
+#ifdef MFEM_USE_OPENMP
+         #pragma omp for schedule(static)
+#endif
+         for (int ic = 0; ic < nrowsA; ic++)
          {
-            ja = A_j[ia];
-            for (ib = B_i[ja]; ib < B_i[ja+1]; ib++)
+            int row_nnz = 0;
+            for (int ia = A_i[ic]; ia < A_i[ic+1]; ia++)
             {
-               jb = B_j[ib];
-               if (B_marker[jb] != ic)
+               const int ja = A_j[ia];
+               for (int ib = B_i[ja]; ib < B_i[ja+1]; ib++)
                {
-                  B_marker[jb] = ic;
-                  num_nonzeros++;
+                  const int jb = B_j[ib];
+                  if (B_marker[jb] != ic)
+                  {
+                     B_marker[jb] = ic;
+                     row_nnz++;
+                  }
                }
             }
+            C_i[ic+1] = row_nnz;
          }
-         C_i[ic+1] = num_nonzeros;
       }
+      for (int ic = 0; ic < nrowsA; ic++) { C_i[ic+1] += C_i[ic]; }
 
+      const int num_nonzeros = C_i[nrowsA];
       C_j    = mfem::New<int>(num_nonzeros);
       C_data = mfem::New<double>(num_nonzeros);
 
       C = new SparseMatrix (C_i, C_j, C_data, nrowsA, ncolsB);
-
-      for (ib = 0; ib < ncolsB; ib++)
-      {
-         B_marker[ib] = -1;
-      }
    }
    else
    {
@@ -3019,50 +3018,64 @@ SparseMatrix *Mult (const SparseMatrix &A, const SparseMatrix &B,
                   << " ncolsB = " << ncolsB
                   << ", C->Width() = " << C->Width());
 
-      // C_i    = C -> GetI(); // not used
+      C_i    = C -> GetI();
       C_j    = C -> GetJ();
       C_data = C -> GetData();
    }
 
-   counter = 0;
-   for (ic = 0; ic < nrowsA; ic++)
+   bool pattern_ok = true;
+#ifdef MFEM_USE_OPENMP
+   #pragma omp parallel reduction(&&:pattern_ok)
+#endif
    {
-      // row_start = C_i[ic];
-      row_start = counter;
-      for (ia = A_i[ic]; ia < A_i[ic+1]; ia++)
+      Array<int> B_marker(ncolsB);
+      B_marker = -1;
+#ifdef MFEM_USE_OPENMP
+      #pragma omp for schedule(static)
+#endif
+      for (int ic = 0; ic < nrowsA; ic++)
       {
-         ja = A_j[ia];
-         a_entry = A_data[ia];
-         for (ib = B_i[ja]; ib < B_i[ja+1]; ib++)
+         const int row_start = C_i[ic];
+         int counter = row_start;
+         if (OAB)
          {
-            jb = B_j[ib];
-            b_entry = B_data[ib];
-            if (B_marker[jb] < row_start)
+            // Reuse the sparsity of OAB: only the values are computed
+            for (int k = row_start; k < C_i[ic+1]; k++)
             {
-               B_marker[jb] = counter;
-               if (OAB == NULL)
+               B_marker[C_j[k]] = k;
+               C_data[k] = 0.0;
+            }
+         }
+         for (int ia = A_i[ic]; ia < A_i[ic+1]; ia++)
+         {
+            const int ja = A_j[ia];
+            const double a_entry = A_data[ia];
+            for (int ib = B_i[ja]; ib < B_i[ja+1]; ib++)
+            {
+               const int jb = B_j[ib];
+               const double b_entry = B_data[ib];
+               if (B_marker[jb] >= row_start)
                {
+                  C_data[B_marker[jb]] += a_entry*b_entry;
+               }
+               else if (OAB)
+               {
+                  pattern_ok = false;
+               }
+               else
+               {
+                  B_marker[jb] = counter;
                   C_j[counter] = jb;
+                  C_data[counter] = a_entry*b_entry;
+                  counter++;
                }
-               C_data[counter] = a_entry*b_entry;
-               counter++;
-            }
-            else
-            {
-               C_data[B_marker[jb]] += a_entry*b_entry;
             }
          }
       }
    }
 
-   MFEM_VERIFY(
-      OAB == NULL || counter == OAB->NumNonZeroElems(),
-      "With pre-allocated output matrix, number of non-zeros ("
-      << OAB->NumNonZeroElems()
-      << ") did not match number of entries changed from matrix-matrix multiply, "
-      << counter);
-
-   delete [] B_marker;
+   MFEM_VERIFY(pattern_ok, "the pre-allocated output matrix does not contain "
+               "the sparsity pattern of the matrix-matrix product");
 
    return C;
 }
@@ -457,7 +457,12 @@ SparseMatrix *TransposeAbstractSparseMatrix (const AbstractSparseMatrix &A,
     of A.B and store the result in OAB.
     If OAB is NULL, we create a new SparseMatrix to store
     the result and return a pointer to it.
-    All matrices must be finalized. */
+    All matrices must be finalized.
+
+    The rows of the product are computed in parallel with OpenMP when
+    MFEM_USE_OPENMP is enabled. With OAB, e.g. the result of a previous product
+    of matrices with the same sparsity, only the values are computed; the
+    pattern of OAB may contain more entries than A.B, which are set to zero. */
 SparseMatrix *Mult(const SparseMatrix &A, const SparseMatrix &B,
                    SparseMatrix *OAB = NULL);
 
@@ -0,0 +1,262 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+// Implementation of the BSR and SELL-C-sigma matrix formats
+
+#include "sparsemat_formats.hpp"
+#include "sparsemat.hpp"
+
+#include <algorithm>
+
+namespace mfem
+{
+
+// Largest block size, the size of the block buffers of the generic kernels.
+static const int BSR_MAX_BS = 16;
+
+BSRMatrix::BSRMatrix(const SparseMatrix &mat, int bs_)
+   : Operator(mat.Height(), mat.Width()), bs(bs_)
+{
+   MFEM_VERIFY(mat.Finalized(), "the matrix must be finalized");
+   MFEM_VERIFY(bs > 0 && bs <= BSR_MAX_BS, "the block size " << bs
+               << " is not in [1, " << BSR_MAX_BS << "]");
+   MFEM_VERIFY(height % bs == 0 && width % bs == 0,
+               "the matrix size is not a multiple of the block size " << bs);
+   const int *Ip = mat.GetI(), *Jp = mat.GetJ();
+   const double *Ap = mat.GetData();
+   const int nbr = height/bs, nbc = width/bs;
+
+   // Count the blocks of each block row, then fill them. The position of block
+   // column J in the current block row is pos[J] if pos[J] >= I[row].
+   Array<int> pos(nbc);
+   pos = -1;
+   I.SetSize(nbr + 1);
+   I[0] = 0;
+   for (int br = 0; br < nbr; br++)
+   {
+      int nb = 0;
+      for (int i = br*bs; i < (br+1)*bs; i++)
+      {
+         for (int k = Ip[i]; k < Ip[i+1]; k++)
+         {
+            const int bc = Jp[k]/bs;
+            if (pos[bc] != br) { pos[bc] = br; nb++; }
+         }
+      }
+      I[br+1] = I[br] + nb;
+   }
+   J.SetSize(I[nbr]);
+   A.SetSize(I[nbr]*bs*bs);
+   A = 0.0;
+   pos = -1;
+   for (int br = 0; br < nbr; br++)
+   {
+      int nb = I[br];
+      for (int i = br*bs; i < (br+1)*bs; i++)
+      {
+         for (int k = Ip[i]; k < Ip[i+1]; k++)
+         {
+            const int bc = Jp[k]/bs;
+            if (pos[bc] < I[br]) { pos[bc] = nb; J[nb++] = bc; }
+            A[(pos[bc]*bs + i - br*bs)*bs + Jp[k] - bc*bs] += Ap[k];
+         }
+      }
+   }
+}
+
+// y += a A x for blocks of size BS, or bs when BS = 0.
+template <int BS>
+static void BSRAddMult(const int nbr, const int bs_, const int *I,
+                       const int *J, const double *A, const double *x,
+                       double *y, const double a)
+{
+   const int bs = BS ? BS : bs_;
+   const int MBS = BS ? BS : BSR_MAX_BS;
+#ifdef MFEM_USE_OPENMP
+   #pragma omp parallel for
+#endif
+   for (int br = 0; br < nbr; br++)
+   {
+      double yb[MBS];
+      for (int r = 0; r < bs; r++) { yb[r] = 0.0; }
+      for (int k = I[br]; k < I[br+1]; k++)
+      {
+         const double *Ak = A + k*bs*bs;
+         const double *xb = x + J[k]*bs;
+         for (int r = 0; r < bs; r++)
+         {
+            for (int c = 0; c < bs; c++) { yb[r] += Ak[r*bs + c] * xb[c]; }
+         }
+      }
+      for (int r = 0; r < bs; r++) { y[br*bs + r] += a * yb[r]; }
+   }
+}
+
+// y += a A^t x for blocks of size BS, or bs when BS = 0.
+template <int BS>
+static void BSRAddMultTranspose(const int nbr, const int bs_, const int *I,
+                                const int *J, const double *A,
+                                const double *x, double *y, const double a)
+{
+   const int bs = BS ? BS : bs_;
+   const int MBS = BS ? BS : BSR_MAX_BS;
+   for (int br = 0; br < nbr; br++)
+   {
+      double xb[MBS];
+      for (int r = 0; r < bs; r++) { xb[r] = a * x[br*bs + r]; }
+      for (int k = I[br]; k < I[br+1]; k++)
+      {
+         const double *Ak = A + k*bs*bs;
+         double *yb = y + J[k]*bs;
+         for (int r = 0; r < bs; r++)
+         {
+            for (int c = 0; c < bs; c++) { yb[c] += Ak[r*bs + c] * xb[r]; }
+         }
+      }
+   }
+}
+
+void BSRMatrix::AddMult(const Vector &x, Vector &y, const double a) const
+{
+   MFEM_ASSERT(x.Size() == width && y.Size() == height, "");
+   const int nbr = height/bs;
+   switch (bs)
+   {
+      case 1: BSRAddMult<1>(nbr, bs, I, J, A, x, y, a); break;
+      case 2: BSRAddMult<2>(nbr, bs, I, J, A, x, y, a); break;
+      case 3: BSRAddMult<3>(nbr, bs, I, J, A, x, y, a); break;
+      case 4: BSRAddMult<4>(nbr, bs, I, J, A, x, y, a); break;
+      default: BSRAddMult<0>(nbr, bs, I, J, A, x, y, a); break;
+   }
+}
+
+void BSRMatrix::AddMultTranspose(const Vector &x, Vector &y,
+                                 const double a) const
+{
+   MFEM_ASSERT(x.Size() == height && y.Size() == width, "");
+   const int nbr = height/bs;
+   switch (bs)
+   {
+      case 1: BSRAddMultTranspose<1>(nbr, bs, I, J, A, x, y, a); break;
+      case 2: BSRAddMultTranspose<2>(nbr, bs, I, J, A, x, y, a); break;
+      case 3: BSRAddMultTranspose<3>(nbr, bs, I, J, A, x, y, a); break;
+      case 4: BSRAddMultTranspose<4>(nbr, bs, I, J, A, x, y, a); break;
+      default: BSRAddMultTranspose<0>(nbr, bs, I, J, A, x, y, a); break;
+   }
+}
+
+
+SELLMatrix::SELLMatrix(const SparseMatrix &mat, int sigma)
+   : Operator(mat.Height(), mat.Width())
+{
+   MFEM_VERIFY(mat.Finalized(), "the matrix must be finalized");
+   const int C = ChunkSize;
+   const int *Ip = mat.GetI(), *Jp = mat.GetJ();
+   const double *Ap = mat.GetData();
+   const int nchunks = (height + C - 1)/C;
+
+   // Sort the rows by decreasing length within the windows of sigma rows
+   row.SetSize(nchunks*C);
+   for (int i = 0; i < row.Size(); i++) { row[i] = (i < height) ? i : -1; }
+   sigma = std::max(sigma, 1);
+   for (int w = 0; w < height; w += sigma)
+   {
+      std::stable_sort(row.GetData() + w,
+                       row.GetData() + std::min(w + sigma, height),
+                       [Ip](int i, int j)
+      { return Ip[i+1] - Ip[i] > Ip[j+1] - Ip[j]; });
+   }
+
+   chunk.SetSize(nchunks + 1);
+   chunk[0] = 0;
+   for (int k = 0; k < nchunks; k++)
+   {
+      int len = 0;
+      for (int l = 0; l < C; l++)
+      {
+         const int i = row[k*C + l];
+         if (i >= 0) { len = std::max(len, Ip[i+1] - Ip[i]); }
+      }
+      chunk[k+1] = chunk[k] + len;
+   }
+   col.SetSize(chunk[nchunks]*C);
+   val.SetSize(chunk[nchunks]*C);
+   col = 0;
+   val = 0.0;
+   for (int k = 0; k < nchunks; k++)
+   {
+      for (int l = 0; l < C; l++)
+      {
+         const int i = row[k*C + l];
+         if (i < 0) { continue; }
+         for (int j = 0; j < Ip[i+1] - Ip[i]; j++)
+         {
+            col[C*(chunk[k] + j) + l] = Jp[Ip[i] + j];
+            val[C*(chunk[k] + j) + l] = Ap[Ip[i] + j];
+         }
+      }
+   }
+}
+
+void SELLMatrix::AddMult(const Vector &x, Vector &y, const double a) const
+{
+   MFEM_ASSERT(x.Size() == width && y.Size() == height, "");
+   const int C = ChunkSize;
+   const int nchunks = NumChunks();
+   const int *ch = chunk, *cl = col, *rw = row;
+   const double *v = val, *xp = x;
+   double *yp = y;
+#ifdef MFEM_USE_OPENMP
+   #pragma omp parallel for
+#endif
+   for (int k = 0; k < nchunks; k++)
+   {
+      simd_t s, vs, xs;
+      s = 0.0;
+      for (int j = ch[k]; j < ch[k+1]; j++)
+      {
+         for (int l = 0; l < C; l++)
+         {
+            vs[l] = v[C*j + l];
+            xs[l] = xp[cl[C*j + l]];
+         }
+         s.fma(vs, xs);
+      }
+      for (int l = 0; l < C; l++)
+      {
+         const int i = rw[k*C + l];
+         if (i >= 0) { yp[i] += a * s[l]; }
+      }
+   }
+}
+
+void SELLMatrix::AddMultTranspose(const Vector &x, Vector &y,
+                                  const double a) const
+{
+   MFEM_ASSERT(x.Size() == height && y.Size() == width, "");
+   const int C = ChunkSize;
+   const int nchunks = NumChunks();
+   for (int k = 0; k < nchunks; k++)
+   {
+      simd_t xs;
+      for (int l = 0; l < C; l++)
+      {
+         const int i = row[k*C + l];
+         xs[l] = (i >= 0) ? a * x(i) : 0.0;
+      }
+      for (int j = chunk[k]; j < chunk[k+1]; j++)
+      {
+         for (int l = 0; l < C; l++) { y(col[C*j + l]) += val[C*j + l]*xs[l]; }
+      }
+   }
+}
+
+}
@@ -0,0 +1,134 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#ifndef MFEM_SPARSEMAT_FORMATS_HPP
+#define MFEM_SPARSEMAT_FORMATS_HPP
+
+// Alternative storage formats of a finalized SparseMatrix, used for faster
+// matrix-vector products
+
+#include "../config/config.hpp"
+#include "../general/array.hpp"
+#include "operator.hpp"
+#include "simd.hpp"
+
+namespace mfem
+{
+
+class SparseMatrix;
+
+/** @brief Block compressed sparse row (BSR) copy of a SparseMatrix with square
+    dense blocks of size @a bs x @a bs.
+
+    Block (I,J) contains the entries (I*bs+r, J*bs+c), 0 <= r,c < bs, so the
+    natural blocks of a vector problem with Ordering::byVDIM are obtained with
+    @a bs equal to the vector dimension. One column index is stored per block
+    instead of one per entry and the products with the blocks are unrolled for
+    @a bs <= 4. Blocks with some zero entries are stored as dense blocks.
+
+    The products with the matrix are parallelized over the block rows with
+    OpenMP when MFEM_USE_OPENMP is enabled. The transposed products are
+    sequential. */
+class BSRMatrix : public Operator
+{
+protected:
+   int bs; ///< Size of the blocks.
+   Array<int> I; ///< Offsets of the block rows in #J, size height/bs + 1.
+   Array<int> J; ///< Block column index of the blocks.
+   /// Entries of the blocks, each block stored row-wise in bs*bs entries.
+   Array<double> A;
+
+public:
+   /** @brief Convert the finalized matrix @a mat, whose height and width must
+       be multiples of @a bs, with 1 <= @a bs <= 16. */
+   BSRMatrix(const SparseMatrix &mat, int bs);
+
+   /// Return the size of the blocks.
+   int BlockSize() const { return bs; }
+
+   /// Return the number of stored blocks.
+   int NumBlocks() const { return J.Size(); }
+
+   /// Return the number of stored entries, including zeros in the blocks.
+   int NumStoredEntries() const { return A.Size(); }
+
+   /// y += a * A.x
+   void AddMult(const Vector &x, Vector &y, const double a = 1.0) const;
+
+   /// y += a * A^t x
+   void AddMultTranspose(const Vector &x, Vector &y,
+                         const double a = 1.0) const;
+
+   virtual void Mult(const Vector &x, Vector &y) const
+   { y = 0.0; AddMult(x, y); }
+
+   virtual void MultTranspose(const Vector &x, Vector &y) const
+   { y = 0.0; AddMultTranspose(x, y); }
+};
+
+/** @brief SELL-C-sigma copy of a SparseMatrix.
+
+    The rows are split in chunks of C = #ChunkSize consecutive rows, C being
+    the number of doubles in the AutoSIMD vectors of simd.hpp. The entries of
+    a chunk are stored column-wise, padded with zeros to the longest row of the
+    chunk, so that the C rows of a chunk are multiplied together in the lanes of
+    one SIMD vector. To limit the padding, the rows are first sorted by
+    decreasing length within windows of @a sigma rows. @a sigma = 1 keeps the
+    original order, @a sigma >= height sorts all the rows.
+
+    The products with the matrix are parallelized over the chunks with OpenMP
+    when MFEM_USE_OPENMP is enabled. The transposed products are sequential. */
+class SELLMatrix : public Operator
+{
+public:
+   /// The number of rows in a chunk, i.e. the SIMD width.
+   static const int ChunkSize = MFEM_SIMD_BYTES/sizeof(double);
+
+protected:
+   typedef AutoSIMD<double,ChunkSize> simd_t;
+
+   /// Original row of the sorted rows, -1 for the padding rows.
+   Array<int> row;
+   /// Offsets of the chunks in #col and #val, in units of ChunkSize entries.
+   Array<int> chunk;
+   /** @brief Column indices and entries: entry j of the row l of chunk k is at
+       ChunkSize*(chunk[k] + j) + l. The padding has column 0 and value 0. */
+   Array<int> col;
+   Array<double> val;
+
+public:
+   /** @brief Convert the finalized matrix @a mat, sorting the rows within
+       windows of @a sigma rows. */
+   SELLMatrix(const SparseMatrix &mat, int sigma = 32*ChunkSize);
+
+   /// Return the number of chunks.
+   int NumChunks() const { return chunk.Size() - 1; }
+
+   /// Return the number of stored entries, including the padding.
+   int NumStoredEntries() const { return val.Size(); }
+
+   /// y += a * A.x
+   void AddMult(const Vector &x, Vector &y, const double a = 1.0) const;
+
+   /// y += a * A^t x
+   void AddMultTranspose(const Vector &x, Vector &y,
+                         const double a = 1.0) const;
+
+   virtual void Mult(const Vector &x, Vector &y) const
+   { y = 0.0; AddMult(x, y); }
+
+   virtual void MultTranspose(const Vector &x, Vector &y) const
+   { y = 0.0; AddMultTranspose(x, y); }
+};
+
+}
+
+#endif
@@ -15,7 +15,11 @@
 #include "matrix.hpp"
 #include "sparsemat.hpp"
 #include "sparsesmoothers.hpp"
+#include "../general/sort_pairs.hpp"
 #include <iostream>
+#include <algorithm>
+#include <functional>
+#include <cmath>
 
 namespace mfem
 {
@@ -31,23 +35,591 @@ void SparseSmoother::SetOperator(const Operator &a)
    width = oper->Width();
 }
 
+void GSSmoother::SetOperator(const Operator &a)
+{
+   SparseSmoother::SetOperator(a);
+   color_row.Clear();
+}
+
+void GSSmoother::BuildColoring() const
+{
+   MFEM_VERIFY(oper && oper->Finalized(), "the matrix must be finalized");
+   const int n = oper->Height();
+   const int *I = oper->GetI(), *J = oper->GetJ();
+
+   // Pattern of the transpose, so that row i is checked against the rows j
+   // with A(i,j) != 0 or A(j,i) != 0
+   Array<int> It(n+1), Jt(I[n]);
+   It = 0;
+   for (int k = 0; k < I[n]; k++) { It[J[k]+1]++; }
+   for (int i = 0; i < n; i++) { It[i+1] += It[i]; }
+   for (int i = 0; i < n; i++)
+   {
+      for (int k = I[i]; k < I[i+1]; k++) { Jt[It[J[k]]++] = i; }
+   }
+   for (int i = n; i > 0; i--) { It[i] = It[i-1]; }
+   It[0] = 0;
+
+   // Greedy coloring: row i gets the smallest color of none of its neighbors.
+   Array<int> row_color(n), color_mark;
+   row_color = -1;
+   int ncolors = 0;
+   for (int i = 0; i < n; i++)
+   {
+      for (int k = I[i]; k < I[i+1]; k++)
+      {
+         if (row_color[J[k]] >= 0) { color_mark[row_color[J[k]]] = i; }
+      }
+      for (int k = It[i]; k < It[i+1]; k++)
+      {
+         if (row_color[Jt[k]] >= 0) { color_mark[row_color[Jt[k]]] = i; }
+      }
+      int c = 0;
+      while (c < ncolors && color_mark[c] == i) { c++; }
+      if (c == ncolors)
+      {
+         color_mark.Append(-1);
+         ncolors++;
+      }
+      row_color[i] = c;
+   }
+   Transpose(row_color, color_row, ncolors);
+}
+
+void GSSmoother::MulticolorSweep(const Vector &x, Vector &y,
+                                 bool forward) const
+{
+   const int *I = oper->GetI(), *J = oper->GetJ();
+   const double *A = oper->GetData(), *xp = x.GetData();
+   double *yp = y.GetData();
+   const double w = omega;
+   const int ncolors = color_row.Size();
+   for (int cc = 0; cc < ncolors; cc++)
+   {
+      const int c = forward ? cc : ncolors - 1 - cc;
+      const int nrows = color_row.RowSize(c);
+      const int *rows = color_row.GetRow(c);
+#ifdef MFEM_USE_OPENMP
+      #pragma omp parallel for
+#endif
+      for (int r = 0; r < nrows; r++)
+      {
+         // The rows of this color do not depend on each other.
+         const int i = rows[r];
+         double sum = xp[i], d = 0.0;
+         for (int k = I[i]; k < I[i+1]; k++)
+         {
+            if (J[k] == i) { d = A[k]; }
+            else { sum -= A[k] * yp[J[k]]; }
+         }
+         MFEM_VERIFY(d != 0.0, "zero diagonal entry in row " << i);
+         yp[i] = (1.0 - w) * yp[i] + w * sum / d;
+      }
+   }
+}
+
 /// Matrix vector multiplication with GS Smoother.
 void GSSmoother::Mult(const Vector &x, Vector &y) const
 {
+   MFEM_VERIFY(multicolor || omega == 1.0,
+               "the relaxation requires the multicolor sweeps");
    if (!iterative_mode)
    {
       y = 0.0;
    }
+   if (multicolor && color_row.Size() < 0) { BuildColoring(); }
    for (int i = 0; i < iterations; i++)
    {
       if (type != 2)
       {
-         oper->Gauss_Seidel_forw(x, y);
+         if (multicolor) { MulticolorSweep(x, y, true); }
+         else { oper->Gauss_Seidel_forw(x, y); }
       }
       if (type != 1)
       {
-         oper->Gauss_Seidel_back(x, y);
+         if (multicolor) { MulticolorSweep(x, y, false); }
+         else { oper->Gauss_Seidel_back(x, y); }
+      }
+   }
+}
+
+void RCMOrdering(const SparseMatrix &A, Array<int> &perm)
+{
+   MFEM_VERIFY(A.Finalized() && A.Height() == A.Width(),
+               "the matrix must be square and finalized");
+   const int n = A.Height();
+
+   // Graph of A + A^t, without the diagonal
+   SparseMatrix *At = Transpose(A);
+   Array<int> gI(n+1), gJ, marker(n);
+   marker = -1;
+   gI[0] = 0;
+   for (int i = 0; i < n; i++)
+   {
+      marker[i] = i;
+      const SparseMatrix *M[2] = { &A, At };
+      for (int m = 0; m < 2; m++)
+      {
+         for (int k = M[m]->GetI()[i]; k < M[m]->GetI()[i+1]; k++)
+         {
+            const int j = M[m]->GetJ()[k];
+            if (marker[j] != i) { marker[j] = i; gJ.Append(j); }
+         }
+      }
+      gI[i+1] = gJ.Size();
+   }
+   delete At;
+
+   // Breadth-first search from the node start, visiting the neighbors by
+   // increasing degree, appending the nodes to perm. Return the first node of
+   // minimum degree in the last level.
+   Array<int> level(n);
+   level = -1;
+   Array<Pair<int,int> > nbrs;
+   auto bfs = [&](int start, Array<int> &order, int &nlevels)
+   {
+      const int first = order.Size();
+      order.Append(start);
+      level[start] = 0;
+      for (int q = first; q < order.Size(); q++)
+      {
+         const int i = order[q];
+         nbrs.SetSize(0);
+         for (int k = gI[i]; k < gI[i+1]; k++)
+         {
+            const int j = gJ[k];
+            if (level[j] < 0)
+            {
+               level[j] = level[i] + 1;
+               nbrs.Append(Pair<int,int>(gI[j+1] - gI[j], j));
+            }
+         }
+         SortPairs<int,int>(nbrs, nbrs.Size());
+         for (int k = 0; k < nbrs.Size(); k++) { order.Append(nbrs[k].two); }
+      }
+      nlevels = level[order.Last()] + 1;
+      int last = order.Last();
+      for (int q = order.Size() - 1; q >= first; q--)
+      {
+         const int i = order[q];
+         if (level[i] < nlevels - 1) { break; }
+         if (gI[i+1] - gI[i] < gI[last+1] - gI[last]) { last = i; }
+      }
+      return last;
+   };
+
+   Array<int> order, trial;
+   order.Reserve(n);
+   for (int i = 0; i < n; i++)
+   {
+      if (level[i] >= 0) { continue; }
+      // Pseudo-peripheral start node of the component of node i
+      int start = i, nlevels, trial_nlevels;
+      trial.SetSize(0);
+      int next = bfs(start, trial, nlevels);
+      for (int it = 0; it < 5; it++)
+      {
+         for (int q = 0; q < trial.Size(); q++) { level[trial[q]] = -1; }
+         trial.SetSize(0);
+         const int next2 = bfs(next, trial, trial_nlevels);
+         if (trial_nlevels <= nlevels) { break; }
+         start = next;
+         next = next2;
+         nlevels = trial_nlevels;
+      }
+      for (int q = 0; q < trial.Size(); q++) { level[trial[q]] = -1; }
+      bfs(start, order, nlevels);
+   }
+   perm.SetSize(n);
+   for (int i = 0; i < n; i++) { perm[i] = order[n-1-i]; }
+}
+
+void IncompleteFactorization::SetReordering(bool use_rcm)
+{
+   reorder = use_rcm;
+   if (oper) { SetOperator(*oper); }
+}
+
+void IncompleteFactorization::SetOperator(const Operator &a)
+{
+   SparseSmoother::SetOperator(a);
+   MFEM_VERIFY(oper->Finalized() && height == width,
+               "the matrix must be square and finalized");
+   const int n = height;
+   const int *Ia = oper->GetI(), *Ja = oper->GetJ();
+   const double *Aa = oper->GetData();
+
+   // The reordered matrix, with sorted columns
+   perm.SetSize(0);
+   if (reorder) { RCMOrdering(*oper, perm); }
+   Array<int> iperm(n);
+   for (int i = 0; i < n; i++) { iperm[reorder ? perm[i] : i] = i; }
+   int *Ip = mfem::New<int>(n+1);
+   int *Jp = mfem::New<int>(Ia[n]);
+   double *Ap = mfem::New<double>(Ia[n]);
+   Ip[0] = 0;
+   for (int i = 0; i < n; i++)
+   {
+      const int row = reorder ? perm[i] : i;
+      Ip[i+1] = Ip[i] + Ia[row+1] - Ia[row];
+      for (int k = Ia[row]; k < Ia[row+1]; k++)
+      {
+         Jp[Ip[i] + k - Ia[row]] = iperm[Ja[k]];
+         Ap[Ip[i] + k - Ia[row]] = Aa[k];
+      }
+   }
+   SparseMatrix Ar(Ip, Jp, Ap, n, n);
+   Ar.SortColumnIndices();
+
+   I.SetSize(n+1);
+   I[0] = 0;
+   diag.SetSize(n);
+   J.SetSize(0);
+   A.SetSize(0);
+   Factor(Ar);
+   BuildLevels();
+}
+
+void IncompleteFactorization::BuildLevels()
+{
+   const int n = height;
+   Array<int> level(n);
+   int nlevels = 0;
+   for (int i = 0; i < n; i++)
+   {
+      int l = 0;
+      for (int k = I[i]; k < diag[i]; k++) { l = std::max(l, level[J[k]] + 1); }
+      level[i] = l;
+      nlevels = std::max(nlevels, l + 1);
+   }
+   Transpose(level, lower_levels, nlevels);
+   nlevels = 0;
+   for (int i = n - 1; i >= 0; i--)
+   {
+      int l = 0;
+      for (int k = diag[i] + 1; k < I[i+1]; k++)
+      {
+         l = std::max(l, level[J[k]] + 1);
+      }
+      level[i] = l;
+      nlevels = std::max(nlevels, l + 1);
+   }
+   Transpose(level, upper_levels, nlevels);
+}
+
+void IncompleteFactorization::Solve(Vector &y) const
+{
+   const int *Ip = I, *Jp = J, *dp = diag;
+   const double *Ap = A;
+   double *yp = y.GetData();
+   for (int l = 0; l < lower_levels.Size(); l++)
+   {
+      const int nrows = lower_levels.RowSize(l);
+      const int *rows = lower_levels.GetRow(l);
+#ifdef MFEM_USE_OPENMP
+      #pragma omp parallel for
+#endif
+      for (int q = 0; q < nrows; q++)
+      {
+         const int i = rows[q];
+         double s = yp[i];
+         for (int k = Ip[i]; k < dp[i]; k++) { s -= Ap[k] * yp[Jp[k]]; }
+         yp[i] = s;
+      }
+   }
+   for (int l = 0; l < upper_levels.Size(); l++)
+   {
+      const int nrows = upper_levels.RowSize(l);
+      const int *rows = upper_levels.GetRow(l);
+#ifdef MFEM_USE_OPENMP
+      #pragma omp parallel for
+#endif
+      for (int q = 0; q < nrows; q++)
+      {
+         const int i = rows[q];
+         double s = yp[i];
+         for (int k = dp[i] + 1; k < Ip[i+1]; k++) { s -= Ap[k] * yp[Jp[k]]; }
+         yp[i] = s / Ap[dp[i]];
+      }
+   }
+}
+
+void IncompleteFactorization::Mult(const Vector &x, Vector &y) const
+{
+   const Vector *b = &x;
+   if (iterative_mode)
+   {
+      r.SetSize(height);
+      oper->Mult(y, r);
+      subtract(x, r, r);
+      b = &r;
+   }
+   z.SetSize(height);
+   for (int i = 0; i < height; i++)
+   {
+      z(i) = (*b)(reorder ? perm[i] : i);
+   }
+   Solve(z);
+   for (int i = 0; i < height; i++)
+   {
+      const int row = reorder ? perm[i] : i;
+      y(row) = iterative_mode ? y(row) + z(i) : z(i);
+   }
+}
+
+void ILUSmoother::Factor(const SparseMatrix &Ap)
+{
+   const int n = height;
+   const int *Ia = Ap.GetI(), *Ja = Ap.GetJ();
+   const double *Aa = Ap.GetData();
+   MFEM_VERIFY(fill_level >= 0, "invalid fill level " << fill_level);
+
+   // Level of fill of the entries of the factors, and of the entries of the
+   // current row (-1 if not present)
+   Array<int> flev, lev(n), lower, upper;
+   Vector w(n);
+   lev = -1;
+   w = 0.0;
+   for (int i = 0; i < n; i++)
+   {
+      // Scatter the row i of the matrix, making sure the diagonal is present
+      lower.SetSize(0);
+      upper.SetSize(0);
+      for (int k = Ia[i]; k < Ia[i+1]; k++)
+      {
+         const int j = Ja[k];
+         if (lev[j] < 0) { (j < i ? lower : upper).Append(j); }
+         lev[j] = 0;
+         w(j) += Aa[k];
+      }
+      if (lev[i] < 0) { lev[i] = 0; upper.Append(i); }
+
+      // Eliminate the entries of L by increasing column, using lower as a
+      // min-heap of columns
+      std::make_heap(lower.begin(), lower.end(), std::greater<int>());
+      const int lower_start = J.Size();
+      while (lower.Size() > 0)
+      {
+         std::pop_heap(lower.begin(), lower.end(), std::greater<int>());
+         const int k = lower.Last();
+         lower.DeleteLast();
+         const double wk = (w(k) /= A[diag[k]]);
+         J.Append(k);
+         flev.Append(lev[k]);
+         for (int q = diag[k] + 1; q < I[k+1]; q++)
+         {
+            const int j = J[q], l = lev[k] + flev[q] + 1;
+            if (lev[j] >= 0)
+            {
+               w(j) -= wk * A[q];
+               lev[j] = std::min(lev[j], l);
+            }
+            else if (l <= fill_level)
+            {
+               lev[j] = l;
+               w(j) = -wk * A[q];
+               if (j > i) { upper.Append(j); continue; }
+               lower.Append(j);
+               std::push_heap(lower.begin(), lower.end(), std::greater<int>());
+            }
+         }
+      }
+
+      // Gather the row i of the factors
+      upper.Sort();
+      for (int k = 0; k < upper.Size(); k++)
+      {
+         J.Append(upper[k]);
+         flev.Append(lev[upper[k]]);
+      }
+      diag[i] = J.Size() - upper.Size();
+      I[i+1] = J.Size();
+      for (int k = lower_start; k < J.Size(); k++)
+      {
+         A.Append(w(J[k]));
+         w(J[k]) = 0.0;
+         lev[J[k]] = -1;
+      }
+      MFEM_VERIFY(A[diag[i]] != 0.0, "zero pivot in row " << i);
+   }
+}
+
+void ILUTSmoother::Factor(const SparseMatrix &Ap)
+{
+   const int n = height;
+   const int *Ia = Ap.GetI(), *Ja = Ap.GetJ();
+   const double *Aa = Ap.GetData();
+
+   Array<int> present(n), lower, upper, heap, elim, kept;
+   Array<Pair<double,int> > large;
+   Vector w(n);
+   present = 0;
+   w = 0.0;
+   // Keep the p entries of largest magnitude of cols, in kept.
+   auto largest = [&](const Array<int> &cols, double drop)
+   {
+      large.SetSize(0);
+      for (int k = 0; k < cols.Size(); k++)
+      {
+         const double a = std::abs(w(cols[k]));
+         if (a >= drop && a > 0.0)
+         {
+            large.Append(Pair<double,int>(-a, cols[k]));
+         }
+      }
+      SortPairs<double,int>(large, large.Size());
+      kept.SetSize(0);
+      for (int k = 0; k < std::min(max_fill, large.Size()); k++)
+      {
+         kept.Append(large[k].two);
+      }
+      kept.Sort();
+   };
+   for (int i = 0; i < n; i++)
+   {
+      lower.SetSize(0);
+      upper.SetSize(0);
+      double norm = 0.0;
+      for (int k = Ia[i]; k < Ia[i+1]; k++)
+      {
+         const int j = Ja[k];
+         if (!present[j])
+         {
+            present[j] = 1;
+            if (j != i) { (j < i ? lower : upper).Append(j); }
+         }
+         w(j) += Aa[k];
+         norm += Aa[k]*Aa[k];
+      }
+      const double drop = tol * std::sqrt(norm);
+      present[i] = 1;
+
+      // Eliminate the entries of L by increasing column, using heap as a
+      // min-heap of columns; lower collects all the columns of L
+      heap = lower;
+      std::make_heap(heap.begin(), heap.end(), std::greater<int>());
+      elim.SetSize(0);
+      while (heap.Size() > 0)
+      {
+         std::pop_heap(heap.begin(), heap.end(), std::greater<int>());
+         const int k = heap.Last();
+         heap.DeleteLast();
+         const double wk = (w(k) /= A[diag[k]]);
+         if (std::abs(wk) < drop) { w(k) = 0.0; continue; }
+         elim.Append(k);
+         for (int q = diag[k] + 1; q < I[k+1]; q++)
+         {
+            const int j = J[q];
+            if (present[j]) { w(j) -= wk * A[q]; continue; }
+            present[j] = 1;
+            w(j) = -wk * A[q];
+            if (j > i) { upper.Append(j); continue; }
+            lower.Append(j);
+            heap.Append(j);
+            std::push_heap(heap.begin(), heap.end(), std::greater<int>());
+         }
+      }
+
+      // Apply the dropping rules to the L and U parts of the row
+      largest(elim, drop);
+      for (int k = 0; k < kept.Size(); k++)
+      {
+         J.Append(kept[k]);
+         A.Append(w(kept[k]));
+      }
+      MFEM_VERIFY(w(i) != 0.0, "zero pivot in row " << i);
+      diag[i] = J.Size();
+      J.Append(i);
+      A.Append(w(i));
+      largest(upper, drop);
+      for (int k = 0; k < kept.Size(); k++)
+      {
+         J.Append(kept[k]);
+         A.Append(w(kept[k]));
+      }
+      I[i+1] = J.Size();
+
+      for (int k = 0; k < lower.Size(); k++)
+      {
+         w(lower[k]) = 0.0;
+         present[lower[k]] = 0;
+      }
+      for (int k = 0; k < upper.Size(); k++)
+      {
+         w(upper[k]) = 0.0;
+         present[upper[k]] = 0;
+      }
+      w(i) = 0.0;
+      present[i] = 0;
+   }
+}
+
+void ICSmoother::Factor(const SparseMatrix &Ap)
+{
+   const int n = height;
+   const int *Ia = Ap.GetI(), *Ja = Ap.GetJ();
+   const double *Aa = Ap.GetData();
+
+   // Sparsity of the factors: the lower triangle of the matrix, the diagonal
+   // and the transpose of the lower triangle
+   Array<int> nupper(n);
+   nupper = 0;
+   for (int i = 0; i < n; i++)
+   {
+      for (int k = Ia[i]; k < Ia[i+1] && Ja[k] < i; k++) { nupper[Ja[k]]++; }
+   }
+   for (int i = 0; i < n; i++)
+   {
+      int nl = 0;
+      for (int k = Ia[i]; k < Ia[i+1] && Ja[k] < i; k++) { nl++; }
+      diag[i] = I[i] + nl;
+      I[i+1] = diag[i] + 1 + nupper[i];
+   }
+   J.SetSize(I[n]);
+   A.SetSize(I[n]);
+   A = 0.0;
+   // next[k]: next entry of the row k of U, filled when the row of L with the
+   // corresponding column is computed
+   Array<int> next(n);
+   for (int i = 0; i < n; i++) { next[i] = diag[i] + 1; }
+
+   Array<int> pos(n);
+   pos = -1;
+   for (int i = 0; i < n; i++)
+   {
+      double a_ii = 0.0;
+      for (int k = Ia[i]; k < Ia[i+1]; k++)
+      {
+         if (Ja[k] < i)
+         {
+            const int q = I[i] + k - Ia[i];
+            J[q] = Ja[k];
+            A[q] = Aa[k];
+            pos[Ja[k]] = q;
+         }
+         else if (Ja[k] == i) { a_ii += Aa[k]; }
+      }
+      J[diag[i]] = i;
+      pos[i] = diag[i];
+      A[diag[i]] = a_ii;
+
+      // l_ik = (a_ik - sum_{j<k} l_ij d_j l_kj) / d_k, updating the entries
+      // m > k of the row i with the row k of U = D L^t
+      for (int q = I[i]; q < diag[i]; q++)
+      {
+         const int k = J[q];
+         const double lik = (A[q] /= A[diag[k]]);
+         for (int p = diag[k] + 1; p < next[k]; p++)
+         {
+            if (pos[J[p]] >= 0) { A[pos[J[p]]] -= lik * A[p]; }
+         }
+         A[diag[i]] -= lik * lik * A[diag[k]];
+         J[next[k]] = i;
+         A[next[k]++] = lik * A[diag[k]];
       }
+      if (A[diag[i]] <= 0.0) { A[diag[i]] = a_ii; }
+      MFEM_VERIFY(A[diag[i]] > 0.0, "non-positive diagonal entry in row " << i);
+      for (int q = I[i]; q <= diag[i]; q++) { pos[J[q]] = -1; }
    }
 }
 
@@ -39,18 +39,179 @@ protected:
    int type; // 0, 1, 2 - symmetric, forward, backward
    int iterations;
 
+   bool multicolor;
+   double omega;
+   /** @brief Color-to-row table of the multicolor sweeps, built on the first
+       call to Mult() and deleted by SetOperator(). */
+   mutable Table color_row;
+
+   /// Build #color_row from the sparsity pattern of the operator.
+   void BuildColoring() const;
+
+   /// One multicolor sweep, through the colors in forward or reverse order.
+   void MulticolorSweep(const Vector &x, Vector &y, bool forward) const;
+
 public:
    /// Create GSSmoother.
-   GSSmoother(int t = 0, int it = 1) { type = t; iterations = it; }
+   GSSmoother(int t = 0, int it = 1)
+   { type = t; iterations = it; multicolor = false; omega = 1.0; }
 
    /// Create GSSmoother.
    GSSmoother(const SparseMatrix &a, int t = 0, int it = 1)
-      : SparseSmoother(a) { type = t; iterations = it; }
+      : SparseSmoother(a)
+   { type = t; iterations = it; multicolor = false; omega = 1.0; }
+
+   /** @brief Enable or disable the multicolor sweeps, which can run with
+       multiple threads. */
+   /** The rows of the finalized matrix are colored such that two rows i and j
+       of the same color are not coupled, i.e. A(i,j) = A(j,i) = 0. A sweep
+       updates all the rows of a color at once, in parallel with OpenMP when
+       MFEM_USE_OPENMP is enabled, and the colors in order (reverse order in
+       the backward sweeps, so the symmetric smoother stays symmetric). This is
+       the sequential Gauss-Seidel method with the rows ordered by color. The
+       coloring is computed once and reused while the operator is not reset
+       with SetOperator(). */
+   void SetMulticolor(bool use_multicolor = true)
+   { multicolor = use_multicolor; }
+
+   /** @brief Set the relaxation parameter of the multicolor sweeps, giving
+       SOR (or SSOR when symmetric) for @a w != 1. */
+   void SetRelaxation(double w) { omega = w; }
+
+   /// Return the number of colors of the multicolor sweeps.
+   int GetNColors() const
+   { if (color_row.Size() < 0) { BuildColoring(); } return color_row.Size(); }
+
+   virtual void SetOperator(const Operator &a);
 
    /// Matrix vector multiplication with GS Smoother.
    virtual void Mult(const Vector &x, Vector &y) const;
 };
 
+/** @brief Base class of the incomplete LU factorizations of a SparseMatrix,
+    A ~ (I + L)(D + U) with L strictly lower and U strictly upper triangular.
+
+    The factors are computed by SetOperator() with the virtual method Factor(),
+    optionally after a reverse Cuthill-McKee (RCM) reordering of the matrix,
+    see SetReordering(). The triangular solves of Mult() are level-scheduled:
+    the rows are grouped in levels whose rows only depend on rows of previous
+    levels, and the rows of a level are solved in parallel with OpenMP when
+    MFEM_USE_OPENMP is enabled.
+
+    In #iterative_mode, Mult() computes y += (LU)^{-1} (x - A y), otherwise
+    y = (LU)^{-1} x. */
+class IncompleteFactorization : public SparseSmoother
+{
+protected:
+   bool reorder;
+   /// Row of the matrix of the row i of the factors, empty without reordering.
+   Array<int> perm;
+
+   /** @brief The factors in CSR format, with sorted columns: the entries of L,
+       D and U of the row i are at I[i] <= k < diag[i], diag[i] and
+       diag[i] < k < I[i+1]. */
+   Array<int> I, J, diag;
+   Array<double> A;
+
+   /// Level-to-row tables of the forward (L) and backward (U) solves.
+   Table lower_levels, upper_levels;
+
+   mutable Vector z, r;
+
+   /** @brief Compute #I, #J, #A and #diag from the matrix @a Ap, with sorted
+       columns, that is already reordered. The arrays are empty on entry. */
+   virtual void Factor(const SparseMatrix &Ap) = 0;
+
+   /// Build the levels of the triangular solves.
+   void BuildLevels();
+
+   /// Solve (I + L)(D + U) y = x, in place.
+   void Solve(Vector &y) const;
+
+public:
+   IncompleteFactorization() : reorder(false) { }
+
+   /** @brief Enable or disable the RCM reordering of the matrix before the
+       factorization. The factors are recomputed if the operator is set. */
+   /** The reordering reduces the bandwidth of the matrix, which often reduces
+       the fill-in and improves the quality of the factors. */
+   void SetReordering(bool use_rcm = true);
+
+   /// Return the number of levels of the forward and backward solves.
+   int GetNLevels() const
+   {
+      return lower_levels.Size() > upper_levels.Size() ?
+             lower_levels.Size() : upper_levels.Size();
+   }
+
+   /// Return the number of entries of the factors.
+   int NumNonZeroElems() const { return J.Size(); }
+
+   /// Factor the SparseMatrix @a a.
+   virtual void SetOperator(const Operator &a);
+
+   /// Apply the inverse of the factors.
+   virtual void Mult(const Vector &x, Vector &y) const;
+};
+
+/** @brief ILU(k) preconditioner: incomplete LU factorization with the fill-in
+    of level up to @a k, ILU(0) (the sparsity of the matrix) by default. */
+class ILUSmoother : public IncompleteFactorization
+{
+protected:
+   int fill_level;
+
+   virtual void Factor(const SparseMatrix &Ap);
+
+public:
+   ILUSmoother(int k = 0) : fill_level(k) { }
+
+   ILUSmoother(const SparseMatrix &a, int k = 0) : fill_level(k)
+   { SetOperator(a); }
+};
+
+/** @brief ILUT preconditioner: incomplete LU factorization with a dual
+    dropping strategy.
+
+    The entries smaller than @a tol times the 2-norm of their row of the matrix
+    are dropped during the elimination, and only the @a p largest entries of
+    the L and U parts of each row are kept. */
+class ILUTSmoother : public IncompleteFactorization
+{
+protected:
+   double tol;
+   int max_fill;
+
+   virtual void Factor(const SparseMatrix &Ap);
+
+public:
+   ILUTSmoother(double tol_ = 1e-3, int p = 10) : tol(tol_), max_fill(p) { }
+
+   ILUTSmoother(const SparseMatrix &a, double tol_ = 1e-3, int p = 10)
+      : tol(tol_), max_fill(p) { SetOperator(a); }
+};
+
+/** @brief IC(0) preconditioner of a symmetric matrix: incomplete Cholesky
+    factorization A ~ (I + L) D (I + L)^t with the sparsity of the matrix.
+
+    Only the lower triangle of the matrix is used. A pivot that is not positive
+    is replaced by the diagonal entry of the matrix, so the preconditioner stays
+    symmetric positive definite. */
+class ICSmoother : public IncompleteFactorization
+{
+protected:
+   virtual void Factor(const SparseMatrix &Ap);
+
+public:
+   ICSmoother() { }
+
+   ICSmoother(const SparseMatrix &a) { SetOperator(a); }
+};
+
+/** @brief Reverse Cuthill-McKee ordering of the graph of A + A^t: the row
+    perm[i] of A is the row i of the reordered matrix. */
+void RCMOrdering(const SparseMatrix &A, Array<int> &perm);
+
 /// Data type for scaled Jacobi-type smoother of sparse matrix
 class DSmoother : public SparseSmoother
 {
@@ -941,6 +941,7 @@ void Mesh::Init()
    sequence = 0;
    Nodes = NULL;
    own_nodes = 1;
+   bin_grid = NULL;
    NURBSext = NULL;
    ncmesh = NULL;
    last_operation = Mesh::NONE;
@@ -977,6 +978,9 @@ void Mesh::DestroyPointers()
 {
    if (own_nodes) { delete Nodes; }
 
+   DeleteElementBinGrid();
+   DeleteGeometricFactors();
+
    delete ncmesh;
 
    delete NURBSext;
@@ -2715,6 +2719,10 @@ Mesh::Mesh(const Mesh &mesh, bool copy_nodes)
       Nodes = mesh.Nodes;
       own_nodes = 0;
    }
+
+   // Do NOT copy the ElementBinGrid, bin_grid, and the GeometricFactors,
+   // geom_factors
+   bin_grid = NULL;
 }
 
 Mesh::Mesh(const char *filename, int generate_edges, int refine,
@@ -5728,6 +5736,7 @@ void Mesh::MoveVertices(const Vector &displacements)
       {
          vertices[i](j) += displacements(j*nv+i);
       }
+   NodesUpdated();
 }
 
 void Mesh::GetVertices(Vector &vert_coord) const
@@ -5748,6 +5757,7 @@ void Mesh::SetVertices(const Vector &vert_coord)
       {
          vertices[i](j) = vert_coord(j*nv+i);
       }
+   NodesUpdated();
 }
 
 void Mesh::GetNode(int i, double *coord)
@@ -5787,6 +5797,7 @@ void Mesh::SetNode(int i, const double *coord)
       }
 
    }
+   NodesUpdated();
 }
 
 void Mesh::MoveNodes(const Vector &displacements)
@@ -5799,6 +5810,7 @@ void Mesh::MoveNodes(const Vector &displacements)
    {
       MoveVertices(displacements);
    }
+   NodesUpdated();
 }
 
 void Mesh::GetNodes(Vector &node_coord) const
@@ -5823,6 +5835,7 @@ void Mesh::SetNodes(const Vector &node_coord)
    {
       SetVertices(node_coord);
    }
+   NodesUpdated();
 }
 
 void Mesh::NewNodes(GridFunction &nodes, bool make_owner)
@@ -5838,6 +5851,7 @@ void Mesh::NewNodes(GridFunction &nodes, bool make_owner)
       delete NURBSext;
       NURBSext = nodes.FESpace()->StealNURBSext();
    }
+   NodesUpdated();
 }
 
 void Mesh::SwapNodes(GridFunction *&nodes, int &own_nodes_)
@@ -5848,6 +5862,42 @@ void Mesh::SwapNodes(GridFunction *&nodes, int &own_nodes_)
    // if (nodes)
    //    nodes->FESpace()->MakeNURBSextOwner();
    // NURBSext = (Nodes) ? Nodes->FESpace()->StealNURBSext() : NULL;
+   NodesUpdated();
+}
+
+void Mesh::NodesUpdated()
+{
+   DeleteElementBinGrid();
+   DeleteGeometricFactors();
+}
+
+// FNV-1a hash of the 64-bit words of the n doubles of x, continuing from h.
+static unsigned long long HashDoubles(const double *x, int n,
+                                      unsigned long long h)
+{
+   for (int i = 0; i < n; i++)
+   {
+      unsigned long long w;
+      std::memcpy(&w, x + i, sizeof(w));
+      h = (h ^ w) * 1099511628211ULL;
+   }
+   return h;
+}
+
+unsigned long long Mesh::GetNodesHash() const
+{
+   unsigned long long h = 14695981039346656037ULL;
+   if (Nodes)
+   {
+      h = (h ^ (unsigned long long) Nodes->Size()) * 1099511628211ULL;
+      return HashDoubles(Nodes->GetData(), Nodes->Size(), h);
+   }
+   h = (h ^ (unsigned long long) NumOfVertices) * 1099511628211ULL;
+   for (int i = 0; i < NumOfVertices; i++)
+   {
+      h = HashDoubles(vertices[i](), spaceDim, h);
+   }
+   return h;
 }
 
 void Mesh::AverageVertices(const int *indexes, int n, int result)
@@ -7070,6 +7120,11 @@ void Mesh::Swap(Mesh& other, bool non_geometry)
    mfem::Swap(attributes, other.attributes);
    mfem::Swap(bdr_attributes, other.bdr_attributes);
 
+   mfem::Swap(bin_grid, other.bin_grid);
+   // The GeometricFactors point to their Mesh, so they are not swapped
+   DeleteGeometricFactors();
+   other.DeleteGeometricFactors();
+
    if (non_geometry)
    {
       mfem::Swap(NURBSext, other.NURBSext);
@@ -9071,6 +9126,7 @@ void Mesh::ScaleSubdomains(double sf)
    delete [] cg;
    delete [] nbea;
    delete [] vn;
+   NodesUpdated();
 }
 
 void Mesh::ScaleElements(double sf)
@@ -9141,6 +9197,7 @@ void Mesh::ScaleElements(double sf)
    delete [] cg;
    delete [] nbea;
    delete [] vn;
+   NodesUpdated();
 }
 
 void Mesh::Transform(void (*f)(const Vector&, Vector&))
@@ -9166,6 +9223,7 @@ void Mesh::Transform(void (*f)(const Vector&, Vector&))
       xnew.ProjectCoefficient(f_pert);
       *Nodes = xnew;
    }
+   NodesUpdated();
 }
 
 void Mesh::Transform(VectorCoefficient &deformation)
@@ -9190,6 +9248,7 @@ void Mesh::Transform(VectorCoefficient &deformation)
       xnew.ProjectCoefficient(deformation);
       *Nodes = xnew;
    }
+   NodesUpdated();
 }
 
 void Mesh::RemoveUnusedVertices()
@@ -9428,81 +9487,103 @@ int Mesh::FindPoints(DenseMatrix &point_mat, Array<int>& elem_ids,
    InverseElementTransformation *inv_tr = inv_trans;
    inv_tr = inv_tr ? inv_tr : new InverseElementTransformation;
 
-   // For each point in 'point_mat', find the element whose center is closest.
-   Vector min_dist(npts);
-   Array<int> e_idx(npts);
-   min_dist = std::numeric_limits<double>::max();
-   e_idx = -1;
-
-   Vector pt(spaceDim);
-   for (int i = 0; i < GetNE(); i++)
+   // For each point in 'point_mat', try only the elements whose bounding boxes
+   // contain the point, starting from the element whose center is closest.
+   const ElementBinGrid &grid = GetElementBinGrid();
+   Array<int> candidates;
+   Vector pt(NULL, spaceDim);
+   int pts_found = 0;
+   for (int k = 0; k < npts; k++)
    {
-      GetElementTransformation(i)->Transform(
-         Geometries.GetCenter(GetElementBaseGeometry(i)), pt);
-      for (int k = 0; k < npts; k++)
+      pt.SetData(data+k*spaceDim);
+      grid.FindCandidates(pt.GetData(), candidates);
+      for (int i = 0; i < candidates.Size(); i++)
       {
-         double dist = pt.DistanceTo(data+k*spaceDim);
-         if (dist < min_dist(k))
+         inv_tr->SetTransformation(*GetElementTransformation(candidates[i]));
+         int res = inv_tr->Transform(pt, ips[k]);
+         if (res == InverseElementTransformation::Inside)
          {
-            min_dist(k) = dist;
-            e_idx[k] = i;
+            elem_ids[k] = candidates[i];
+            pts_found++;
+            break;
          }
       }
    }
+   if (inv_trans == NULL) { delete inv_tr; }
 
-   // Checks if the points lie in the closest element
-   int pts_found = 0;
-   pt.NewDataAndSize(NULL, spaceDim);
-   for (int k = 0; k < npts; k++)
+   if (warn && pts_found != npts)
    {
-      pt.SetData(data+k*spaceDim);
-      inv_tr->SetTransformation(*GetElementTransformation(e_idx[k]));
-      int res = inv_tr->Transform(pt, ips[k]);
-      if (res == InverseElementTransformation::Inside)
+      MFEM_WARNING((npts-pts_found) << " points were not found");
+   }
+   return pts_found;
+}
+
+const ElementBinGrid &Mesh::GetElementBinGrid()
+{
+   // The coordinates are not hashed here, to keep the cost of FindPoints()
+   // independent of the mesh size: NodesUpdated() deletes the grid instead.
+   if (bin_grid && bin_grid->GetSequence() != sequence)
+   {
+      DeleteElementBinGrid();
+   }
+   if (!bin_grid)
+   {
+      bin_grid = new ElementBinGrid(*this);
+   }
+   return *bin_grid;
+}
+
+void Mesh::DeleteElementBinGrid()
+{
+   delete bin_grid;
+   bin_grid = NULL;
+}
+
+// Return true if the rules a and b have the same points and weights.
+static bool SameIntegrationRule(const IntegrationRule &a,
+                                const IntegrationRule &b)
+{
+   if (a.GetNPoints() != b.GetNPoints()) { return false; }
+   for (int i = 0; i < a.GetNPoints(); i++)
+   {
+      const IntegrationPoint &p = a.IntPoint(i), &q = b.IntPoint(i);
+      if (p.x != q.x || p.y != q.y || p.z != q.z || p.weight != q.weight)
       {
-         elem_ids[k] = e_idx[k];
-         pts_found++;
+         return false;
       }
    }
-   if (pts_found != npts)
+   return true;
+}
+
+const GeometricFactors *Mesh::GetGeometricFactors(const IntegrationRule &ir,
+                                                  const int flags)
+{
+   if (geom_factors.Size() && (geom_factors[0]->sequence != sequence ||
+                               geom_factors[0]->nodes_hash != GetNodesHash()))
+   {
+      DeleteGeometricFactors();
+   }
+   for (int i = 0; i < geom_factors.Size(); i++)
    {
-      Array<int> vertices;
-      Table *vtoel = GetVertexToElementTable();
-      for (int k = 0; k < npts; k++)
+      GeometricFactors *gf = geom_factors[i];
+      if ((gf->computed_factors & flags) == flags &&
+          SameIntegrationRule(gf->rule, ir))
       {
-         if (elem_ids[k] != -1) { continue; }
-         // Try all vertex-neighbors of element e_idx[k]
-         pt.SetData(data+k*spaceDim);
-         GetElementVertices(e_idx[k], vertices);
-         for (int v = 0; v < vertices.Size(); v++)
-         {
-            int vv = vertices[v];
-            int ne = vtoel->RowSize(vv);
-            const int* els = vtoel->GetRow(vv);
-            for (int e = 0; e < ne; e++)
-            {
-               if (els[e] == e_idx[k]) { continue; }
-               inv_tr->SetTransformation(*GetElementTransformation(els[e]));
-               int res = inv_tr->Transform(pt, ips[k]);
-               if (res == InverseElementTransformation::Inside)
-               {
-                  elem_ids[k] = els[e];
-                  pts_found++;
-                  goto next_point;
-               }
-            }
-         }
-      next_point: ;
+         return gf;
       }
-      delete vtoel;
    }
-   if (inv_trans == NULL) { delete inv_tr; }
+   GeometricFactors *gf = new GeometricFactors(*this, ir, flags);
+   geom_factors.Append(gf);
+   return gf;
+}
 
-   if (warn && pts_found != npts)
+void Mesh::DeleteGeometricFactors()
+{
+   for (int i = 0; i < geom_factors.Size(); i++)
    {
-      MFEM_WARNING((npts-pts_found) << " points were not found");
+      delete geom_factors[i];
    }
-   return pts_found;
+   geom_factors.SetSize(0);
 }
 
 NodeExtrudeCoefficient::NodeExtrudeCoefficient(const int dim, const int _n,
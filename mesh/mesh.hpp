@@ -39,6 +39,8 @@ struct Refinement;
 class ParMesh;
 class ParNCMesh;
 #endif
+class ElementBinGrid;
+class GeometricFactors;
 
 
 class Mesh
@@ -150,6 +152,15 @@ protected:
    GridFunction *Nodes;
    int own_nodes;
 
+   // Spatial search structure used by FindPoints(); built on demand and
+   // deleted when the mesh nodes or vertices change.
+   ElementBinGrid *bin_grid;
+
+   // Geometric factors at the points of integration rules, shared by all the
+   // objects using the Mesh; computed on demand and deleted when the mesh
+   // nodes or vertices change.
+   Array<GeometricFactors*> geom_factors;
+
    static const int vtk_quadratic_tet[10];
    static const int vtk_quadratic_wedge[18];
    static const int vtk_quadratic_hex[27];
@@ -1016,6 +1027,21 @@ public:
    bool OwnsNodes() const { return own_nodes; }
    /// Set the mesh nodes ownership flag.
    void SetNodesOwner(bool nodes_owner) { own_nodes = nodes_owner; }
+   /** @brief Notify the Mesh that its nodes or vertices were modified
+       externally, e.g. through the GridFunction returned by GetNodes(). */
+   /** This deletes any cached data that depends on the mesh geometry, such as
+       the ElementBinGrid returned by GetElementBinGrid() and the
+       GeometricFactors returned by GetGeometricFactors(). The Mesh methods
+       that modify the nodes/vertices call this method automatically; it must
+       be called after modifying the coordinates in place. The
+       GeometricFactors are also rebuilt when GetNodesHash() changes. */
+   void NodesUpdated();
+   /** @brief Return a hash of the node coordinates, or of the vertex
+       coordinates for a mesh without nodes. */
+   /** The hash changes when the coordinates are modified, including in place
+       through GetNodes() or GetVertex(). The cached GeometricFactors are
+       rebuilt when it changes. */
+   unsigned long long GetNodesHash() const;
    /// Replace the internal node GridFunction with the given GridFunction.
    void NewNodes(GridFunction &nodes, bool make_owner = false);
    /** Swap the internal node GridFunction pointer and ownership flag members
@@ -1253,10 +1279,80 @@ public:
                           Array<IntegrationPoint>& ips, bool warn = true,
                           InverseElementTransformation *inv_trans = NULL);
 
+   /** @brief Return the uniform grid of element bounding boxes used by
+       FindPoints(), building it if necessary. */
+   /** The grid is cached and reused until the sequence of the mesh changes
+       or NodesUpdated() is called. The coordinates are not checked on each
+       call, so NodesUpdated() must be called after modifying them in
+       place. */
+   const ElementBinGrid &GetElementBinGrid();
+
+   /// Delete the cached ElementBinGrid, if any.
+   void DeleteElementBinGrid();
+
+   /** @brief Return the mesh geometric factors at the points of the
+       integration rule @a ir, computing them if necessary. */
+   /** The @a flags are a combination of GeometricFactors::FactorFlags. The
+       factors are cached, keyed by the points and weights of @a ir and the
+       computed flags, and shared by all callers, e.g. the partial assembly of
+       all the integrators of a form. They are reused until the mesh is
+       modified, i.e. until its sequence or GetNodesHash() changes or
+       NodesUpdated() is called. */
+   const GeometricFactors *GetGeometricFactors(const IntegrationRule &ir,
+                                               const int flags);
+
+   /// Delete all the cached GeometricFactors.
+   void DeleteGeometricFactors();
+
    /// Destroys Mesh.
    virtual ~Mesh() { DestroyPointers(); }
 };
 
+/** @brief Geometric factors of a Mesh at the points of an IntegrationRule, on
+    all mesh elements. */
+/** The factors are stored with the element index running slowest: with NQ
+    points, NE elements, DIM = Mesh::Dimension() and SDIM =
+    Mesh::SpaceDimension(),
+    - X, the physical coordinates, is SDIM x NQ x NE,
+    - J, the Jacobians dx_i/dxi_j, is SDIM x DIM x NQ x NE,
+    - invJ, their (pseudo-)inverses, is DIM x SDIM x NQ x NE,
+    - detJ, the (generalized) determinants of the Jacobians, is NQ x NE.
+
+    Only the factors in computed_factors are set, the other arrays are empty.
+    On quadrilateral and hexahedral meshes they are computed with the partial
+    assembly kernels, on other meshes with the ElementTransformation%s. Use
+    Mesh::GetGeometricFactors() to get the cached instances. */
+class GeometricFactors
+{
+protected:
+   /// Compute the factors with the element transformations of @a mesh_.
+   void ComputeWithTransformations(Mesh &mesh_);
+
+public:
+   /// Flags selecting the factors to compute.
+   enum FactorFlags
+   {
+      COORDINATES       = 1 << 0,
+      JACOBIANS         = 1 << 1,
+      INVERSE_JACOBIANS = 1 << 2,
+      DETERMINANTS      = 1 << 3
+   };
+
+   const Mesh *mesh;
+   IntegrationRule rule; ///< Copy of the integration rule
+   const IntegrationRule *IntRule; ///< Points to #rule
+   int computed_factors;
+   long sequence; ///< Mesh sequence at the time of construction
+   /// Mesh::GetNodesHash() at the time of construction
+   unsigned long long nodes_hash;
+
+   Array<double> X, J, invJ, detJ;
+
+   /** @brief Compute the factors of @a mesh_ selected by @a flags at the
+       points of @a ir. */
+   GeometricFactors(Mesh &mesh_, const IntegrationRule &ir, const int flags);
+};
+
 /** Overload operator<< for std::ostream and Mesh; valid also for the derived
     class ParMesh */
 std::ostream &operator<<(std::ostream &out, const Mesh &mesh);
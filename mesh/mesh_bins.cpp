@@ -0,0 +1,278 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#include "mesh_bins.hpp"
+#include "mesh_headers.hpp"
+#include "../fem/fem.hpp"
+
+#include <cmath>
+
+namespace mfem
+{
+
+ElementBinGrid::ElementBinGrid(Mesh &mesh, double rel_tol, double curved_tol)
+   : sdim(mesh.SpaceDimension()), ne(mesh.GetNE()),
+     sequence(mesh.GetSequence())
+{
+   MFEM_VERIFY(sdim >= 1 && sdim <= 3, "invalid space dimension: " << sdim);
+
+   ComputeElementBoxes(mesh, curved_tol);
+
+   // Enlarge the element boxes by a small amount to make sure points lying on
+   // the element boundaries are found.
+   for (int i = 0; i < ne; i++)
+   {
+      double *box = elem_box.GetData() + 2*sdim*i;
+      double diam = 0.0;
+      for (int d = 0; d < sdim; d++)
+      {
+         diam += (box[sdim+d] - box[d])*(box[sdim+d] - box[d]);
+      }
+      diam = rel_tol*std::sqrt(diam);
+      for (int d = 0; d < sdim; d++)
+      {
+         box[d] -= diam;
+         box[sdim+d] += diam;
+      }
+   }
+
+   SetupBins();
+   BuildBinTable();
+}
+
+void ElementBinGrid::ComputeElementBoxes(Mesh &mesh, double curved_tol)
+{
+   elem_box.SetSize(2*sdim*ne);
+   elem_ctr.SetSize(sdim*ne);
+
+   const GridFunction *nodes = mesh.GetNodes();
+   const FiniteElementSpace *nfes = nodes ? nodes->FESpace() : NULL;
+
+   // This loop only reads mesh data and can be executed in parallel.
+#ifdef MFEM_USE_OPENMP
+   #pragma omp parallel for
+#endif
+   for (int i = 0; i < ne; i++)
+   {
+      double *box = elem_box.GetData() + 2*sdim*i;
+      double *ctr = elem_ctr.GetData() + sdim*i;
+      for (int d = 0; d < sdim; d++)
+      {
+         box[d] = infinity();
+         box[sdim+d] = -infinity();
+         ctr[d] = 0.0;
+      }
+
+      double tol = 0.0;
+      int np;
+      if (nodes == NULL)
+      {
+         const Element *el = mesh.GetElement(i);
+         const int *v = el->GetVertices();
+         np = el->GetNVertices();
+         for (int j = 0; j < np; j++)
+         {
+            const double *x = mesh.GetVertex(v[j]);
+            for (int d = 0; d < sdim; d++)
+            {
+               box[d] = std::min(box[d], x[d]);
+               box[sdim+d] = std::max(box[sdim+d], x[d]);
+               ctr[d] += x[d];
+            }
+         }
+      }
+      else
+      {
+         Array<int> vdofs;
+         nfes->GetElementVDofs(i, vdofs);
+         np = vdofs.Size()/sdim;
+         for (int d = 0; d < sdim; d++)
+         {
+            for (int j = 0; j < np; j++)
+            {
+               const double x = (*nodes)(vdofs[np*d+j]);
+               box[d] = std::min(box[d], x);
+               box[sdim+d] = std::max(box[sdim+d], x);
+               ctr[d] += x;
+            }
+         }
+         // Curved elements may extend beyond the hull of their nodes.
+         if (nfes->GetOrder(i) > 1) { tol = curved_tol; }
+      }
+
+      double diam = 0.0;
+      for (int d = 0; d < sdim; d++)
+      {
+         ctr[d] /= np;
+         diam += (box[sdim+d] - box[d])*(box[sdim+d] - box[d]);
+      }
+      diam = tol*std::sqrt(diam);
+      for (int d = 0; d < sdim; d++)
+      {
+         box[d] -= diam;
+         box[sdim+d] += diam;
+      }
+   }
+}
+
+void ElementBinGrid::SetupBins()
+{
+   for (int d = 0; d < 3; d++)
+   {
+      bmin[d] = 0.0;
+      bmax[d] = 0.0;
+      nbins[d] = 1;
+      inv_h[d] = 0.0;
+   }
+   if (ne == 0) { return; }
+
+   for (int d = 0; d < sdim; d++)
+   {
+      bmin[d] = infinity();
+      bmax[d] = -infinity();
+   }
+   for (int i = 0; i < ne; i++)
+   {
+      const double *box = elem_box.GetData() + 2*sdim*i;
+      for (int d = 0; d < sdim; d++)
+      {
+         bmin[d] = std::min(bmin[d], box[d]);
+         bmax[d] = std::max(bmax[d], box[sdim+d]);
+      }
+   }
+
+   // Choose the bin sizes so that the total number of bins is approximately
+   // equal to the number of elements and the bins are roughly cubical.
+   int nact = 0;
+   double vol = 1.0;
+   for (int d = 0; d < sdim; d++)
+   {
+      if (bmax[d] > bmin[d]) { nact++; vol *= bmax[d] - bmin[d]; }
+   }
+   if (nact == 0) { return; }
+   const double s = std::pow(ne/vol, 1.0/nact);
+   for (int d = 0; d < sdim; d++)
+   {
+      const double len = bmax[d] - bmin[d];
+      if (len <= 0.0) { continue; }
+      nbins[d] = std::max(1, std::min((int) std::ceil(len*s), ne));
+      inv_h[d] = nbins[d]/len;
+   }
+}
+
+void ElementBinGrid::BuildBinTable()
+{
+   const int nx = nbins[0], ny = nbins[1], nz = nbins[2];
+   int lo[3] = { 0, 0, 0 }, hi[3] = { 0, 0, 0 };
+
+   bin_elem.MakeI(nx*ny*nz);
+   for (int pass = 0; pass < 2; pass++)
+   {
+      for (int i = 0; i < ne; i++)
+      {
+         const double *box = elem_box.GetData() + 2*sdim*i;
+         for (int d = 0; d < sdim; d++)
+         {
+            lo[d] = BinCoord(d, box[d]);
+            hi[d] = BinCoord(d, box[sdim+d]);
+         }
+         for (int k = lo[2]; k <= hi[2]; k++)
+         {
+            for (int j = lo[1]; j <= hi[1]; j++)
+            {
+               for (int l = lo[0]; l <= hi[0]; l++)
+               {
+                  const int b = l + nx*(j + ny*k);
+                  if (pass == 0) { bin_elem.AddAColumnInRow(b); }
+                  else { bin_elem.AddConnection(b, i); }
+               }
+            }
+         }
+      }
+      if (pass == 0) { bin_elem.MakeJ(); }
+   }
+   bin_elem.ShiftUpI();
+}
+
+bool ElementBinGrid::BoxContains(int i, const double *pt) const
+{
+   const double *box = elem_box.GetData() + 2*sdim*i;
+   for (int d = 0; d < sdim; d++)
+   {
+      if (pt[d] < box[d] || pt[d] > box[sdim+d]) { return false; }
+   }
+   return true;
+}
+
+void ElementBinGrid::FindCandidates(const double *pt, Array<int> &elems) const
+{
+   elems.SetSize(0);
+   if (ne == 0) { return; }
+   for (int d = 0; d < sdim; d++)
+   {
+      if (pt[d] < bmin[d] || pt[d] > bmax[d]) { return; }
+   }
+
+   int b = 0;
+   for (int d = sdim-1; d >= 0; d--)
+   {
+      b = b*nbins[d] + BinCoord(d, pt[d]);
+   }
+
+   const int nb = bin_elem.RowSize(b);
+   const int *bel = bin_elem.GetRow(b);
+   Array<double> dist(nb);
+   dist.SetSize(0);
+   for (int j = 0; j < nb; j++)
+   {
+      const int e = bel[j];
+      if (!BoxContains(e, pt)) { continue; }
+
+      const double *ctr = elem_ctr.GetData() + sdim*e;
+      double dst = 0.0;
+      for (int d = 0; d < sdim; d++)
+      {
+         dst += (pt[d] - ctr[d])*(pt[d] - ctr[d]);
+      }
+
+      // Insertion sort: the number of candidates is small.
+      int k = elems.Size();
+      elems.Append(e);
+      dist.Append(dst);
+      for ( ; k > 0 && dist[k-1] > dst; k--)
+      {
+         elems[k] = elems[k-1];
+         dist[k] = dist[k-1];
+      }
+      elems[k] = e;
+      dist[k] = dst;
+   }
+}
+
+void ElementBinGrid::GetElementBox(int i, Vector &min, Vector &max) const
+{
+   const double *box = elem_box.GetData() + 2*sdim*i;
+   min.SetSize(sdim);
+   max.SetSize(sdim);
+   for (int d = 0; d < sdim; d++)
+   {
+      min(d) = box[d];
+      max(d) = box[sdim+d];
+   }
+}
+
+long ElementBinGrid::MemoryUsage() const
+{
+   return (elem_box.Size() + elem_ctr.Size())*sizeof(double) +
+          bin_elem.MemoryUsage();
+}
+
+}
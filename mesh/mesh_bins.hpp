@@ -0,0 +1,98 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#ifndef MFEM_MESH_BINS
+#define MFEM_MESH_BINS
+
+#include "../config/config.hpp"
+#include "../general/array.hpp"
+#include "../general/table.hpp"
+#include "../linalg/vector.hpp"
+
+namespace mfem
+{
+
+class Mesh;
+
+/** @brief Uniform grid of bins over the physical bounding box of a Mesh, where
+    each bin stores the elements whose (slightly enlarged) bounding boxes
+    intersect it.
+
+    The element bounding boxes are computed from the extents of the element
+    nodes (or vertices, when the mesh has no nodes). For curved elements, i.e.
+    when the nodal space has order > 1, the boxes are enlarged to account for
+    the curved element boundaries.
+
+    The grid is used by Mesh::FindPoints() to limit the element transformation
+    inversions to a small set of candidate elements. It is built on demand and
+    cached by the Mesh, see Mesh::GetElementBinGrid(). */
+class ElementBinGrid
+{
+protected:
+   int sdim, ne;
+   int nbins[3];
+   double bmin[3], bmax[3], inv_h[3];
+
+   Vector elem_box;   // element boxes: (min[sdim], max[sdim]) for each element
+   Vector elem_ctr;   // element centers (of the boxes), sdim entries each
+   Table bin_elem;    // bin-to-element connectivity
+
+   long sequence;     // Mesh sequence at the time of construction
+
+   /// Compute the bounding boxes of all mesh elements.
+   void ComputeElementBoxes(Mesh &mesh, double curved_tol);
+
+   /// Compute the global box and the number of bins in each direction.
+   void SetupBins();
+
+   /// Build the bin-to-element Table.
+   void BuildBinTable();
+
+   /// Return the bin index of @a x in direction @a d, clamped to the grid.
+   inline int BinCoord(int d, double x) const
+   {
+      const int i = (int) ((x - bmin[d]) * inv_h[d]);
+      return (i < 0) ? 0 : ((i >= nbins[d]) ? nbins[d]-1 : i);
+   }
+
+public:
+   /** @brief Construct the bin grid for the given @a mesh.
+
+       The element boxes are enlarged by @a rel_tol times their diameter for
+       straight-sided elements and by @a curved_tol times their diameter for
+       curved elements. */
+   ElementBinGrid(Mesh &mesh, double rel_tol = 1e-8, double curved_tol = 0.1);
+
+   /// Return the Mesh sequence that this grid was built for.
+   long GetSequence() const { return sequence; }
+
+   /// Return the total number of bins.
+   int GetNBins() const { return bin_elem.Size(); }
+
+   /// Return the number of bins in direction @a d.
+   int GetNBins(int d) const { return nbins[d]; }
+
+   /** @brief Return in @a elems the elements whose bounding boxes contain the
+       point @a pt, sorted by increasing distance from their box centers. */
+   void FindCandidates(const double *pt, Array<int> &elems) const;
+
+   /// Return true if the bounding box of element @a i contains the point @a pt.
+   bool BoxContains(int i, const double *pt) const;
+
+   /// Return the bounding box of element @a i.
+   void GetElementBox(int i, Vector &min, Vector &max) const;
+
+   long MemoryUsage() const;
+};
+
+}
+
+#endif
@@ -0,0 +1,406 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+// Implementation of the GeometricFactors class
+
+#include "mesh_headers.hpp"
+#include "../fem/fem.hpp"
+#include "../general/forall.hpp"
+
+namespace mfem
+{
+
+// Gather the coordinates of the ND nodes of each element into the E-vector
+// meshNodes (VDIM x ND x NE). The node with dof index i and component v is
+// X[v*xs + i*ds].
+static void GeomFill(const int vdim, const int NE, const int ND, const int NX,
+                     const int xs, const int ds, const int* elementMap,
+                     const double *_X, double *meshNodes)
+{
+   const DeviceArray d_elementMap(elementMap, ND*NE);
+   const DeviceVector X(_X, NX);
+   DeviceVector d_meshNodes(meshNodes, vdim*ND*NE);
+   MFEM_FORALL(e, NE,
+   {
+      for (int d = 0; d < ND; ++d)
+      {
+         const int lid = d+ND*e;
+         const int gid = d_elementMap[lid];
+         for (int v = 0; v < vdim; ++v)
+         {
+            d_meshNodes[v+vdim*lid] = X[v*xs+gid*ds];
+         }
+      }
+   });
+}
+
+// The factors which are not requested have a NULL pointer and are given zero
+// sizes, so that no device pointer is looked up for them.
+template<int T_D1D = 0, int T_Q1D = 0> static
+void PAGeom2D(const int NE,
+              const double* _B,
+              const double* _G,
+              const double* _X,
+              double* _Xq,
+              double* _J,
+              double* _invJ,
+              double* _detJ,
+              const int d1d = 0,
+              const int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const int ND = D1D*D1D;
+   const int NQ = Q1D*Q1D;
+   const bool want_X = _Xq, want_J = _J, want_invJ = _invJ, want_detJ = _detJ;
+
+   const DeviceTensor<2> B(_B, NQ, ND);
+   const DeviceTensor<3> G(_G, 2,NQ, ND);
+   const DeviceTensor<3> X(_X, 2,ND, NE);
+   DeviceTensor<3> Xq(_Xq, 2, NQ, want_X ? NE : 0);
+   DeviceTensor<4> J(_J, 2, 2, NQ, want_J ? NE : 0);
+   DeviceTensor<4> invJ(_invJ, 2, 2, NQ, want_invJ ? NE : 0);
+   DeviceMatrix detJ(_detJ, NQ, want_detJ ? NE : 0);
+
+   MFEM_FORALL(e, NE,
+   {
+      const int D1D = T_D1D ? T_D1D : d1d; // nvcc workaround
+      const int Q1D = T_Q1D ? T_Q1D : q1d;
+      const int ND = D1D*D1D;
+      const int NQ = Q1D*Q1D;
+
+      double s_X[2*MAX_D1D*MAX_D1D];
+      for (int q = 0; q < NQ; ++q)
+      {
+         for (int d = q; d < ND; d +=NQ)
+         {
+            s_X[0+d*2] = X(0,d,e);
+            s_X[1+d*2] = X(1,d,e);
+         }
+      }
+      for (int q = 0; q < NQ; ++q)
+      {
+         double X0  = 0; double X1  = 0;
+         double J11 = 0; double J12 = 0;
+         double J21 = 0; double J22 = 0;
+         for (int d = 0; d < ND; ++d)
+         {
+            const double b = B(q,d);
+            const double wx = G(0,q,d);
+            const double wy = G(1,q,d);
+            const double x = s_X[0+d*2];
+            const double y = s_X[1+d*2];
+            J11 += (wx * x); J12 += (wx * y);
+            J21 += (wy * x); J22 += (wy * y);
+            X0 += b*x; X1 += b*y;
+         }
+         if (want_X) { Xq(0,q,e) = X0; Xq(1,q,e) = X1; }
+         const double r_detJ = (J11 * J22)-(J12 * J21);
+         if (want_J)
+         {
+            J(0,0,q,e) = J11;
+            J(1,0,q,e) = J12;
+            J(0,1,q,e) = J21;
+            J(1,1,q,e) = J22;
+         }
+         if (want_invJ)
+         {
+            const double r_idetJ = 1.0 / r_detJ;
+            invJ(0,0,q,e) =  J22 * r_idetJ;
+            invJ(1,0,q,e) = -J12 * r_idetJ;
+            invJ(0,1,q,e) = -J21 * r_idetJ;
+            invJ(1,1,q,e) =  J11 * r_idetJ;
+         }
+         if (want_detJ) { detJ(q,e) = r_detJ; }
+      }
+   });
+}
+
+template<int T_D1D = 0, int T_Q1D = 0> static
+void PAGeom3D(const int NE,
+              const double* _B,
+              const double* _G,
+              const double* _X,
+              double* _Xq,
+              double* _J,
+              double* _invJ,
+              double* _detJ,
+              const int d1d = 0,
+              const int q1d = 0)
+{
+   const int D1D = T_D1D ? T_D1D : d1d;
+   const int Q1D = T_Q1D ? T_Q1D : q1d;
+   MFEM_VERIFY(D1D <= MAX_D1D, "");
+   MFEM_VERIFY(Q1D <= MAX_Q1D, "");
+   const int ND = D1D*D1D*D1D;
+   const int NQ = Q1D*Q1D*Q1D;
+   const bool want_X = _Xq, want_J = _J, want_invJ = _invJ, want_detJ = _detJ;
+
+   const DeviceTensor<2> B(_B, NQ, ND);
+   const DeviceTensor<3> G(_G, 3, NQ, ND);
+   const DeviceTensor<3> X(_X, 3, ND, NE);
+   DeviceTensor<3> Xq(_Xq, 3, NQ, want_X ? NE : 0);
+   DeviceTensor<4> J(_J, 3, 3, NQ, want_J ? NE : 0);
+   DeviceTensor<4> invJ(_invJ, 3, 3, NQ, want_invJ ? NE : 0);
+   DeviceMatrix detJ(_detJ, NQ, want_detJ ? NE : 0);
+
+   MFEM_FORALL(e,NE,
+   {
+      const int D1D = T_D1D ? T_D1D : d1d; // nvcc workaround
+      const int Q1D = T_Q1D ? T_Q1D : q1d;
+      const int ND = D1D*D1D*D1D;
+      const int NQ = Q1D*Q1D*Q1D;
+
+      double s_nodes[3*MAX_D1D*MAX_D1D*MAX_D1D];
+      for (int q = 0; q < NQ; ++q)
+      {
+         for (int d = q; d < ND; d += NQ)
+         {
+            s_nodes[0+d*3] = X(0,d,e);
+            s_nodes[1+d*3] = X(1,d,e);
+            s_nodes[2+d*3] = X(2,d,e);
+         }
+      }
+      for (int q = 0; q < NQ; ++q)
+      {
+         double X0 = 0; double X1 = 0; double X2 = 0;
+         double J11 = 0; double J12 = 0; double J13 = 0;
+         double J21 = 0; double J22 = 0; double J23 = 0;
+         double J31 = 0; double J32 = 0; double J33 = 0;
+         for (int d = 0; d < ND; ++d)
+         {
+            const double b = B(q,d);
+            const double wx = G(0,q,d);
+            const double wy = G(1,q,d);
+            const double wz = G(2,q,d);
+            const double x = s_nodes[0+d*3];
+            const double y = s_nodes[1+d*3];
+            const double z = s_nodes[2+d*3];
+            J11 += (wx * x); J12 += (wx * y); J13 += (wx * z);
+            J21 += (wy * x); J22 += (wy * y); J23 += (wy * z);
+            J31 += (wz * x); J32 += (wz * y); J33 += (wz * z);
+            X0 += b*x; X1 += b*y; X2 += b*z;
+         }
+         if (want_X) { Xq(0,q,e) = X0; Xq(1,q,e) = X1; Xq(2,q,e) = X2; }
+         const double r_detJ = ((J11 * J22 * J33) + (J12 * J23 * J31) +
+                                (J13 * J21 * J32) - (J13 * J22 * J31) -
+                                (J12 * J21 * J33) - (J11 * J23 * J32));
+         if (want_J)
+         {
+            J(0,0,q,e) = J11;
+            J(1,0,q,e) = J12;
+            J(2,0,q,e) = J13;
+            J(0,1,q,e) = J21;
+            J(1,1,q,e) = J22;
+            J(2,1,q,e) = J23;
+            J(0,2,q,e) = J31;
+            J(1,2,q,e) = J32;
+            J(2,2,q,e) = J33;
+         }
+         if (want_invJ)
+         {
+            const double r_idetJ = 1.0 / r_detJ;
+            invJ(0,0,q,e) = r_idetJ * ((J22 * J33)-(J23 * J32));
+            invJ(1,0,q,e) = r_idetJ * ((J32 * J13)-(J33 * J12));
+            invJ(2,0,q,e) = r_idetJ * ((J12 * J23)-(J13 * J22));
+            invJ(0,1,q,e) = r_idetJ * ((J23 * J31)-(J21 * J33));
+            invJ(1,1,q,e) = r_idetJ * ((J33 * J11)-(J31 * J13));
+            invJ(2,1,q,e) = r_idetJ * ((J13 * J21)-(J11 * J23));
+            invJ(0,2,q,e) = r_idetJ * ((J21 * J32)-(J22 * J31));
+            invJ(1,2,q,e) = r_idetJ * ((J31 * J12)-(J32 * J11));
+            invJ(2,2,q,e) = r_idetJ * ((J11 * J22)-(J12 * J21));
+         }
+         if (want_detJ) { detJ(q,e) = r_detJ; }
+      }
+   });
+}
+
+static void PAGeom(const int dim,
+                   const int D1D,
+                   const int Q1D,
+                   const int NE,
+                   const double* B,
+                   const double* G,
+                   const double* X,
+                   double* Xq,
+                   double* J,
+                   double* invJ,
+                   double* detJ)
+{
+   if (dim == 2)
+   {
+      switch ((D1D << 4) | Q1D)
+      {
+         case 0x22: PAGeom2D<2,2>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x23: PAGeom2D<2,3>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x24: PAGeom2D<2,4>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x25: PAGeom2D<2,5>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x32: PAGeom2D<3,2>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x34: PAGeom2D<3,4>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x42: PAGeom2D<4,2>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x44: PAGeom2D<4,4>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x45: PAGeom2D<4,5>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x46: PAGeom2D<4,6>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x58: PAGeom2D<5,8>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         default: PAGeom2D(NE, B, G, X, Xq, J, invJ, detJ, D1D, Q1D); break;
+      }
+      return;
+   }
+   if (dim == 3)
+   {
+      switch ((D1D << 4) | Q1D)
+      {
+         case 0x23: PAGeom3D<2,3>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x24: PAGeom3D<2,4>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x25: PAGeom3D<2,5>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x26: PAGeom3D<2,6>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         case 0x34: PAGeom3D<3,4>(NE, B, G, X, Xq, J, invJ, detJ); break;
+         default: PAGeom3D(NE, B, G, X, Xq, J, invJ, detJ, D1D, Q1D); break;
+      }
+      return;
+   }
+   MFEM_ABORT("Unknown kernel.");
+}
+
+GeometricFactors::GeometricFactors(Mesh &mesh_, const IntegrationRule &ir,
+                                   const int flags)
+   : mesh(&mesh_), rule(ir), IntRule(&rule), computed_factors(flags),
+     sequence(mesh_.GetSequence()), nodes_hash(mesh_.GetNodesHash())
+{
+   const int NE = mesh->GetNE();
+   const int dim = mesh->Dimension();
+   const int sdim = mesh->SpaceDimension();
+   const int NQ = ir.GetNPoints();
+   if (flags & COORDINATES) { X.SetSize(sdim*NQ*NE); }
+   if (flags & JACOBIANS) { J.SetSize(sdim*dim*NQ*NE); }
+   if (flags & INVERSE_JACOBIANS) { invJ.SetSize(dim*sdim*NQ*NE); }
+   if (flags & DETERMINANTS) { detJ.SetSize(NQ*NE); }
+   if (NE == 0) { return; }
+
+   // The nodal element of the mesh: the one of the nodes or, for a mesh
+   // without nodes, the order 1 H1 element on the vertices.
+   const GridFunction *nodes = mesh->GetNodes();
+   const FiniteElementSpace *nfes = nodes ? nodes->FESpace() : NULL;
+   H1_FECollection vfec(1, dim);
+   const Geometry::Type geom = mesh->GetElementBaseGeometry(0);
+   const FiniteElement *fe =
+      nfes ? nfes->GetFE(0) : vfec.FiniteElementForGeometry(geom);
+
+   // The kernels are used for a single geometry of quadrilaterals/hexahedra
+   // with a nodal element of (D1D)^dim dofs and a rule of (Q1D)^dim points.
+   const int D1D = fe->GetOrder() + 1;
+   const int Q1D = IntRules.Get(Geometry::SEGMENT, ir.GetOrder()).GetNPoints();
+   const bool tensor =
+      (geom == Geometry::SQUARE || geom == Geometry::CUBE) &&
+      sdim == dim && mesh->GetNumGeometries(dim) == 1 &&
+      (!nfes || !nfes->GetNURBSext()) &&
+      fe->GetDof() == (dim == 2 ? D1D*D1D : D1D*D1D*D1D) &&
+      NQ == (dim == 2 ? Q1D*Q1D : Q1D*Q1D*Q1D) &&
+      D1D <= MAX_D1D && Q1D <= MAX_Q1D;
+   if (!tensor)
+   {
+      ComputeWithTransformations(mesh_);
+      return;
+   }
+
+   // Dense basis (NQ x ND) and reference gradients (DIM x NQ x ND) of the
+   // nodal element at the points of the rule.
+   const int ND = fe->GetDof();
+   Array<double> B(NQ*ND), G(dim*NQ*ND);
+   Vector shape(ND);
+   DenseMatrix dshape(ND, dim);
+   for (int q = 0; q < NQ; q++)
+   {
+      fe->CalcShape(ir.IntPoint(q), shape);
+      fe->CalcDShape(ir.IntPoint(q), dshape);
+      for (int d = 0; d < ND; d++)
+      {
+         B[q+NQ*d] = shape(d);
+         for (int i = 0; i < dim; i++) { G[i+dim*(q+NQ*d)] = dshape(d,i); }
+      }
+   }
+
+   Array<double> meshNodes(dim*ND*NE);
+   if (nfes)
+   {
+      const bool byNODES = (nfes->GetOrdering() == Ordering::byNODES);
+      const int ndofs = nfes->GetNDofs();
+      GeomFill(dim, NE, ND, nodes->Size(),
+               byNODES ? ndofs : 1, byNODES ? 1 : dim,
+               nfes->GetElementToDofTable().GetJ(),
+               nodes->GetData(), meshNodes);
+   }
+   else
+   {
+      Array<int> v;
+      for (int e = 0; e < NE; e++)
+      {
+         mesh->GetElementVertices(e, v);
+         for (int d = 0; d < ND; d++)
+         {
+            const double *vx = mesh->GetVertex(v[d]);
+            for (int c = 0; c < dim; c++) { meshNodes[c+dim*(d+ND*e)] = vx[c]; }
+         }
+      }
+   }
+   PAGeom(dim, D1D, Q1D, NE, B, G, meshNodes,
+          (flags & COORDINATES) ? X.GetData() : NULL,
+          (flags & JACOBIANS) ? J.GetData() : NULL,
+          (flags & INVERSE_JACOBIANS) ? invJ.GetData() : NULL,
+          (flags & DETERMINANTS) ? detJ.GetData() : NULL);
+}
+
+void GeometricFactors::ComputeWithTransformations(Mesh &mesh_)
+{
+   const int NE = mesh->GetNE();
+   const int dim = mesh->Dimension();
+   const int sdim = mesh->SpaceDimension();
+   const int NQ = IntRule->GetNPoints();
+   MFEM_VERIFY(mesh->GetNumGeometries(dim) == 1,
+               "the geometric factors require a single element geometry");
+   Vector x;
+   for (int e = 0; e < NE; e++)
+   {
+      ElementTransformation &T = *mesh_.GetElementTransformation(e);
+      for (int q = 0; q < NQ; q++)
+      {
+         const IntegrationPoint &ip = IntRule->IntPoint(q);
+         T.SetIntPoint(&ip);
+         const int k = q + NQ*e;
+         if (computed_factors & COORDINATES)
+         {
+            x.SetDataAndSize(X.GetData() + sdim*k, sdim);
+            T.Transform(ip, x);
+         }
+         if (computed_factors & JACOBIANS)
+         {
+            const DenseMatrix &Jq = T.Jacobian();
+            for (int i = 0; i < sdim*dim; i++)
+            {
+               J[i+sdim*dim*k] = Jq.Data()[i];
+            }
+         }
+         if (computed_factors & INVERSE_JACOBIANS)
+         {
+            const DenseMatrix &iJq = T.InverseJacobian();
+            for (int i = 0; i < dim*sdim; i++)
+            {
+               invJ[i+dim*sdim*k] = iJq.Data()[i];
+            }
+         }
+         if (computed_factors & DETERMINANTS) { detJ[k] = T.Weight(); }
+      }
+   }
+}
+
+}
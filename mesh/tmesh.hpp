@@ -16,6 +16,7 @@
 #include "../linalg/tlayout.hpp"
 
 #include "mesh.hpp"
+#include "../fem/gridfunc.hpp"
 
 namespace mfem
 {
@@ -50,6 +51,14 @@ public:
       MFEM_STATIC_ASSERT(space_dim != 0, "dynamic space dim is not allowed");
    }
 
+   /// Use the given @a nodes instead of the nodes of the @a mesh.
+   TMesh(const Mesh &mesh, const GridFunction &nodes)
+      : m_mesh(mesh), fes(*nodes.FESpace()), Nodes(nodes),
+        fe(*fes.FEColl()), t_fes(fe, fes), node_layout(fes)
+   {
+      MFEM_STATIC_ASSERT(space_dim != 0, "dynamic space dim is not allowed");
+   }
+
    int GetNE() const { return m_mesh.GetNE(); }
 
    static bool MatchesGeometry(const Mesh &mesh)
@@ -14,6 +14,7 @@
 
 #include "mfem.hpp"
 #include "general/tassign.hpp"
+#include "linalg/simd.hpp"
 #include "linalg/tlayout.hpp"
 #include "linalg/tmatrix.hpp"
 #include "linalg/ttensor.hpp"
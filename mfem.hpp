@@ -30,6 +30,7 @@
 #include "general/optparser.hpp"
 #include "general/gzstream.hpp"
 #include "general/version.hpp"
+#include "general/jit.hpp"
 #include "general/globals.hpp"
 #ifdef MFEM_USE_MPI
 #include "general/communication.hpp"
@@ -0,0 +1,192 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#include "mfem.hpp"
+#include "catch.hpp"
+
+#include <cmath>
+
+using namespace mfem;
+
+namespace assembly_levels
+{
+
+static double coeff_func(const Vector &x)
+{
+   double r = 1.0;
+   for (int d = 0; d < x.Size(); d++) { r += x(d)*x(d); }
+   return r;
+}
+
+static void perturb(const Vector &x, Vector &y)
+{
+   y = x;
+   double s = 1.0;
+   for (int d = 0; d < x.Size(); d++) { s *= sin(M_PI*x(d)); }
+   y(0) += 0.05*s;
+}
+
+// Return the max norm of the difference of the matrices of a and b, relative
+// to the max norm of the matrix of a.
+static double MatrixError(BilinearForm &a, BilinearForm &b)
+{
+   SparseMatrix diff(a.SpMat());
+   diff.Add(-1.0, b.SpMat());
+   return diff.MaxNorm() / a.SpMat().MaxNorm();
+}
+
+}
+
+using namespace assembly_levels;
+
+TEST_CASE("Full assembly extension", "[FullAssembly]")
+{
+   FunctionCoefficient fcoeff(coeff_func);
+   ConstantCoefficient one(1.0);
+
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = (dim == 2) ?
+                   new Mesh(3, 3, Element::QUADRILATERAL, true) :
+                   new Mesh(2, 2, 2, Element::TETRAHEDRON, true);
+      if (dim == 3) { mesh->ReorientTetMesh(); }
+      mesh->Transform(perturb);
+
+      for (int order = 1; order <= 2; order++)
+      {
+         H1_FECollection h1_fec(order, dim);
+         ND_FECollection nd_fec(order, dim);
+
+         SECTION("H1, dim " + std::to_string(dim) + ", order " +
+                 std::to_string(order))
+         {
+            FiniteElementSpace fes(mesh, &h1_fec);
+            BilinearForm a(&fes), b(&fes);
+            b.SetAssemblyLevel(AssemblyLevel::FULL);
+            for (int k = 0; k < 2; k++)
+            {
+               BilinearForm &f = k ? b : a;
+               f.AddDomainIntegrator(new DiffusionIntegrator(fcoeff));
+               f.AddDomainIntegrator(new MassIntegrator(one));
+               f.AddBoundaryIntegrator(new MassIntegrator(fcoeff));
+               f.Assemble();
+               f.Finalize();
+            }
+            REQUIRE(MatrixError(a, b) < 1e-14);
+
+            // The linear system is formed by the BilinearForm
+            Array<int> ess_tdof_list, ess_bdr(mesh->bdr_attributes.Max());
+            ess_bdr = 1;
+            fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+            GridFunction x(&fes);
+            Vector rhs(fes.GetVSize()), X, B;
+            x.Randomize(1);
+            rhs.Randomize(2);
+            SparseMatrix A;
+            b.FormLinearSystem(ess_tdof_list, x, rhs, A, X, B);
+            REQUIRE(A.Height() == fes.GetTrueVSize());
+         }
+         SECTION("Vector H1, dim " + std::to_string(dim) + ", order " +
+                 std::to_string(order))
+         {
+            for (int ordering = 0; ordering <= 1; ordering++)
+            {
+               FiniteElementSpace fes(mesh, &h1_fec, dim, ordering);
+               BilinearForm a(&fes), b(&fes);
+               b.SetAssemblyLevel(AssemblyLevel::FULL);
+               for (int k = 0; k < 2; k++)
+               {
+                  BilinearForm &f = k ? b : a;
+                  f.AddDomainIntegrator(new ElasticityIntegrator(one, fcoeff));
+                  f.Assemble();
+                  f.Finalize();
+               }
+               REQUIRE(MatrixError(a, b) < 1e-14);
+            }
+         }
+         SECTION("ND, dim " + std::to_string(dim) + ", order " +
+                 std::to_string(order))
+         {
+            FiniteElementSpace fes(mesh, &nd_fec);
+            BilinearForm a(&fes), b(&fes);
+            b.SetAssemblyLevel(AssemblyLevel::FULL);
+            for (int k = 0; k < 2; k++)
+            {
+               BilinearForm &f = k ? b : a;
+               f.AddDomainIntegrator(new CurlCurlIntegrator(fcoeff));
+               f.AddDomainIntegrator(new VectorFEMassIntegrator(one));
+               f.Assemble();
+               f.Finalize();
+            }
+            REQUIRE(MatrixError(a, b) < 1e-14);
+         }
+         SECTION("Reproducibility, dim " + std::to_string(dim) + ", order " +
+                 std::to_string(order))
+         {
+            FiniteElementSpace fes(mesh, &h1_fec);
+            BilinearForm a(&fes), b(&fes);
+            for (int k = 0; k < 2; k++)
+            {
+               BilinearForm &f = k ? b : a;
+               f.SetAssemblyLevel(AssemblyLevel::FULL);
+               f.AddDomainIntegrator(new DiffusionIntegrator(fcoeff));
+               f.Assemble();
+               f.Finalize();
+            }
+            REQUIRE(MatrixError(a, b) == 0.0);
+         }
+         SECTION("Fallback, dim " + std::to_string(dim) + ", order " +
+                 std::to_string(order))
+         {
+            // Interior face integrators
+            DG_FECollection dg_fec(order, dim);
+            FiniteElementSpace dg_fes(mesh, &dg_fec);
+            BilinearForm a(&dg_fes), b(&dg_fes);
+            b.SetAssemblyLevel(AssemblyLevel::FULL);
+            for (int k = 0; k < 2; k++)
+            {
+               BilinearForm &f = k ? b : a;
+               f.AddDomainIntegrator(new DiffusionIntegrator(fcoeff));
+               f.AddInteriorFaceIntegrator(
+                  new DGDiffusionIntegrator(fcoeff, -1.0, 2.0*order*order));
+               f.Assemble();
+               f.Finalize();
+            }
+            REQUIRE(MatrixError(a, b) < 1e-14);
+
+            // Precomputed element matrices and static condensation
+            FiniteElementSpace fes(mesh, &h1_fec);
+            Array<int> ess_tdof_list, ess_bdr(mesh->bdr_attributes.Max());
+            ess_bdr = 1;
+            fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+            for (int sc = 0; sc <= 1; sc++)
+            {
+               BilinearForm c(&fes), d(&fes);
+               d.SetAssemblyLevel(AssemblyLevel::FULL);
+               SparseMatrix A[2];
+               for (int k = 0; k < 2; k++)
+               {
+                  BilinearForm &f = k ? d : c;
+                  f.AddDomainIntegrator(new DiffusionIntegrator(fcoeff));
+                  if (sc) { f.EnableStaticCondensation(); }
+                  else { f.ComputeElementMatrices(); }
+                  f.Assemble();
+                  f.Finalize();
+                  f.FormSystemMatrix(ess_tdof_list, A[k]);
+               }
+               A[1].Add(-1.0, A[0]);
+               REQUIRE(A[1].MaxNorm() < 1e-14 * A[0].MaxNorm());
+            }
+         }
+      }
+      delete mesh;
+   }
+}
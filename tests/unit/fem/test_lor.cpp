@@ -0,0 +1,165 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#include "mfem.hpp"
+#include "catch.hpp"
+
+using namespace mfem;
+
+namespace lor
+{
+
+// Return the number of PCG iterations for the operator A with the
+// preconditioner M.
+static int PCGIterations(Operator &A, Solver &M)
+{
+   Vector B(A.Height()), X(A.Height());
+   B.Randomize(1);
+   X = 0.0;
+   CGSolver cg;
+   cg.SetRelTol(1e-8);
+   cg.SetMaxIter(500);
+   cg.SetPreconditioner(M);
+   cg.SetOperator(A);
+   cg.Mult(B, X);
+   REQUIRE(cg.GetConverged());
+   return cg.GetNumIterations();
+}
+
+static double coord_x(const Vector &x) { return x(0); }
+static double coord_y(const Vector &x) { return x(1); }
+static double coord_z(const Vector &x) { return x(x.Size()-1); }
+
+static void perturb(const Vector &x, Vector &y)
+{
+   y = x;
+   for (int d = 0; d < x.Size(); d++) { y(d) += 0.1*x(d)*(1.0 - x(d)); }
+}
+
+}
+
+using namespace lor;
+
+TEST_CASE("LOR matrix", "[LOR]")
+{
+   // With order 1, the LOR matrix is the matrix of the form.
+   Mesh mesh(3, 3, Element::QUADRILATERAL, true);
+   H1_FECollection fec(1, 2);
+   FiniteElementSpace fes(&mesh, &fec);
+   Array<int> ess_bdr(mesh.bdr_attributes.Max()), ess_tdof_list;
+   ess_bdr = 1;
+   fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+
+   BilinearForm a(&fes);
+   a.AddDomainIntegrator(new DiffusionIntegrator);
+   a.AddDomainIntegrator(new MassIntegrator);
+   a.Assemble();
+   LORSolver lor(a, ess_tdof_list);
+   OperatorHandle A;
+   a.FormSystemMatrix(ess_tdof_list, A);
+
+   const SparseMatrix &A_lor =
+      dynamic_cast<const SparseMatrix&>(lor.GetAssembledOperator());
+   SparseMatrix *D = Add(1.0, *A.As<SparseMatrix>(), -1.0, A_lor);
+   REQUIRE(D->MaxNorm() < 1e-12);
+   delete D;
+
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      for (int order = 2; order <= 3; order++)
+      {
+         SECTION("dim " + std::to_string(dim) + ", order " +
+                 std::to_string(order))
+         {
+            Mesh *ho_mesh = (dim == 2) ?
+                            new Mesh(3, 3, Element::QUADRILATERAL, true) :
+                            new Mesh(2, 2, 2, Element::HEXAHEDRON, true);
+            ho_mesh->Transform(perturb);
+            H1_FECollection ho_fec(order, dim);
+            FiniteElementSpace ho_fes(ho_mesh, &ho_fec);
+            BilinearForm b(&ho_fes);
+            b.AddDomainIntegrator(new DiffusionIntegrator);
+            b.Assemble();
+            Array<int> no_ess;
+            LORSolver lor_b(b, no_ess);
+
+            // Each dof of the LOR space is the vertex of the LOR mesh at the
+            // node of the same dof of the high-order space.
+            const Mesh &lor_mesh = *lor_b.GetLORSpace().GetMesh();
+            REQUIRE(lor_mesh.GetNV() == ho_fes.GetVSize());
+            FunctionCoefficient coords[3] =
+            {
+               FunctionCoefficient(coord_x), FunctionCoefficient(coord_y),
+               FunctionCoefficient(coord_z)
+            };
+            for (int d = 0; d < dim; d++)
+            {
+               GridFunction x_ho(&ho_fes);
+               x_ho.ProjectCoefficient(coords[d]);
+               for (int i = 0; i < x_ho.Size(); i++)
+               {
+                  REQUIRE(fabs(lor_mesh.GetVertex(i)[d] - x_ho(i)) < 1e-12);
+               }
+            }
+
+            // The constants are in the kernel of the LOR diffusion matrix.
+            const Operator &B_lor = lor_b.GetAssembledOperator();
+            Vector one(B_lor.Width()), y(B_lor.Height());
+            one = 1.0;
+            B_lor.Mult(one, y);
+            REQUIRE(y.Normlinf() < 1e-12);
+            delete ho_mesh;
+         }
+      }
+   }
+}
+
+TEST_CASE("LOR preconditioner", "[LOR]")
+{
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = (dim == 2) ?
+                   new Mesh(4, 4, Element::QUADRILATERAL, true) :
+                   new Mesh(2, 2, 2, Element::HEXAHEDRON, true);
+      Array<int> ess_bdr(mesh->bdr_attributes.Max());
+      ess_bdr = 1;
+      Array<int> iterations;
+      for (int order = 2; order <= ((dim == 2) ? 8 : 4); order *= 2)
+      {
+         H1_FECollection fec(order, dim);
+         FiniteElementSpace fes(mesh, &fec);
+         Array<int> ess_tdof_list;
+         fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+
+         BilinearForm a(&fes);
+         a.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+         a.AddDomainIntegrator(new DiffusionIntegrator);
+         a.Assemble();
+         OperatorHandle A;
+         a.FormSystemMatrix(ess_tdof_list, A);
+
+         LORSolver lor(a, ess_tdof_list);
+         REQUIRE(lor.GetLORSpace().GetMesh()->GetNE() ==
+                 mesh->GetNE() * (int) pow(order, dim));
+         PCGIterations(*A, lor);
+
+         // With an exact solve of the LOR system, the iteration counts are
+         // bounded independently of the order.
+         CGSolver *cg = new CGSolver;
+         cg->SetRelTol(1e-12);
+         cg->SetMaxIter(2000);
+         lor.SetSolver(cg);
+         iterations.Append(PCGIterations(*A, lor));
+      }
+      REQUIRE(iterations.Max() < 40);
+      delete mesh;
+   }
+}
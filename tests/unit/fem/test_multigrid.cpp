@@ -0,0 +1,359 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#include "mfem.hpp"
+#include "catch.hpp"
+
+using namespace mfem;
+
+namespace multigrid
+{
+
+static double linear_func(const Vector &x)
+{
+   double r = 1.0;
+   for (int d = 0; d < x.Size(); d++) { r += (d + 1) * x(d); }
+   return r;
+}
+
+// Return the number of PCG iterations for the diffusion problem on fes with
+// the preconditioner M, and the assembled operator A.
+static int PCGIterations(FiniteElementSpace &fes, Operator &A, Solver &M)
+{
+   Vector B(fes.GetTrueVSize()), X(fes.GetTrueVSize());
+   B.Randomize(1);
+   X = 0.0;
+   CGSolver cg;
+   cg.SetRelTol(1e-8);
+   cg.SetMaxIter(500);
+   cg.SetPreconditioner(M);
+   cg.SetOperator(A);
+   cg.Mult(B, X);
+   REQUIRE(cg.GetConverged());
+   return cg.GetNumIterations();
+}
+
+#ifdef MFEM_USE_MPI
+// Parallel version of PCGIterations() on MPI_COMM_WORLD.
+static int ParPCGIterations(ParFiniteElementSpace &fes, Operator &A,
+                            Solver &M)
+{
+   Vector B(fes.GetTrueVSize()), X(fes.GetTrueVSize());
+   B.Randomize(1);
+   X = 0.0;
+   CGSolver cg(MPI_COMM_WORLD);
+   cg.SetRelTol(1e-8);
+   cg.SetMaxIter(500);
+   cg.SetPreconditioner(M);
+   cg.SetOperator(A);
+   cg.Mult(B, X);
+   REQUIRE(cg.GetConverged());
+   return cg.GetNumIterations();
+}
+#endif
+
+}
+
+using namespace multigrid;
+
+TEST_CASE("p-transfer", "[Multigrid]")
+{
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = (dim == 2) ?
+                   new Mesh(3, 3, Element::QUADRILATERAL, true) :
+                   new Mesh(2, 2, 2, Element::HEXAHEDRON, true);
+      H1_FECollection l_fec(2, dim), h_fec(4, dim);
+      FiniteElementSpace l_fes(mesh, &l_fec), h_fes(mesh, &h_fec);
+      InterpolationGridTransfer transfer(l_fes, h_fes);
+      const Operator &P = transfer.ForwardOperator();
+
+      // Interpolation of a linear function is exact.
+      FunctionCoefficient coeff(linear_func);
+      GridFunction l_gf(&l_fes), h_gf(&h_fes), h_ex(&h_fes);
+      l_gf.ProjectCoefficient(coeff);
+      h_ex.ProjectCoefficient(coeff);
+      P.Mult(l_gf, h_gf);
+      h_gf -= h_ex;
+      REQUIRE(h_gf.Normlinf() < 1e-12);
+
+      // The transpose satisfies (P x, y) = (x, P^T y).
+      Vector x(P.Width()), y(P.Height()), Px(P.Height()), Pty(P.Width());
+      x.Randomize(1);
+      y.Randomize(2);
+      P.Mult(x, Px);
+      P.MultTranspose(y, Pty);
+      REQUIRE(fabs((Px * y) - (x * Pty)) < 1e-12 * fabs(Px * y));
+      delete mesh;
+   }
+}
+
+TEST_CASE("p-multigrid", "[Multigrid]")
+{
+   Mesh mesh(4, 4, Element::QUADRILATERAL, true);
+   Array<int> ess_bdr(mesh.bdr_attributes.Max());
+   ess_bdr = 1;
+   ConstantCoefficient one(1.0);
+   Array<int> iterations;
+   for (int order = 2; order <= 8; order *= 2)
+   {
+      H1_FECollection fec(order, 2);
+      FiniteElementSpace fes(&mesh, &fec);
+      PMultigridSolver mg(fes, ess_bdr, &one);
+      REQUIRE(mg.GetOrderAtLevel(0) == 1);
+      REQUIRE(mg.GetOrderAtLevel(mg.NumLevels() - 1) == order);
+      Operator &A = *mg.GetOperatorAtLevel(mg.NumLevels() - 1);
+      iterations.Append(PCGIterations(fes, A, mg));
+
+      SECTION("W-cycle, order " + std::to_string(order))
+      {
+         mg.SetCycle(2, 2, 2);
+         REQUIRE(PCGIterations(fes, A, mg) <= iterations.Last());
+      }
+   }
+   // Iteration counts are bounded independently of the order.
+   REQUIRE(iterations.Max() < 30);
+}
+
+TEST_CASE("h-multigrid", "[Multigrid]")
+{
+   for (int nc = 0; nc <= 1; nc++)
+   {
+      Mesh mesh(2, 2, Element::QUADRILATERAL, true);
+      if (nc) { mesh.EnsureNCMesh(); }
+      H1_FECollection fec(2, 2);
+      FiniteElementSpace fes(&mesh, &fec);
+      Array<int> ess_bdr(mesh.bdr_attributes.Max());
+      ess_bdr = 1;
+      HMultigridSolver mg(fes);
+      Array<BilinearForm*> forms;
+      Array<int> iterations;
+      for (int l = 0; l < 4; l++)
+      {
+         if (l > 0)
+         {
+            mesh.UniformRefinement();
+            fes.Update();
+         }
+         Array<int> ess_tdof_list;
+         fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+         BilinearForm *form = new BilinearForm(&fes);
+         form->AddDomainIntegrator(new DiffusionIntegrator);
+         form->Assemble();
+         form->Finalize();
+         forms.Append(form);
+         SparseMatrix A;
+         form->FormSystemMatrix(ess_tdof_list, A);
+         if (l == 0)
+         {
+            CGSolver *cg = new CGSolver;
+            cg->SetRelTol(1e-12);
+            cg->SetMaxIter(100);
+            cg->SetOperator(form->SpMat());
+            mg.AddCoarseLevel(&form->SpMat(), cg, ess_tdof_list, false, true);
+         }
+         else
+         {
+            mg.AddRefinedLevel(&form->SpMat(), new GSSmoother(form->SpMat()),
+                               ess_tdof_list, false, true);
+            iterations.Append(PCGIterations(fes, form->SpMat(), mg));
+         }
+      }
+      REQUIRE(mg.NumLevels() == 4);
+      // Iteration counts are bounded independently of the mesh size.
+      REQUIRE(iterations.Max() < 15);
+      REQUIRE(iterations.Last() <= iterations[0] + 2);
+
+      SECTION("W-cycle, nc = " + std::to_string(nc))
+      {
+         mg.SetCycle(2, 2, 2);
+         REQUIRE(PCGIterations(fes, forms.Last()->SpMat(), mg) <=
+                 iterations.Last());
+      }
+      for (int l = 0; l < forms.Size(); l++) { delete forms[l]; }
+   }
+}
+
+TEST_CASE("Algebraic multigrid", "[Multigrid]")
+{
+   SECTION("Diffusion")
+   {
+      Mesh mesh(8, 8, Element::QUADRILATERAL, true);
+      H1_FECollection fec(2, 2);
+      FiniteElementSpace fes(&mesh, &fec);
+      Array<int> ess_bdr(mesh.bdr_attributes.Max());
+      ess_bdr = 1;
+      Array<int> iterations[4];
+      for (int l = 0; l < 3; l++)
+      {
+         if (l > 0)
+         {
+            mesh.UniformRefinement();
+            fes.Update();
+         }
+         Array<int> ess_tdof_list;
+         fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+         BilinearForm a(&fes);
+         a.AddDomainIntegrator(new DiffusionIntegrator);
+         a.Assemble();
+         a.Finalize();
+         SparseMatrix A;
+         a.FormSystemMatrix(ess_tdof_list, A);
+         GSSmoother gs(A);
+         const int gs_its = PCGIterations(fes, A, gs);
+         for (int s = 0; s < 4; s++)
+         {
+            AMGSolver amg;
+            amg.SetSmoother(AMGSolver::SmootherType(s));
+            amg.SetOperator(A);
+            REQUIRE(amg.NumLevels() == ((l < 2) ? 2 : 3));
+            iterations[s].Append(PCGIterations(fes, A, amg));
+         }
+         REQUIRE(iterations[AMGSolver::GAUSS_SEIDEL].Last() < gs_its/2);
+
+         if (l == 0)
+         {
+            // Without coarsening, the matrix is solved directly.
+            AMGSolver direct;
+            direct.SetCoarseSize(A.Height());
+            direct.SetOperator(A);
+            REQUIRE(direct.NumLevels() == 1);
+            Vector x(A.Height()), b(A.Height()), y(A.Height());
+            x.Randomize(2);
+            A.Mult(x, b);
+            direct.Mult(b, y);
+            y -= x;
+            REQUIRE(y.Normlinf() < 1e-10 * x.Normlinf());
+
+            // When the coarsening stops above the coarse size, the coarsest
+            // level is solved iteratively.
+            for (int s = 0; s < 4; s++)
+            {
+               AMGSolver single;
+               single.SetMaxLevels(1);
+               single.SetSmoother(AMGSolver::SmootherType(s));
+               single.SetOperator(A);
+               REQUIRE(single.NumLevels() == 1);
+               single.Mult(b, y);
+               y -= x;
+               REQUIRE(y.Normlinf() < 1e-8 * x.Normlinf());
+            }
+         }
+      }
+      // Iteration counts are bounded independently of the mesh size.
+      for (int s = 0; s < 4; s++)
+      {
+         REQUIRE(iterations[s].Max() < 25);
+         REQUIRE(iterations[s].Last() <= iterations[s][0] + 3);
+      }
+   }
+
+   SECTION("Elasticity")
+   {
+      Mesh mesh(4, 2, 2, Element::HEXAHEDRON, true, 2.0, 1.0, 1.0);
+      mesh.UniformRefinement();
+      H1_FECollection fec(1, 3);
+      Array<int> ess_bdr(mesh.bdr_attributes.Max());
+      ess_bdr = 0;
+      ess_bdr[4] = 1;
+      Array<int> iterations;
+      for (int ordering = Ordering::byNODES; ordering <= Ordering::byVDIM;
+           ordering++)
+      {
+         FiniteElementSpace fes(&mesh, &fec, 3, ordering);
+         Array<int> ess_tdof_list;
+         fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+         ConstantCoefficient lambda(1.0), mu(1.0);
+         BilinearForm a(&fes);
+         a.AddDomainIntegrator(new ElasticityIntegrator(lambda, mu));
+         a.Assemble(0);
+         a.Finalize(0);
+         SparseMatrix A;
+         a.FormSystemMatrix(ess_tdof_list, A);
+
+         // The rigid body modes improve on the constant components.
+         AMGSolver systems, rbms;
+         systems.SetSystemsOptions(3, ordering == Ordering::byNODES);
+         systems.SetOperator(A);
+         rbms.SetElasticityOptions(&fes);
+         rbms.SetOperator(A);
+         REQUIRE(rbms.NumLevels() == 2);
+         const int rbms_its = PCGIterations(fes, A, rbms);
+         REQUIRE(rbms_its < PCGIterations(fes, A, systems)/2);
+         iterations.Append(rbms_its);
+      }
+      // The aggregates do not depend on the ordering.
+      REQUIRE(iterations[0] == iterations[1]);
+   }
+}
+
+#ifdef MFEM_USE_MPI
+
+TEST_CASE("Parallel h-multigrid", "[Multigrid][Parallel]")
+{
+   for (int nc = 0; nc <= 1; nc++)
+   {
+      Mesh serial_mesh(4, 4, Element::QUADRILATERAL, true);
+      if (nc) { serial_mesh.EnsureNCMesh(); }
+      ParMesh mesh(MPI_COMM_WORLD, serial_mesh);
+      H1_FECollection fec(2, 2);
+      ParFiniteElementSpace fes(&mesh, &fec);
+      Array<int> ess_bdr(mesh.bdr_attributes.Max());
+      ess_bdr = 1;
+      HMultigridSolver mg(fes);
+      Array<ParBilinearForm*> forms;
+      Array<HypreParMatrix*> mats;
+      Array<int> iterations;
+      for (int l = 0; l < 3; l++)
+      {
+         if (l > 0)
+         {
+            mesh.UniformRefinement();
+            fes.Update();
+         }
+         Array<int> ess_tdof_list;
+         fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+         ParBilinearForm *form = new ParBilinearForm(&fes);
+         form->AddDomainIntegrator(new DiffusionIntegrator);
+         form->Assemble();
+         form->Finalize();
+         HypreParMatrix *A = new HypreParMatrix;
+         form->FormSystemMatrix(ess_tdof_list, *A);
+         forms.Append(form);
+         mats.Append(A);
+         if (l == 0)
+         {
+            CGSolver *cg = new CGSolver(MPI_COMM_WORLD);
+            cg->SetRelTol(1e-12);
+            cg->SetMaxIter(100);
+            cg->SetOperator(*A);
+            mg.AddCoarseLevel(A, cg, ess_tdof_list, false, true);
+         }
+         else
+         {
+            mg.AddRefinedLevel(A, new HypreSmoother(*A), ess_tdof_list,
+                               false, true);
+            iterations.Append(ParPCGIterations(fes, *A, mg));
+         }
+      }
+      REQUIRE(mg.NumLevels() == 3);
+      // Iteration counts are bounded independently of the mesh size.
+      REQUIRE(iterations.Max() < 15);
+      REQUIRE(iterations.Last() <= iterations[0] + 2);
+      for (int l = 0; l < forms.Size(); l++)
+      {
+         delete mats[l];
+         delete forms[l];
+      }
+   }
+}
+
+#endif // MFEM_USE_MPI
@@ -0,0 +1,1174 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#include "mfem.hpp"
+#include "catch.hpp"
+
+#include <cmath>
+
+using namespace mfem;
+
+namespace pa_kernels
+{
+
+static double coeff_func(const Vector &x)
+{
+   double r = 1.0;
+   for (int d = 0; d < x.Size(); d++) { r += x(d)*x(d); }
+   return r;
+}
+
+// Smooth map of the unit square/cube, making the elements non-affine.
+static void perturb(const Vector &x, Vector &y)
+{
+   y = x;
+   double s = 1.0;
+   for (int d = 0; d < x.Size(); d++) { s *= sin(M_PI*x(d)); }
+   y(0) += 0.05*s;
+   y(x.Size()-1) -= 0.03*s;
+}
+
+static Mesh *MakeMesh(int dim)
+{
+   Mesh *mesh = (dim == 2) ?
+                new Mesh(3, 3, Element::QUADRILATERAL, true) :
+                new Mesh(2, 2, 2, Element::HEXAHEDRON, true);
+   mesh->Transform(perturb);
+   return mesh;
+}
+
+// Return the relative max norm of the difference between the actions of the
+// fully assembled form with the integrator fa_integ and the form assembled at
+// the given level with the (same) integrator integ.
+static double PAError(FiniteElementSpace &fes,
+                      BilinearFormIntegrator *fa_integ,
+                      BilinearFormIntegrator *integ,
+                      AssemblyLevel level = AssemblyLevel::PARTIAL)
+{
+   BilinearForm fa(&fes), pa(&fes);
+   fa.AddDomainIntegrator(fa_integ);
+   fa.Assemble();
+   fa.Finalize();
+   pa.SetAssemblyLevel(level);
+   pa.AddDomainIntegrator(integ);
+   pa.Assemble();
+
+   Array<int> ess_tdof_list;
+   OperatorHandle A_pa;
+   pa.FormSystemMatrix(ess_tdof_list, A_pa);
+
+   Vector x(fes.GetVSize()), y_fa(fes.GetVSize()), y_pa(fes.GetVSize());
+   x.Randomize(1);
+   fa.Mult(x, y_fa);
+   A_pa->Mult(x, y_pa);
+   y_pa -= y_fa;
+   return y_pa.Normlinf() / y_fa.Normlinf();
+}
+
+// Symmetric positive definite, anisotropic conductivity.
+static void conductivity_func(const Vector &x, DenseMatrix &K)
+{
+   const int dim = x.Size();
+   K.SetSize(dim);
+   for (int i = 0; i < dim; i++)
+   {
+      for (int j = 0; j < dim; j++)
+      {
+         K(i,j) = (i == j) ? 2.0 + i + x(i)*x(i) : 0.1*x(0)*x(dim-1);
+      }
+   }
+}
+
+static void velocity_func(const Vector &x, Vector &v)
+{
+   v.SetSize(x.Size());
+   for (int d = 0; d < x.Size(); d++) { v(d) = 1.0 + d + x(d)*x(d); }
+}
+
+}
+
+using namespace pa_kernels;
+
+TEST_CASE("PA Nedelec integrators", "[PartialAssembly]")
+{
+   FunctionCoefficient fcoeff(coeff_func);
+   ConstantCoefficient ccoeff(2.5);
+
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      for (int order = 1; order <= 3; order++)
+      {
+         ND_FECollection fec(order, dim);
+         FiniteElementSpace fes(mesh, &fec);
+
+         SECTION("VectorFEMassIntegrator, dim " + std::to_string(dim) +
+                 ", order " + std::to_string(order))
+         {
+            double err = PAError(fes, new VectorFEMassIntegrator(fcoeff),
+                                 new VectorFEMassIntegrator(fcoeff));
+            REQUIRE(err < 1e-12);
+            err = PAError(fes, new VectorFEMassIntegrator,
+                          new VectorFEMassIntegrator);
+            REQUIRE(err < 1e-12);
+         }
+         SECTION("CurlCurlIntegrator, dim " + std::to_string(dim) +
+                 ", order " + std::to_string(order))
+         {
+            double err = PAError(fes, new CurlCurlIntegrator(ccoeff),
+                                 new CurlCurlIntegrator(ccoeff));
+            REQUIRE(err < 1e-12);
+            err = PAError(fes, new CurlCurlIntegrator(fcoeff),
+                          new CurlCurlIntegrator(fcoeff));
+            REQUIRE(err < 1e-12);
+         }
+      }
+      delete mesh;
+   }
+}
+
+TEST_CASE("PA Raviart-Thomas integrators", "[PartialAssembly]")
+{
+   FunctionCoefficient fcoeff(coeff_func);
+   ConstantCoefficient ccoeff(2.5);
+
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      for (int order = 0; order <= 2; order++)
+      {
+         RT_FECollection fec(order, dim);
+         FiniteElementSpace fes(mesh, &fec);
+
+         SECTION("VectorFEMassIntegrator, dim " + std::to_string(dim) +
+                 ", order " + std::to_string(order))
+         {
+            double err = PAError(fes, new VectorFEMassIntegrator(fcoeff),
+                                 new VectorFEMassIntegrator(fcoeff));
+            REQUIRE(err < 1e-12);
+            err = PAError(fes, new VectorFEMassIntegrator,
+                          new VectorFEMassIntegrator);
+            REQUIRE(err < 1e-12);
+         }
+         SECTION("DivDivIntegrator, dim " + std::to_string(dim) +
+                 ", order " + std::to_string(order))
+         {
+            double err = PAError(fes, new DivDivIntegrator(ccoeff),
+                                 new DivDivIntegrator(ccoeff));
+            REQUIRE(err < 1e-12);
+            err = PAError(fes, new DivDivIntegrator(fcoeff),
+                          new DivDivIntegrator(fcoeff));
+            REQUIRE(err < 1e-12);
+         }
+         SECTION("Mixed VectorFEDivergenceIntegrator, dim " +
+                 std::to_string(dim) + ", order " + std::to_string(order))
+         {
+            L2_FECollection l2_fec(order, dim);
+            FiniteElementSpace l2_fes(mesh, &l2_fec);
+
+            MixedBilinearForm fa(&fes, &l2_fes), pa(&fes, &l2_fes);
+            fa.AddDomainIntegrator(new VectorFEDivergenceIntegrator(fcoeff));
+            fa.Assemble();
+            fa.Finalize();
+            pa.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+            pa.AddDomainIntegrator(new VectorFEDivergenceIntegrator(fcoeff));
+            pa.Assemble();
+
+            Vector x(fes.GetVSize()), y_fa(l2_fes.GetVSize()),
+                   y_pa(l2_fes.GetVSize());
+            x.Randomize(1);
+            fa.Mult(x, y_fa);
+            pa.Mult(x, y_pa);
+            y_pa -= y_fa;
+            REQUIRE(y_pa.Normlinf() / y_fa.Normlinf() < 1e-12);
+
+            Vector z(l2_fes.GetVSize()), w_fa(fes.GetVSize()),
+                   w_pa(fes.GetVSize());
+            z.Randomize(2);
+            fa.MultTranspose(z, w_fa);
+            pa.MultTranspose(z, w_pa);
+            w_pa -= w_fa;
+            REQUIRE(w_pa.Normlinf() / w_fa.Normlinf() < 1e-12);
+         }
+      }
+      delete mesh;
+   }
+}
+
+TEST_CASE("PA diffusion coefficients", "[PartialAssembly]")
+{
+   FunctionCoefficient fcoeff(coeff_func);
+
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      Vector pw(mesh->attributes.Max());
+      for (int i = 0; i < pw.Size(); i++) { pw(i) = 1.0 + i; }
+      PWConstCoefficient pwcoeff(pw);
+      MatrixFunctionCoefficient mcoeff(dim, conductivity_func);
+      DenseMatrix K(dim);
+      Vector xc(dim);
+      xc = 0.3;
+      conductivity_func(xc, K);
+      MatrixConstantCoefficient kcoeff(K);
+
+      for (int order = 1; order <= 3; order++)
+      {
+         H1_FECollection fec(order, dim);
+         FiniteElementSpace fes(mesh, &fec);
+         GridFunction gf(&fes);
+         gf.ProjectCoefficient(fcoeff);
+         GridFunctionCoefficient gfcoeff(&gf);
+
+         SECTION("Scalar coefficients, dim " + std::to_string(dim) +
+                 ", order " + std::to_string(order))
+         {
+            REQUIRE(PAError(fes, new DiffusionIntegrator(fcoeff),
+                            new DiffusionIntegrator(fcoeff)) < 1e-12);
+            REQUIRE(PAError(fes, new DiffusionIntegrator(pwcoeff),
+                            new DiffusionIntegrator(pwcoeff)) < 1e-12);
+            REQUIRE(PAError(fes, new DiffusionIntegrator(gfcoeff),
+                            new DiffusionIntegrator(gfcoeff)) < 1e-12);
+         }
+         SECTION("Matrix coefficients, dim " + std::to_string(dim) +
+                 ", order " + std::to_string(order))
+         {
+            REQUIRE(PAError(fes, new DiffusionIntegrator(mcoeff),
+                            new DiffusionIntegrator(mcoeff)) < 1e-12);
+            REQUIRE(PAError(fes, new DiffusionIntegrator(kcoeff),
+                            new DiffusionIntegrator(kcoeff)) < 1e-12);
+         }
+      }
+      delete mesh;
+   }
+}
+
+TEST_CASE("PA kernels of high order", "[PartialAssembly]")
+{
+   // These sizes have no precompiled instance: the kernels are compiled at
+   // runtime with MFEM_USE_JIT, and use the generic instance otherwise.
+   ConstantCoefficient one(1.0);
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      for (int order = 5; order <= 6; order++)
+      {
+         H1_FECollection fec(order, dim);
+         FiniteElementSpace fes(mesh, &fec);
+         SECTION("dim " + std::to_string(dim) + ", order " +
+                 std::to_string(order))
+         {
+            REQUIRE(PAError(fes, new DiffusionIntegrator(one),
+                            new DiffusionIntegrator(one)) < 1e-12);
+            REQUIRE(PAError(fes, new MassIntegrator(one),
+                            new MassIntegrator(one)) < 1e-12);
+         }
+      }
+      delete mesh;
+   }
+}
+
+TEST_CASE("PA templated forms", "[PartialAssembly]")
+{
+   ConstantCoefficient ccoeff(2.5);
+   FunctionCoefficient fcoeff(coeff_func);
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      for (int order = 1; order <= 5; order++)
+      {
+         H1_FECollection fec(order, dim);
+         FiniteElementSpace fes(mesh, &fec);
+         SECTION("dim " + std::to_string(dim) + ", order " +
+                 std::to_string(order))
+         {
+            // Orders 1 to 4 are registered by default.
+            MassIntegrator mass(ccoeff);
+            DiffusionIntegrator diffusion, fdiffusion(fcoeff);
+            Operator *op = TBilinearFormRegistry::Create(mass, fes);
+            REQUIRE((op != NULL) == (order <= 4));
+            delete op;
+            op = TBilinearFormRegistry::Create(diffusion, fes);
+            REQUIRE((op != NULL) == (order <= 4));
+            delete op;
+            REQUIRE(TBilinearFormRegistry::Create(fdiffusion, fes) == NULL);
+
+            REQUIRE(PAError(fes, new MassIntegrator(ccoeff),
+                            new MassIntegrator(ccoeff)) < 1e-12);
+            REQUIRE(PAError(fes, new DiffusionIntegrator,
+                            new DiffusionIntegrator) < 1e-12);
+
+            if (order <= 4)
+            {
+               // Sum of templated operators
+               BilinearForm fa(&fes), pa(&fes);
+               fa.AddDomainIntegrator(new MassIntegrator(ccoeff));
+               fa.AddDomainIntegrator(new DiffusionIntegrator);
+               fa.Assemble();
+               fa.Finalize();
+               pa.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+               pa.AddDomainIntegrator(new MassIntegrator(ccoeff));
+               pa.AddDomainIntegrator(new DiffusionIntegrator);
+               pa.Assemble();
+               Array<int> ess_tdof_list;
+               OperatorHandle A_pa;
+               pa.FormSystemMatrix(ess_tdof_list, A_pa);
+               Vector x(fes.GetVSize()), y_fa(fes.GetVSize()),
+                      y_pa(fes.GetVSize());
+               x.Randomize(1);
+               fa.Mult(x, y_fa);
+               A_pa->Mult(x, y_pa);
+               y_pa -= y_fa;
+               REQUIRE(y_pa.Normlinf() / y_fa.Normlinf() < 1e-12);
+            }
+         }
+      }
+
+      // The mesh nodes of order 2 have no templated counterpart.
+      mesh->SetCurvature(2);
+      H1_FECollection fec(2, dim);
+      FiniteElementSpace fes(mesh, &fec);
+      MassIntegrator mass;
+      REQUIRE(TBilinearFormRegistry::Create(mass, fes) == NULL);
+      delete mesh;
+   }
+}
+
+// Same as PAError, with the partial assembly and its action on the Device
+// configured with the SIMD backend.
+static double SIMDPAError(FiniteElementSpace &fes,
+                          BilinearFormIntegrator *fa_integ,
+                          BilinearFormIntegrator *integ)
+{
+   BilinearForm fa(&fes), pa(&fes);
+   fa.AddDomainIntegrator(fa_integ);
+   fa.Assemble();
+   fa.Finalize();
+   Vector x(fes.GetVSize()), y_fa(fes.GetVSize()), y_pa(fes.GetVSize());
+   x.Randomize(1);
+   fa.Mult(x, y_fa);
+
+   Device::Enable();
+   pa.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   pa.AddDomainIntegrator(integ);
+   pa.Assemble();
+   Array<int> ess_tdof_list;
+   OperatorHandle A_pa;
+   pa.FormSystemMatrix(ess_tdof_list, A_pa);
+   A_pa->Mult(x, y_pa);
+   Device::Disable();
+
+   y_pa -= y_fa;
+   return y_pa.Normlinf() / y_fa.Normlinf();
+}
+
+TEST_CASE("PA SIMD backend", "[PartialAssembly]")
+{
+   if (!Device::IsConfigured()) { Device::Configure("simd"); }
+   Device::Enable();
+   const bool simd = Device::Allows(Backend::SIMD);
+   Device::Disable();
+   if (!simd) { return; }
+
+   ConstantCoefficient one(1.0);
+   FunctionCoefficient fcoeff(coeff_func);
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      // The number of elements is not a multiple of the SIMD width.
+      Mesh *mesh = (dim == 2) ?
+                   new Mesh(3, 3, Element::QUADRILATERAL, true) :
+                   new Mesh(3, 3, 1, Element::HEXAHEDRON, true);
+      mesh->Transform(perturb);
+      for (int order = 1; order <= 5; order++)
+      {
+         H1_FECollection fec(order, dim);
+         FiniteElementSpace fes(mesh, &fec);
+         SECTION("dim " + std::to_string(dim) + ", order " +
+                 std::to_string(order))
+         {
+            REQUIRE(SIMDPAError(fes, new DiffusionIntegrator(fcoeff),
+                                new DiffusionIntegrator(fcoeff)) < 1e-12);
+            REQUIRE(SIMDPAError(fes, new MassIntegrator(one),
+                                new MassIntegrator(one)) < 1e-12);
+         }
+      }
+      delete mesh;
+   }
+}
+
+TEST_CASE("PA vector H1 integrators", "[PartialAssembly]")
+{
+   FunctionCoefficient fcoeff(coeff_func);
+   ConstantCoefficient ccoeff(2.5);
+
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      for (int order = 1; order <= 3; order++)
+      {
+         H1_FECollection fec(order, dim);
+         for (int ordering = 0; ordering <= 1; ordering++)
+         {
+            FiniteElementSpace fes(mesh, &fec, dim, ordering);
+            const std::string name = ", dim " + std::to_string(dim) +
+                                     ", order " + std::to_string(order) +
+                                     ", ordering " + std::to_string(ordering);
+
+            SECTION("VectorMassIntegrator" + name)
+            {
+               REQUIRE(PAError(fes, new VectorMassIntegrator(fcoeff),
+                               new VectorMassIntegrator(fcoeff)) < 1e-12);
+               REQUIRE(PAError(fes, new VectorMassIntegrator,
+                               new VectorMassIntegrator) < 1e-12);
+            }
+            SECTION("VectorDiffusionIntegrator" + name)
+            {
+               REQUIRE(PAError(fes, new VectorDiffusionIntegrator(fcoeff),
+                               new VectorDiffusionIntegrator(fcoeff)) < 1e-12);
+               REQUIRE(PAError(fes, new VectorDiffusionIntegrator,
+                               new VectorDiffusionIntegrator) < 1e-12);
+            }
+            SECTION("ElasticityIntegrator" + name)
+            {
+               REQUIRE(PAError(fes, new ElasticityIntegrator(ccoeff, fcoeff),
+                               new ElasticityIntegrator(ccoeff, fcoeff))
+                       < 1e-12);
+               REQUIRE(PAError(fes, new ElasticityIntegrator(fcoeff, 1.5, 0.5),
+                               new ElasticityIntegrator(fcoeff, 1.5, 0.5))
+                       < 1e-12);
+            }
+         }
+      }
+      delete mesh;
+   }
+}
+
+TEST_CASE("Element assembly", "[ElementAssembly]")
+{
+   FunctionCoefficient fcoeff(coeff_func);
+   const AssemblyLevel EA = AssemblyLevel::ELEMENT;
+
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      for (int order = 1; order <= 3; order++)
+      {
+         H1_FECollection h1_fec(order, dim);
+         ND_FECollection nd_fec(order, dim);
+
+         SECTION("H1 integrators, dim " + std::to_string(dim) +
+                 ", order " + std::to_string(order))
+         {
+            FiniteElementSpace fes(mesh, &h1_fec);
+            REQUIRE(PAError(fes, new MassIntegrator(fcoeff),
+                            new MassIntegrator(fcoeff), EA) < 1e-12);
+            REQUIRE(PAError(fes, new DiffusionIntegrator(fcoeff),
+                            new DiffusionIntegrator(fcoeff), EA) < 1e-12);
+         }
+         SECTION("Vector H1 integrators, dim " + std::to_string(dim) +
+                 ", order " + std::to_string(order))
+         {
+            for (int ordering = 0; ordering <= 1; ordering++)
+            {
+               FiniteElementSpace fes(mesh, &h1_fec, dim, ordering);
+               ConstantCoefficient one(1.0);
+               REQUIRE(PAError(fes, new ElasticityIntegrator(one, fcoeff),
+                               new ElasticityIntegrator(one, fcoeff), EA)
+                       < 1e-12);
+            }
+         }
+         SECTION("ND integrators, dim " + std::to_string(dim) +
+                 ", order " + std::to_string(order))
+         {
+            FiniteElementSpace fes(mesh, &nd_fec);
+            REQUIRE(PAError(fes, new CurlCurlIntegrator(fcoeff),
+                            new CurlCurlIntegrator(fcoeff), EA) < 1e-12);
+            REQUIRE(PAError(fes, new VectorFEMassIntegrator(fcoeff),
+                            new VectorFEMassIntegrator(fcoeff), EA) < 1e-12);
+         }
+         SECTION("Non-symmetric, dim " + std::to_string(dim) +
+                 ", order " + std::to_string(order))
+         {
+            FiniteElementSpace fes(mesh, &h1_fec);
+            VectorFunctionCoefficient vel(dim, velocity_func);
+            BilinearForm fa(&fes), ea(&fes);
+            fa.AddDomainIntegrator(new ConvectionIntegrator(vel));
+            fa.Assemble();
+            fa.Finalize();
+            ea.AddDomainIntegrator(new ConvectionIntegrator(vel));
+            EABilinearFormExtension ea_ext(&ea);
+            ea_ext.Assemble();
+
+            Vector x(fes.GetVSize()), y_fa(fes.GetVSize()),
+                   y_ea(fes.GetVSize());
+            x.Randomize(1);
+            fa.Mult(x, y_fa);
+            ea_ext.Mult(x, y_ea);
+            y_ea -= y_fa;
+            REQUIRE(y_ea.Normlinf() / y_fa.Normlinf() < 1e-12);
+
+            fa.MultTranspose(x, y_fa);
+            ea_ext.MultTranspose(x, y_ea);
+            y_ea -= y_fa;
+            REQUIRE(y_ea.Normlinf() / y_fa.Normlinf() < 1e-12);
+         }
+      }
+      delete mesh;
+   }
+}
+
+TEST_CASE("Matrix-free diffusion", "[MatrixFree]")
+{
+   ConstantCoefficient ccoeff(2.5);
+   const AssemblyLevel MF = AssemblyLevel::NONE;
+
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      for (int order = 1; order <= 3; order++)
+      {
+         SECTION("DiffusionIntegrator, dim " + std::to_string(dim) +
+                 ", order " + std::to_string(order))
+         {
+            H1_FECollection fec(order, dim);
+            FiniteElementSpace fes(mesh, &fec);
+            REQUIRE(PAError(fes, new DiffusionIntegrator(ccoeff),
+                            new DiffusionIntegrator(ccoeff), MF) < 1e-12);
+            REQUIRE(PAError(fes, new DiffusionIntegrator,
+                            new DiffusionIntegrator, MF) < 1e-12);
+            // The vertices are used for a mesh without nodes.
+            REQUIRE(mesh->GetNodes() == NULL);
+
+            // The transposed action is the action.
+            BilinearForm fa(&fes), mf(&fes);
+            fa.AddDomainIntegrator(new DiffusionIntegrator(ccoeff));
+            fa.Assemble();
+            fa.Finalize();
+            mf.AddDomainIntegrator(new DiffusionIntegrator(ccoeff));
+            MFBilinearFormExtension mf_ext(&mf);
+            mf_ext.Assemble();
+            Vector x(fes.GetVSize()), y_fa(fes.GetVSize()),
+                   y_mf(fes.GetVSize());
+            x.Randomize(1);
+            fa.MultTranspose(x, y_fa);
+            mf_ext.MultTranspose(x, y_mf);
+            y_mf -= y_fa;
+            REQUIRE(y_mf.Normlinf() / y_fa.Normlinf() < 1e-12);
+         }
+      }
+      // Curved mesh with high-order nodes.
+      mesh->SetCurvature(2);
+      SECTION("DiffusionIntegrator, curved mesh, dim " + std::to_string(dim))
+      {
+         H1_FECollection fec(2, dim);
+         FiniteElementSpace fes(mesh, &fec);
+         REQUIRE(PAError(fes, new DiffusionIntegrator(ccoeff),
+                         new DiffusionIntegrator(ccoeff), MF) < 1e-12);
+      }
+      delete mesh;
+   }
+}
+
+namespace pa_kernels
+{
+
+// Same as PAError for the DG advection operator: the ConvectionIntegrator on
+// the elements and the DGTraceIntegrator on the interior and boundary faces.
+// If transpose is true, the integrators are wrapped in TransposeIntegrator%s.
+static double DGAdvectionError(FiniteElementSpace &fes,
+                               VectorCoefficient &vel, bool transpose)
+{
+   BilinearForm fa(&fes), pa(&fes);
+   pa.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   BilinearForm *forms[2] = { &fa, &pa };
+   for (int i = 0; i < 2; i++)
+   {
+      BilinearFormIntegrator *conv = new ConvectionIntegrator(vel, -1.0);
+      BilinearFormIntegrator *itrace = new DGTraceIntegrator(vel, 1.0, 0.5);
+      BilinearFormIntegrator *btrace = new DGTraceIntegrator(vel, 1.0, 0.5);
+      if (transpose)
+      {
+         conv = new TransposeIntegrator(conv);
+         itrace = new TransposeIntegrator(itrace);
+         btrace = new TransposeIntegrator(btrace);
+      }
+      forms[i]->AddDomainIntegrator(conv);
+      forms[i]->AddInteriorFaceIntegrator(itrace);
+      forms[i]->AddBdrFaceIntegrator(btrace);
+      forms[i]->Assemble();
+   }
+   fa.Finalize();
+
+   Array<int> ess_tdof_list;
+   OperatorHandle A_pa;
+   pa.FormSystemMatrix(ess_tdof_list, A_pa);
+
+   Vector x(fes.GetVSize()), y_fa(fes.GetVSize()), y_pa(fes.GetVSize());
+   x.Randomize(1);
+   fa.Mult(x, y_fa);
+   A_pa->Mult(x, y_pa);
+   y_pa -= y_fa;
+   return y_pa.Normlinf() / y_fa.Normlinf();
+}
+
+}
+
+TEST_CASE("PA advection integrators", "[PartialAssembly]")
+{
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      VectorFunctionCoefficient vel(dim, velocity_func);
+      for (int order = 1; order <= 3; order++)
+      {
+         const std::string name = ", dim " + std::to_string(dim) +
+                                  ", order " + std::to_string(order);
+
+         SECTION("ConvectionIntegrator" + name)
+         {
+            H1_FECollection fec(order, dim);
+            FiniteElementSpace fes(mesh, &fec);
+            REQUIRE(PAError(fes, new ConvectionIntegrator(vel, 2.0),
+                            new ConvectionIntegrator(vel, 2.0)) < 1e-12);
+            REQUIRE(PAError(fes, new TransposeIntegrator(
+                               new ConvectionIntegrator(vel)),
+                            new TransposeIntegrator(
+                               new ConvectionIntegrator(vel))) < 1e-12);
+         }
+         SECTION("DGTraceIntegrator" + name)
+         {
+            DG_FECollection fec(order, dim, BasisType::GaussLobatto);
+            FiniteElementSpace fes(mesh, &fec);
+            REQUIRE(DGAdvectionError(fes, vel, false) < 1e-12);
+            REQUIRE(DGAdvectionError(fes, vel, true) < 1e-12);
+         }
+      }
+      delete mesh;
+   }
+}
+
+namespace pa_kernels
+{
+
+// Return the relative max norm of the difference between the diagonals of the
+// fully assembled form with the integrator fa_integ and the form assembled at
+// the given level with the (same) integrator integ.
+static double PADiagonalError(FiniteElementSpace &fes,
+                              BilinearFormIntegrator *fa_integ,
+                              BilinearFormIntegrator *integ,
+                              AssemblyLevel level = AssemblyLevel::PARTIAL)
+{
+   BilinearForm fa(&fes), pa(&fes);
+   fa.AddDomainIntegrator(fa_integ);
+   fa.Assemble();
+   fa.Finalize();
+   pa.SetAssemblyLevel(level);
+   pa.AddDomainIntegrator(integ);
+   pa.Assemble();
+
+   Vector d_fa, d_pa;
+   fa.AssembleDiagonal(d_fa);
+   pa.AssembleDiagonal(d_pa);
+   d_pa -= d_fa;
+   return d_pa.Normlinf() / d_fa.Normlinf();
+}
+
+}
+
+TEST_CASE("PA diagonal", "[PartialAssembly]")
+{
+   ConstantCoefficient ccoeff(2.5);
+
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      MatrixFunctionCoefficient kcoeff(dim, conductivity_func);
+      for (int order = 1; order <= 4; order++)
+      {
+         H1_FECollection fec(order, dim);
+         FiniteElementSpace fes(mesh, &fec);
+         const std::string name = ", dim " + std::to_string(dim) +
+                                  ", order " + std::to_string(order);
+
+         SECTION("MassIntegrator" + name)
+         {
+            REQUIRE(PADiagonalError(fes, new MassIntegrator(ccoeff),
+                                    new MassIntegrator(ccoeff)) < 1e-12);
+         }
+         SECTION("DiffusionIntegrator" + name)
+         {
+            REQUIRE(PADiagonalError(fes, new DiffusionIntegrator,
+                                    new DiffusionIntegrator) < 1e-12);
+            REQUIRE(PADiagonalError(fes, new DiffusionIntegrator(kcoeff),
+                                    new DiffusionIntegrator(kcoeff)) < 1e-12);
+         }
+      }
+      delete mesh;
+   }
+}
+
+TEST_CASE("Element assembly diagonal", "[ElementAssembly]")
+{
+   FunctionCoefficient fcoeff(coeff_func);
+   ConstantCoefficient one(1.0);
+   const AssemblyLevel EA = AssemblyLevel::ELEMENT;
+
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      for (int order = 1; order <= 2; order++)
+      {
+         H1_FECollection h1_fec(order, dim);
+         ND_FECollection nd_fec(order, dim);
+         const std::string name = ", dim " + std::to_string(dim) +
+                                  ", order " + std::to_string(order);
+
+         SECTION("H1" + name)
+         {
+            FiniteElementSpace fes(mesh, &h1_fec);
+            REQUIRE(PADiagonalError(fes, new DiffusionIntegrator(fcoeff),
+                                    new DiffusionIntegrator(fcoeff), EA)
+                    < 1e-12);
+         }
+         SECTION("Vector H1" + name)
+         {
+            for (int ordering = 0; ordering <= 1; ordering++)
+            {
+               FiniteElementSpace fes(mesh, &h1_fec, dim, ordering);
+               REQUIRE(PADiagonalError(fes,
+                                       new ElasticityIntegrator(one, fcoeff),
+                                       new ElasticityIntegrator(one, fcoeff),
+                                       EA) < 1e-12);
+            }
+         }
+         SECTION("ND" + name)
+         {
+            // The local dofs of the ND elements have sign changes.
+            FiniteElementSpace fes(mesh, &nd_fec);
+            REQUIRE(PADiagonalError(fes, new CurlCurlIntegrator(fcoeff),
+                                    new CurlCurlIntegrator(fcoeff), EA)
+                    < 1e-12);
+         }
+      }
+      delete mesh;
+   }
+}
+
+namespace pa_kernels
+{
+
+// Mesh of quadrilaterals and triangles (2D), or of a hexahedron, a wedge and a
+// tetrahedron (3D), refined once and perturbed.
+static Mesh *MakeMixedMesh(int dim)
+{
+   Mesh *mesh;
+   if (dim == 2)
+   {
+      const double vert[6][2] =
+      { {0,0}, {1,0}, {2,0}, {0,1}, {1,1}, {2,1} };
+      const int quad[4] = { 0, 1, 4, 3 };
+      const int tri[2][3] = { { 1, 2, 5 }, { 1, 5, 4 } };
+      mesh = new Mesh(2, 6, 3);
+      for (int i = 0; i < 6; i++) { mesh->AddVertex(vert[i]); }
+      mesh->AddQuad(quad);
+      mesh->AddTri(tri[0]);
+      mesh->AddTri(tri[1]);
+   }
+   else
+   {
+      const double vert[11][3] =
+      {
+         {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0}, {0,0,1}, {1,0,1}, {1,1,1},
+         {0,1,1}, {0,0.5,2}, {1,0.5,2}, {2,0.5,1.3}
+      };
+      const int hex[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+      const int wedge[6] = { 4, 7, 8, 5, 6, 9 };
+      const int tet[4] = { 5, 6, 9, 10 };
+      mesh = new Mesh(3, 11, 3);
+      for (int i = 0; i < 11; i++) { mesh->AddVertex(vert[i]); }
+      mesh->AddHex(hex);
+      mesh->AddWedge(wedge);
+      mesh->AddTet(tet);
+   }
+   mesh->FinalizeMesh();
+   mesh->UniformRefinement();
+   mesh->Transform(perturb);
+   return mesh;
+}
+
+}
+
+TEST_CASE("PA simplex and mixed meshes", "[PartialAssembly]")
+{
+   FunctionCoefficient fcoeff(coeff_func);
+   ConstantCoefficient ccoeff(2.5);
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      MatrixFunctionCoefficient kcoeff(dim, conductivity_func);
+      for (int m = 0; m < 2; m++)
+      {
+         Mesh *mesh = (m == 1) ? MakeMixedMesh(dim) : (dim == 2) ?
+                      new Mesh(3, 3, Element::TRIANGLE, true) :
+                      new Mesh(2, 2, 2, Element::TETRAHEDRON, true);
+         if (m == 0) { mesh->Transform(perturb); }
+         for (int order = 1; order <= 3; order++)
+         {
+            H1_FECollection fec(order, dim);
+            FiniteElementSpace fes(mesh, &fec);
+            SECTION((m ? "mixed" : "simplex") + std::string(", dim ") +
+                    std::to_string(dim) + ", order " + std::to_string(order))
+            {
+               ElementBatches batches(fes);
+               REQUIRE(!ElementBatches::UsesTensorLayout(fes));
+               REQUIRE(batches.Size() == (m ? dim : 1));
+
+               REQUIRE(PAError(fes, new MassIntegrator(fcoeff),
+                               new MassIntegrator(fcoeff)) < 1e-12);
+               REQUIRE(PAError(fes, new DiffusionIntegrator(ccoeff),
+                               new DiffusionIntegrator(ccoeff)) < 1e-12);
+               REQUIRE(PAError(fes, new DiffusionIntegrator(kcoeff),
+                               new DiffusionIntegrator(kcoeff)) < 1e-12);
+               REQUIRE(PADiagonalError(fes, new MassIntegrator(fcoeff),
+                                       new MassIntegrator(fcoeff)) < 1e-12);
+               REQUIRE(PADiagonalError(fes, new DiffusionIntegrator(kcoeff),
+                                       new DiffusionIntegrator(kcoeff))
+                       < 1e-12);
+            }
+         }
+         delete mesh;
+      }
+   }
+}
+
+TEST_CASE("Element assembly on simplex and mixed meshes", "[ElementAssembly]")
+{
+   FunctionCoefficient fcoeff(coeff_func);
+   ConstantCoefficient one(1.0);
+   const AssemblyLevel EA = AssemblyLevel::ELEMENT;
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      VectorFunctionCoefficient vel(dim, velocity_func);
+      for (int m = 0; m < 2; m++)
+      {
+         Mesh *mesh = (m == 1) ? MakeMixedMesh(dim) : (dim == 2) ?
+                      new Mesh(3, 3, Element::TRIANGLE, true) :
+                      new Mesh(2, 2, 2, Element::TETRAHEDRON, true);
+         if (m == 0) { mesh->Transform(perturb); }
+         for (int order = 1; order <= 3; order++)
+         {
+            H1_FECollection h1_fec(order, dim);
+            ND_FECollection nd_fec(order, dim);
+            SECTION((m ? "mixed" : "simplex") + std::string(", dim ") +
+                    std::to_string(dim) + ", order " + std::to_string(order))
+            {
+               FiniteElementSpace fes(mesh, &h1_fec);
+               REQUIRE(PAError(fes, new MassIntegrator(fcoeff),
+                               new MassIntegrator(fcoeff), EA) < 1e-12);
+               REQUIRE(PAError(fes, new DiffusionIntegrator(fcoeff),
+                               new DiffusionIntegrator(fcoeff), EA) < 1e-12);
+               for (int ordering = 0; ordering <= 1; ordering++)
+               {
+                  FiniteElementSpace vfes(mesh, &h1_fec, dim, ordering);
+                  REQUIRE(PAError(vfes, new ElasticityIntegrator(one, fcoeff),
+                                  new ElasticityIntegrator(one, fcoeff), EA)
+                          < 1e-12);
+               }
+               if (m == 0 && dim == 2)
+               {
+                  FiniteElementSpace nd_fes(mesh, &nd_fec);
+                  REQUIRE(PAError(nd_fes, new CurlCurlIntegrator(fcoeff),
+                                  new CurlCurlIntegrator(fcoeff), EA)
+                          < 1e-12);
+               }
+
+               BilinearForm fa(&fes), ea(&fes);
+               fa.AddDomainIntegrator(new ConvectionIntegrator(vel));
+               fa.Assemble();
+               fa.Finalize();
+               ea.AddDomainIntegrator(new ConvectionIntegrator(vel));
+               EABilinearFormExtension ea_ext(&ea);
+               ea_ext.Assemble();
+
+               Vector x(fes.GetVSize()), y_fa(fes.GetVSize()),
+                      y_ea(fes.GetVSize());
+               x.Randomize(1);
+               fa.MultTranspose(x, y_fa);
+               ea_ext.MultTranspose(x, y_ea);
+               y_ea -= y_fa;
+               REQUIRE(y_ea.Normlinf() / y_fa.Normlinf() < 1e-12);
+            }
+         }
+         delete mesh;
+      }
+   }
+}
+
+TEST_CASE("PA after in-place changes of the mesh nodes", "[PartialAssembly]")
+{
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      H1_FECollection fec(2, dim);
+      FiniteElementSpace fes(mesh, &fec);
+      ConstantCoefficient one(1.0);
+      // The geometric factors cached by this assembly must not be reused.
+      REQUIRE(PAError(fes, new MassIntegrator(one),
+                      new MassIntegrator(one)) < 1e-12);
+      for (int i = 0; i < mesh->GetNV(); i++)
+      {
+         mesh->GetVertex(i)[0] *= 2.0;
+      }
+      REQUIRE(PAError(fes, new MassIntegrator(one),
+                      new MassIntegrator(one)) < 1e-12);
+
+      mesh->SetCurvature(2);
+      REQUIRE(PAError(fes, new DiffusionIntegrator(one),
+                      new DiffusionIntegrator(one)) < 1e-12);
+      *mesh->GetNodes() *= 3.0;
+      REQUIRE(PAError(fes, new MassIntegrator(one),
+                      new MassIntegrator(one)) < 1e-12);
+      REQUIRE(PAError(fes, new DiffusionIntegrator(one),
+                      new DiffusionIntegrator(one)) < 1e-12);
+      delete mesh;
+   }
+}
+
+TEST_CASE("PA operator smoothers", "[PartialAssembly]")
+{
+   Mesh *mesh = MakeMesh(2);
+   mesh->UniformRefinement();
+   H1_FECollection fec(4, 2);
+   FiniteElementSpace fes(mesh, &fec);
+   Array<int> ess_tdof_list, ess_bdr(mesh->bdr_attributes.Max());
+   ess_bdr = 1;
+   fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+
+   BilinearForm a(&fes);
+   a.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   a.AddDomainIntegrator(new DiffusionIntegrator);
+   a.Assemble();
+   Vector diag;
+   a.AssembleDiagonal(diag);
+
+   GridFunction x(&fes);
+   x = 0.0;
+   Vector b(fes.GetVSize());
+   b.Randomize(1);
+   OperatorHandle A;
+   Vector X, B;
+   a.FormLinearSystem(ess_tdof_list, x, b, A, X, B);
+
+   CGSolver cg;
+   cg.SetRelTol(1e-8);
+   cg.SetMaxIter(1000);
+   cg.SetOperator(*A);
+   X = 0.0;
+   cg.Mult(B, X);
+   REQUIRE(cg.GetConverged());
+   const int cg_iter = cg.GetNumIterations();
+
+   SECTION("OperatorJacobiSmoother")
+   {
+      OperatorJacobiSmoother jacobi(diag, ess_tdof_list);
+      cg.SetPreconditioner(jacobi);
+      cg.SetOperator(*A);
+      X = 0.0;
+      cg.Mult(B, X);
+      REQUIRE(cg.GetConverged());
+      REQUIRE(cg.GetNumIterations() < cg_iter);
+   }
+   SECTION("OperatorChebyshevSmoother")
+   {
+      OperatorChebyshevSmoother cheby(A.Ptr(), diag, ess_tdof_list, 3);
+      REQUIRE(cheby.GetMaxEigenvalue() > 0.0);
+      cg.SetPreconditioner(cheby);
+      cg.SetOperator(*A);
+      X = 0.0;
+      cg.Mult(B, X);
+      REQUIRE(cg.GetConverged());
+      REQUIRE(2*cg.GetNumIterations() < cg_iter);
+   }
+   delete mesh;
+}
+
+TEST_CASE("PA fused apply and dot", "[PartialAssembly]")
+{
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      H1_FECollection fec(3, dim);
+      for (int vdim = 1; vdim <= dim; vdim += dim - 1)
+      {
+         for (int ordering = Ordering::byNODES; ordering <= Ordering::byVDIM;
+              ordering++)
+         {
+            FiniteElementSpace fes(mesh, &fec, vdim, ordering);
+            Array<int> ess_tdof_list, ess_bdr(mesh->bdr_attributes.Max());
+            ess_bdr = 1;
+            fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+
+            BilinearForm a(&fes);
+            a.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+            if (vdim == 1) { a.AddDomainIntegrator(new DiffusionIntegrator); }
+            else { a.AddDomainIntegrator(new VectorDiffusionIntegrator); }
+            a.Assemble();
+            OperatorHandle A;
+            a.FormSystemMatrix(ess_tdof_list, A);
+
+            Vector x(A->Width()), y(A->Height()), y_fused(A->Height());
+            x.Randomize(1);
+            A->Mult(x, y);
+            const double dot = A->MultAndDot(x, y_fused);
+            y_fused -= y;
+            REQUIRE(y_fused.Normlinf() < 1e-12 * y.Normlinf());
+            REQUIRE(fabs(dot - x * y) < 1e-12 * fabs(x * y));
+         }
+      }
+      delete mesh;
+   }
+}
+
+TEST_CASE("Pipelined CG", "[PartialAssembly]")
+{
+   Mesh *mesh = MakeMesh(2);
+   mesh->UniformRefinement();
+   H1_FECollection fec(3, 2);
+   FiniteElementSpace fes(mesh, &fec);
+   Array<int> ess_tdof_list, ess_bdr(mesh->bdr_attributes.Max());
+   ess_bdr = 1;
+   fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+
+   BilinearForm a(&fes);
+   a.SetAssemblyLevel(AssemblyLevel::PARTIAL);
+   a.AddDomainIntegrator(new DiffusionIntegrator);
+   a.Assemble();
+   Vector diag;
+   a.AssembleDiagonal(diag);
+   OperatorHandle A;
+   a.FormSystemMatrix(ess_tdof_list, A);
+   OperatorJacobiSmoother jacobi(diag, ess_tdof_list);
+
+   Vector B(A->Height()), X(A->Height()), X_pipe(A->Height());
+   B.Randomize(1);
+   for (int precond = 0; precond <= 1; precond++)
+   {
+      CGSolver cg;
+      PipelinedCGSolver pcg;
+      IterativeSolver *solvers[2] = { &cg, &pcg };
+      Vector *sols[2] = { &X, &X_pipe };
+      for (int k = 0; k < 2; k++)
+      {
+         solvers[k]->SetRelTol(1e-10);
+         solvers[k]->SetMaxIter(1000);
+         if (precond) { solvers[k]->SetPreconditioner(jacobi); }
+         solvers[k]->SetOperator(*A);
+         *sols[k] = 0.0;
+         solvers[k]->Mult(B, *sols[k]);
+         REQUIRE(solvers[k]->GetConverged());
+      }
+      REQUIRE(abs(pcg.GetNumIterations() - cg.GetNumIterations()) <= 2);
+      X_pipe -= X;
+      REQUIRE(X_pipe.Normlinf() < 1e-6 * X.Normlinf());
+   }
+   delete mesh;
+}
+
+namespace pa_kernels
+{
+
+static double device_coeff_func(const Vector3 &x)
+{
+   return 1.0 + x(0)*x(0) + 2.0*x(1);
+}
+
+// Return the relative max norm of the difference between the linear forms with
+// the integrator integ assembled element by element and all at once.
+static double FastAssemblyError(FiniteElementSpace &fes,
+                                LinearFormIntegrator *integ)
+{
+   LinearForm lf(&fes), fast(&fes);
+   lf.AddDomainIntegrator(integ);
+   lf.Assemble();
+   fast.AddDomainIntegrator(integ);
+   fast.UseFastAssembly(true);
+   fast.Assemble();
+   fast.GetDLFI()->SetSize(0);
+   fast -= lf;
+   return fast.Normlinf() / lf.Normlinf();
+}
+
+}
+
+TEST_CASE("Fast linear form assembly", "[PartialAssembly]")
+{
+   ConstantCoefficient ccoeff(2.5);
+   FunctionCoefficient fcoeff(coeff_func);
+   FunctionCoefficient dcoeff(device_coeff_func);
+   for (int dim = 2; dim <= 3; dim++)
+   {
+      Mesh *mesh = MakeMesh(dim);
+      for (int order = 1; order <= 4; order++)
+      {
+         H1_FECollection fec(order, dim);
+         FiniteElementSpace fes(mesh, &fec);
+         GridFunction x(&fes);
+         x.ProjectCoefficient(fcoeff);
+         GridFunctionCoefficient gcoeff(&x);
+         SECTION("dim " + std::to_string(dim) + ", order " +
+                 std::to_string(order))
+         {
+            DomainLFIntegrator integ(ccoeff);
+            REQUIRE(integ.SupportsPA(fes));
+            REQUIRE(FastAssemblyError(fes, new DomainLFIntegrator(ccoeff))
+                    < 1e-12);
+            REQUIRE(FastAssemblyError(fes, new DomainLFIntegrator(fcoeff))
+                    < 1e-12);
+            REQUIRE(FastAssemblyError(fes, new DomainLFIntegrator(dcoeff))
+                    < 1e-12);
+            REQUIRE(FastAssemblyError(fes, new DomainLFIntegrator(gcoeff))
+                    < 1e-12);
+            REQUIRE(FastAssemblyError(fes,
+                                      new DomainLFIntegrator(fcoeff, 2, 3))
+                    < 1e-12);
+         }
+      }
+      delete mesh;
+   }
+
+   SECTION("Fallback and mesh updates")
+   {
+      Mesh mesh(2, 2, 2, Element::TETRAHEDRON);
+      H1_FECollection fec(2, 3);
+      FiniteElementSpace fes(&mesh, &fec);
+      REQUIRE(!DomainLFIntegrator(ccoeff).SupportsPA(fes));
+      REQUIRE(FastAssemblyError(fes, new DomainLFIntegrator(fcoeff)) < 1e-12);
+
+      Mesh *hex = MakeMesh(3);
+      FiniteElementSpace hex_fes(hex, &fec);
+      LinearForm lf(&hex_fes), fast(&hex_fes);
+      lf.AddDomainIntegrator(new DomainLFIntegrator(fcoeff));
+      fast.AddDomainIntegrator(new DomainLFIntegrator(fcoeff));
+      fast.AddBoundaryIntegrator(new BoundaryLFIntegrator(ccoeff));
+      lf.AddBoundaryIntegrator(new BoundaryLFIntegrator(ccoeff));
+      fast.UseFastAssembly(true);
+      for (int ref = 0; ref < 2; ref++)
+      {
+         if (ref) { hex->UniformRefinement(); hex_fes.Update(); }
+         lf.Update();
+         fast.Update();
+         lf.Assemble();
+         fast.Assemble();
+         fast -= lf;
+         REQUIRE(fast.Normlinf() < 1e-12 * lf.Normlinf());
+      }
+      delete hex;
+   }
+}
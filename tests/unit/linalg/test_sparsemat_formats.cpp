@@ -0,0 +1,164 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#include "mfem.hpp"
+using namespace mfem;
+
+#include "catch.hpp"
+
+namespace sparsemat_formats
+{
+
+// Random matrix with rows of 1 to 20 entries.
+static SparseMatrix *RandomMatrix(int height, int width)
+{
+   SparseMatrix *M = new SparseMatrix(height, width);
+   for (int i = 0; i < height; i++)
+   {
+      const int nnz = rand() % 20 + 1;
+      for (int k = 0; k < nnz; k++)
+      {
+         M->Set(i, rand() % width, double(rand())/RAND_MAX - 0.5);
+      }
+   }
+   M->Finalize();
+   return M;
+}
+
+// Return the max norm of the differences between the products of op and the
+// products of mat, relative to the max norm of the latter.
+template <typename matrix_t>
+static double ProductError(const SparseMatrix &mat, const matrix_t &op)
+{
+   REQUIRE(op.Height() == mat.Height());
+   REQUIRE(op.Width() == mat.Width());
+   Vector x(mat.Width()), y(mat.Height()), y_op(mat.Height());
+   x.Randomize(1);
+   double err = 0.0;
+
+   mat.Mult(x, y);
+   op.Mult(x, y_op);
+   y_op -= y;
+   err = std::max(err, y_op.Normlinf() / y.Normlinf());
+
+   y_op = 1.0;
+   op.AddMult(x, y_op, -2.0);
+   y_op -= 1.0;
+   y_op.Add(2.0, y);
+   err = std::max(err, y_op.Normlinf() / y.Normlinf());
+
+   Vector xt(mat.Height()), yt(mat.Width()), yt_op(mat.Width());
+   xt.Randomize(2);
+   mat.MultTranspose(xt, yt);
+   op.MultTranspose(xt, yt_op);
+   yt_op -= yt;
+   err = std::max(err, yt_op.Normlinf() / yt.Normlinf());
+
+   yt_op = 0.0;
+   op.AddMultTranspose(xt, yt_op, 0.5);
+   yt_op.Add(-0.5, yt);
+   return std::max(err, yt_op.Normlinf() / yt.Normlinf());
+}
+
+}
+
+using namespace sparsemat_formats;
+
+TEST_CASE("BSR and SELL matrices", "[SparseMatrix]")
+{
+   SECTION("Random matrices")
+   {
+      srand(1234);
+      const int sizes[3][2] = { { 240, 240 }, { 120, 360 }, { 37, 53 } };
+      for (int m = 0; m < 3; m++)
+      {
+         SparseMatrix *A = RandomMatrix(sizes[m][0], sizes[m][1]);
+         for (int bs = 1; bs <= 5; bs += 2)
+         {
+            if (A->Height() % bs || A->Width() % bs) { continue; }
+            BSRMatrix bsr(*A, bs);
+            REQUIRE(bsr.BlockSize() == bs);
+            REQUIRE(bsr.NumStoredEntries() >= A->NumNonZeroElems());
+            REQUIRE(ProductError(*A, bsr) < 1e-14);
+         }
+         const int sigmas[3] = { 1, 8, 1000 };
+         for (int s = 0; s < 3; s++)
+         {
+            SELLMatrix sell(*A, sigmas[s]);
+            REQUIRE(sell.NumStoredEntries() >= A->NumNonZeroElems());
+            REQUIRE(sell.NumStoredEntries() % SELLMatrix::ChunkSize == 0);
+            REQUIRE(ProductError(*A, sell) < 1e-14);
+         }
+         delete A;
+      }
+   }
+
+   SECTION("Elasticity matrix ordered byVDIM")
+   {
+      Mesh mesh(4, 3, 2, Element::HEXAHEDRON);
+      H1_FECollection fec(2, 3);
+      FiniteElementSpace fes(&mesh, &fec, 3, Ordering::byVDIM);
+      ConstantCoefficient lambda(1.0), mu(1.0);
+      BilinearForm a(&fes);
+      a.AddDomainIntegrator(new ElasticityIntegrator(lambda, mu));
+      a.AddDomainIntegrator(new VectorMassIntegrator);
+      a.Assemble(0);
+      a.Finalize(0);
+      const SparseMatrix &A = a.SpMat();
+
+      BSRMatrix bsr(A, 3);
+      REQUIRE(bsr.NumStoredEntries() == 9*bsr.NumBlocks());
+      REQUIRE(bsr.NumStoredEntries() == A.GetI()[A.Height()]);
+      REQUIRE(ProductError(A, bsr) < 1e-14);
+      SELLMatrix sell(A);
+      REQUIRE(ProductError(A, sell) < 1e-14);
+
+      // The converted matrices can be used as operators of the solvers
+      Vector b(A.Height()), x(A.Height()), x_bsr(A.Height());
+      b.Randomize(3);
+      x = 0.0;
+      CG(A, b, x, 0, 2000, 1e-24, 0.0);
+      const Operator *ops[2] = { &bsr, &sell };
+      for (int k = 0; k < 2; k++)
+      {
+         CGSolver cg;
+         cg.SetRelTol(1e-12);
+         cg.SetMaxIter(2000);
+         cg.SetOperator(*ops[k]);
+         x_bsr = 0.0;
+         cg.Mult(b, x_bsr);
+         REQUIRE(cg.GetConverged());
+         x_bsr -= x;
+         REQUIRE(x_bsr.Normlinf() < 1e-8 * x.Normlinf());
+      }
+
+      // ... and of the blocks of a BlockOperator
+      Array<int> offsets(3);
+      offsets[0] = 0;
+      offsets[1] = A.Height();
+      offsets[2] = 2*A.Height();
+      BlockOperator block(offsets);
+      block.SetBlock(0, 0, &bsr);
+      block.SetBlock(1, 1, &sell);
+      block.SetBlock(0, 1, &sell, 2.0);
+      BlockVector bx(offsets), by(offsets);
+      bx.Randomize(4);
+      block.Mult(bx, by);
+      Vector y0(A.Height()), y1(A.Height());
+      A.Mult(bx.GetBlock(0), y0);
+      A.AddMult(bx.GetBlock(1), y0, 2.0);
+      A.Mult(bx.GetBlock(1), y1);
+      y0 -= by.GetBlock(0);
+      y1 -= by.GetBlock(1);
+      REQUIRE(y0.Normlinf() < 1e-12);
+      REQUIRE(y1.Normlinf() < 1e-12);
+   }
+}
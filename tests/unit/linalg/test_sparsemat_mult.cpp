@@ -0,0 +1,125 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#include "mfem.hpp"
+using namespace mfem;
+
+#include "catch.hpp"
+
+namespace sparsemat_mult
+{
+
+// Random matrix with rows of 0 to 5 entries.
+static SparseMatrix *RandomSparse(int height, int width)
+{
+   SparseMatrix *M = new SparseMatrix(height, width);
+   for (int i = 0; i < height; i++)
+   {
+      const int nnz = rand() % 6;
+      for (int k = 0; k < nnz; k++)
+      {
+         M->Set(i, rand() % width, double(rand())/RAND_MAX - 0.5);
+      }
+   }
+   M->Finalize();
+   return M;
+}
+
+// Return the max norm of the difference between the sparse matrix C and the
+// dense matrix D.
+static double DenseError(const SparseMatrix &C, const DenseMatrix &D)
+{
+   DenseMatrix Cd;
+   C.ToDenseMatrix(Cd);
+   REQUIRE(Cd.Height() == D.Height());
+   REQUIRE(Cd.Width() == D.Width());
+   Cd -= D;
+   return Cd.MaxMaxNorm();
+}
+
+}
+
+using namespace sparsemat_mult;
+
+TEST_CASE("Sparse matrix products", "[SparseMatrix]")
+{
+   srand(4321);
+   SparseMatrix *A = RandomSparse(60, 50);
+   SparseMatrix *B = RandomSparse(50, 40);
+   DenseMatrix Ad, Bd, ABd(60, 40);
+   A->ToDenseMatrix(Ad);
+   B->ToDenseMatrix(Bd);
+   Mult(Ad, Bd, ABd);
+
+   SparseMatrix *AB = Mult(*A, *B);
+   REQUIRE(DenseError(*AB, ABd) < 1e-14);
+
+   SECTION("Values are recomputed in the given matrix")
+   {
+      *A *= 2.0;
+      ABd *= 2.0;
+      double *data = AB->GetData();
+      REQUIRE(Mult(*A, *B, AB) == AB);
+      REQUIRE(AB->GetData() == data);
+      REQUIRE(DenseError(*AB, ABd) < 1e-14);
+
+      // The order of the columns in the rows does not matter
+      AB->SortColumnIndices();
+      *AB = 1.0;
+      Mult(*A, *B, AB);
+      REQUIRE(DenseError(*AB, ABd) < 1e-14);
+
+      // Entries that are not in A.B are set to zero
+      SparseMatrix eye(60, 40);
+      for (int i = 0; i < 40; i++) { eye.Set(i, i, 1.0); }
+      eye.Finalize();
+      SparseMatrix *C = Add(*AB, eye);
+      Mult(*A, *B, C);
+      REQUIRE(DenseError(*C, ABd) < 1e-14);
+      delete C;
+   }
+
+   SECTION("RAP and Mult_AtDA")
+   {
+      SparseMatrix *S = RandomSparse(50, 50);
+      SparseMatrix *R = RandomSparse(30, 50);
+      DenseMatrix Sd, Rd, RSd(30, 50), RSRtd(30, 30);
+      S->ToDenseMatrix(Sd);
+      R->ToDenseMatrix(Rd);
+      Mult(Rd, Sd, RSd);
+      MultABt(RSd, Rd, RSRtd);
+      SparseMatrix *RSRt = RAP(*S, *R);
+      REQUIRE(DenseError(*RSRt, RSRtd) < 1e-14);
+      *S *= -3.0;
+      RSRtd *= -3.0;
+      RAP(*S, *R, RSRt);
+      REQUIRE(DenseError(*RSRt, RSRtd) < 1e-14);
+
+      Vector D(60);
+      D.Randomize(1);
+      DenseMatrix DAd(Ad), AtDAd(50, 50);
+      DAd.LeftScaling(D);
+      MultAtB(Ad, DAd, AtDAd);
+      SparseMatrix *AtDA = Mult_AtDA(*A, D);
+      REQUIRE(DenseError(*AtDA, AtDAd) < 1e-14);
+      D *= 0.5;
+      AtDAd *= 0.5;
+      Mult_AtDA(*A, D, AtDA);
+      REQUIRE(DenseError(*AtDA, AtDAd) < 1e-14);
+      delete AtDA;
+      delete RSRt;
+      delete R;
+      delete S;
+   }
+   delete AB;
+   delete B;
+   delete A;
+}
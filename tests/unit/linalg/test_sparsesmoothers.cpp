@@ -0,0 +1,319 @@
+// Copyright (c) 2010, Lawrence Livermore National Security, LLC. Produced at
+// the Lawrence Livermore National Laboratory. LLNL-CODE-443211. All Rights
+// reserved. See file COPYRIGHT for details.
+//
+// This file is part of the MFEM library. For more information and source code
+// availability see http://mfem.org.
+//
+// MFEM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU Lesser General Public License (as published by the Free
+// Software Foundation) version 2.1 dated February 1999.
+
+#include "mfem.hpp"
+using namespace mfem;
+
+#include "catch.hpp"
+
+namespace sparsesmoothers
+{
+
+// GSSmoother giving access to its coloring.
+class ColoredGSSmoother : public GSSmoother
+{
+public:
+   ColoredGSSmoother(const SparseMatrix &a, int t)
+      : GSSmoother(a, t) { SetMulticolor(); }
+   const Table &Colors() { GetNColors(); return color_row; }
+};
+
+// Diffusion matrix with a mass shift, without boundary conditions.
+static SparseMatrix *DiffusionMatrix(Mesh &mesh, int order)
+{
+   H1_FECollection fec(order, mesh.Dimension());
+   FiniteElementSpace fes(&mesh, &fec);
+   ConstantCoefficient one(1.0), shift(10.0);
+   BilinearForm a(&fes);
+   a.AddDomainIntegrator(new DiffusionIntegrator(one));
+   a.AddDomainIntegrator(new MassIntegrator(shift));
+   a.Assemble();
+   a.Finalize();
+   return a.LoseMat();
+}
+
+}
+
+using namespace sparsesmoothers;
+
+TEST_CASE("Multicolor Gauss-Seidel", "[GSSmoother]")
+{
+   Mesh mesh(8, 8, Element::QUADRILATERAL);
+   mesh.Transform([](const Vector &x, Vector &y)
+   { y = x; y(0) += 0.1*x(1)*x(1); });
+   SparseMatrix *A = DiffusionMatrix(mesh, 2);
+   const int n = A->Height();
+
+   SECTION("Rows of the same color are not coupled")
+   {
+      ColoredGSSmoother gs(*A, 1);
+      const Table &colors = gs.Colors();
+      REQUIRE(colors.Size() > 1);
+      REQUIRE(colors.Size() <= 25);
+      REQUIRE(colors.Size_of_connections() == n);
+      Array<int> color(n);
+      color = -1;
+      for (int c = 0; c < colors.Size(); c++)
+      {
+         for (int k = 0; k < colors.RowSize(c); k++)
+         {
+            color[colors.GetRow(c)[k]] = c;
+         }
+      }
+      REQUIRE(color.Min() == 0);
+      for (int i = 0; i < n; i++)
+      {
+         for (int k = A->GetI()[i]; k < A->GetI()[i+1]; k++)
+         {
+            const int j = A->GetJ()[k];
+            REQUIRE((j == i || color[j] != color[i]));
+         }
+      }
+
+      // One sweep equals the sequential sweep with the rows in color order
+      Array<int> perm;
+      for (int c = 0; c < colors.Size(); c++)
+      {
+         perm.Append(colors.GetRow(c), colors.RowSize(c));
+      }
+      Vector b(n), y(n), y_ref(n);
+      b.Randomize(1);
+      y = 0.0;
+      gs.Mult(b, y);
+      y_ref = 0.0;
+      for (int r = 0; r < n; r++)
+      {
+         const int i = perm[r];
+         double sum = b(i), d = 0.0;
+         for (int k = A->GetI()[i]; k < A->GetI()[i+1]; k++)
+         {
+            const int j = A->GetJ()[k];
+            if (j == i) { d = A->GetData()[k]; }
+            else { sum -= A->GetData()[k] * y_ref(j); }
+         }
+         y_ref(i) = sum / d;
+      }
+      y -= y_ref;
+      REQUIRE(y.Normlinf() < 1e-12 * y_ref.Normlinf());
+   }
+
+   SECTION("Convergence is comparable to the sequential sweeps")
+   {
+      Vector b(n), x(n);
+      b.Randomize(2);
+      int its[3];
+      for (int k = 0; k < 3; k++)
+      {
+         GSSmoother gs(*A, 0);
+         if (k > 0) { gs.SetMulticolor(); }
+         if (k == 2) { gs.SetRelaxation(1.5); }
+         SLISolver sli;
+         sli.SetRelTol(1e-8);
+         sli.SetMaxIter(5000);
+         sli.SetOperator(*A);
+         sli.SetPreconditioner(gs);
+         x = 0.0;
+         sli.Mult(b, x);
+         REQUIRE(sli.GetConverged());
+         its[k] = sli.GetNumIterations();
+      }
+      REQUIRE(its[1] <= 1.5*its[0]);
+      REQUIRE(its[2] != its[1]);
+      REQUIRE(its[2] <= 1.5*its[0]);
+
+      // The symmetric multicolor SSOR is a valid preconditioner for PCG
+      GSSmoother ssor(*A, 0);
+      ssor.SetMulticolor();
+      ssor.SetRelaxation(1.2);
+      CGSolver cg;
+      cg.SetRelTol(1e-10);
+      cg.SetMaxIter(500);
+      cg.SetOperator(*A);
+      cg.SetPreconditioner(ssor);
+      x = 0.0;
+      cg.Mult(b, x);
+      REQUIRE(cg.GetConverged());
+   }
+
+   SECTION("The coloring is updated with the operator")
+   {
+      mesh.UniformRefinement();
+      SparseMatrix *A_fine = DiffusionMatrix(mesh, 2);
+      ColoredGSSmoother gs(*A, 2);
+      REQUIRE(gs.Colors().Size_of_connections() == n);
+      gs.SetOperator(*A_fine);
+      REQUIRE(gs.GetNColors() > 1);
+      REQUIRE(gs.Colors().Size_of_connections() == A_fine->Height());
+      delete A_fine;
+   }
+   delete A;
+}
+
+namespace sparsesmoothers
+{
+
+// Random nonsymmetric matrix with a dominant diagonal.
+static SparseMatrix *RandomDominant(int n)
+{
+   SparseMatrix *M = new SparseMatrix(n, n);
+   for (int i = 0; i < n; i++)
+   {
+      M->Add(i, i, 8.0);
+      for (int k = 0; k < 3; k++)
+      {
+         M->Add(i, rand() % n, double(rand())/RAND_MAX - 0.5);
+      }
+   }
+   M->Finalize();
+   return M;
+}
+
+// Return the relative error of the solution of A y = b with the solver.
+static double SolveError(const SparseMatrix &A, Solver &solver)
+{
+   Vector x(A.Width()), b(A.Height()), y(A.Width());
+   x.Randomize(3);
+   A.Mult(x, b);
+   solver.Mult(b, y);
+   y -= x;
+   return y.Normlinf() / x.Normlinf();
+}
+
+}
+
+TEST_CASE("Incomplete factorizations", "[GSSmoother]")
+{
+   SECTION("Exact factorizations")
+   {
+      srand(7);
+      SparseMatrix *A = RandomDominant(80);
+      SparseMatrix tridiag(50);
+      for (int i = 0; i < 50; i++)
+      {
+         tridiag.Add(i, i, 2.5);
+         if (i > 0) { tridiag.Add(i, i-1, -1.0); tridiag.Add(i-1, i, -1.0); }
+      }
+      tridiag.Finalize();
+      for (int rcm = 0; rcm <= 1; rcm++)
+      {
+         // Without dropping, the factors are the full LU factors
+         ILUSmoother ilu_full(80), ilu0(0);
+         ILUTSmoother ilut(0.0, 80);
+         ICSmoother ic0;
+         IncompleteFactorization *full[2] = { &ilu_full, &ilut };
+         for (int k = 0; k < 2; k++)
+         {
+            full[k]->SetReordering(rcm);
+            full[k]->SetOperator(*A);
+            REQUIRE(SolveError(*A, *full[k]) < 1e-12);
+         }
+         // No fill-in for a tridiagonal matrix
+         IncompleteFactorization *banded[2] = { &ilu0, &ic0 };
+         for (int k = 0; k < 2; k++)
+         {
+            banded[k]->SetOperator(tridiag);
+            banded[k]->SetReordering(rcm);
+            REQUIRE(banded[k]->NumNonZeroElems() == 148);
+            REQUIRE(SolveError(tridiag, *banded[k]) < 1e-12);
+         }
+      }
+      delete A;
+   }
+
+   SECTION("Preconditioning of CG and GMRES")
+   {
+      Mesh mesh(12, 12, Element::QUADRILATERAL);
+      H1_FECollection fec(2, 2);
+      FiniteElementSpace fes(&mesh, &fec);
+      Array<int> ess_tdof_list, ess_bdr(mesh.bdr_attributes.Max());
+      ess_bdr = 1;
+      fes.GetEssentialTrueDofs(ess_bdr, ess_tdof_list);
+      ConstantCoefficient one(1.0);
+      VectorFunctionCoefficient velocity(2, [](const Vector &x, Vector &v)
+      { v(0) = 4.0; v(1) = 2.0*x(0); });
+      BilinearForm a(&fes), c(&fes);
+      a.AddDomainIntegrator(new DiffusionIntegrator(one));
+      a.Assemble();
+      c.AddDomainIntegrator(new DiffusionIntegrator(one));
+      c.AddDomainIntegrator(new ConvectionIntegrator(velocity));
+      c.Assemble();
+      SparseMatrix A, C;
+      Vector b(fes.GetVSize()), x(fes.GetVSize()), X, B;
+      b.Randomize(5);
+      x = 0.0;
+      a.FormLinearSystem(ess_tdof_list, x, b, A, X, B);
+      c.FormLinearSystem(ess_tdof_list, x, b, C, X, B);
+
+      CGSolver cg;
+      cg.SetRelTol(1e-10);
+      cg.SetMaxIter(1000);
+      cg.SetOperator(A);
+      X = 0.0;
+      cg.Mult(B, X);
+      const int cg_its = cg.GetNumIterations();
+
+      ICSmoother ic(A);
+      ILUSmoother ilu0(A);
+      ICSmoother ic_rcm;
+      ic_rcm.SetReordering();
+      ic_rcm.SetOperator(A);
+      REQUIRE(ic.GetNLevels() < A.Height() / 2);
+      Solver *cg_precs[3] = { &ic, &ilu0, &ic_rcm };
+      for (int k = 0; k < 3; k++)
+      {
+         cg.SetPreconditioner(*cg_precs[k]);
+         X = 0.0;
+         cg.Mult(B, X);
+         REQUIRE(cg.GetConverged());
+         REQUIRE(cg.GetNumIterations() < 0.6*cg_its);
+      }
+      // The RCM ordering improves the factors
+      REQUIRE(cg.GetNumIterations() < cg_its / 3);
+
+      GMRESSolver gmres;
+      gmres.SetRelTol(1e-10);
+      gmres.SetMaxIter(1000);
+      gmres.SetKDim(50);
+      gmres.SetOperator(C);
+      X = 0.0;
+      gmres.Mult(B, X);
+      const int gmres_its = gmres.GetNumIterations();
+
+      ILUSmoother ilu1(C, 1);
+      ILUTSmoother ilut(C, 1e-4, 20);
+      REQUIRE(ilu1.NumNonZeroElems() > C.NumNonZeroElems());
+      Solver *gmres_precs[2] = { &ilu1, &ilut };
+      for (int k = 0; k < 2; k++)
+      {
+         gmres.SetPreconditioner(*gmres_precs[k]);
+         X = 0.0;
+         gmres.Mult(B, X);
+         REQUIRE(gmres.GetConverged());
+         REQUIRE(gmres.GetNumIterations() < gmres_its / 4);
+      }
+
+      // Stationary iteration, using the iterative mode
+      SLISolver sli;
+      sli.SetRelTol(1e-8);
+      sli.SetMaxIter(500);
+      sli.SetOperator(C);
+      sli.SetPreconditioner(ilut);
+      X = 0.0;
+      sli.Mult(B, X);
+      REQUIRE(sli.GetConverged());
+      ilut.iterative_mode = true;
+      Vector Y(X.Size());
+      Y = 0.0;
+      for (int it = 0; it < sli.GetNumIterations(); it++) { ilut.Mult(B, Y); }
+      Y -= X;
+      REQUIRE(Y.Normlinf() < 1e-10 * X.Normlinf());
+   }
+}
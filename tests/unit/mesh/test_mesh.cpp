@@ -95,3 +95,264 @@ TEST_CASE("Gecko integration in MFEM", "[Mesh]")
 }
 
 #endif
+
+static void check_find_points(Mesh &mesh, int npts)
+{
+   const int dim = mesh.SpaceDimension();
+   DenseMatrix point_mat(dim, npts);
+   for (int k = 0; k < npts; k++)
+   {
+      for (int d = 0; d < dim; d++)
+      {
+         point_mat(d, k) = (k*(d + 3) % 97 + 0.5)/97.0;
+      }
+   }
+
+   Array<int> elem_ids;
+   Array<IntegrationPoint> ips;
+   REQUIRE(mesh.FindPoints(point_mat, elem_ids, ips) == npts);
+
+   Vector pt, x(dim);
+   for (int k = 0; k < npts; k++)
+   {
+      REQUIRE(elem_ids[k] >= 0);
+      point_mat.GetColumnReference(k, pt);
+      mesh.GetElementTransformation(elem_ids[k])->Transform(ips[k], x);
+      x -= pt;
+      REQUIRE(x.Normlinf() < 1e-8);
+   }
+}
+
+TEST_CASE("FindPoints with the element bin grid", "[Mesh]")
+{
+   SECTION("Hex mesh")
+   {
+      Mesh mesh(4, 5, 3, Element::HEXAHEDRON);
+      check_find_points(mesh, 50);
+      REQUIRE(mesh.GetElementBinGrid().GetNBins() > 1);
+   }
+
+   SECTION("Tet mesh")
+   {
+      Mesh mesh(3, 3, 3, Element::TETRAHEDRON);
+      check_find_points(mesh, 50);
+   }
+
+   SECTION("Curved quad mesh")
+   {
+      // The boundary of the unit square is fixed, the interior edges are
+      // curved beyond the extents of their nodes.
+      Mesh mesh(6, 6, Element::QUADRILATERAL);
+      mesh.SetCurvature(3);
+      mesh.Transform([](const Vector &x, Vector &p)
+      {
+         p = x;
+         p(0) += 0.1*sin(M_PI*x(0))*sin(2.0*M_PI*x(1));
+         p(1) += 0.1*sin(2.0*M_PI*x(0))*sin(M_PI*x(1));
+      });
+      check_find_points(mesh, 50);
+
+      // A point in the bulge of a curved edge, beyond the extents of the
+      // nodes, is found thanks to the enlarged element boxes.
+      Mesh bulge(1, 1, Element::QUADRILATERAL);
+      bulge.SetCurvature(3);
+      bulge.Transform([](const Vector &x, Vector &p)
+      { p = x; p(1) *= 1.0 + 0.3*sin(M_PI*x(0)); });
+      DenseMatrix point_mat(2, 1);
+      point_mat(0, 0) = 0.5;
+      point_mat(1, 0) = 1.26;
+      const GridFunction &nodes = *bulge.GetNodes();
+      for (int i = 0; i < nodes.FESpace()->GetNDofs(); i++)
+      {
+         REQUIRE(nodes(nodes.FESpace()->DofToVDof(i, 1)) < point_mat(1, 0));
+      }
+      Array<int> elem_ids;
+      Array<IntegrationPoint> ips;
+      REQUIRE(bulge.FindPoints(point_mat, elem_ids, ips) == 1);
+   }
+
+   SECTION("Grid is rebuilt after the mesh changes")
+   {
+      Mesh mesh(2, 2, Element::TRIANGLE);
+      check_find_points(mesh, 20);
+      mesh.UniformRefinement();
+      check_find_points(mesh, 20);
+
+      Vector vert_coord;
+      mesh.GetVertices(vert_coord);
+      vert_coord *= 2.0;
+      mesh.SetVertices(vert_coord);
+      check_find_points(mesh, 20);
+      vert_coord *= 0.5;
+      mesh.SetVertices(vert_coord);
+      check_find_points(mesh, 20);
+   }
+
+   SECTION("Grid is rebuilt by NodesUpdated() after in-place changes")
+   {
+      DenseMatrix point_mat(2, 1);
+      point_mat(0, 0) = 2.5;
+      point_mat(1, 0) = 0.5;
+      Array<int> elem_ids;
+      Array<IntegrationPoint> ips;
+
+      Mesh mesh(3, 3, Element::QUADRILATERAL);
+      check_find_points(mesh, 20);
+      for (int i = 0; i < mesh.GetNV(); i++)
+      {
+         for (int d = 0; d < 2; d++) { mesh.GetVertex(i)[d] *= 3.0; }
+      }
+      mesh.NodesUpdated();
+      REQUIRE(mesh.FindPoints(point_mat, elem_ids, ips, false) == 1);
+
+      Mesh curved(3, 3, Element::QUADRILATERAL);
+      curved.SetCurvature(2);
+      check_find_points(curved, 20);
+      *curved.GetNodes() *= 3.0;
+      curved.NodesUpdated();
+      REQUIRE(curved.FindPoints(point_mat, elem_ids, ips, false) == 1);
+      *curved.GetNodes() *= 1.0/3.0;
+      curved.NodesUpdated();
+      check_find_points(curved, 20);
+   }
+}
+
+static void check_geometric_factors(Mesh &mesh, const IntegrationRule &ir,
+                                    const GeometricFactors &geom)
+{
+   const int dim = mesh.Dimension(), sdim = mesh.SpaceDimension();
+   const int nq = ir.GetNPoints();
+   REQUIRE(geom.X.Size() == sdim*nq*mesh.GetNE());
+   REQUIRE(geom.J.Size() == sdim*dim*nq*mesh.GetNE());
+   REQUIRE(geom.invJ.Size() == dim*sdim*nq*mesh.GetNE());
+   REQUIRE(geom.detJ.Size() == nq*mesh.GetNE());
+   Vector x(sdim);
+   double err = 0.0;
+   for (int e = 0; e < mesh.GetNE(); e++)
+   {
+      ElementTransformation &T = *mesh.GetElementTransformation(e);
+      for (int q = 0; q < nq; q++)
+      {
+         const IntegrationPoint &ip = ir.IntPoint(q);
+         T.SetIntPoint(&ip);
+         T.Transform(ip, x);
+         const int k = q + nq*e;
+         for (int i = 0; i < sdim; i++)
+         {
+            err = std::max(err, fabs(geom.X[i + sdim*k] - x(i)));
+         }
+         for (int i = 0; i < sdim*dim; i++)
+         {
+            err = std::max(err, fabs(geom.J[i + sdim*dim*k] -
+                                     T.Jacobian().Data()[i]));
+            err = std::max(err, fabs(geom.invJ[i + sdim*dim*k] -
+                                     T.InverseJacobian().Data()[i]));
+         }
+         err = std::max(err, fabs(geom.detJ[k] - T.Weight()));
+      }
+   }
+   REQUIRE(err < 1e-12);
+}
+
+static void perturb(const Vector &x, Vector &p)
+{
+   p = x;
+   p(0) += 0.05*sin(3.0*x(1));
+   p(1) += 0.05*sin(2.0*x(0));
+}
+
+TEST_CASE("Mesh geometric factors", "[Mesh]")
+{
+   const int all = GeometricFactors::COORDINATES |
+                   GeometricFactors::JACOBIANS |
+                   GeometricFactors::INVERSE_JACOBIANS |
+                   GeometricFactors::DETERMINANTS;
+
+   SECTION("Factors match the element transformations")
+   {
+      Mesh quad(3, 4, Element::QUADRILATERAL, false, 1.0, 2.0);
+      quad.Transform(perturb);
+      Mesh hex(3, 2, 2, Element::HEXAHEDRON);
+      hex.Transform(perturb);
+      Mesh curved(3, 3, Element::QUADRILATERAL);
+      curved.SetCurvature(3);
+      curved.Transform(perturb);
+      Mesh tet(2, 2, 2, Element::TETRAHEDRON);
+      Mesh *meshes[4] = { &quad, &hex, &curved, &tet };
+      for (int m = 0; m < 4; m++)
+      {
+         Mesh &mesh = *meshes[m];
+         const Geometry::Type geom = mesh.GetElementBaseGeometry(0);
+         for (int order = 1; order <= 6; order += 5)
+         {
+            const IntegrationRule &ir = IntRules.Get(geom, order);
+            check_geometric_factors(mesh, ir,
+                                    *mesh.GetGeometricFactors(ir, all));
+         }
+      }
+   }
+
+   SECTION("Factors are cached and updated with the mesh")
+   {
+      Mesh mesh(2, 3, 2, Element::HEXAHEDRON);
+      const IntegrationRule &ir = IntRules.Get(Geometry::CUBE, 3);
+      const GeometricFactors *detJ =
+         mesh.GetGeometricFactors(ir, GeometricFactors::DETERMINANTS);
+      REQUIRE(detJ->J.Size() == 0);
+      REQUIRE(mesh.GetGeometricFactors(ir, GeometricFactors::DETERMINANTS)
+              == detJ);
+      const GeometricFactors *geom = mesh.GetGeometricFactors(ir, all);
+      REQUIRE(geom != detJ);
+      REQUIRE(mesh.GetGeometricFactors(ir, GeometricFactors::JACOBIANS)
+              == geom);
+
+      mesh.Transform(perturb);
+      geom = mesh.GetGeometricFactors(ir, all);
+      check_geometric_factors(mesh, ir, *geom);
+
+      mesh.UniformRefinement();
+      geom = mesh.GetGeometricFactors(ir, all);
+      check_geometric_factors(mesh, ir, *geom);
+
+      mesh.EnsureNodes();
+      mesh.GetNodes()->operator*=(2.0);
+      mesh.NodesUpdated();
+      check_geometric_factors(mesh, ir, *mesh.GetGeometricFactors(ir, all));
+   }
+
+   SECTION("Factors are updated after in-place changes of the coordinates")
+   {
+      Mesh mesh(3, 2, Element::QUADRILATERAL);
+      const IntegrationRule &ir = IntRules.Get(Geometry::SQUARE, 3);
+      mesh.GetGeometricFactors(ir, all);
+      for (int i = 0; i < mesh.GetNV(); i++)
+      {
+         mesh.GetVertex(i)[0] *= 2.0;
+      }
+      check_geometric_factors(mesh, ir, *mesh.GetGeometricFactors(ir, all));
+
+      mesh.SetCurvature(2);
+      mesh.GetGeometricFactors(ir, all);
+      *mesh.GetNodes() *= 3.0;
+      check_geometric_factors(mesh, ir, *mesh.GetGeometricFactors(ir, all));
+   }
+
+   SECTION("Factors are keyed by the points of the rule")
+   {
+      Mesh mesh(3, 2, Element::QUADRILATERAL);
+      mesh.Transform(perturb);
+      const IntegrationRule &ir = IntRules.Get(Geometry::SQUARE, 3);
+      const GeometricFactors *geom = mesh.GetGeometricFactors(ir, all);
+      IntegrationRule *ir_copy = new IntegrationRule(ir);
+      REQUIRE(mesh.GetGeometricFactors(*ir_copy, all) == geom);
+      delete ir_copy;
+
+      // A rule of the same order and size, with another point.
+      IntegrationRule moved(ir);
+      moved.IntPoint(0).x += 0.1;
+      const GeometricFactors *moved_geom =
+         mesh.GetGeometricFactors(moved, all);
+      REQUIRE(moved_geom != geom);
+      check_geometric_factors(mesh, moved, *moved_geom);
+   }
+}
@@ -9,5 +9,24 @@
 // terms of the GNU Lesser General Public License (as published by the Free
 // Software Foundation) version 2.1 dated February 1999.
 
+#include "mfem.hpp"
+
+#ifndef MFEM_USE_MPI
+
 #define CATCH_CONFIG_MAIN     // This tells Catch to provide a main() - only do this in one cpp file
 #include "catch.hpp"
+
+#else
+
+// With MPI, the tests run inside an MPI session, so that the parallel tests
+// can use MPI_COMM_WORLD; the serial tests run independently on every rank.
+#define CATCH_CONFIG_RUNNER
+#include "catch.hpp"
+
+int main(int argc, char *argv[])
+{
+   mfem::MPI_Session mpi(argc, argv);
+   return Catch::Session().run(argc, argv);
+}
+
+#endif